@@ -1,10 +1,14 @@
 #include "config.h"
+#include "ext/threads_ext.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -12,6 +16,19 @@
 namespace po = boost::program_options;
 
 static boost::filesystem::path configFile;
+static boost::filesystem::path configSnapshotFile;
+
+static struct {
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable wakeUp;
+	bool running;
+	uintmax_t lastFullSize;
+} configCheckpoint;
+
+static bool caerConfigLoadSnapshot(void);
+static void caerConfigWriteSnapshot(bool onlyChanged);
+static void caerConfigCheckpointThread(void);
 
 [[ noreturn ]] static inline void printHelpAndExit(po::options_description &desc) {
 	std::cout << std::endl << desc << std::endl;
@@ -83,16 +100,21 @@ void caerConfigInit(int argc, char *argv[]) {
 		}
 	}
 
+	// Binary snapshot of the configuration lives next to the XML file.
+	configSnapshotFile = configFile;
+	configSnapshotFile += CAER_CONFIG_SNAPSHOT_SUFFIX;
+
 	// Let's try to open the file for reading, or create it.
 	int configFileFd = open(configFile.string().c_str(), O_RDONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP);
 
 	if (configFileFd >= 0) {
 		// File opened for reading (or created) successfully.
-		// Load XML configuration from file if not empty.
+		// Load XML configuration from file if not empty, unless there is an
+		// up-to-date binary snapshot, which is much faster to load.
 		struct stat configFileStat;
 		fstat(configFileFd, &configFileStat);
 
-		if (configFileStat.st_size > 0) {
+		if (!caerConfigLoadSnapshot() && configFileStat.st_size > 0) {
 			sshsNodeImportSubTreeFromXML(sshsGetNode(sshsGetGlobal(), "/"), configFileFd, true);
 		}
 
@@ -102,6 +124,9 @@ void caerConfigInit(int argc, char *argv[]) {
 		// it for writing the configuration later at shutdown.
 		configFile = boost::filesystem::canonical(configFile);
 
+		configSnapshotFile = configFile;
+		configSnapshotFile += CAER_CONFIG_SNAPSHOT_SUFFIX;
+
 		// Ensure configuration is written back at shutdown.
 		atexit(&caerConfigWriteBack);
 	}
@@ -151,9 +176,134 @@ void caerConfigInit(int argc, char *argv[]) {
 			iter += 4;
 		}
 	}
+
+	// Periodically save changed configuration to the binary snapshot.
+	sshsNode configNode = sshsGetNode(sshsGetGlobal(), "/caer/config/");
+
+	sshsNodeCreateInt(configNode, "checkpointInterval", 60, 0, 86400, SSHS_FLAGS_NORMAL,
+		"Interval in seconds for saving changed configuration to the binary snapshot (0 to disable).");
+
+	configCheckpoint.running = true;
+	configCheckpoint.thread = std::thread(&caerConfigCheckpointThread);
+}
+
+static bool caerConfigLoadSnapshot(void) {
+	boost::system::error_code ec;
+
+	// Only use the snapshot if it's at least as recent as the XML file,
+	// else the XML file was edited by hand and takes precedence.
+	if (!boost::filesystem::is_regular_file(configSnapshotFile, ec)
+		|| boost::filesystem::last_write_time(configSnapshotFile, ec)
+			< boost::filesystem::last_write_time(configFile, ec)) {
+		// Remove stale snapshot, so checkpoints don't append to it.
+		boost::filesystem::remove(configSnapshotFile, ec);
+		return (false);
+	}
+
+	int snapshotFd = open(configSnapshotFile.string().c_str(), O_RDONLY);
+	if (snapshotFd < 0) {
+		return (false);
+	}
+
+	bool result = sshsNodeImportSubTreeFromBinary(sshsGetNode(sshsGetGlobal(), "/"), snapshotFd, true);
+
+	close(snapshotFd);
+
+	if (result) {
+		configCheckpoint.lastFullSize = boost::filesystem::file_size(configSnapshotFile, ec);
+	}
+	else {
+		std::cout << "Failed to load configuration snapshot " << configSnapshotFile << ", using XML file." << std::endl;
+		boost::filesystem::remove(configSnapshotFile, ec);
+	}
+
+	return (result);
+}
+
+static void caerConfigWriteSnapshot(bool onlyChanged) {
+	std::string snapshotPath = configSnapshotFile.string();
+
+	if (onlyChanged) {
+		// Append changed nodes to the current snapshot. Compact it by writing
+		// a full one if it grew too much, or if there is none yet.
+		boost::system::error_code ec;
+		uintmax_t snapshotSize = boost::filesystem::file_size(configSnapshotFile, ec);
+
+		if (!ec && snapshotSize <= (configCheckpoint.lastFullSize * 2)) {
+			int snapshotFd = open(snapshotPath.c_str(), O_WRONLY | O_APPEND);
+
+			if (snapshotFd >= 0) {
+				sshsNodeExportSubTreeToBinary(sshsGetNode(sshsGetGlobal(), "/"), snapshotFd, true);
+
+				close(snapshotFd);
+				return;
+			}
+		}
+	}
+
+	// Full snapshot: write to temporary file and then replace, so that
+	// there always is a complete snapshot on disk.
+	std::string tmpSnapshotPath = snapshotPath + ".tmp";
+
+	int snapshotFd = open(tmpSnapshotPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR | S_IRGRP);
+
+	if (snapshotFd < 0) {
+		caerLog(CAER_LOG_ERROR, "Config", "Could not write to the configuration snapshot '%s'. Error: %d.",
+			tmpSnapshotPath.c_str(), errno);
+		return;
+	}
+
+	bool result = sshsNodeExportSubTreeToBinary(sshsGetNode(sshsGetGlobal(), "/"), snapshotFd, false);
+
+	struct stat snapshotStat;
+	fstat(snapshotFd, &snapshotStat);
+
+	close(snapshotFd);
+
+	if (result && rename(tmpSnapshotPath.c_str(), snapshotPath.c_str()) == 0) {
+		configCheckpoint.lastFullSize = (uintmax_t) snapshotStat.st_size;
+	}
+	else {
+		caerLog(CAER_LOG_ERROR, "Config", "Could not replace the configuration snapshot '%s'. Error: %d.",
+			snapshotPath.c_str(), errno);
+		unlink(tmpSnapshotPath.c_str());
+	}
+}
+
+static void caerConfigCheckpointThread(void) {
+	// Set thread name.
+	thrd_set_name("ConfigCheckpoint");
+
+	sshsNode configNode = sshsGetNode(sshsGetGlobal(), "/caer/config/");
+
+	std::unique_lock<std::mutex> lock(configCheckpoint.lock);
+
+	while (configCheckpoint.running) {
+		int32_t interval = sshsNodeGetInt(configNode, "checkpointInterval");
+
+		// Disabled: check again later if it was enabled.
+		configCheckpoint.wakeUp.wait_for(lock, std::chrono::seconds((interval > 0) ? (interval) : (1)));
+
+		if (!configCheckpoint.running || interval <= 0) {
+			continue;
+		}
+
+		caerConfigWriteSnapshot(true);
+	}
 }
 
 void caerConfigWriteBack(void) {
+	// Stop checkpoints, the final full snapshot is written below.
+	if (configCheckpoint.thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(configCheckpoint.lock);
+			configCheckpoint.running = false;
+		}
+
+		configCheckpoint.wakeUp.notify_all();
+		configCheckpoint.thread.join();
+	}
+
 	// configFile can only be correctly initialized, absolute and canonical
 	// by the point this function may ever be called, so we use it directly.
 	int configFileFd = open(configFile.string().c_str(), O_WRONLY | O_TRUNC);
@@ -162,6 +312,9 @@ void caerConfigWriteBack(void) {
 		sshsNodeExportSubTreeToXML(sshsGetNode(sshsGetGlobal(), "/"), configFileFd);
 
 		close(configFileFd);
+
+		// Write snapshot after XML, so it's the more recent one on next load.
+		caerConfigWriteSnapshot(false);
 	}
 	else {
 		caerLog(CAER_LOG_EMERGENCY, "Config", "Could not write to the configuration file '%s'. Error: %d.",
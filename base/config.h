@@ -8,6 +8,7 @@ extern "C" {
 #endif
 
 #define CAER_CONFIG_FILE_NAME "caer-config.xml"
+#define CAER_CONFIG_SNAPSHOT_SUFFIX ".snapshot"
 
 // Create configuration storage, initialize it with content from the
 // configuration file, and apply eventual CLI overrides.
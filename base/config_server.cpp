@@ -1,5 +1,6 @@
 #include "config_server.h"
 #include "mainloop.h"
+#include "metrics.h"
 #include "ext/threads_ext.h"
 #include "ext/pathmax.h"
 
@@ -7,6 +8,13 @@
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <chrono>
+#include <istream>
 
 #include <boost/asio.hpp>
 #include <boost/format.hpp>
@@ -21,27 +29,56 @@ using asioTCP = boost::asio::ip::tcp;
 
 #define CONFIG_SERVER_NAME "Config Server"
 
+// Maximum size of an HTTP request to the metrics endpoint (headers included).
+#define CONFIG_SERVER_METRICS_MAX_REQUEST (8 * 1024)
+
+// Maximum amount of queued, unsent data per client before notifications
+// are held back (and coalesced further) until the client catches up.
+#define CONFIG_SERVER_MAX_QUEUED_NOTIFY (256 * 1024)
+
+// Maximum amount of queued, unsent data per client before no more requests
+// are read from it, until enough of the queue has been written out.
+#define CONFIG_SERVER_MAX_QUEUED_READ (1024 * 1024)
+
 class ConfigServerConnection;
+class ConfigServerSubscription;
 
 static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection> client, uint8_t action, uint8_t type,
 	const uint8_t *extra, size_t extraLength, const uint8_t *node, size_t nodeLength, const uint8_t *key,
 	size_t keyLength, const uint8_t *value, size_t valueLength);
+static void caerConfigSendMultiResponse(std::shared_ptr<ConfigServerConnection> client, uint8_t action,
+	const std::vector<uint8_t> &msg);
+static inline void batchAppendString(std::vector<uint8_t> &msg, const char *str);
 
 class ConfigServerConnection: public std::enable_shared_from_this<ConfigServerConnection> {
 private:
+	asio::io_service &ioService;
 	asioTCP::socket socket;
+	/// Remote address and port, kept for logging even after the client disconnected.
+	std::string clientName;
 	uint8_t data[CAER_CONFIG_SERVER_BUFFER_SIZE];
+	/// Responses and notifications waiting to be written, in order.
+	std::deque<std::shared_ptr<std::vector<uint8_t>>> writeQueue;
+	size_t writeQueueSize;
+	/// Reading requests is paused, because too many responses are queued.
+	bool readPaused;
+	/// Active subscriptions, by node path.
+	std::map<std::string, std::shared_ptr<ConfigServerSubscription>> subscriptions;
 
 public:
-	ConfigServerConnection(asioTCP::socket s) :
-			socket(std::move(s)) {
-		log(logLevel::INFO, CONFIG_SERVER_NAME, "New connection from client %s:%d.",
-			socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
+	ConfigServerConnection(asioTCP::socket s, asio::io_service &ioServ) :
+			ioService(ioServ),
+			socket(std::move(s)),
+			clientName(remoteName(socket)),
+			writeQueueSize(0),
+			readPaused(false) {
+		log(logLevel::INFO, CONFIG_SERVER_NAME, "New connection from client %s.",
+			clientName.c_str());
 	}
 
 	~ConfigServerConnection() {
-		log(logLevel::INFO, CONFIG_SERVER_NAME, "Closing connection from client %s:%d.",
-			socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
+		log(logLevel::INFO, CONFIG_SERVER_NAME, "Closing connection from client %s.",
+			clientName.c_str());
 	}
 
 	void start() {
@@ -52,22 +89,78 @@ public:
 		return (data);
 	}
 
+	asio::io_service &getIOService() {
+		return (ioService);
+	}
+
+	size_t getWriteQueueSize() const {
+		return (writeQueueSize);
+	}
+
+	void writeResponse(std::shared_ptr<std::vector<uint8_t>> response) {
+		queueWrite(response);
+	}
+
 	void writeResponse(size_t dataLength) {
+		// Copy out of the data buffer, so that the next request can be read
+		// while this response is still waiting to be written.
+		queueWrite(std::make_shared<std::vector<uint8_t>>(data, data + dataLength));
+	}
+
+	void addSubscription(const std::string &nodePath, std::shared_ptr<ConfigServerSubscription> subscription);
+	bool removeSubscription(const std::string &nodePath);
+
+private:
+	void queueWrite(std::shared_ptr<std::vector<uint8_t>> buffer) {
+		bool writeInProgress = !writeQueue.empty();
+
+		writeQueue.push_back(buffer);
+		writeQueueSize += buffer->size();
+
+		if (!writeInProgress) {
+			writeNext();
+		}
+	}
+
+	void writeNext() {
 		auto self(shared_from_this());
 
-		asio::async_write(socket, asio::buffer(data, dataLength),
+		// The buffer stays alive in the queue until the write is complete.
+		asio::async_write(socket, asio::buffer(*writeQueue.front()),
 			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to write response");
+					return;
 				}
-				else {
-					// Restart.
+
+				writeQueueSize -= writeQueue.front()->size();
+				writeQueue.pop_front();
+
+				// Enough was written out, continue with the next request.
+				if (readPaused && writeQueueSize <= CONFIG_SERVER_MAX_QUEUED_READ) {
+					readPaused = false;
 					readHeader();
 				}
+
+				if (!writeQueue.empty()) {
+					writeNext();
+				}
 			});
 	}
 
-private:
+	void stopSubscriptions();
+
+	static std::string remoteName(asioTCP::socket &sock) {
+		boost::system::error_code error;
+		asioTCP::endpoint endpoint = sock.remote_endpoint(error);
+
+		if (error) {
+			return ("unknown");
+		}
+
+		return (endpoint.address().to_string() + ":" + std::to_string(endpoint.port()));
+	}
+
 	void readHeader() {
 		auto self(shared_from_this());
 
@@ -91,8 +184,8 @@ private:
 					// Check for wrong (excessive) requested read length.
 					// Close connection by falling out of scope.
 					if (readLength > (CAER_CONFIG_SERVER_BUFFER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE)) {
-						log(logLevel::INFO, CONFIG_SERVER_NAME, "Client %s:%d: read length error (%d bytes requested).",
-							socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port(), readLength);
+						log(logLevel::INFO, CONFIG_SERVER_NAME, "Client %s: read length error (%d bytes requested).",
+							clientName.c_str(), readLength);
 						return;
 					}
 
@@ -128,37 +221,454 @@ private:
 					const uint8_t *value = (valueLength == 0) ? (nullptr) : (data + CAER_CONFIG_SERVER_HEADER_SIZE + extraLength + nodeLength + keyLength);
 
 					caerConfigServerHandleRequest(self, action, type, extra, extraLength, node, nodeLength, key, keyLength, value, valueLength);
+
+					// Responses are queued, so we can go on reading the next request,
+					// unless the client isn't picking them up. Then the next write
+					// completion resumes reading, once the queue drained enough.
+					if (writeQueueSize > CONFIG_SERVER_MAX_QUEUED_READ) {
+						readPaused = true;
+					}
+					else {
+						readHeader();
+					}
 				}
 			});
 	}
 
 	void handleError(const boost::system::error_code &error, const char *message) {
+		// Connection is going away, stop sending notifications to it.
+		stopSubscriptions();
+
 		if (error == asio::error::eof) {
 			// Handle EOF separately.
-			log(logLevel::INFO, CONFIG_SERVER_NAME, "Client %s:%d: connection closed.",
-				socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
+			log(logLevel::INFO, CONFIG_SERVER_NAME, "Client %s: connection closed.",
+				clientName.c_str());
 		}
 		else {
-			log(logLevel::ERROR, CONFIG_SERVER_NAME, "Client %s:%d: %s. Error: %s (%d).",
-				socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port(), message,
+			log(logLevel::ERROR, CONFIG_SERVER_NAME, "Client %s: %s. Error: %s (%d).",
+				clientName.c_str(), message,
 				error.message().c_str(), error.value());
 		}
 	}
 };
 
+// Pushes attribute changes on a node (or a whole subtree) to a client.
+// SSHS listeners can be called from any thread: changes are collected in
+// 'pending', coalescing multiple changes of the same attribute, and then
+// sent out from the server's IO thread, at most once every 'minInterval'.
+//
+// Lifetime: SSHS listeners never get a pointer to the subscription, only
+// its ID in 'registry', which maps it to a weak_ptr. A subscription is
+// registered from start() until stop(), and listener calls only reach it
+// in between, holding a reference while they run. Calls from any thread
+// racing with or following stop() find nothing and return, so freeing a
+// subscription never depends on which thread notifies or removes nodes.
+class ConfigServerSubscription: public std::enable_shared_from_this<ConfigServerSubscription> {
+private:
+	static std::mutex registryLock;
+	static std::map<uintptr_t, std::weak_ptr<ConfigServerSubscription>> registry;
+	static uintptr_t registryNextID;
+
+	/// Key in the registry, given to SSHS listeners as userData.
+	uintptr_t id;
+	std::weak_ptr<ConfigServerConnection> client;
+	asio::io_service &ioService;
+	asio::steady_timer timer;
+	const bool subTree;
+	const std::chrono::milliseconds minInterval;
+	std::chrono::steady_clock::time_point lastFlush;
+	/// Latest change per (node, key, type): event and value string.
+	std::map<std::tuple<std::string, std::string, uint8_t>, std::pair<uint8_t, std::string>> pending;
+	bool flushScheduled;
+	std::mutex pendingLock;
+	/// Nodes with listeners installed, by path. Updated from listeners too.
+	std::map<std::string, sshsNode> nodes;
+	bool active;
+	std::mutex nodesLock;
+
+public:
+	ConfigServerSubscription(std::shared_ptr<ConfigServerConnection> cl, bool subscribeSubTree,
+		std::chrono::milliseconds interval) :
+			id(0),
+			client(cl),
+			ioService(cl->getIOService()),
+			timer(cl->getIOService()),
+			subTree(subscribeSubTree),
+			minInterval(interval),
+			flushScheduled(false),
+			active(true) {
+	}
+
+	void start(sshsNode node) {
+		{
+			std::lock_guard<std::mutex> lock(registryLock);
+
+			id = registryNextID++;
+			registry[id] = shared_from_this();
+		}
+
+		addNode(node);
+	}
+
+	// Unregister and remove all listeners. After this returns, no listener
+	// calls into this subscription anymore.
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(registryLock);
+			registry.erase(id);
+		}
+
+		std::map<std::string, sshsNode> stopNodes;
+
+		{
+			std::lock_guard<std::mutex> lock(nodesLock);
+			active = false;
+			stopNodes.swap(nodes);
+		}
+
+		sshs configStore = sshsGetGlobal();
+
+		for (const auto &node : stopNodes) {
+			// Only cleanup, unregistering above already made the listeners
+			// harmless. Removed nodes took their listeners with them; like
+			// anyone holding a node, this relies on SSHS' rule that nodes are
+			// not removed while still in use elsewhere (sshsNodeRemoveNode()).
+			if (!sshsExistsNode(configStore, node.first) || sshsGetNode(configStore, node.first) != node.second) {
+				continue;
+			}
+
+			sshsNodeRemoveAttributeListener(node.second, userData(), &attributeChangedListener);
+
+			if (subTree) {
+				sshsNodeRemoveNodeListener(node.second, userData(), &nodeChangedListener);
+			}
+		}
+
+		timer.cancel();
+	}
+
+private:
+	void *userData() const {
+		return (reinterpret_cast<void *>(id));
+	}
+
+	// Registered subscription for a listener call, nullptr once stopped.
+	static std::shared_ptr<ConfigServerSubscription> lookup(void *userData) {
+		std::lock_guard<std::mutex> lock(registryLock);
+
+		auto iter = registry.find(reinterpret_cast<uintptr_t>(userData));
+		if (iter == registry.end()) {
+			return (nullptr);
+		}
+
+		return (iter->second.lock());
+	}
+
+	void addNode(sshsNode node) {
+		{
+			std::lock_guard<std::mutex> lock(nodesLock);
+
+			if (!active) {
+				return;
+			}
+
+			nodes[sshsNodeGetPath(node)] = node;
+		}
+
+		// Duplicate listeners are ignored by SSHS, so racing with a
+		// concurrent child addition is fine.
+		// Listeners can't be added while holding nodesLock: SSHS calls them
+		// with its node lock held, and nodeChangedListener takes nodesLock.
+		sshsNodeAddAttributeListener(node, userData(), &attributeChangedListener);
+
+		if (subTree) {
+			sshsNodeAddNodeListener(node, userData(), &nodeChangedListener);
+		}
+
+		// A concurrent stop() may have run its removals before the listeners
+		// above were in place, so check again and take them out ourselves.
+		bool stopped;
+
+		{
+			std::lock_guard<std::mutex> lock(nodesLock);
+			stopped = !active;
+		}
+
+		if (stopped) {
+			sshsNodeRemoveAttributeListener(node, userData(), &attributeChangedListener);
+
+			if (subTree) {
+				sshsNodeRemoveNodeListener(node, userData(), &nodeChangedListener);
+			}
+
+			return;
+		}
+
+		if (subTree) {
+			size_t numChildren;
+			sshsNode *children = sshsNodeGetChildren(node, &numChildren);
+
+			for (size_t i = 0; i < numChildren; i++) {
+				addNode(children[i]);
+			}
+
+			free(children);
+		}
+	}
+
+	static void nodeChangedListener(sshsNode node, void *userData, enum sshs_node_node_events event,
+		const char *changeNode) {
+		auto subscription = lookup(userData);
+		if (!subscription) {
+			return;
+		}
+
+		if (event == SSHS_CHILD_NODE_ADDED) {
+			const std::string childPath = std::string(changeNode) + "/";
+
+			if (sshsExistsRelativeNode(node, childPath)) {
+				subscription->addNode(sshsGetRelativeNode(node, childPath));
+			}
+		}
+	}
+
+	static void attributeChangedListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+		auto subscription = lookup(userData);
+		if (!subscription) {
+			return;
+		}
+
+		char *valueStr = sshsHelperValueToStringConverter(changeType, changeValue);
+
+		{
+			std::lock_guard<std::mutex> lock(subscription->pendingLock);
+
+			subscription->pending[std::make_tuple(std::string(sshsNodeGetPath(node)), std::string(changeKey),
+				U8T(changeType))] = std::make_pair(U8T(event), std::string((valueStr == nullptr) ? ("") : (valueStr)));
+
+			if (!subscription->flushScheduled) {
+				subscription->flushScheduled = true;
+
+				// Continue on the IO thread.
+				auto self(subscription);
+				subscription->ioService.post([self]() {
+					self->scheduleFlush();
+				});
+			}
+		}
+
+		free(valueStr);
+	}
+
+	void scheduleFlush() {
+		auto nextFlush = lastFlush + minInterval;
+
+		// Hold back notifications while the client can't keep up.
+		auto cl = client.lock();
+		if (cl && cl->getWriteQueueSize() > CONFIG_SERVER_MAX_QUEUED_NOTIFY) {
+			nextFlush = std::max(nextFlush, std::chrono::steady_clock::now() + std::chrono::milliseconds(10));
+		}
+
+		if (std::chrono::steady_clock::now() >= nextFlush) {
+			flush();
+			return;
+		}
+
+		auto self(shared_from_this());
+
+		timer.expires_at(nextFlush);
+		timer.async_wait([self](const boost::system::error_code &error) {
+			if (error != asio::error::operation_aborted) {
+				self->scheduleFlush();
+			}
+		});
+	}
+
+	void flush() {
+		decltype(pending) changes;
+
+		{
+			std::lock_guard<std::mutex> lock(pendingLock);
+			changes.swap(pending);
+			flushScheduled = false;
+		}
+
+		lastFlush = std::chrono::steady_clock::now();
+
+		auto cl = client.lock();
+		if (!cl || changes.empty()) {
+			return;
+		}
+
+		std::vector<uint8_t> msg;
+
+		for (const auto &change : changes) {
+			msg.push_back(change.second.first);
+			msg.push_back(std::get<2>(change.first));
+			batchAppendString(msg, std::get<0>(change.first).c_str());
+			batchAppendString(msg, std::get<1>(change.first).c_str());
+			batchAppendString(msg, change.second.second.c_str());
+		}
+
+		caerConfigSendMultiResponse(cl, CAER_CONFIG_NOTIFY, msg);
+	}
+};
+
+std::mutex ConfigServerSubscription::registryLock;
+std::map<uintptr_t, std::weak_ptr<ConfigServerSubscription>> ConfigServerSubscription::registry;
+uintptr_t ConfigServerSubscription::registryNextID = 1;
+
+void ConfigServerConnection::addSubscription(const std::string &nodePath,
+	std::shared_ptr<ConfigServerSubscription> subscription) {
+	// Replace any previous subscription to the same node.
+	removeSubscription(nodePath);
+
+	subscriptions[nodePath] = subscription;
+}
+
+bool ConfigServerConnection::removeSubscription(const std::string &nodePath) {
+	auto iter = subscriptions.find(nodePath);
+	if (iter == subscriptions.end()) {
+		return (false);
+	}
+
+	iter->second->stop();
+	subscriptions.erase(iter);
+
+	return (true);
+}
+
+void ConfigServerConnection::stopSubscriptions() {
+	for (const auto &subscription : subscriptions) {
+		subscription.second->stop();
+	}
+
+	subscriptions.clear();
+}
+
+// Minimal HTTP/1.1 server for metrics scraping: one GET request per
+// connection, answered with the current metrics in Prometheus text format.
+class MetricsConnection: public std::enable_shared_from_this<MetricsConnection> {
+private:
+	asioTCP::socket socket;
+	asio::streambuf request;
+	std::string response;
+
+public:
+	MetricsConnection(asioTCP::socket s) :
+			socket(std::move(s)),
+			request(CONFIG_SERVER_METRICS_MAX_REQUEST) {
+	}
+
+	void start() {
+		auto self(shared_from_this());
+
+		asio::async_read_until(socket, request, "\r\n\r\n",
+			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					// Client went away, or request too big: just close.
+					return;
+				}
+
+				handleRequest();
+			});
+	}
+
+private:
+	void handleRequest() {
+		std::istream requestStream(&request);
+		std::string method, target;
+		requestStream >> method >> target;
+
+		// Ignore any query string.
+		target = target.substr(0, target.find('?'));
+
+		if (method != "GET") {
+			writeResponse("405 Method Not Allowed", "Only GET is supported.\n");
+		}
+		else if (target != "/metrics" && target != "/") {
+			writeResponse("404 Not Found", "Metrics are at /metrics.\n");
+		}
+		else {
+			char *metrics = caerMetricsRenderText();
+			if (metrics == nullptr) {
+				writeResponse("500 Internal Server Error", "Failed to render metrics.\n");
+				return;
+			}
+
+			writeResponse("200 OK", metrics);
+
+			free(metrics);
+		}
+	}
+
+	void writeResponse(const char *status, const char *body) {
+		size_t bodyLength = strlen(body);
+
+		response = std::string("HTTP/1.1 ") + status + "\r\n"
+			+ "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+			+ "Content-Length: " + std::to_string(bodyLength) + "\r\n"
+			+ "Connection: close\r\n\r\n";
+		response.append(body, bodyLength);
+
+		auto self(shared_from_this());
+
+		asio::async_write(socket, asio::buffer(response),
+			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					return;
+				}
+
+				boost::system::error_code ignored;
+				socket.shutdown(asioTCP::socket::shutdown_both, ignored);
+			});
+	}
+};
+
 class ConfigServer {
 private:
 	asio::io_service ioService;
 	asioTCP::acceptor acceptor;
 	asioTCP::socket socket;
+	asioTCP::acceptor metricsAcceptor;
+	asioTCP::socket metricsSocket;
 	std::thread ioThread;
 
 public:
-	ConfigServer(const asioIP::address &listenAddress, unsigned short listenPort) :
+	ConfigServer(const asioIP::address &listenAddress, unsigned short listenPort, unsigned short metricsPort) :
 			acceptor(ioService, asioTCP::endpoint(listenAddress, listenPort)),
-			socket(ioService) {
+			socket(ioService),
+			metricsAcceptor(ioService),
+			metricsSocket(ioService) {
 		acceptStart();
 
+		// Metrics endpoint is optional (port 0). Failing to open it is not
+		// fatal, configuration is more important than monitoring.
+		if (metricsPort != 0) {
+			asioTCP::endpoint metricsEndpoint(listenAddress, metricsPort);
+			boost::system::error_code error;
+
+			metricsAcceptor.open(metricsEndpoint.protocol(), error);
+			if (!error) {
+				metricsAcceptor.set_option(asioTCP::acceptor::reuse_address(true), error);
+			}
+			if (!error) {
+				metricsAcceptor.bind(metricsEndpoint, error);
+			}
+			if (!error) {
+				metricsAcceptor.listen(asio::socket_base::max_connections, error);
+			}
+
+			if (error) {
+				log(logLevel::ERROR, CONFIG_SERVER_NAME, "Failed to start metrics server on port %d. Error: %s (%d).",
+					metricsPort, error.message().c_str(), error.value());
+			}
+			else {
+				metricsAcceptStart();
+			}
+		}
+
 		threadStart();
 	}
 
@@ -174,13 +684,28 @@ private:
 					"Failed to accept new connection. Error: %s (%d).", error.message().c_str(), error.value());
 			}
 			else {
-				std::make_shared<ConfigServerConnection>(std::move(socket))->start();
+				std::make_shared<ConfigServerConnection>(std::move(socket), ioService)->start();
 			}
 
 			acceptStart();
 		});
 	}
 
+	void metricsAcceptStart() {
+		metricsAcceptor.async_accept(metricsSocket, [this](const boost::system::error_code &error) {
+			if (error) {
+				log(logLevel::ERROR, CONFIG_SERVER_NAME,
+					"Failed to accept new metrics connection. Error: %s (%d).", error.message().c_str(),
+					error.value());
+			}
+			else {
+				std::make_shared<MetricsConnection>(std::move(metricsSocket))->start();
+			}
+
+			metricsAcceptStart();
+		});
+	}
+
 	void threadStart() {
 		ioThread = std::thread([this]() {
 			// Set thread name.
@@ -214,12 +739,14 @@ void caerConfigServerStart(void) {
 		"IPv4 address to listen on for configuration server connections.");
 	sshsNodeCreate(serverNode, "portNumber", 4040, 1, UINT16_MAX, SSHS_FLAGS_NORMAL,
 		"Port to listen on for configuration server connections.");
+	sshsNodeCreate(serverNode, "metricsPortNumber", 4041, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Port to serve metrics on over HTTP (Prometheus text format, GET /metrics), on the same address. 0 disables it.");
 
 	// Start the thread.
 	try {
 		glConfigServerData.server = std::make_unique<ConfigServer>(
 			asioIP::address::from_string(sshsNodeGetStdString(serverNode, "ipAddress")),
-			sshsNodeGetInt(serverNode, "portNumber"));
+			sshsNodeGetInt(serverNode, "portNumber"), sshsNodeGetInt(serverNode, "metricsPortNumber"));
 	}
 	catch (const std::system_error &ex) {
 		// Failed to create thread.
@@ -288,8 +815,9 @@ static inline void caerConfigSendResponse(std::shared_ptr<ConfigServerConnection
 		"Sent back message to client: action=%" PRIu8 ", type=%" PRIu8 ", msgLength=%zu.", action, type, msgLength);
 }
 
-static inline bool checkNodeExists(sshs configStore, const char *node, std::shared_ptr<ConfigServerConnection> client) {
-	bool nodeExists = sshsExistsNode(configStore, node);
+static inline bool checkNodeExists(sshs configStore, const char *node, size_t nodeLength,
+	std::shared_ptr<ConfigServerConnection> client) {
+	bool nodeExists = sshsExistsNodeN(configStore, node, nodeLength);
 
 	// Only allow operations on existing nodes, this is for remote
 	// control, so we only manipulate what's already there!
@@ -315,6 +843,121 @@ static inline bool checkAttributeExists(sshsNode wantedNode, const char *key, en
 	return (attrExists);
 }
 
+// Split a response into as many messages as needed. TYPE is used to signal
+// if more messages follow (1) or if this is the last one (0).
+static void caerConfigSendMultiResponse(std::shared_ptr<ConfigServerConnection> client, uint8_t action,
+	const std::vector<uint8_t> &msg) {
+	const size_t maxMsgLength = CAER_CONFIG_SERVER_BUFFER_SIZE - 4;
+
+	auto response = std::make_shared<std::vector<uint8_t>>();
+	response->reserve(msg.size() + (4 * ((msg.size() / maxMsgLength) + 1)));
+
+	size_t offset = 0;
+
+	do {
+		size_t msgLength = std::min(maxMsgLength, msg.size() - offset);
+		bool lastMsg = ((offset + msgLength) == msg.size());
+
+		uint8_t header[4] = { action, (lastMsg) ? (U8T(0)) : (U8T(1)), 0, 0 };
+		setMsgLen(header, (uint16_t) msgLength);
+
+		response->insert(response->end(), header, header + 4);
+		response->insert(response->end(), msg.begin() + (ptrdiff_t) offset,
+			msg.begin() + (ptrdiff_t) (offset + msgLength));
+
+		offset += msgLength;
+	}
+	while (offset < msg.size());
+
+	client->writeResponse(response);
+
+	caerLog(CAER_LOG_DEBUG, CONFIG_SERVER_NAME, "Sent back multi-part message to client: action=%" PRIu8 ", msgLength=%zu.",
+		action, msg.size());
+}
+
+// Get the next NUL terminated string from a batch request.
+static inline bool batchNextString(const uint8_t **pos, const uint8_t *end, const char **str, size_t *strLength) {
+	const uint8_t *nul = (const uint8_t *) memchr(*pos, '\0', (size_t) (end - *pos));
+	if (nul == nullptr) {
+		return (false);
+	}
+
+	*str = (const char *) *pos;
+	*strLength = (size_t) (nul - *pos);
+
+	*pos = nul + 1;
+
+	return (true);
+}
+
+static inline void batchAppendString(std::vector<uint8_t> &msg, const char *str) {
+	msg.insert(msg.end(), (const uint8_t *) str, (const uint8_t *) str + strlen(str) + 1);
+}
+
+static inline void batchAppendValue(std::vector<uint8_t> &msg, sshsNode node, const char *key,
+	enum sshs_node_attr_value_type type) {
+	union sshs_node_attr_value value = sshsNodeGetAttribute(node, key, type);
+
+	char *valueStr = sshsHelperValueToStringConverter(type, value);
+
+	if (type == SSHS_STRING) {
+		free(value.string);
+	}
+
+	// Out of memory: send back an empty value, but keep the format intact.
+	batchAppendString(msg, (valueStr == nullptr) ? ("") : (valueStr));
+
+	free(valueStr);
+}
+
+static void caerConfigDumpSubTree(sshsNode node, const std::string &relativePath, std::vector<uint8_t> &msg) {
+	msg.push_back(CAER_CONFIG_BATCH_NODE);
+	batchAppendString(msg, relativePath.c_str());
+
+	size_t numKeys;
+	const char **keys = sshsNodeGetAttributeKeys(node, &numKeys);
+
+	for (size_t i = 0; i < numKeys; i++) {
+		size_t numTypes;
+		enum sshs_node_attr_value_type *types = sshsNodeGetAttributeTypes(node, keys[i], &numTypes);
+
+		for (size_t j = 0; j < numTypes; j++) {
+			msg.push_back(U8T(types[j]));
+			batchAppendString(msg, keys[i]);
+			batchAppendValue(msg, node, keys[i], types[j]);
+		}
+
+		free(types);
+	}
+
+	free(keys);
+
+	size_t numChildren;
+	sshsNode *children = sshsNodeGetChildren(node, &numChildren);
+
+	for (size_t i = 0; i < numChildren; i++) {
+		caerConfigDumpSubTree(children[i], relativePath + sshsNodeGetName(children[i]) + "/", msg);
+	}
+
+	free(children);
+}
+
+struct config_batch_put {
+	sshsNode node;
+	std::string nodePath;
+	const char *key;
+	enum sshs_node_attr_value_type type;
+	union sshs_node_attr_value value;
+};
+
+static inline void batchPutFree(std::vector<struct config_batch_put> &puts) {
+	for (const auto &put : puts) {
+		if (put.type == SSHS_STRING) {
+			free(put.value.string);
+		}
+	}
+}
+
 static inline void caerConfigSendBoolResponse(std::shared_ptr<ConfigServerConnection> client, uint8_t action,
 	bool result) {
 	// Send back result to client. Format is the same as incoming data.
@@ -335,12 +978,15 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 	// Interpretation of data is up to each action individually.
 	sshs configStore = sshsGetGlobal();
 
+	// Node paths are sent NUL terminated, their length is known already.
+	size_t nodePathLength = (nodeLength > 0 && node[nodeLength - 1] == '\0') ? (nodeLength - 1) : (nodeLength);
+
 	switch (action) {
 		case CAER_CONFIG_NODE_EXISTS: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
 			// We only need the node name here. Type is not used (ignored)!
-			bool result = sshsExistsNode(configStore, (const char *) node);
+			bool result = sshsExistsNodeN(configStore, (const char *) node, nodePathLength);
 
 			// Send back result to client. Format is the same as incoming data.
 			caerConfigSendBoolResponse(client, CAER_CONFIG_NODE_EXISTS, result);
@@ -351,12 +997,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_ATTR_EXISTS: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			// Check if attribute exists.
 			bool result = sshsNodeAttributeExists(wantedNode, (const char *) key,
@@ -371,12 +1017,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_GET: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			if (!checkAttributeExists(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type, client)) {
 				break;
@@ -410,12 +1056,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_PUT: {
 			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			if (!checkAttributeExists(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type, client)) {
 				break;
@@ -451,12 +1097,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_GET_CHILDREN: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			// Get the names of all the child nodes and return them.
 			size_t numNames;
@@ -498,12 +1144,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_GET_ATTRIBUTES: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			// Get the keys of all the attributes and return them.
 			size_t numKeys;
@@ -545,12 +1191,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_GET_TYPES: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			// Check if any keys match the given one and return its types.
 			size_t numTypes;
@@ -595,12 +1241,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_GET_RANGES: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			if (!checkAttributeExists(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type, client)) {
 				break;
@@ -644,12 +1290,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_GET_FLAGS: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			if (!checkAttributeExists(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type, client)) {
 				break;
@@ -683,12 +1329,12 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		case CAER_CONFIG_GET_DESCRIPTION: {
 			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
-			if (!checkNodeExists(configStore, (const char *) node, client)) {
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
 				break;
 			}
 
 			// This cannot fail, since we know the node exists from above.
-			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
 
 			if (!checkAttributeExists(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type, client)) {
 				break;
@@ -840,6 +1486,242 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			break;
 		}
 
+		case CAER_CONFIG_GET_BATCH: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			std::vector<uint8_t> response;
+			response.reserve(valueLength * 2);
+
+			const uint8_t *pos = value;
+			const uint8_t *end = value + valueLength;
+			sshsNode batchNode = nullptr;
+			bool batchError = false;
+
+			while (pos < end) {
+				uint8_t entryType = *pos++;
+
+				const char *entryNode, *entryKey;
+				size_t entryNodeLength, entryKeyLength;
+
+				if (!batchNextString(&pos, end, &entryNode, &entryNodeLength)
+					|| !batchNextString(&pos, end, &entryKey, &entryKeyLength)) {
+					batchError = true;
+					break;
+				}
+
+				// Empty node: same as previous entry.
+				if (entryNodeLength != 0) {
+					batchNode =
+						(sshsExistsNodeN(configStore, entryNode, entryNodeLength)) ?
+							(sshsGetNodeN(configStore, entryNode, entryNodeLength)) : (nullptr);
+				}
+
+				if (batchNode == nullptr || entryType > SSHS_STRING
+					|| !sshsNodeAttributeExists(batchNode, entryKey, (enum sshs_node_attr_value_type) entryType)) {
+					response.push_back(CAER_CONFIG_BATCH_NOT_FOUND);
+					response.push_back('\0');
+					continue;
+				}
+
+				response.push_back(entryType);
+				batchAppendValue(response, batchNode, entryKey, (enum sshs_node_attr_value_type) entryType);
+			}
+
+			if (batchError) {
+				caerConfigSendError(client, "Malformed batch request.");
+				break;
+			}
+
+			caerConfigSendMultiResponse(client, CAER_CONFIG_GET_BATCH, response);
+
+			break;
+		}
+
+		case CAER_CONFIG_PUT_BATCH: {
+			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			std::vector<struct config_batch_put> puts;
+
+			const uint8_t *pos = value;
+			const uint8_t *end = value + valueLength;
+			struct config_batch_put *lastPut = nullptr;
+			const char *batchError = nullptr;
+			size_t batchEntry = 0;
+
+			// First parse and check all entries, nothing is changed yet.
+			while (pos < end) {
+				batchEntry++;
+
+				uint8_t entryType = *pos++;
+
+				const char *entryNode, *entryKey, *entryValue;
+				size_t entryNodeLength, entryKeyLength, entryValueLength;
+
+				if (!batchNextString(&pos, end, &entryNode, &entryNodeLength)
+					|| !batchNextString(&pos, end, &entryKey, &entryKeyLength)
+					|| !batchNextString(&pos, end, &entryValue, &entryValueLength)) {
+					batchError = "Malformed batch request.";
+					break;
+				}
+
+				struct config_batch_put put;
+
+				// Empty node: same as previous entry.
+				if (entryNodeLength != 0) {
+					if (!sshsExistsNodeN(configStore, entryNode, entryNodeLength)) {
+						batchError = "Node doesn't exist. Operations are only allowed on existing data.";
+						break;
+					}
+
+					put.node = sshsGetNodeN(configStore, entryNode, entryNodeLength);
+					put.nodePath = std::string(entryNode, entryNodeLength);
+				}
+				else if (lastPut != nullptr) {
+					put.node = lastPut->node;
+					put.nodePath = lastPut->nodePath;
+				}
+				else {
+					batchError = "Malformed batch request.";
+					break;
+				}
+
+				put.key = entryKey;
+				put.type = (enum sshs_node_attr_value_type) entryType;
+
+				if (entryType > SSHS_STRING || !sshsHelperStringToValueConverter(put.type, entryValue, &put.value)) {
+					batchError = "Impossible to convert value according to type.";
+					break;
+				}
+
+				puts.push_back(put);
+				lastPut = &puts.back();
+
+				if (!sshsNodeCheckAttributeValue(put.node, put.key, put.type, put.value)) {
+					if (errno == ENOENT) {
+						batchError =
+							"Attribute of given type doesn't exist. Operations are only allowed on existing data.";
+					}
+					else if (errno == EPERM) {
+						batchError = "Cannot write to a read-only attribute.";
+					}
+					else if (errno == ERANGE) {
+						batchError = "Value out of attribute range.";
+					}
+					else {
+						batchError = "Unknown error.";
+					}
+					break;
+				}
+			}
+
+			if (batchError != nullptr) {
+				batchPutFree(puts);
+
+				char errorMsg[256];
+				snprintf(errorMsg, 256, "Batch entry %zu: %s", batchEntry, batchError);
+				caerConfigSendError(client, errorMsg);
+				break;
+			}
+
+			// Lock all nodes involved (in a fixed order), so that other users
+			// of SSHS see either none or all of the changes.
+			std::vector<std::string> nodePaths;
+			for (const auto &put : puts) {
+				nodePaths.push_back(put.nodePath);
+			}
+
+			vectorSortUnique(nodePaths);
+
+			std::vector<char *> nodePathsPtrs;
+			for (const auto &nodePath : nodePaths) {
+				nodePathsPtrs.push_back(const_cast<char *>(nodePath.c_str()));
+			}
+
+			sshsBeginTransaction(configStore, nodePathsPtrs.data(), nodePathsPtrs.size());
+
+			for (const auto &put : puts) {
+				// Already checked above, so this cannot fail.
+				sshsNodePutAttribute(put.node, put.key, put.type, put.value);
+			}
+
+			sshsEndTransaction(configStore, nodePathsPtrs.data(), nodePathsPtrs.size());
+
+			batchPutFree(puts);
+
+			// Send back confirmation to the client.
+			caerConfigSendBoolResponse(client, CAER_CONFIG_PUT_BATCH, true);
+
+			break;
+		}
+
+		case CAER_CONFIG_GET_SUBTREE: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
+
+			std::vector<uint8_t> response;
+			caerConfigDumpSubTree(wantedNode, "", response);
+
+			caerConfigSendMultiResponse(client, CAER_CONFIG_GET_SUBTREE, response);
+
+			break;
+		}
+
+		case CAER_CONFIG_SUBSCRIBE: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkNodeExists(configStore, (const char *) node, nodePathLength, client)) {
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNodeN(configStore, (const char *) node, nodePathLength);
+
+			// Optional minimum interval between notifications, in ms.
+			long interval = 0;
+
+			if (value != nullptr) {
+				char *endPtr = nullptr;
+				errno = 0;
+				interval = strtol((const char *) value, &endPtr, 10);
+
+				if (errno != 0 || endPtr == (const char *) value || *endPtr != '\0' || interval < 0
+					|| interval > CAER_CONFIG_SUBSCRIBE_MAX_INTERVAL) {
+					caerConfigSendError(client, "Invalid notification interval.");
+					break;
+				}
+			}
+
+			auto subscription = std::make_shared<ConfigServerSubscription>(client, (type != 0),
+				std::chrono::milliseconds(interval));
+
+			client->addSubscription(std::string((const char *) node, nodePathLength), subscription);
+
+			subscription->start(wantedNode);
+
+			// Send back confirmation to the client.
+			caerConfigSendBoolResponse(client, CAER_CONFIG_SUBSCRIBE, true);
+
+			break;
+		}
+
+		case CAER_CONFIG_UNSUBSCRIBE: {
+			if (node == nullptr || !client->removeSubscription(std::string((const char *) node, nodePathLength))) {
+				caerConfigSendError(client, "No subscription to this node exists.");
+				break;
+			}
+
+			// Send back confirmation to the client.
+			caerConfigSendBoolResponse(client, CAER_CONFIG_UNSUBSCRIBE, true);
+
+			break;
+		}
+
 		default: {
 			// Unknown action, send error back to client.
 			caerConfigSendError(client, "Unknown action.");
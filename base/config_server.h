@@ -31,8 +31,51 @@ enum caer_config_actions {
 	CAER_CONFIG_GET_DESCRIPTION = 10,
 	CAER_CONFIG_ADD_MODULE = 11,
 	CAER_CONFIG_REMOVE_MODULE = 12,
+	CAER_CONFIG_GET_BATCH = 13,
+	CAER_CONFIG_PUT_BATCH = 14,
+	CAER_CONFIG_GET_SUBTREE = 15,
+	CAER_CONFIG_SUBSCRIBE = 16,
+	CAER_CONFIG_UNSUBSCRIBE = 17,
+	CAER_CONFIG_NOTIFY = 18,
 };
 
+// Batched requests (GET_BATCH, PUT_BATCH) carry all their entries in VALUE,
+// one after the other. GET_BATCH entries are: 1 byte TYPE, NODE, KEY.
+// PUT_BATCH entries are: 1 byte TYPE, NODE, KEY, VALUE (as string).
+// NODE, KEY and VALUE are NUL terminated. An empty NODE means the same node
+// as in the previous entry. PUT_BATCH is all-or-nothing: all entries are
+// checked first, and only applied if they are all valid.
+//
+// GET_BATCH responses contain, for each entry in order: 1 byte TYPE, VALUE
+// (as NUL terminated string). TYPE is CAER_CONFIG_BATCH_NOT_FOUND and VALUE
+// empty if the node or attribute doesn't exist.
+//
+// GET_SUBTREE takes a NODE and responds with all nodes below it (and itself),
+// depth-first. Each node starts with 1 byte CAER_CONFIG_BATCH_NODE and its
+// path relative to NODE (NUL terminated, empty for NODE itself), followed by
+// each of its attributes as: 1 byte TYPE, KEY, VALUE (both NUL terminated).
+//
+// Responses to these three actions can be longer than one message. They
+// are split into as many messages as needed, each with the same ACTION and
+// up to 4092 bytes of MSG. TYPE is 1 on all messages but the last, where it
+// is 0. The MSGs are simply concatenated to get the full response.
+#define CAER_CONFIG_BATCH_NOT_FOUND 0xFF
+#define CAER_CONFIG_BATCH_NODE 0xFE
+
+// SUBSCRIBE takes a NODE and asks for changes to its attributes to be sent
+// to the client as they happen. TYPE is 1 to also get changes to all nodes
+// below NODE (including ones created later), or 0 for only NODE itself.
+// VALUE optionally gives the minimum time between notifications in ms, as
+// string. Changes to the same attribute within that time are coalesced, and
+// only the latest one is sent. Subscribing to the same NODE again replaces
+// the old subscription. UNSUBSCRIBE takes a NODE and stops notifications.
+//
+// NOTIFY messages are sent by the server at any time, interleaved with the
+// responses to requests, and are split like the batch responses above. Each
+// change is: 1 byte EVENT (enum sshs_node_attribute_events), 1 byte TYPE,
+// NODE (full path), KEY, VALUE (as string), all three NUL terminated.
+#define CAER_CONFIG_SUBSCRIBE_MAX_INTERVAL (60 * 60 * 1000)
+
 void caerConfigServerStart(void);
 void caerConfigServerStop(void);
 
@@ -2,12 +2,75 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <stdatomic.h>
+#include <time.h>
 #include "ext/portable_misc.h"
+#include "ext/portable_time.h"
 #include "ext/pathmax.h"
 
+#ifdef HAVE_PTHREADS
+#include "ext/c11threads_posix.h"
+#endif
+
 int CAER_LOG_FILE_FD = -1;
 
+#define CAER_LOG_ASYNC_SLOTS 128 // Messages per thread buffer, must be power of two.
+#define CAER_LOG_ASYNC_MESSAGE_LENGTH 512
+#define CAER_LOG_ASYNC_SUBSYSTEM_LENGTH 64
+#define CAER_LOG_ASYNC_FLUSH_INTERVAL_MS 10
+#define CAER_LOG_ASYNC_REPEAT_INTERVAL_S 1 // Report suppressed duplicates at least this often.
+#define CAER_LOG_ASYNC_WRITE_BUFFER (64 * 1024)
+
+struct caer_log_async_message {
+	uint64_t sequence;
+	struct timespec time;
+	enum caer_log_level level;
+	char subSystem[CAER_LOG_ASYNC_SUBSYSTEM_LENGTH];
+	char message[CAER_LOG_ASYNC_MESSAGE_LENGTH];
+};
+
+// Single-producer (owning thread), single-consumer (flusher thread) ring.
+struct caer_log_async_buffer {
+	/// Next slot to write, only changed by the owning thread.
+	atomic_size_t head;
+	/// Next slot to read, only changed by the flusher thread.
+	atomic_size_t tail;
+	/// Messages lost because the buffer was full.
+	atomic_uint_fast64_t dropped;
+	/// Owning thread exited, free once empty.
+	atomic_bool orphaned;
+	/// Head at last collection, only used by the flusher thread.
+	size_t flushHead;
+	struct caer_log_async_buffer *next;
+	struct caer_log_async_message messages[CAER_LOG_ASYNC_SLOTS];
+};
+
+typedef struct caer_log_async_buffer *caerLogAsyncBuffer;
+
+static struct {
+	atomic_bool running;
+	thrd_t flusherThread;
+	/// Per-thread buffer of the calling thread.
+	tss_t threadBuffer;
+	/// All per-thread buffers, only locked to add buffers or when flushing.
+	mtx_t buffersLock;
+	caerLogAsyncBuffer buffers;
+	/// Global order of messages across threads.
+	atomic_uint_fast64_t sequence;
+	mtx_t wakeUpLock;
+	cnd_t wakeUp;
+	/// Duplicate suppression state, only used by the flusher thread.
+	struct caer_log_async_message lastMessage;
+	size_t lastMessageRepeats;
+	struct timespec lastMessageReport;
+} caerLogAsync;
+
 static void caerLogShutDownWriteBack(void);
+static void caerLogAsyncStart(void);
+static void caerLogAsyncStop(void);
+static void caerLogAsyncBufferRelease(void *buffer);
+static int caerLogAsyncFlusherThread(void *arg);
+static void caerLogAsyncFlush(void);
 static void caerLogSSHSLogger(const char *msg);
 static void caerLogLevelListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
@@ -66,11 +129,17 @@ void caerLogInit(void) {
 	// set the SSHS logger to use our internal logger too.
 	sshsSetGlobalErrorLogCallback(&caerLogSSHSLogger);
 
+	// Start background writing of module log messages.
+	caerLogAsyncStart();
+
 	// Log sub-system initialized fully and correctly, log this.
 	caerLog(CAER_LOG_NOTICE, "Logger", "Initialization successful with log-level %" PRIu8 ".", logLevel);
 }
 
 static void caerLogShutDownWriteBack(void) {
+	// Write out all pending messages first.
+	caerLogAsyncStop();
+
 	caerLog(CAER_LOG_DEBUG, "Logger", "Shutting down ...");
 
 	// Flush interactive outputs.
@@ -98,3 +167,344 @@ static void caerLogLevelListener(sshsNode node, void *userData, enum sshs_node_a
 		caerLog(CAER_LOG_DEBUG, "Logger", "Log-level set to %" PRIi8 ".", changeValue.ibyte);
 	}
 }
+
+static void caerLogAsyncStart(void) {
+	if (tss_create(&caerLogAsync.threadBuffer, &caerLogAsyncBufferRelease) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, "Logger", "Failed to create thread buffer key, using synchronous logging.");
+		return;
+	}
+
+	if (mtx_init(&caerLogAsync.buffersLock, mtx_plain) != thrd_success
+		|| mtx_init(&caerLogAsync.wakeUpLock, mtx_plain) != thrd_success
+		|| cnd_init(&caerLogAsync.wakeUp) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, "Logger", "Failed to initialize locks, using synchronous logging.");
+		return;
+	}
+
+	atomic_store(&caerLogAsync.running, true);
+
+	if (thrd_create(&caerLogAsync.flusherThread, &caerLogAsyncFlusherThread, NULL) != thrd_success) {
+		atomic_store(&caerLogAsync.running, false);
+
+		caerLog(CAER_LOG_ERROR, "Logger", "Failed to start flusher thread, using synchronous logging.");
+		return;
+	}
+}
+
+static void caerLogAsyncStop(void) {
+	if (!atomic_exchange(&caerLogAsync.running, false)) {
+		return;
+	}
+
+	mtx_lock(&caerLogAsync.wakeUpLock);
+	cnd_signal(&caerLogAsync.wakeUp);
+	mtx_unlock(&caerLogAsync.wakeUpLock);
+
+	// Flusher thread does a last flush before exiting.
+	thrd_join(caerLogAsync.flusherThread, NULL);
+}
+
+// Called on thread exit. The flusher frees the buffer after writing it out.
+static void caerLogAsyncBufferRelease(void *buffer) {
+	atomic_store_explicit(&((caerLogAsyncBuffer) buffer)->orphaned, true, memory_order_release);
+}
+
+void caerLogAsyncVA(enum caer_log_level logLevel, const char *subSystem, const char *format, va_list args) {
+	// Severe messages often precede an exit(), so they are written right away,
+	// same as everything before the flusher thread is running.
+	if (logLevel <= CAER_LOG_CRITICAL || !atomic_load_explicit(&caerLogAsync.running, memory_order_relaxed)) {
+		caerLogVAFull(caerLogFileDescriptorsGetFirst(), caerLogFileDescriptorsGetSecond(), CAER_LOG_DEBUG, logLevel,
+			subSystem, format, args);
+		return;
+	}
+
+	caerLogAsyncBuffer buffer = tss_get(caerLogAsync.threadBuffer);
+
+	if (buffer == NULL) {
+		// First message from this thread: allocate and register its buffer.
+		buffer = calloc(1, sizeof(*buffer));
+		if (buffer == NULL) {
+			caerLogVAFull(caerLogFileDescriptorsGetFirst(), caerLogFileDescriptorsGetSecond(), CAER_LOG_DEBUG,
+				logLevel, subSystem, format, args);
+			return;
+		}
+
+		tss_set(caerLogAsync.threadBuffer, buffer);
+
+		mtx_lock(&caerLogAsync.buffersLock);
+		buffer->next = caerLogAsync.buffers;
+		caerLogAsync.buffers = buffer;
+		mtx_unlock(&caerLogAsync.buffersLock);
+	}
+
+	size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+
+	if ((head - tail) >= CAER_LOG_ASYNC_SLOTS) {
+		// Full, never block the caller.
+		atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+		return;
+	}
+
+	struct caer_log_async_message *msg = &buffer->messages[head & (CAER_LOG_ASYNC_SLOTS - 1)];
+
+	msg->sequence = atomic_fetch_add_explicit(&caerLogAsync.sequence, 1, memory_order_relaxed);
+	portable_clock_gettime_realtime(&msg->time);
+	msg->level = logLevel;
+
+	strncpy(msg->subSystem, subSystem, CAER_LOG_ASYNC_SUBSYSTEM_LENGTH - 1);
+	msg->subSystem[CAER_LOG_ASYNC_SUBSYSTEM_LENGTH - 1] = '\0';
+
+	vsnprintf(msg->message, CAER_LOG_ASYNC_MESSAGE_LENGTH, format, args);
+
+	atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+
+	// Wake up the flusher early if the buffer is filling up.
+	if ((head + 1 - tail) == (CAER_LOG_ASYNC_SLOTS / 2)) {
+		cnd_signal(&caerLogAsync.wakeUp);
+	}
+}
+
+static int caerLogAsyncFlusherThread(void *arg) {
+	UNUSED_ARGUMENT(arg);
+
+	// Set thread name.
+	thrd_set_name("Logger");
+
+	while (atomic_load(&caerLogAsync.running)) {
+		struct timespec wakeUpTime;
+		portable_clock_gettime_realtime(&wakeUpTime);
+
+		wakeUpTime.tv_nsec += CAER_LOG_ASYNC_FLUSH_INTERVAL_MS * 1000000L;
+		if (wakeUpTime.tv_nsec >= 1000000000L) {
+			wakeUpTime.tv_sec++;
+			wakeUpTime.tv_nsec -= 1000000000L;
+		}
+
+		mtx_lock(&caerLogAsync.wakeUpLock);
+		if (atomic_load(&caerLogAsync.running)) {
+			cnd_timedwait(&caerLogAsync.wakeUp, &caerLogAsync.wakeUpLock, &wakeUpTime);
+		}
+		mtx_unlock(&caerLogAsync.wakeUpLock);
+
+		caerLogAsyncFlush();
+	}
+
+	// Last flush, for anything logged while shutting down.
+	caerLogAsyncFlush();
+
+	return (thrd_success);
+}
+
+static const char *caerLogAsyncLevelName(enum caer_log_level logLevel) {
+	switch (logLevel) {
+		case CAER_LOG_EMERGENCY:
+			return ("EMERGENCY");
+
+		case CAER_LOG_ALERT:
+			return ("ALERT");
+
+		case CAER_LOG_CRITICAL:
+			return ("CRITICAL");
+
+		case CAER_LOG_ERROR:
+			return ("ERROR");
+
+		case CAER_LOG_WARNING:
+			return ("WARNING");
+
+		case CAER_LOG_NOTICE:
+			return ("NOTICE");
+
+		case CAER_LOG_INFO:
+			return ("INFO");
+
+		case CAER_LOG_DEBUG:
+			return ("DEBUG");
+
+		default:
+			return ("UNKNOWN");
+	}
+}
+
+struct caer_log_async_output {
+	char data[CAER_LOG_ASYNC_WRITE_BUFFER];
+	size_t size;
+};
+
+static void caerLogAsyncOutputWrite(struct caer_log_async_output *out) {
+	int fds[2] = { caerLogFileDescriptorsGetFirst(), caerLogFileDescriptorsGetSecond() };
+
+	for (size_t i = 0; i < 2; i++) {
+		if (fds[i] < 0 || (i == 1 && fds[1] == fds[0])) {
+			continue;
+		}
+
+		size_t written = 0;
+		while (written < out->size) {
+			ssize_t result = write(fds[i], out->data + written, out->size - written);
+			if (result <= 0) {
+				if (result < 0 && errno == EINTR) {
+					continue;
+				}
+
+				break;
+			}
+
+			written += (size_t) result;
+		}
+	}
+
+	out->size = 0;
+}
+
+// Same line format as libcaer's caerLog().
+static void caerLogAsyncOutputAppend(struct caer_log_async_output *out, const struct timespec *time,
+	enum caer_log_level logLevel, const char *subSystem, const char *message) {
+	char timeString[64];
+	struct tm currentTime;
+	localtime_r(&time->tv_sec, &currentTime);
+	strftime(timeString, 64, "%Y-%m-%d %H:%M:%S (TZ%z)", &currentTime);
+
+	char line[CAER_LOG_ASYNC_MESSAGE_LENGTH + CAER_LOG_ASYNC_SUBSYSTEM_LENGTH + 128];
+	int lineLength = snprintf(line, sizeof(line), "%s: %s: %s: %s\n", timeString, caerLogAsyncLevelName(logLevel),
+		subSystem, message);
+	if (lineLength <= 0) {
+		return;
+	}
+
+	size_t length = ((size_t) lineLength < sizeof(line)) ? ((size_t) lineLength) : (sizeof(line) - 1);
+
+	if ((out->size + length) > CAER_LOG_ASYNC_WRITE_BUFFER) {
+		caerLogAsyncOutputWrite(out);
+	}
+
+	memcpy(out->data + out->size, line, length);
+	out->size += length;
+}
+
+static void caerLogAsyncReportRepeats(struct caer_log_async_output *out, const struct timespec *now) {
+	if (caerLogAsync.lastMessageRepeats > 0) {
+		char message[128];
+		snprintf(message, 128, "Last message repeated %zu times.", caerLogAsync.lastMessageRepeats);
+
+		caerLogAsyncOutputAppend(out, now, caerLogAsync.lastMessage.level, caerLogAsync.lastMessage.subSystem, message);
+
+		caerLogAsync.lastMessageRepeats = 0;
+	}
+
+	caerLogAsync.lastMessageReport = *now;
+}
+
+static void caerLogAsyncOutputMessage(struct caer_log_async_output *out, const struct caer_log_async_message *msg) {
+	// Suppress identical consecutive messages, only reporting how often they repeated.
+	if (msg->level == caerLogAsync.lastMessage.level
+		&& strcmp(msg->subSystem, caerLogAsync.lastMessage.subSystem) == 0
+		&& strcmp(msg->message, caerLogAsync.lastMessage.message) == 0) {
+		caerLogAsync.lastMessageRepeats++;
+
+		if ((msg->time.tv_sec - caerLogAsync.lastMessageReport.tv_sec) >= CAER_LOG_ASYNC_REPEAT_INTERVAL_S) {
+			caerLogAsyncReportRepeats(out, &msg->time);
+		}
+
+		return;
+	}
+
+	caerLogAsyncReportRepeats(out, &msg->time);
+
+	caerLogAsyncOutputAppend(out, &msg->time, msg->level, msg->subSystem, msg->message);
+
+	caerLogAsync.lastMessage = *msg;
+}
+
+static int caerLogAsyncMessageCmp(const void *a, const void *b) {
+	const struct caer_log_async_message *aa = *(const struct caer_log_async_message * const *) a;
+	const struct caer_log_async_message *bb = *(const struct caer_log_async_message * const *) b;
+
+	return ((aa->sequence < bb->sequence) ? (-1) : ((aa->sequence > bb->sequence) ? (1) : (0)));
+}
+
+static void caerLogAsyncFlush(void) {
+	static struct caer_log_async_output out;
+	static const struct caer_log_async_message **pending = NULL;
+	static size_t pendingCapacity = 0;
+
+	mtx_lock(&caerLogAsync.buffersLock);
+
+	// Collect all pending messages, in global order across threads.
+	size_t pendingSize = 0;
+	uint64_t dropped = 0;
+
+	for (caerLogAsyncBuffer buf = caerLogAsync.buffers; buf != NULL; buf = buf->next) {
+		size_t tail = atomic_load_explicit(&buf->tail, memory_order_relaxed);
+		size_t head = atomic_load_explicit(&buf->head, memory_order_acquire);
+
+		if ((pendingSize + (head - tail)) > pendingCapacity) {
+			size_t newCapacity = pendingSize + (head - tail) + (4 * CAER_LOG_ASYNC_SLOTS);
+			const struct caer_log_async_message **newPending = realloc(pending, newCapacity * sizeof(*pending));
+			if (newPending == NULL) {
+				// Try again next time.
+				buf->flushHead = tail;
+				continue;
+			}
+
+			pending = newPending;
+			pendingCapacity = newCapacity;
+		}
+
+		for (size_t i = tail; i != head; i++) {
+			pending[pendingSize++] = &buf->messages[i & (CAER_LOG_ASYNC_SLOTS - 1)];
+		}
+
+		buf->flushHead = head;
+
+		dropped += atomic_exchange_explicit(&buf->dropped, 0, memory_order_relaxed);
+	}
+
+	qsort(pending, pendingSize, sizeof(*pending), &caerLogAsyncMessageCmp);
+
+	for (size_t i = 0; i < pendingSize; i++) {
+		caerLogAsyncOutputMessage(&out, pending[i]);
+	}
+
+	struct timespec now;
+	portable_clock_gettime_realtime(&now);
+
+	// Don't hold back repeat counts forever if no new message comes.
+	if (caerLogAsync.lastMessageRepeats > 0
+		&& (now.tv_sec - caerLogAsync.lastMessageReport.tv_sec) >= CAER_LOG_ASYNC_REPEAT_INTERVAL_S) {
+		caerLogAsyncReportRepeats(&out, &now);
+	}
+
+	if (dropped > 0) {
+		char message[128];
+		snprintf(message, 128, "Dropped %" PRIu64 " log messages, buffers full.", dropped);
+
+		caerLogAsyncOutputAppend(&out, &now, CAER_LOG_WARNING, "Logger", message);
+	}
+
+	caerLogAsyncOutputWrite(&out);
+
+	// Release the written slots back to their threads, and free the
+	// buffers of threads that exited once they're empty.
+	caerLogAsyncBuffer *prev = &caerLogAsync.buffers;
+
+	for (caerLogAsyncBuffer buf = caerLogAsync.buffers; buf != NULL;) {
+		atomic_store_explicit(&buf->tail, buf->flushHead, memory_order_release);
+
+		caerLogAsyncBuffer next = buf->next;
+
+		if (atomic_load_explicit(&buf->orphaned, memory_order_acquire)
+			&& buf->flushHead == atomic_load_explicit(&buf->head, memory_order_acquire)) {
+			*prev = next;
+			free(buf);
+		}
+		else {
+			prev = &buf->next;
+		}
+
+		buf = next;
+	}
+
+	mtx_unlock(&caerLogAsync.buffersLock);
+}
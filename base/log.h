@@ -18,6 +18,11 @@ extern int CAER_LOG_FILE_FD;
 
 void caerLogInit(void);
 
+// Log asynchronously: the message is formatted into a per-thread buffer,
+// without taking any lock, and written out by a background thread.
+// Check the log level before calling this, it's not checked again.
+void caerLogAsyncVA(enum caer_log_level logLevel, const char *subSystem, const char *format, va_list args);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,7 @@
 #include "mainloop.h"
 #include "ext/pathmax.h"
+#include "trace.h"
+#include "metrics.h"
 #include <csignal>
 
 #include <regex>
@@ -91,6 +93,8 @@ struct ModuleInfo {
 	caerModuleInfo libraryInfo;
 	// Module runtime data.
 	caerModuleData runtimeData;
+	// Run function execution time.
+	caerMetric runTime;
 
 	ModuleInfo() :
 			id(-1),
@@ -99,7 +103,8 @@ struct ModuleInfo {
 			library(),
 			libraryHandle(),
 			libraryInfo(nullptr),
-			runtimeData(nullptr) {
+			runtimeData(nullptr),
+			runTime(nullptr) {
 	}
 
 	ModuleInfo(int16_t i, const std::string &n, sshsNode c, const std::string &l) :
@@ -109,7 +114,8 @@ struct ModuleInfo {
 			library(l),
 			libraryHandle(),
 			libraryInfo(nullptr),
-			runtimeData(nullptr) {
+			runtimeData(nullptr),
+			runTime(nullptr) {
 	}
 };
 
@@ -211,6 +217,8 @@ static struct {
 	std::vector<ActiveStreams> streams;
 	std::vector<std::reference_wrapper<ModuleInfo>> globalExecution;
 	std::vector<caerEventPacketHeader> eventPackets;
+	caerMetric runs;
+	caerMetric dataAvailableMetric;
 } glMainloopData;
 
 static int caerMainloopRunner();
@@ -1484,10 +1492,20 @@ static void runModules(caerEventPacketContainer in) {
 			m.get().outputs.size());
 
 		// Run module state machine.
+		caerTraceBegin(m.get().name.c_str(), idx);
+
+		const auto runStart = std::chrono::steady_clock::now();
+
 		caerEventPacketContainer out = nullptr;
 		caerModuleSM(m.get().libraryInfo->functions, m.get().runtimeData, m.get().libraryInfo->memSize,
 			(idx > 0) ? (in) : (nullptr), (m.get().outputs.size() > 0) ? (&out) : (nullptr));
 
+		caerMetricsHistogramObserve(m.get().runTime,
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - runStart).count()));
+
+		caerTraceEnd(m.get().name.c_str(), (out != nullptr) ? (caerEventPacketContainerGetEventPacketsNumber(out)) : (0));
+
 		// Parse possible output container.
 		if (out != nullptr) {
 			caerModuleLog(m.get().runtimeData, CAER_LOG_DEBUG, "Module Output: got %" PRIi32 " packets.",
@@ -1963,8 +1981,15 @@ static int caerMainloopRunner() {
 		}
 
 		m.get().runtimeData = runData;
+
+		m.get().runTime = caerMetricsGetHistogram("caer_module_run_seconds",
+			"Time spent running a module, per mainloop run.", runData->moduleSubSystemString);
 	}
 
+	glMainloopData.runs = caerMetricsGetCounter("caer_mainloop_runs_total", "Number of mainloop runs.", nullptr);
+	glMainloopData.dataAvailableMetric = caerMetricsGetGauge("caer_mainloop_data_available",
+		"Packet containers waiting in input modules to be processed.", nullptr);
+
 	// Allocate only one packet container to be re-used over all runModules() calls.
 	// It needs enough capacity to handle the highest number of inputs of any module.
 	caerEventPacketContainer inputContainer = caerEventPacketContainerAllocate(
@@ -1993,9 +2018,14 @@ static int caerMainloopRunner() {
 	while (glMainloopData.running.load(std::memory_order_relaxed)) {
 		// Run only if data available to consume, else sleep. But make a run
 		// anyway each second, to detect new devices for example.
-		if (glMainloopData.dataAvailable.load(std::memory_order_acquire) > 0 || sleepCount > 1000) {
+		uint_fast32_t dataAvailable = glMainloopData.dataAvailable.load(std::memory_order_acquire);
+		caerMetricsGaugeSet(glMainloopData.dataAvailableMetric, dataAvailable);
+
+		if (dataAvailable > 0 || sleepCount > 1000) {
 			sleepCount = 0;
 
+			caerMetricsCounterAdd(glMainloopData.runs, 1);
+
 			runModules(inputContainer);
 			// TODO: handle exceptions here.
 		}
@@ -2015,9 +2045,17 @@ static int caerMainloopRunner() {
 
 	// Destroy the runtime memory for all modules.
 	for (const auto &m : glMainloopData.globalExecution) {
+		caerMetricsRelease(m.get().runTime);
+		m.get().runTime = nullptr;
+
 		caerModuleDestroy(m.get().runtimeData);
 	}
 
+	caerMetricsRelease(glMainloopData.runs);
+	glMainloopData.runs = nullptr;
+	caerMetricsRelease(glMainloopData.dataAvailableMetric);
+	glMainloopData.dataAvailableMetric = nullptr;
+
 	free(inputContainer);
 
 	// Cleanup modules and streams on exit.
@@ -0,0 +1,385 @@
+/*
+ * metrics.cpp
+ *
+ * Metrics registry and its Prometheus text format exposition.
+ */
+
+#include "metrics.h"
+
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <memory>
+#include <string>
+#include <cmath>
+
+enum class MetricType {
+	COUNTER,
+	GAUGE,
+	HISTOGRAM,
+};
+
+// Histogram bucket upper bounds, in nanoseconds (1µs to 10s).
+static const uint64_t histogramBounds[] = { 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000, 10000000,
+	50000000, 100000000, 500000000, 1000000000, 5000000000, 10000000000 };
+
+#define HISTOGRAM_BUCKETS (sizeof(histogramBounds) / sizeof(histogramBounds[0]))
+
+struct caer_metric {
+	MetricType type;
+	/// Number of gets not yet released. Only changed with the registry lock held.
+	size_t references;
+	/// Counter value, or histogram observation count.
+	std::atomic<uint64_t> count;
+	/// Gauge value.
+	std::atomic<int64_t> value;
+	/// Histogram sum of observations, in nanoseconds.
+	std::atomic<uint64_t> sum;
+	/// Histogram observations per bucket (not cumulative). Last is +Inf.
+	std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS + 1];
+
+	caer_metric(MetricType t) :
+			type(t),
+			references(0),
+			count(0),
+			value(0),
+			sum(0) {
+		for (auto &bucket : buckets) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+};
+
+struct MetricFamily {
+	MetricType type;
+	std::string help;
+	/// Metrics by 'module' label value (empty for no label).
+	std::map<std::string, std::unique_ptr<struct caer_metric>> metrics;
+};
+
+static struct {
+	std::mutex lock;
+	std::map<std::string, MetricFamily> families;
+} glMetricsData;
+
+static caerMetric caerMetricsGet(MetricType type, const char *name, const char *help, const char *module);
+// Output of the read-only attribute walk. Failure stops it, as exceptions
+// can't pass through SSHS.
+struct metrics_config_render {
+	std::string *out;
+	bool failed;
+};
+
+static void renderConfigReadOnly(sshsNode node, void *userData);
+static void appendLabelValue(std::string &out, const char *value);
+static void appendDouble(std::string &out, double value);
+
+caerMetric caerMetricsGetCounter(const char *name, const char *help, const char *module) {
+	return (caerMetricsGet(MetricType::COUNTER, name, help, module));
+}
+
+caerMetric caerMetricsGetGauge(const char *name, const char *help, const char *module) {
+	return (caerMetricsGet(MetricType::GAUGE, name, help, module));
+}
+
+caerMetric caerMetricsGetHistogram(const char *name, const char *help, const char *module) {
+	return (caerMetricsGet(MetricType::HISTOGRAM, name, help, module));
+}
+
+static caerMetric caerMetricsGet(MetricType type, const char *name, const char *help, const char *module) {
+	try {
+		std::lock_guard<std::mutex> lock(glMetricsData.lock);
+
+		auto familyIter = glMetricsData.families.find(name);
+
+		if (familyIter == glMetricsData.families.end()) {
+			MetricFamily family;
+			family.type = type;
+			family.help = (help != nullptr) ? (help) : ("");
+
+			familyIter = glMetricsData.families.emplace(name, std::move(family)).first;
+		}
+		else if (familyIter->second.type != type) {
+			caerLog(CAER_LOG_ERROR, "Metrics", "Metric '%s' already exists with a different type.", name);
+			return (nullptr);
+		}
+
+		auto &metric = familyIter->second.metrics[(module != nullptr) ? (module) : ("")];
+
+		if (!metric) {
+			metric = std::make_unique<struct caer_metric>(type);
+		}
+
+		metric->references++;
+
+		return (metric.get());
+	}
+	catch (const std::bad_alloc &) {
+		return (nullptr);
+	}
+}
+
+void caerMetricsRelease(caerMetric metric) {
+	if (metric == nullptr) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(glMetricsData.lock);
+
+	if (--metric->references > 0) {
+		return;
+	}
+
+	// Last reference gone: remove it, and its family if now empty.
+	for (auto familyIter = glMetricsData.families.begin(); familyIter != glMetricsData.families.end();
+		familyIter++) {
+		auto &metrics = familyIter->second.metrics;
+
+		for (auto metricIter = metrics.begin(); metricIter != metrics.end(); metricIter++) {
+			if (metricIter->second.get() == metric) {
+				metrics.erase(metricIter);
+
+				if (metrics.empty()) {
+					glMetricsData.families.erase(familyIter);
+				}
+
+				return;
+			}
+		}
+	}
+}
+
+void caerMetricsCounterAdd(caerMetric metric, uint64_t value) {
+	if (metric != nullptr) {
+		metric->count.fetch_add(value, std::memory_order_relaxed);
+	}
+}
+
+void caerMetricsGaugeSet(caerMetric metric, int64_t value) {
+	if (metric != nullptr) {
+		metric->value.store(value, std::memory_order_relaxed);
+	}
+}
+
+void caerMetricsGaugeAdd(caerMetric metric, int64_t value) {
+	if (metric != nullptr) {
+		metric->value.fetch_add(value, std::memory_order_relaxed);
+	}
+}
+
+void caerMetricsHistogramObserve(caerMetric metric, uint64_t nanoseconds) {
+	if (metric == nullptr) {
+		return;
+	}
+
+	size_t bucket = 0;
+	while (bucket < HISTOGRAM_BUCKETS && nanoseconds > histogramBounds[bucket]) {
+		bucket++;
+	}
+
+	metric->buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	metric->sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+	metric->count.fetch_add(1, std::memory_order_relaxed);
+}
+
+char *caerMetricsRenderText(void) {
+	std::string out;
+
+	try {
+		std::lock_guard<std::mutex> lock(glMetricsData.lock);
+
+		for (const auto &family : glMetricsData.families) {
+			const std::string &name = family.first;
+
+			out += "# HELP " + name + " " + family.second.help + "\n";
+
+			switch (family.second.type) {
+				case MetricType::COUNTER:
+					out += "# TYPE " + name + " counter\n";
+					break;
+
+				case MetricType::GAUGE:
+					out += "# TYPE " + name + " gauge\n";
+					break;
+
+				case MetricType::HISTOGRAM:
+					out += "# TYPE " + name + " histogram\n";
+					break;
+			}
+
+			for (const auto &metricPair : family.second.metrics) {
+				const std::string &module = metricPair.first;
+				const struct caer_metric &metric = *metricPair.second;
+
+				// Label set, without the closing brace so 'le' can be appended.
+				std::string labels;
+				if (!module.empty()) {
+					labels = "{module=";
+					appendLabelValue(labels, module.c_str());
+				}
+
+				if (metric.type == MetricType::HISTOGRAM) {
+					uint64_t cumulative = 0;
+
+					for (size_t i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+						cumulative += metric.buckets[i].load(std::memory_order_relaxed);
+
+						out += name + "_bucket" + ((labels.empty()) ? ("{") : (labels + ",")) + "le=\"";
+						if (i < HISTOGRAM_BUCKETS) {
+							appendDouble(out, static_cast<double>(histogramBounds[i]) / 1e9);
+						}
+						else {
+							out += "+Inf";
+						}
+						out += "\"} " + std::to_string(cumulative) + "\n";
+					}
+
+					out += name + "_sum" + ((labels.empty()) ? ("") : (labels + "}")) + " ";
+					appendDouble(out, static_cast<double>(metric.sum.load(std::memory_order_relaxed)) / 1e9);
+					out += "\n";
+
+					out += name + "_count" + ((labels.empty()) ? ("") : (labels + "}")) + " "
+						+ std::to_string(metric.count.load(std::memory_order_relaxed)) + "\n";
+				}
+				else {
+					out += name + ((labels.empty()) ? ("") : (labels + "}")) + " ";
+
+					if (metric.type == MetricType::COUNTER) {
+						out += std::to_string(metric.count.load(std::memory_order_relaxed));
+					}
+					else {
+						out += std::to_string(metric.value.load(std::memory_order_relaxed));
+					}
+
+					out += "\n";
+				}
+			}
+		}
+	}
+	catch (const std::bad_alloc &) {
+		return (nullptr);
+	}
+
+	// Statistics modules keep in SSHS (read-only attributes), always current.
+	out += "# HELP caer_config_read_only Numeric read-only configuration attributes.\n";
+	out += "# TYPE caer_config_read_only gauge\n";
+
+	struct metrics_config_render render = { &out, false };
+
+	sshsNodeVisitSubTree(sshsGetNode(sshsGetGlobal(), "/"), &renderConfigReadOnly, &render);
+
+	if (render.failed) {
+		return (nullptr);
+	}
+
+	return (strdup(out.c_str()));
+}
+
+// Renders the numeric read-only attributes of one node. Called with the
+// node's traversal lock held, so exceptions must not leave this function.
+static void renderConfigReadOnly(sshsNode node, void *userData) {
+	struct metrics_config_render *render = static_cast<struct metrics_config_render *>(userData);
+	std::string &out = *render->out;
+
+	if (render->failed) {
+		return;
+	}
+
+	// One copy of all attributes: modules may remove theirs at any time.
+	size_t numAttributes;
+	struct sshs_node_attr_snapshot *attributes = sshsNodeGetAttributeSnapshot(node, &numAttributes);
+
+	try {
+		for (size_t i = 0; i < numAttributes; i++) {
+			if (attributes[i].type == SSHS_STRING || (attributes[i].flags & SSHS_FLAGS_READ_ONLY) == 0) {
+				continue;
+			}
+
+			out += "caer_config_read_only{node=";
+			appendLabelValue(out, sshsNodeGetPath(node));
+			out += ",key=";
+			appendLabelValue(out, attributes[i].key);
+			out += "} ";
+
+			switch (attributes[i].type) {
+				case SSHS_BOOL:
+					out += (attributes[i].value.boolean) ? ("1") : ("0");
+					break;
+
+				case SSHS_BYTE:
+					out += std::to_string(attributes[i].value.ibyte);
+					break;
+
+				case SSHS_SHORT:
+					out += std::to_string(attributes[i].value.ishort);
+					break;
+
+				case SSHS_INT:
+					out += std::to_string(attributes[i].value.iint);
+					break;
+
+				case SSHS_LONG:
+					out += std::to_string(attributes[i].value.ilong);
+					break;
+
+				case SSHS_FLOAT:
+					appendDouble(out, static_cast<double>(attributes[i].value.ffloat));
+					break;
+
+				case SSHS_DOUBLE:
+					appendDouble(out, attributes[i].value.ddouble);
+					break;
+
+				default:
+					break;
+			}
+
+			out += "\n";
+		}
+	}
+	catch (const std::bad_alloc &) {
+		render->failed = true;
+	}
+
+	sshsNodeFreeAttributeSnapshot(attributes, numAttributes);
+}
+
+static void appendLabelValue(std::string &out, const char *value) {
+	out += '"';
+
+	for (const char *c = value; *c != '\0'; c++) {
+		switch (*c) {
+			case '\\':
+				out += "\\\\";
+				break;
+
+			case '"':
+				out += "\\\"";
+				break;
+
+			case '\n':
+				out += "\\n";
+				break;
+
+			default:
+				out += *c;
+				break;
+		}
+	}
+
+	out += '"';
+}
+
+static void appendDouble(std::string &out, double value) {
+	if (std::isnan(value)) {
+		out += "NaN";
+	}
+	else if (std::isinf(value)) {
+		out += (value > 0) ? ("+Inf") : ("-Inf");
+	}
+	else {
+		char buffer[32];
+		snprintf(buffer, 32, "%.15g", value);
+		out += buffer;
+	}
+}
@@ -0,0 +1,48 @@
+/*
+ * metrics.h
+ *
+ * Registry of counters, gauges and histograms, served in Prometheus text
+ * format by the configuration server (see /caer/server/metricsPortNumber).
+ * Updating a metric is a single atomic operation, so it can be done from
+ * any thread, including hot paths. All functions accept a NULL metric and
+ * do nothing in that case.
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct caer_metric *caerMetric;
+
+// Get a metric, creating it if it doesn't exist yet. Name must follow the
+// Prometheus naming rules, counters should end in '_total'. Module is the
+// value of the 'module' label, or NULL for no label. Getting the same
+// name and module again returns the same metric, each get must be
+// matched by a release. Returns NULL if name already exists with another
+// type, or on memory allocation failure.
+caerMetric caerMetricsGetCounter(const char *name, const char *help, const char *module) CAER_SYMBOL_EXPORT;
+caerMetric caerMetricsGetGauge(const char *name, const char *help, const char *module) CAER_SYMBOL_EXPORT;
+// Histograms record durations, in nanoseconds, and are exported in seconds.
+caerMetric caerMetricsGetHistogram(const char *name, const char *help, const char *module) CAER_SYMBOL_EXPORT;
+void caerMetricsRelease(caerMetric metric) CAER_SYMBOL_EXPORT;
+
+void caerMetricsCounterAdd(caerMetric metric, uint64_t value) CAER_SYMBOL_EXPORT;
+void caerMetricsGaugeSet(caerMetric metric, int64_t value) CAER_SYMBOL_EXPORT;
+void caerMetricsGaugeAdd(caerMetric metric, int64_t value) CAER_SYMBOL_EXPORT;
+void caerMetricsHistogramObserve(caerMetric metric, uint64_t nanoseconds) CAER_SYMBOL_EXPORT;
+
+// All metrics in Prometheus text exposition format (version 0.0.4), plus
+// all numeric read-only configuration attributes (statistics kept in SSHS)
+// as 'caer_config_read_only' gauges. Returned string must be freed.
+char *caerMetricsRenderText(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* METRICS_H_ */
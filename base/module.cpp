@@ -6,6 +6,7 @@
  */
 
 #include "module.h"
+#include "log.h"
 
 #include <regex>
 #include <thread>
@@ -222,11 +223,14 @@ void caerModuleConfigDefaultListener(sshsNode node, void *userData, enum sshs_no
 }
 
 void caerModuleLog(caerModuleData moduleData, enum caer_log_level logLevel, const char *format, ...) {
+	// Check log level first, so disabled messages cost next to nothing.
+	if (logLevel > moduleData->moduleLogLevel.load(std::memory_order_relaxed)) {
+		return;
+	}
+
 	va_list argumentList;
 	va_start(argumentList, format);
-	caerLogVAFull(caerLogFileDescriptorsGetFirst(), caerLogFileDescriptorsGetSecond(),
-		moduleData->moduleLogLevel.load(std::memory_order_relaxed), logLevel, moduleData->moduleSubSystemString, format,
-		argumentList);
+	caerLogAsyncVA(logLevel, moduleData->moduleSubSystemString, format, argumentList);
 	va_end(argumentList);
 }
 
@@ -0,0 +1,355 @@
+#include "trace.h"
+#include <stdio.h>
+#include <unistd.h>
+#include "ext/portable_misc.h"
+#include "ext/portable_time.h"
+#include "ext/pathmax.h"
+
+#ifdef HAVE_PTHREADS
+#include "ext/c11threads_posix.h"
+#endif
+
+#define CAER_TRACE_RECORDS 4096 // Records per thread buffer, must be power of two.
+#define CAER_TRACE_NAME_LENGTH 39
+#define CAER_TRACE_FLUSH_INTERVAL_MS 100
+
+atomic_bool caerTraceActive = ATOMIC_VAR_INIT(false);
+
+// Fixed-size binary record, 64 bytes.
+struct caer_trace_record {
+	uint64_t timestamp;
+	uint64_t id;
+	int64_t value;
+	char phase;
+	char name[CAER_TRACE_NAME_LENGTH];
+};
+
+// Single-producer (owning thread), single-consumer (writer thread) ring.
+struct caer_trace_buffer {
+	atomic_size_t head;
+	atomic_size_t tail;
+	atomic_uint_fast64_t dropped;
+	/// Owning thread exited, free once empty.
+	atomic_bool orphaned;
+	/// Thread ID and name, as shown in the trace viewer.
+	uint32_t threadID;
+	char threadName[32];
+	/// Thread name was already written to the current trace file.
+	bool described;
+	struct caer_trace_buffer *next;
+	struct caer_trace_record records[CAER_TRACE_RECORDS];
+};
+
+typedef struct caer_trace_buffer *caerTraceBuffer;
+
+static struct {
+	sshsNode traceNode;
+	tss_t threadBuffer;
+	mtx_t buffersLock;
+	caerTraceBuffer buffers;
+	uint32_t nextThreadID;
+	/// Writer thread, runs while tracing is enabled.
+	thrd_t writerThread;
+	atomic_bool writerRunning;
+	FILE *traceFile;
+	/// Serialize enable/disable.
+	mtx_t controlLock;
+} caerTrace;
+
+static void caerTraceShutDown(void);
+static void caerTraceStart(void);
+static void caerTraceStop(void);
+static void caerTraceBufferRelease(void *buffer);
+static int caerTraceWriterThread(void *arg);
+static void caerTraceFlush(bool discard);
+static void caerTraceEnabledListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+
+void caerTraceInit(void) {
+	caerTrace.traceNode = sshsGetNode(sshsGetGlobal(), "/caer/trace/");
+
+	// The default path is a file named caer-trace.json inside the program's CWD.
+	const char *traceFileName = "/caer-trace.json";
+
+	char *traceFileDir = getcwd(NULL, 0);
+	char *traceFileDirClean = portable_realpath(traceFileDir);
+
+	char *traceFilePath = malloc(strlen(traceFileDirClean) + strlen(traceFileName) + 1); // +1 for terminating NUL byte.
+	strcpy(traceFilePath, traceFileDirClean);
+	strcat(traceFilePath, traceFileName);
+
+	sshsNodeCreateString(caerTrace.traceNode, "traceFile", traceFilePath, 2, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Path to the file where trace events are written to, in Chrome trace event format.");
+
+	free(traceFilePath);
+	free(traceFileDirClean);
+	free(traceFileDir);
+
+	sshsNodeCreateBool(caerTrace.traceNode, "enabled", false, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
+		"Record pipeline trace events to the trace file. Each enable starts a new file.");
+	sshsNodeCreateLong(caerTrace.traceNode, "droppedRecords", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Trace records lost because a thread's buffer was full.");
+
+	if (tss_create(&caerTrace.threadBuffer, &caerTraceBufferRelease) != thrd_success
+		|| mtx_init(&caerTrace.buffersLock, mtx_plain) != thrd_success
+		|| mtx_init(&caerTrace.controlLock, mtx_plain) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, "Trace", "Failed to initialize, tracing is not available.");
+		return;
+	}
+
+	// Always start disabled.
+	sshsNodePutBool(caerTrace.traceNode, "enabled", false);
+	sshsNodeAddAttributeListenerAsync(caerTrace.traceNode, NULL, &caerTraceEnabledListener);
+
+	// Make sure the trace file is complete at exit time.
+	atexit(&caerTraceShutDown);
+}
+
+static void caerTraceShutDown(void) {
+	sshsNodeRemoveAttributeListener(caerTrace.traceNode, NULL, &caerTraceEnabledListener);
+
+	caerTraceStop();
+}
+
+static void caerTraceEnabledListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+	UNUSED_ARGUMENT(userData);
+
+	if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_BOOL && caerStrEquals(changeKey, "enabled")) {
+		if (changeValue.boolean) {
+			caerTraceStart();
+		}
+		else {
+			caerTraceStop();
+		}
+	}
+}
+
+static void caerTraceStart(void) {
+	mtx_lock(&caerTrace.controlLock);
+
+	if (atomic_load(&caerTrace.writerRunning)) {
+		mtx_unlock(&caerTrace.controlLock);
+		return;
+	}
+
+	char *traceFilePath = sshsNodeGetString(caerTrace.traceNode, "traceFile");
+
+	caerTrace.traceFile = fopen(traceFilePath, "w");
+	if (caerTrace.traceFile == NULL) {
+		caerLog(CAER_LOG_ERROR, "Trace", "Failed to open trace file '%s'. Error: %d.", traceFilePath, errno);
+		free(traceFilePath);
+
+		mtx_unlock(&caerTrace.controlLock);
+		return;
+	}
+
+	// Drop records left over from a previous session, and describe
+	// threads again in the new file.
+	caerTraceFlush(true);
+
+	// JSON array format, the closing bracket is optional for trace viewers,
+	// so a file is usable even if cAER is killed.
+	fputs("[\n", caerTrace.traceFile);
+
+	atomic_store(&caerTrace.writerRunning, true);
+
+	if (thrd_create(&caerTrace.writerThread, &caerTraceWriterThread, NULL) != thrd_success) {
+		atomic_store(&caerTrace.writerRunning, false);
+
+		fclose(caerTrace.traceFile);
+		caerTrace.traceFile = NULL;
+
+		caerLog(CAER_LOG_ERROR, "Trace", "Failed to start trace writer thread.");
+		free(traceFilePath);
+
+		mtx_unlock(&caerTrace.controlLock);
+		return;
+	}
+
+	atomic_store(&caerTraceActive, true);
+
+	caerLog(CAER_LOG_INFO, "Trace", "Tracing to file '%s'.", traceFilePath);
+	free(traceFilePath);
+
+	mtx_unlock(&caerTrace.controlLock);
+}
+
+static void caerTraceStop(void) {
+	mtx_lock(&caerTrace.controlLock);
+
+	atomic_store(&caerTraceActive, false);
+
+	if (atomic_exchange(&caerTrace.writerRunning, false)) {
+		// Writer does a last flush before exiting.
+		thrd_join(caerTrace.writerThread, NULL);
+
+		fputs("{}]\n", caerTrace.traceFile);
+		fclose(caerTrace.traceFile);
+		caerTrace.traceFile = NULL;
+
+		caerLog(CAER_LOG_INFO, "Trace", "Tracing stopped.");
+	}
+
+	mtx_unlock(&caerTrace.controlLock);
+}
+
+// Called on thread exit. The writer frees the buffer once it's empty.
+static void caerTraceBufferRelease(void *buffer) {
+	atomic_store_explicit(&((caerTraceBuffer) buffer)->orphaned, true, memory_order_release);
+}
+
+void caerTraceRecord(enum caer_trace_phase phase, const char *name, uint64_t id, int64_t value) {
+	caerTraceBuffer buffer = tss_get(caerTrace.threadBuffer);
+
+	if (buffer == NULL) {
+		// First record from this thread: allocate and register its buffer.
+		buffer = calloc(1, sizeof(*buffer));
+		if (buffer == NULL) {
+			return;
+		}
+
+		thrd_get_name(buffer->threadName, 32);
+		buffer->threadName[31] = '\0';
+
+		tss_set(caerTrace.threadBuffer, buffer);
+
+		mtx_lock(&caerTrace.buffersLock);
+		buffer->threadID = ++caerTrace.nextThreadID;
+		buffer->next = caerTrace.buffers;
+		caerTrace.buffers = buffer;
+		mtx_unlock(&caerTrace.buffersLock);
+	}
+
+	size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+
+	if ((head - tail) >= CAER_TRACE_RECORDS) {
+		// Full, never block the caller.
+		atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+		return;
+	}
+
+	struct caer_trace_record *record = &buffer->records[head & (CAER_TRACE_RECORDS - 1)];
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	record->timestamp = (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+	record->id = id;
+	record->value = value;
+	record->phase = (char) phase;
+
+	// Last byte stays NUL from calloc().
+	strncpy(record->name, name, CAER_TRACE_NAME_LENGTH - 1);
+
+	atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+static int caerTraceWriterThread(void *arg) {
+	UNUSED_ARGUMENT(arg);
+
+	// Set thread name.
+	thrd_set_name("TraceWriter");
+
+	while (atomic_load(&caerTrace.writerRunning)) {
+		struct timespec flushSleep = { .tv_sec = 0, .tv_nsec = CAER_TRACE_FLUSH_INTERVAL_MS * 1000000L };
+		thrd_sleep(&flushSleep, NULL);
+
+		caerTraceFlush(false);
+	}
+
+	// Last flush, for anything recorded while stopping.
+	caerTraceFlush(false);
+
+	fflush(caerTrace.traceFile);
+
+	return (thrd_success);
+}
+
+static void caerTraceWriteRecord(FILE *out, uint32_t threadID, const struct caer_trace_record *record) {
+	// Names must be valid JSON strings.
+	char name[CAER_TRACE_NAME_LENGTH];
+	for (size_t i = 0; i < CAER_TRACE_NAME_LENGTH; i++) {
+		name[i] = (record->name[i] == '"' || record->name[i] == '\\') ? ('_') : (record->name[i]);
+	}
+
+	fprintf(out, "{\"name\":\"%s\",\"cat\":\"caer\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64 ",\"pid\":%d,\"tid\":%"
+	PRIu32, name, record->phase, record->timestamp / 1000, record->timestamp % 1000, (int) getpid(), threadID);
+
+	switch (record->phase) {
+		case CAER_TRACE_FLOW_START:
+			fprintf(out, ",\"id\":\"0x%" PRIx64 "\"},\n", record->id);
+			break;
+
+		case CAER_TRACE_FLOW_END:
+			// Bind to the enclosing slice, so arrows end where the data is used.
+			fprintf(out, ",\"id\":\"0x%" PRIx64 "\",\"bp\":\"e\"},\n", record->id);
+			break;
+
+		case CAER_TRACE_INSTANT:
+			fprintf(out, ",\"s\":\"t\",\"args\":{\"value\":%" PRIi64 "}},\n", record->value);
+			break;
+
+		default:
+			fprintf(out, ",\"args\":{\"value\":%" PRIi64 "}},\n", record->value);
+			break;
+	}
+}
+
+static void caerTraceFlush(bool discard) {
+	FILE *out = caerTrace.traceFile;
+	uint64_t dropped = 0;
+
+	mtx_lock(&caerTrace.buffersLock);
+
+	caerTraceBuffer *prev = &caerTrace.buffers;
+
+	for (caerTraceBuffer buf = caerTrace.buffers; buf != NULL;) {
+		size_t tail = atomic_load_explicit(&buf->tail, memory_order_relaxed);
+		size_t head = atomic_load_explicit(&buf->head, memory_order_acquire);
+
+		if (discard) {
+			buf->described = false;
+		}
+		else if (tail != head) {
+			if (!buf->described) {
+				fprintf(out,
+					"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s\"}},\n",
+					(int) getpid(), buf->threadID, buf->threadName);
+				buf->described = true;
+			}
+
+			for (size_t i = tail; i != head; i++) {
+				caerTraceWriteRecord(out, buf->threadID, &buf->records[i & (CAER_TRACE_RECORDS - 1)]);
+			}
+		}
+
+		atomic_store_explicit(&buf->tail, head, memory_order_release);
+
+		dropped += atomic_exchange_explicit(&buf->dropped, 0, memory_order_relaxed);
+
+		caerTraceBuffer next = buf->next;
+
+		// Free buffers of threads that exited, once they're empty.
+		if (atomic_load_explicit(&buf->orphaned, memory_order_acquire)
+			&& head == atomic_load_explicit(&buf->head, memory_order_acquire)) {
+			*prev = next;
+			free(buf);
+		}
+		else {
+			prev = &buf->next;
+		}
+
+		buf = next;
+	}
+
+	mtx_unlock(&caerTrace.buffersLock);
+
+	if (dropped > 0 && !discard) {
+		int64_t totalDropped = sshsNodeGetLong(caerTrace.traceNode, "droppedRecords") + (int64_t) dropped;
+		sshsNodeUpdateReadOnlyAttribute(caerTrace.traceNode, "droppedRecords", SSHS_LONG,
+			(union sshs_node_attr_value ) { .ilong = totalDropped });
+	}
+}
@@ -0,0 +1,89 @@
+/*
+ * trace.h
+ *
+ * Low-overhead tracing of pipeline events, for offline latency analysis.
+ * Records are written to a file in Chrome trace event format, which can be
+ * opened with chrome://tracing or Perfetto. Enable through /caer/trace/.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+
+#include <atomic>
+using atomic_bool = std::atomic_bool;
+
+#else
+
+#include <stdatomic.h>
+
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum caer_trace_phase {
+	CAER_TRACE_BEGIN = 'B',
+	CAER_TRACE_END = 'E',
+	CAER_TRACE_INSTANT = 'i',
+	CAER_TRACE_FLOW_START = 's',
+	CAER_TRACE_FLOW_END = 'f',
+};
+
+// Tracing is enabled. Tracepoints check this before doing anything else.
+extern atomic_bool caerTraceActive CAER_SYMBOL_EXPORT;
+
+void caerTraceInit(void);
+
+// Record an event in the calling thread's trace buffer. Name is copied
+// (up to 38 characters). ID correlates flow events across threads, for
+// example the address of a packet container. Use the inline functions below.
+void caerTraceRecord(enum caer_trace_phase phase, const char *name, uint64_t id, int64_t value) CAER_SYMBOL_EXPORT;
+
+static inline bool caerTraceIsActive(void) {
+#ifdef __cplusplus
+	return (caerTraceActive.load(std::memory_order_relaxed));
+#else
+	return (atomic_load_explicit(&caerTraceActive, memory_order_relaxed));
+#endif
+}
+
+static inline void caerTraceBegin(const char *name, int64_t value) {
+	if (caerTraceIsActive()) {
+		caerTraceRecord(CAER_TRACE_BEGIN, name, 0, value);
+	}
+}
+
+static inline void caerTraceEnd(const char *name, int64_t value) {
+	if (caerTraceIsActive()) {
+		caerTraceRecord(CAER_TRACE_END, name, 0, value);
+	}
+}
+
+static inline void caerTraceInstant(const char *name, int64_t value) {
+	if (caerTraceIsActive()) {
+		caerTraceRecord(CAER_TRACE_INSTANT, name, 0, value);
+	}
+}
+
+static inline void caerTraceFlowStart(const char *name, const void *id) {
+	if (caerTraceIsActive()) {
+		caerTraceRecord(CAER_TRACE_FLOW_START, name, (uint64_t) (uintptr_t) id, 0);
+	}
+}
+
+static inline void caerTraceFlowEnd(const char *name, const void *id) {
+	if (caerTraceIsActive()) {
+		caerTraceRecord(CAER_TRACE_FLOW_END, name, (uint64_t) (uintptr_t) id, 0);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H_ */
@@ -13,7 +13,10 @@ typedef pthread_t thrd_t;
 typedef pthread_once_t once_flag;
 typedef pthread_mutex_t mtx_t;
 typedef pthread_rwlock_t mtx_shared_t; // NON STANDARD!
+typedef pthread_cond_t cnd_t;
+typedef pthread_key_t tss_t;
 typedef int (*thrd_start_t)(void *);
+typedef void (*tss_dtor_t)(void *);
 
 enum {
 	mtx_plain = 0, mtx_timed = 1, mtx_recursive = 2,
@@ -335,4 +338,86 @@ static inline int mtx_shared_unlock_shared(mtx_shared_t *mutex) {
 	return (thrd_success);
 }
 
+static inline int cnd_init(cnd_t *cond) {
+	int ret = pthread_cond_init(cond, NULL);
+
+	switch (ret) {
+		case 0:
+			return (thrd_success);
+
+		case ENOMEM:
+			return (thrd_nomem);
+
+		default:
+			return (thrd_error);
+	}
+}
+
+static inline void cnd_destroy(cnd_t *cond) {
+	pthread_cond_destroy(cond);
+}
+
+static inline int cnd_signal(cnd_t *cond) {
+	if (pthread_cond_signal(cond) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static inline int cnd_broadcast(cnd_t *cond) {
+	if (pthread_cond_broadcast(cond) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static inline int cnd_wait(cnd_t *cond, mtx_t *mutex) {
+	if (pthread_cond_wait(cond, mutex) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static inline int cnd_timedwait(cnd_t *restrict cond, mtx_t *restrict mutex, const struct timespec *restrict time_point) {
+	int ret = pthread_cond_timedwait(cond, mutex, time_point);
+
+	switch (ret) {
+		case 0:
+			return (thrd_success);
+
+		case ETIMEDOUT:
+			return (thrd_timedout);
+
+		default:
+			return (thrd_error);
+	}
+}
+
+static inline int tss_create(tss_t *key, tss_dtor_t dtor) {
+	if (pthread_key_create(key, dtor) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static inline void tss_delete(tss_t key) {
+	pthread_key_delete(key);
+}
+
+static inline void *tss_get(tss_t key) {
+	return (pthread_getspecific(key));
+}
+
+static inline int tss_set(tss_t key, void *val) {
+	if (pthread_setspecific(key, val) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
 #endif	/* C11THREADS_POSIX_H_ */
@@ -0,0 +1,211 @@
+#ifndef FRAME_CONVERT_H_
+#define FRAME_CONVERT_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+// Kernels are selected at compile time: SSE2 is always there on x86-64
+// and NEON on ARM64, SSSE3 and AVX2 need the matching -m flags (or
+// -march=native). Whatever is left over uses the scalar code.
+// Defining FRAME_CONVERT_NO_SIMD before inclusion selects only the scalar
+// code, caer-frameconvert-bench uses that as reference.
+#if !defined(FRAME_CONVERT_NO_SIMD)
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+		#define FRAME_CONVERT_AVX2 1
+	#endif
+	#if defined(__SSSE3__)
+		#include <tmmintrin.h>
+		#define FRAME_CONVERT_SSSE3 1
+	#endif
+	#if defined(__SSE2__)
+		#include <emmintrin.h>
+		#define FRAME_CONVERT_SSE2 1
+	#endif
+	#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#include <arm_neon.h>
+		#define FRAME_CONVERT_NEON 1
+	#endif
+#endif
+
+/**
+ * Convert 16-bit frame pixel values to 8-bit, keeping the channel layout.
+ * The 8 most significant bits are kept, as libcaer frames always use the
+ * full 16-bit range.
+ *
+ * @param dst destination, 'count' bytes.
+ * @param src frame pixel array, as from caerFrameEventGetPixelArrayUnsafe().
+ * @param count number of values (pixels times channels).
+ */
+static inline void frameConvert16To8(uint8_t *dst, const uint16_t *src, size_t count) {
+	size_t i = 0;
+
+#if defined(FRAME_CONVERT_AVX2)
+	for (; (i + 32) <= count; i += 32) {
+		__m256i lo = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *) (src + i)), 8);
+		__m256i hi = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *) (src + i + 16)), 8);
+
+		// Packing works per 128-bit lane, restore the order afterwards.
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+
+		_mm256_storeu_si256((__m256i *) (dst + i), packed);
+	}
+#endif
+
+#if defined(FRAME_CONVERT_SSE2)
+	for (; (i + 16) <= count; i += 16) {
+		__m128i lo = _mm_srli_epi16(_mm_loadu_si128((const __m128i *) (src + i)), 8);
+		__m128i hi = _mm_srli_epi16(_mm_loadu_si128((const __m128i *) (src + i + 8)), 8);
+
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+	}
+#elif defined(FRAME_CONVERT_NEON)
+	for (; (i + 16) <= count; i += 16) {
+		uint8x8_t lo = vshrn_n_u16(vld1q_u16(src + i), 8);
+		uint8x8_t hi = vshrn_n_u16(vld1q_u16(src + i + 8), 8);
+
+		vst1q_u8(dst + i, vcombine_u8(lo, hi));
+	}
+#endif
+
+	for (; i < count; i++) {
+		dst[i] = (uint8_t) (src[i] >> 8);
+	}
+}
+
+/**
+ * Convert a 16-bit grayscale frame to 32-bit RGBA pixels (8-bit per channel),
+ * with all color channels equal and alpha fully opaque.
+ *
+ * @param dst destination, 'pixels * 4' bytes.
+ * @param src frame pixel array, one value per pixel.
+ * @param pixels number of pixels.
+ */
+static inline void frameConvertGrayscaleToRGBA(uint8_t *dst, const uint16_t *src, size_t pixels) {
+	size_t i = 0;
+
+#if defined(FRAME_CONVERT_AVX2)
+	const __m256i alpha256 = _mm256_set1_epi16((short) 0xFF00);
+
+	for (; (i + 16) <= pixels; i += 16) {
+		__m256i grey = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *) (src + i)), 8);
+
+		// Little-endian 16-bit words: (G << 8 | R) and (A << 8 | B).
+		__m256i rg = _mm256_or_si256(grey, _mm256_slli_epi16(grey, 8));
+		__m256i ba = _mm256_or_si256(grey, alpha256);
+
+		// Unpacking works per 128-bit lane too: lo has pixels 0-3 and 8-11, hi 4-7 and 12-15.
+		__m256i lo = _mm256_unpacklo_epi16(rg, ba);
+		__m256i hi = _mm256_unpackhi_epi16(rg, ba);
+
+		_mm256_storeu_si256((__m256i *) (dst + (i * 4)), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *) (dst + (i * 4) + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+#endif
+
+#if defined(FRAME_CONVERT_SSE2)
+	const __m128i alpha128 = _mm_set1_epi16((short) 0xFF00);
+
+	for (; (i + 8) <= pixels; i += 8) {
+		__m128i grey = _mm_srli_epi16(_mm_loadu_si128((const __m128i *) (src + i)), 8);
+
+		__m128i rg = _mm_or_si128(grey, _mm_slli_epi16(grey, 8));
+		__m128i ba = _mm_or_si128(grey, alpha128);
+
+		_mm_storeu_si128((__m128i *) (dst + (i * 4)), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *) (dst + (i * 4) + 16), _mm_unpackhi_epi16(rg, ba));
+	}
+#elif defined(FRAME_CONVERT_NEON)
+	for (; (i + 8) <= pixels; i += 8) {
+		uint8x8_t grey = vshrn_n_u16(vld1q_u16(src + i), 8);
+
+		uint8x8x4_t rgba;
+		rgba.val[0] = grey;
+		rgba.val[1] = grey;
+		rgba.val[2] = grey;
+		rgba.val[3] = vdup_n_u8(UINT8_MAX);
+
+		vst4_u8(dst + (i * 4), rgba);
+	}
+#endif
+
+	for (; i < pixels; i++) {
+		uint8_t grey = (uint8_t) (src[i] >> 8);
+
+		dst[(i * 4)] = grey;
+		dst[(i * 4) + 1] = grey;
+		dst[(i * 4) + 2] = grey;
+		dst[(i * 4) + 3] = UINT8_MAX;
+	}
+}
+
+/**
+ * Convert a 16-bit RGB frame to 32-bit RGBA pixels (8-bit per channel),
+ * with alpha fully opaque.
+ *
+ * @param dst destination, 'pixels * 4' bytes.
+ * @param src frame pixel array, three values per pixel.
+ * @param pixels number of pixels.
+ */
+static inline void frameConvertRGBToRGBA(uint8_t *dst, const uint16_t *src, size_t pixels) {
+	size_t i = 0;
+
+#if defined(FRAME_CONVERT_SSSE3)
+	// Spread three bytes per pixel to four, alpha is OR-ed in afterwards.
+	const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((int) 0xFF000000);
+
+	for (; (i + 16) <= pixels; i += 16) {
+		const uint16_t *in = src + (i * 3);
+
+		// 16 pixels are 48 values, narrowed to three vectors of 16 bytes.
+		__m128i a = _mm_packus_epi16(_mm_srli_epi16(_mm_loadu_si128((const __m128i *) (in)), 8),
+			_mm_srli_epi16(_mm_loadu_si128((const __m128i *) (in + 8)), 8));
+		__m128i b = _mm_packus_epi16(_mm_srli_epi16(_mm_loadu_si128((const __m128i *) (in + 16)), 8),
+			_mm_srli_epi16(_mm_loadu_si128((const __m128i *) (in + 24)), 8));
+		__m128i c = _mm_packus_epi16(_mm_srli_epi16(_mm_loadu_si128((const __m128i *) (in + 32)), 8),
+			_mm_srli_epi16(_mm_loadu_si128((const __m128i *) (in + 40)), 8));
+
+		uint8_t *out = dst + (i * 4);
+
+		_mm_storeu_si128((__m128i *) (out), _mm_or_si128(_mm_shuffle_epi8(a, spread), alpha));
+		_mm_storeu_si128((__m128i *) (out + 16),
+			_mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), spread), alpha));
+		_mm_storeu_si128((__m128i *) (out + 32),
+			_mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), spread), alpha));
+		_mm_storeu_si128((__m128i *) (out + 48), _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), spread), alpha));
+	}
+#elif defined(FRAME_CONVERT_NEON)
+	for (; (i + 8) <= pixels; i += 8) {
+		uint16x8x3_t in = vld3q_u16(src + (i * 3));
+
+		uint8x8x4_t rgba;
+		rgba.val[0] = vshrn_n_u16(in.val[0], 8);
+		rgba.val[1] = vshrn_n_u16(in.val[1], 8);
+		rgba.val[2] = vshrn_n_u16(in.val[2], 8);
+		rgba.val[3] = vdup_n_u8(UINT8_MAX);
+
+		vst4_u8(dst + (i * 4), rgba);
+	}
+#endif
+
+	for (; i < pixels; i++) {
+		dst[(i * 4)] = (uint8_t) (src[(i * 3)] >> 8);
+		dst[(i * 4) + 1] = (uint8_t) (src[(i * 3) + 1] >> 8);
+		dst[(i * 4) + 2] = (uint8_t) (src[(i * 3) + 2] >> 8);
+		dst[(i * 4) + 3] = UINT8_MAX;
+	}
+}
+
+/**
+ * Convert a 16-bit RGBA frame to 32-bit RGBA pixels (8-bit per channel).
+ *
+ * @param dst destination, 'pixels * 4' bytes.
+ * @param src frame pixel array, four values per pixel.
+ * @param pixels number of pixels.
+ */
+static inline void frameConvertRGBAToRGBA(uint8_t *dst, const uint16_t *src, size_t pixels) {
+	frameConvert16To8(dst, src, pixels * 4);
+}
+
+#endif /* FRAME_CONVERT_H_ */
@@ -283,6 +283,51 @@ static inline int libuvWriteUDP(uv_udp_t *dest, const struct sockaddr *destAddre
 	return (retVal);
 }
 
+// Send the buffers as multiple datagrams, each made up of buffersPerMessage
+// consecutive buffers, all sharing the same reference-counted buffers.
+// buffer has to be dynamically allocated (on heap). It is always consumed:
+// it will get free'd automatically once the last datagram has been sent,
+// or right away if no datagram could be queued at all.
+static inline int libuvWriteUDPMessages(uv_udp_t *dest, const struct sockaddr *destAddress, libuvWriteMultiBuf buffers,
+	size_t buffersPerMessage) {
+	int retVal = 0;
+
+	for (size_t msg = 0; msg < buffers->buffersSize; msg += buffersPerMessage) {
+		uv_udp_send_t *sendRequest = calloc(1, sizeof(*sendRequest));
+		if (sendRequest == NULL) {
+			retVal = UV_ENOMEM;
+			break;
+		}
+
+		sendRequest->data = buffers;
+
+		size_t msgBuffersSize =
+			((buffers->buffersSize - msg) > buffersPerMessage) ? (buffersPerMessage) : (buffers->buffersSize - msg);
+
+		uv_buf_t uvBuffers[msgBuffersSize];
+
+		for (size_t i = 0; i < msgBuffersSize; i++) {
+			uvBuffers[i] = buffers->buffers[msg + i].buf;
+		}
+
+		// Each queued datagram holds one reference.
+		buffers->refCount++;
+
+		retVal = uv_udp_send(sendRequest, dest, uvBuffers, (unsigned int) msgBuffersSize, destAddress,
+			&libuvWriteFreeUDP);
+		if (retVal < 0) {
+			buffers->refCount--;
+			free(sendRequest);
+			break;
+		}
+	}
+
+	// Drop the initial reference held by the caller.
+	libuvWriteBufFree(buffers);
+
+	return (retVal);
+}
+
 static inline void libuvCloseFree(uv_handle_t *handle) {
 	free(handle);
 }
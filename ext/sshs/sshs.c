@@ -1,8 +1,20 @@
 #include "sshs_internal.h"
-#include "ext/slre/slre.h"
+#include "ext/uthash/uthash.h"
+
+// Interned absolute paths, mapping them directly to their node.
+struct sshs_path_cache_entry {
+	UT_hash_handle hh;
+	sshsNode node;
+	char path[];
+};
+
+typedef struct sshs_path_cache_entry *sshsPathCacheEntry;
 
 struct sshs_struct {
 	sshsNode root;
+	sshsPathCacheEntry pathCache;
+	uint64_t pathCacheGeneration;
+	mtx_shared_t pathCacheLock;
 };
 
 static void sshsGlobalInitialize(void);
@@ -11,6 +23,10 @@ static void sshsGlobalErrorLogCallbackSetInternal(sshsErrorLogCallback error_log
 static void sshsDefaultErrorLogCallback(const char *msg);
 static bool sshsCheckAbsoluteNodePath(const char *absolutePath, size_t absolutePathLength);
 static bool sshsCheckRelativeNodePath(const char *relativePath, size_t relativePathLength);
+static sshsNode sshsWalkNodePath(sshsNode node, const char *nodePath, size_t nodePathLength, bool create);
+static sshsNode sshsPathCacheGet(sshs st, const char *nodePath, size_t nodePathLength);
+static void sshsPathCachePut(sshs st, const char *nodePath, size_t nodePathLength, sshsNode node,
+	uint64_t removalGeneration);
 
 static sshs sshsGlobal = NULL;
 static once_flag sshsGlobalIsInitialized = ONCE_FLAG_INIT;
@@ -68,117 +84,102 @@ sshs sshsNew(void) {
 	// Create root node.
 	newSshs->root = sshsNodeNew("", NULL);
 
+	// Empty path cache.
+	newSshs->pathCache = NULL;
+	newSshs->pathCacheGeneration = sshsNodeGetRemovalGeneration();
+
+	if (mtx_shared_init(&newSshs->pathCacheLock) != thrd_success) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to initialize pathCacheLock.");
+		exit(EXIT_FAILURE);
+	}
+
 	return (newSshs);
 }
 
 bool sshsExistsNode(sshs st, const char *nodePath) {
-	size_t nodePathLength = strlen(nodePath);
+	if (nodePath == NULL) {
+		return (sshsExistsNodeN(st, NULL, 0));
+	}
+
+	return (sshsExistsNodeN(st, nodePath, strlen(nodePath)));
+}
 
+bool sshsExistsNodeN(sshs st, const char *nodePath, size_t nodePathLength) {
 	if (!sshsCheckAbsoluteNodePath(nodePath, nodePathLength)) {
 		errno = EINVAL;
 		return (false);
 	}
 
-	// First node is the root.
-	sshsNode curr = st->root;
-
-	// Optimization: the root node always exists.
-	if (strncmp(nodePath, "/", nodePathLength) == 0) {
+	if (sshsPathCacheGet(st, nodePath, nodePathLength) != NULL) {
 		return (true);
 	}
 
-	// Create a copy of nodePath, so that strtok_r() can modify it.
-	char nodePathCopy[nodePathLength + 1];
-	strcpy(nodePathCopy, nodePath);
+	// Taken before the walk, so that removals during it are noticed.
+	const uint64_t removalGeneration = sshsNodeGetRemovalGeneration();
 
-	// Search (or create) viable node iteratively.
-	char *tokenSavePtr = NULL, *nextName = NULL, *currName = nodePathCopy;
-	while ((nextName = strtok_r(currName, "/", &tokenSavePtr)) != NULL) {
-		sshsNode next = sshsNodeGetChild(curr, nextName);
+	// Skip the leading '/', the root node always exists.
+	sshsNode node = sshsWalkNodePath(st->root, nodePath + 1, nodePathLength - 1, false);
 
-		// If node doesn't exist, return that.
-		if (next == NULL) {
-			errno = ENOENT;
-			return (false);
-		}
-
-		curr = next;
-
-		currName = NULL;
+	// If node doesn't exist, return that.
+	if (node == NULL) {
+		errno = ENOENT;
+		return (false);
 	}
 
-	// We got to the end, so the node exists.
+	sshsPathCachePut(st, nodePath, nodePathLength, node, removalGeneration);
+
 	return (true);
 }
 
 sshsNode sshsGetNode(sshs st, const char *nodePath) {
-	size_t nodePathLength = strlen(nodePath);
+	if (nodePath == NULL) {
+		return (sshsGetNodeN(st, NULL, 0));
+	}
 
+	return (sshsGetNodeN(st, nodePath, strlen(nodePath)));
+}
+
+sshsNode sshsGetNodeN(sshs st, const char *nodePath, size_t nodePathLength) {
 	if (!sshsCheckAbsoluteNodePath(nodePath, nodePathLength)) {
 		errno = EINVAL;
 		return (NULL);
 	}
 
-	// First node is the root.
-	sshsNode curr = st->root;
-
-	// Optimization: the root node always exists and is right there.
-	if (strncmp(nodePath, "/", nodePathLength) == 0) {
-		return (curr);
+	sshsNode node = sshsPathCacheGet(st, nodePath, nodePathLength);
+	if (node != NULL) {
+		return (node);
 	}
 
-	// Create a copy of nodePath, so that strtok_r() can modify it.
-	char nodePathCopy[nodePathLength + 1];
-	strcpy(nodePathCopy, nodePath);
+	// Taken before the walk, so that removals during it are noticed.
+	const uint64_t removalGeneration = sshsNodeGetRemovalGeneration();
 
-	// Search (or create) viable node iteratively.
-	char *tokenSavePtr = NULL, *nextName = NULL, *currName = nodePathCopy;
-	while ((nextName = strtok_r(currName, "/", &tokenSavePtr)) != NULL) {
-		sshsNode next = sshsNodeGetChild(curr, nextName);
+	// Skip the leading '/', search (or create) viable node iteratively.
+	node = sshsWalkNodePath(st->root, nodePath + 1, nodePathLength - 1, true);
 
-		// Create next node in path if not existing.
-		if (next == NULL) {
-			next = sshsNodeAddChild(curr, nextName);
-		}
+	sshsPathCachePut(st, nodePath, nodePathLength, node, removalGeneration);
 
-		curr = next;
+	return (node);
+}
 
-		currName = NULL;
+bool sshsExistsRelativeNode(sshsNode node, const char *nodePath) {
+	if (nodePath == NULL) {
+		return (sshsExistsRelativeNodeN(node, NULL, 0));
 	}
 
-	// 'curr' now contains the specified node.
-	return (curr);
+	return (sshsExistsRelativeNodeN(node, nodePath, strlen(nodePath)));
 }
 
-bool sshsExistsRelativeNode(sshsNode node, const char *nodePath) {
-	size_t nodePathLength = strlen(nodePath);
-
+bool sshsExistsRelativeNodeN(sshsNode node, const char *nodePath, size_t nodePathLength) {
 	if (!sshsCheckRelativeNodePath(nodePath, nodePathLength)) {
 		errno = EINVAL;
 		return (false);
 	}
 
-	// Start with the given node.
-	sshsNode curr = node;
-
-	// Create a copy of nodePath, so that strtok_r() can modify it.
-	char nodePathCopy[nodePathLength + 1];
-	strcpy(nodePathCopy, nodePath);
-
-	// Search (or create) viable node iteratively.
-	char *tokenSavePtr = NULL, *nextName = NULL, *currName = nodePathCopy;
-	while ((nextName = strtok_r(currName, "/", &tokenSavePtr)) != NULL) {
-		sshsNode next = sshsNodeGetChild(curr, nextName);
-
-		// If node doesn't exist, return that.
-		if (next == NULL) {
-			errno = ENOENT;
-			return (false);
-		}
-
-		curr = next;
-
-		currName = NULL;
+	// Relative nodes aren't cached: they have no link to their tree (and
+	// thus its cache), and are mostly used once to set up modules.
+	if (sshsWalkNodePath(node, nodePath, nodePathLength, false) == NULL) {
+		errno = ENOENT;
+		return (false);
 	}
 
 	// We got to the end, so the node exists.
@@ -186,39 +187,120 @@ bool sshsExistsRelativeNode(sshsNode node, const char *nodePath) {
 }
 
 sshsNode sshsGetRelativeNode(sshsNode node, const char *nodePath) {
-	size_t nodePathLength = strlen(nodePath);
+	if (nodePath == NULL) {
+		return (sshsGetRelativeNodeN(node, NULL, 0));
+	}
+
+	return (sshsGetRelativeNodeN(node, nodePath, strlen(nodePath)));
+}
 
+sshsNode sshsGetRelativeNodeN(sshsNode node, const char *nodePath, size_t nodePathLength) {
 	if (!sshsCheckRelativeNodePath(nodePath, nodePathLength)) {
 		errno = EINVAL;
 		return (NULL);
 	}
 
-	// Start with the given node.
+	return (sshsWalkNodePath(node, nodePath, nodePathLength, true));
+}
+
+// Follow a path of '/' terminated node names, starting at the given node.
+// The path is not modified, nor does it need to be NUL terminated.
+// Returns NULL if a node doesn't exist and create is false.
+static sshsNode sshsWalkNodePath(sshsNode node, const char *nodePath, size_t nodePathLength, bool create) {
 	sshsNode curr = node;
+	size_t nameStart = 0;
+
+	for (size_t i = 0; i < nodePathLength; i++) {
+		if (nodePath[i] != '/') {
+			continue;
+		}
 
-	// Create a copy of nodePath, so that strtok_r() can modify it.
-	char nodePathCopy[nodePathLength + 1];
-	strcpy(nodePathCopy, nodePath);
+		const char *name = nodePath + nameStart;
+		size_t nameLength = i - nameStart;
+		nameStart = i + 1;
 
-	// Search (or create) viable node iteratively.
-	char *tokenSavePtr = NULL, *nextName = NULL, *currName = nodePathCopy;
-	while ((nextName = strtok_r(currName, "/", &tokenSavePtr)) != NULL) {
-		sshsNode next = sshsNodeGetChild(curr, nextName);
+		sshsNode next = sshsNodeGetChildN(curr, name, nameLength);
 
-		// Create next node in path if not existing.
 		if (next == NULL) {
-			next = sshsNodeAddChild(curr, nextName);
+			if (!create) {
+				return (NULL);
+			}
+
+			// Create next node in path if not existing. This needs
+			// a NUL terminated name, but is rare, so copy it here.
+			char nameCopy[nameLength + 1];
+			memcpy(nameCopy, name, nameLength);
+			nameCopy[nameLength] = '\0';
+
+			next = sshsNodeAddChild(curr, nameCopy);
 		}
 
 		curr = next;
-
-		currName = NULL;
 	}
 
 	// 'curr' now contains the specified node.
 	return (curr);
 }
 
+// Lookup of absolute paths that were already resolved once. Never allocates.
+static sshsNode sshsPathCacheGet(sshs st, const char *nodePath, size_t nodePathLength) {
+	mtx_shared_lock_shared(&st->pathCacheLock);
+
+	// Removing any node invalidates the whole cache, as removed nodes
+	// may be anywhere in it, and removal is rare compared to lookups.
+	if (st->pathCacheGeneration != sshsNodeGetRemovalGeneration()) {
+		mtx_shared_unlock_shared(&st->pathCacheLock);
+		return (NULL);
+	}
+
+	sshsPathCacheEntry entry;
+	HASH_FIND(hh, st->pathCache, nodePath, nodePathLength, entry);
+
+	sshsNode node = (entry != NULL) ? (entry->node) : (NULL);
+
+	mtx_shared_unlock_shared(&st->pathCacheLock);
+
+	return (node);
+}
+
+// removalGeneration must be taken before the node was looked up: if any node
+// was removed since, the found one may already be gone and isn't cached.
+static void sshsPathCachePut(sshs st, const char *nodePath, size_t nodePathLength, sshsNode node,
+	uint64_t removalGeneration) {
+	mtx_shared_lock_exclusive(&st->pathCacheLock);
+
+	if (removalGeneration != sshsNodeGetRemovalGeneration()) {
+		mtx_shared_unlock_exclusive(&st->pathCacheLock);
+		return;
+	}
+
+	if (st->pathCacheGeneration != removalGeneration) {
+		sshsPathCacheEntry currEntry, tmpEntry;
+		HASH_ITER(hh, st->pathCache, currEntry, tmpEntry)
+		{
+			HASH_DELETE(hh, st->pathCache, currEntry);
+			free(currEntry);
+		}
+
+		st->pathCacheGeneration = removalGeneration;
+	}
+
+	sshsPathCacheEntry entry;
+	HASH_FIND(hh, st->pathCache, nodePath, nodePathLength, entry);
+
+	if (entry == NULL) {
+		entry = malloc(sizeof(*entry) + nodePathLength);
+		SSHS_MALLOC_CHECK_EXIT(entry);
+
+		entry->node = node;
+		memcpy(entry->path, nodePath, nodePathLength);
+
+		HASH_ADD(hh, st->pathCache, path, nodePathLength, entry);
+	}
+
+	mtx_shared_unlock_exclusive(&st->pathCacheLock);
+}
+
 bool sshsBeginTransaction(sshs st, char *nodePaths[], size_t nodePathsLength) {
 	// Check all node paths, then lock them.
 	for (size_t i = 0; i < nodePathsLength; i++) {
@@ -251,9 +333,38 @@ bool sshsEndTransaction(sshs st, char *nodePaths[], size_t nodePathsLength) {
 	return (true);
 }
 
-#define ALLOWED_CHARS_REGEXP "([a-zA-Z-_\\d\\.:\\(\\)\\[\\]{}]+/)"
-static const char *sshsAbsoluteNodePathRegexp = "^/" ALLOWED_CHARS_REGEXP "*$";
-static const char *sshsRelativeNodePathRegexp = "^" ALLOWED_CHARS_REGEXP "+$";
+// Node names are made up of the characters in: a-zA-Z0-9-_.:()[]{}
+static inline bool sshsCheckNodePathCharacter(char c) {
+	return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_'
+		|| c == '.' || c == ':' || c == '(' || c == ')' || c == '[' || c == ']' || c == '{' || c == '}');
+}
+
+// One or more non-empty node names, each followed by '/'.
+static bool sshsCheckNodePathNames(const char *nodePath, size_t nodePathLength) {
+	if (nodePathLength == 0 || nodePath[nodePathLength - 1] != '/') {
+		return (false);
+	}
+
+	size_t nameLength = 0;
+
+	for (size_t i = 0; i < nodePathLength; i++) {
+		if (nodePath[i] == '/') {
+			if (nameLength == 0) {
+				return (false);
+			}
+
+			nameLength = 0;
+		}
+		else if (sshsCheckNodePathCharacter(nodePath[i])) {
+			nameLength++;
+		}
+		else {
+			return (false);
+		}
+	}
+
+	return (true);
+}
 
 static bool sshsCheckAbsoluteNodePath(const char *absolutePath, size_t absolutePathLength) {
 	if (absolutePath == NULL || absolutePathLength == 0) {
@@ -261,9 +372,12 @@ static bool sshsCheckAbsoluteNodePath(const char *absolutePath, size_t absoluteP
 		return (false);
 	}
 
-	if (slre_match(sshsAbsoluteNodePathRegexp, absolutePath, (int) absolutePathLength, NULL, 0, 0) <= 0) {
+	// Either only the root node, or the root followed by node names.
+	if (absolutePath[0] != '/'
+		|| (absolutePathLength > 1 && !sshsCheckNodePathNames(absolutePath + 1, absolutePathLength - 1))) {
 		char errorMsg[4096];
-		snprintf(errorMsg, 4096, "Invalid absolute node path format: '%s'.", absolutePath);
+		snprintf(errorMsg, 4096, "Invalid absolute node path format: '%.*s'.", (int) absolutePathLength,
+			absolutePath);
 		(*sshsGetGlobalErrorLogCallback())(errorMsg);
 		return (false);
 	}
@@ -277,9 +391,10 @@ static bool sshsCheckRelativeNodePath(const char *relativePath, size_t relativeP
 		return (false);
 	}
 
-	if (slre_match(sshsRelativeNodePathRegexp, relativePath, (int) relativePathLength, NULL, 0, 0) <= 0) {
+	if (!sshsCheckNodePathNames(relativePath, relativePathLength)) {
 		char errorMsg[4096];
-		snprintf(errorMsg, 4096, "Invalid relative node path format: '%s'.", relativePath);
+		snprintf(errorMsg, 4096, "Invalid relative node path format: '%.*s'.", (int) relativePathLength,
+			relativePath);
 		(*sshsGetGlobalErrorLogCallback())(errorMsg);
 		return (false);
 	}
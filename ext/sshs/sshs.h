@@ -76,6 +76,14 @@ struct sshs_node_attr_ranges {
 	union sshs_node_attr_range max;
 };
 
+// Copy of one attribute, see sshsNodeGetAttributeSnapshot().
+struct sshs_node_attr_snapshot {
+	char *key;
+	enum sshs_node_attr_value_type type;
+	int flags;
+	union sshs_node_attr_value value;
+};
+
 #define SSHS_RANGES_LONG(MIV, MAV) (struct sshs_node_attr_ranges) { .min = { .i = MIV }, .max = { .i = MAV } }
 #define SSHS_RANGES_DOUBLE(MIV, MAV) (struct sshs_node_attr_ranges) { .min = { .d = MIV }, .max = { .d = MAV } }
 
@@ -101,6 +109,12 @@ const char *sshsNodeGetName(sshsNode node) CAER_SYMBOL_EXPORT;
 const char *sshsNodeGetPath(sshsNode node) CAER_SYMBOL_EXPORT;
 sshsNode sshsNodeGetParent(sshsNode node) CAER_SYMBOL_EXPORT;
 sshsNode *sshsNodeGetChildren(sshsNode node, size_t *numChildren) CAER_SYMBOL_EXPORT; // Walk all children.
+// Call visitor on a node and then on all nodes below it, children sorted by
+// name. Unlike walking sshsNodeGetChildren(), nodes can't be removed while
+// being visited: each node's children are walked with its traversal lock held.
+// So the visitor must not add or remove nodes.
+void sshsNodeVisitSubTree(sshsNode node, void (*visitor)(sshsNode node, void *userData), void *userData)
+	CAER_SYMBOL_EXPORT;
 void sshsNodeAddNodeListener(sshsNode node, void *userData,
 	void (*node_changed)(sshsNode node, void *userData, enum sshs_node_node_events event, const char *changeNode))
 		CAER_SYMBOL_EXPORT;
@@ -112,6 +126,13 @@ void sshsNodeAddAttributeListener(sshsNode node, void *userData,
 	void (*attribute_changed)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue))
 			CAER_SYMBOL_EXPORT;
+// Same as sshsNodeAddAttributeListener(), but the listener is called from a
+// separate executor thread, in change order, without holding the node lock.
+// Removing it waits for all its queued calls to complete.
+void sshsNodeAddAttributeListenerAsync(sshsNode node, void *userData,
+	void (*attribute_changed)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue))
+			CAER_SYMBOL_EXPORT;
 void sshsNodeRemoveAttributeListener(sshsNode node, void *userData,
 	void (*attribute_changed)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue))
@@ -125,6 +146,8 @@ void sshsNodeRemoveAllAttributes(sshsNode node) CAER_SYMBOL_EXPORT;
 void sshsNodeRemoveNode(sshsNode node) CAER_SYMBOL_EXPORT;
 void sshsNodeClearSubTree(sshsNode startNode, bool clearStartNode) CAER_SYMBOL_EXPORT;
 bool sshsNodeAttributeExists(sshsNode node, const char *key, enum sshs_node_attr_value_type type) CAER_SYMBOL_EXPORT;
+bool sshsNodeCheckAttributeValue(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) CAER_SYMBOL_EXPORT;
 bool sshsNodePutAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
 	union sshs_node_attr_value value) CAER_SYMBOL_EXPORT;
 union sshs_node_attr_value sshsNodeGetAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type)
@@ -167,6 +190,11 @@ void sshsNodeExportNodeToXML(sshsNode node, int outFd) CAER_SYMBOL_EXPORT;
 void sshsNodeExportSubTreeToXML(sshsNode node, int outFd) CAER_SYMBOL_EXPORT;
 bool sshsNodeImportNodeFromXML(sshsNode node, int inFd, bool strict) CAER_SYMBOL_EXPORT;
 bool sshsNodeImportSubTreeFromXML(sshsNode node, int inFd, bool strict) CAER_SYMBOL_EXPORT;
+// Binary snapshots, much faster to save and load than XML. With onlyChanged,
+// only nodes changed since their last export are appended to an existing
+// snapshot, so outFd should be opened with O_APPEND.
+bool sshsNodeExportSubTreeToBinary(sshsNode node, int outFd, bool onlyChanged) CAER_SYMBOL_EXPORT;
+bool sshsNodeImportSubTreeFromBinary(sshsNode node, int inFd, bool strict) CAER_SYMBOL_EXPORT;
 bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const char *type, const char *value)
 	CAER_SYMBOL_EXPORT;
 const char **sshsNodeGetChildNames(sshsNode node, size_t *numNames) CAER_SYMBOL_EXPORT;
@@ -179,6 +207,34 @@ int sshsNodeGetAttributeFlags(sshsNode node, const char *key, enum sshs_node_att
 	CAER_SYMBOL_EXPORT;
 char *sshsNodeGetAttributeDescription(sshsNode node, const char *key, enum sshs_node_attr_value_type type)
 	CAER_SYMBOL_EXPORT;
+// Key, type, flags and value of all attributes of a node, copied in one pass
+// under the node's lock, sorted by key. Unlike getting keys and then reading
+// each attribute, this can't fail if attributes are removed meanwhile.
+// Free with sshsNodeFreeAttributeSnapshot().
+struct sshs_node_attr_snapshot *sshsNodeGetAttributeSnapshot(sshsNode node, size_t *numAttributes)
+	CAER_SYMBOL_EXPORT;
+void sshsNodeFreeAttributeSnapshot(struct sshs_node_attr_snapshot *attributes, size_t numAttributes)
+	CAER_SYMBOL_EXPORT;
+
+// Attribute handles: bind an attribute once, then read its current value
+// without locks or memory allocation, for example in a module's run function.
+// Booleans, integers and floats are one atomic load, doubles and strings are
+// read under a sequence lock. A handle stays valid as long as its node does.
+// The getter must match the type the handle was created with.
+typedef struct sshs_node_attr_handle *sshsNodeAttrHandle;
+
+sshsNodeAttrHandle sshsNodeGetAttributeHandle(sshsNode node, const char *key, enum sshs_node_attr_value_type type)
+	CAER_SYMBOL_EXPORT;
+uint64_t sshsNodeAttrHandleGetVersion(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT; // Incremented on every change.
+bool sshsNodeAttrHandleExists(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+bool sshsNodeAttrHandleGetBool(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+int8_t sshsNodeAttrHandleGetByte(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+int16_t sshsNodeAttrHandleGetShort(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+int32_t sshsNodeAttrHandleGetInt(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+int64_t sshsNodeAttrHandleGetLong(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+float sshsNodeAttrHandleGetFloat(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+double sshsNodeAttrHandleGetDouble(sshsNodeAttrHandle handle) CAER_SYMBOL_EXPORT;
+size_t sshsNodeAttrHandleGetString(sshsNodeAttrHandle handle, char *buffer, size_t bufferSize) CAER_SYMBOL_EXPORT;
 
 // Helper functions
 const char *sshsHelperTypeToStringConverter(enum sshs_node_attr_value_type type) CAER_SYMBOL_EXPORT;
@@ -199,6 +255,11 @@ bool sshsExistsNode(sshs st, const char *nodePath) CAER_SYMBOL_EXPORT;
 sshsNode sshsGetNode(sshs st, const char *nodePath) CAER_SYMBOL_EXPORT;
 bool sshsExistsRelativeNode(sshsNode node, const char *nodePath) CAER_SYMBOL_EXPORT;
 sshsNode sshsGetRelativeNode(sshsNode node, const char *nodePath) CAER_SYMBOL_EXPORT;
+// Same as above, but paths are given as (pointer, length) and don't need to be NUL terminated.
+bool sshsExistsNodeN(sshs st, const char *nodePath, size_t nodePathLength) CAER_SYMBOL_EXPORT;
+sshsNode sshsGetNodeN(sshs st, const char *nodePath, size_t nodePathLength) CAER_SYMBOL_EXPORT;
+bool sshsExistsRelativeNodeN(sshsNode node, const char *nodePath, size_t nodePathLength) CAER_SYMBOL_EXPORT;
+sshsNode sshsGetRelativeNodeN(sshsNode node, const char *nodePath, size_t nodePathLength) CAER_SYMBOL_EXPORT;
 bool sshsBeginTransaction(sshs st, char *nodePaths[], size_t nodePathsLength) CAER_SYMBOL_EXPORT;
 bool sshsEndTransaction(sshs st, char *nodePaths[], size_t nodePathsLength) CAER_SYMBOL_EXPORT;
 
@@ -102,19 +102,19 @@ inline bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, cons
 
 // std::string variants of node getters.
 inline bool sshsExistsNode(sshs st, const std::string &nodePath) {
-	return (sshsExistsNode(st, nodePath.c_str()));
+	return (sshsExistsNodeN(st, nodePath.c_str(), nodePath.length()));
 }
 
 inline sshsNode sshsGetNode(sshs st, const std::string &nodePath) {
-	return (sshsGetNode(st, nodePath.c_str()));
+	return (sshsGetNodeN(st, nodePath.c_str(), nodePath.length()));
 }
 
 inline bool sshsExistsRelativeNode(sshsNode node, const std::string &nodePath) {
-	return (sshsExistsRelativeNode(node, nodePath.c_str()));
+	return (sshsExistsRelativeNodeN(node, nodePath.c_str(), nodePath.length()));
 }
 
 inline sshsNode sshsGetRelativeNode(sshsNode node, const std::string &nodePath) {
-	return (sshsGetRelativeNode(node, nodePath.c_str()));
+	return (sshsGetRelativeNodeN(node, nodePath.c_str(), nodePath.length()));
 }
 
 #endif /* SSHS_HPP_ */
@@ -0,0 +1,161 @@
+#include "sshs_internal.h"
+
+// Asynchronous attribute listeners: their calls are queued here and run on
+// a separate thread, in the same order the changes happened, so that whoever
+// changes an attribute never has to wait for slow listeners.
+struct sshs_executor_event {
+	struct sshs_executor_event *next;
+	sshsNode node;
+	void *userData;
+	sshsAttributeChangedListener attribute_changed;
+	enum sshs_node_attribute_events event;
+	enum sshs_node_attr_value_type value_type;
+	union sshs_node_attr_value value;
+	uint64_t sequence;
+	char key[];
+};
+
+typedef struct sshs_executor_event *sshsExecutorEvent;
+
+static struct {
+	thrd_t thread;
+	mtx_t lock;
+	cnd_t eventAvailable;
+	cnd_t eventCompleted;
+	sshsExecutorEvent queueHead;
+	sshsExecutorEvent queueTail;
+	uint64_t eventsQueued;
+	uint64_t eventsCompleted;
+} sshsExecutor;
+
+static once_flag sshsExecutorIsInitialized = ONCE_FLAG_INIT;
+
+static void sshsExecutorInitialize(void);
+static int sshsExecutorThread(void *arg);
+
+static void sshsExecutorInitialize(void) {
+	if (mtx_init(&sshsExecutor.lock, mtx_plain) != thrd_success) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to initialize listener executor lock.");
+		exit(EXIT_FAILURE);
+	}
+
+	if (cnd_init(&sshsExecutor.eventAvailable) != thrd_success
+		|| cnd_init(&sshsExecutor.eventCompleted) != thrd_success) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to initialize listener executor conditions.");
+		exit(EXIT_FAILURE);
+	}
+
+	// The executor thread lives as long as the process, like the global tree.
+	if (thrd_create(&sshsExecutor.thread, &sshsExecutorThread, NULL) != thrd_success) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to start listener executor thread.");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static int sshsExecutorThread(void *arg) {
+	(void) (arg); // UNUSED.
+
+	mtx_lock(&sshsExecutor.lock);
+
+	while (true) {
+		while (sshsExecutor.queueHead == NULL) {
+			cnd_wait(&sshsExecutor.eventAvailable, &sshsExecutor.lock);
+		}
+
+		sshsExecutorEvent event = sshsExecutor.queueHead;
+
+		sshsExecutor.queueHead = event->next;
+		if (sshsExecutor.queueHead == NULL) {
+			sshsExecutor.queueTail = NULL;
+		}
+
+		mtx_unlock(&sshsExecutor.lock);
+
+		// Call listener without holding any lock.
+		(*event->attribute_changed)(event->node, event->userData, event->event, event->key, event->value_type,
+			event->value);
+
+		if (event->value_type == SSHS_STRING) {
+			free(event->value.string);
+		}
+
+		mtx_lock(&sshsExecutor.lock);
+
+		sshsExecutor.eventsCompleted = event->sequence;
+		cnd_broadcast(&sshsExecutor.eventCompleted);
+
+		free(event);
+	}
+
+	return (0);
+}
+
+// Called with the node lock held, so events from one node are queued
+// (and thus delivered) in the same order as the changes happened.
+void sshsExecutorEnqueue(sshsNode node, void *userData, sshsAttributeChangedListener attribute_changed,
+	enum sshs_node_attribute_events event, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) {
+	call_once(&sshsExecutorIsInitialized, &sshsExecutorInitialize);
+
+	size_t keyLength = strlen(key);
+	sshsExecutorEvent newEvent = malloc(sizeof(*newEvent) + keyLength + 1);
+	SSHS_MALLOC_CHECK_EXIT(newEvent);
+
+	newEvent->next = NULL;
+	newEvent->node = node;
+	newEvent->userData = userData;
+	newEvent->attribute_changed = attribute_changed;
+	newEvent->event = event;
+	newEvent->value_type = type;
+	strcpy(newEvent->key, key);
+
+	if (type == SSHS_STRING) {
+		// Make a copy of the string, the original may be gone by the time
+		// the listener runs.
+		newEvent->value.string = strdup(value.string);
+		SSHS_MALLOC_CHECK_EXIT(newEvent->value.string);
+	}
+	else {
+		newEvent->value = value;
+	}
+
+	mtx_lock(&sshsExecutor.lock);
+
+	newEvent->sequence = ++sshsExecutor.eventsQueued;
+
+	if (sshsExecutor.queueTail == NULL) {
+		sshsExecutor.queueHead = newEvent;
+	}
+	else {
+		sshsExecutor.queueTail->next = newEvent;
+	}
+
+	sshsExecutor.queueTail = newEvent;
+
+	cnd_signal(&sshsExecutor.eventAvailable);
+
+	mtx_unlock(&sshsExecutor.lock);
+}
+
+// Wait until all events queued so far have been delivered. Used when removing
+// asynchronous listeners, as their userData may be freed right after.
+// Must not be called with any node lock held.
+void sshsExecutorDrain(void) {
+	call_once(&sshsExecutorIsInitialized, &sshsExecutorInitialize);
+
+	// Listeners removing themselves (or others) from the executor thread
+	// can't wait for themselves to finish.
+	if (thrd_equal(thrd_current(), sshsExecutor.thread)) {
+		return;
+	}
+
+	mtx_lock(&sshsExecutor.lock);
+
+	uint64_t waitFor = sshsExecutor.eventsQueued;
+
+	while (sshsExecutor.eventsCompleted < waitFor) {
+		cnd_wait(&sshsExecutor.eventCompleted, &sshsExecutor.lock);
+	}
+
+	mtx_unlock(&sshsExecutor.lock);
+}
@@ -22,13 +22,23 @@
 typedef struct sshs_node_attr *sshsNodeAttr;
 typedef struct sshs_node_listener *sshsNodeListener;
 typedef struct sshs_node_attr_listener *sshsNodeAttrListener;
+typedef void (*sshsAttributeChangedListener)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 
 sshsNode sshsNodeNew(const char *nodeName, sshsNode parent);
 sshsNode sshsNodeAddChild(sshsNode node, const char *childName);
 sshsNode sshsNodeGetChild(sshsNode node, const char* childName);
+sshsNode sshsNodeGetChildN(sshsNode node, const char *childName, size_t childNameLength);
+uint64_t sshsNodeGetRemovalGeneration(void);
 void sshsNodeTransactionLock(sshsNode node);
 void sshsNodeTransactionUnlock(sshsNode node);
 
+// SSHS listener executor
+void sshsExecutorEnqueue(sshsNode node, void *userData, sshsAttributeChangedListener attribute_changed,
+	enum sshs_node_attribute_events event, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value);
+void sshsExecutorDrain(void);
+
 // SSHS
 sshsErrorLogCallback sshsGetGlobalErrorLogCallback(void);
 
@@ -2,6 +2,14 @@
 #include "ext/uthash/uthash.h"
 #include "ext/uthash/utlist.h"
 #include <float.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if !defined(OS_WINDOWS)
+#include <sys/mman.h>
+#endif
 
 struct sshs_node {
 	char *name;
@@ -9,10 +17,13 @@ struct sshs_node {
 	sshsNode parent;
 	sshsNode children;
 	sshsNodeAttr attributes;
+	sshsNodeAttrHandle attrHandles;
 	sshsNodeListener nodeListeners;
 	sshsNodeAttrListener attrListeners;
 	mtx_shared_t traversal_lock;
 	mtx_t node_lock;
+	/// Exported attributes changed since the last binary snapshot of this node.
+	atomic_bool dirty;
 	UT_hash_handle hh;
 };
 
@@ -22,11 +33,47 @@ struct sshs_node_attr {
 	union sshs_node_attr_range max;
 	int flags;
 	char *description;
+	sshsNodeAttrHandle handle;
 	union sshs_node_attr_value value;
 	enum sshs_node_attr_value_type value_type;
 	char key[];
 };
 
+// String value of an attribute handle. Its size and length live in the same
+// allocation as the characters and are published with them as one pointer,
+// so a reader can never pair the length of one buffer with another buffer.
+struct sshs_node_attr_handle_string {
+	/// Size of data, in bytes.
+	size_t capacity;
+	/// Length of the current string, without NUL. Always below capacity.
+	atomic_size_t length;
+	char data[];
+};
+
+// Cached copy of an attribute's value, readable without taking any lock.
+// Updated by writers while holding node_lock. It lives as long as its node,
+// even if the attribute itself is removed (and maybe re-created) meanwhile.
+struct sshs_node_attr_handle {
+	UT_hash_handle hh;
+	/// Sequence lock: odd while an update is in progress. Half of it is the version.
+	atomic_uint_fast64_t sequence;
+	/// Attribute currently exists on the node.
+	atomic_bool exists;
+	/// Current value of booleans, integers and floats (as bits), read in one atomic load.
+	atomic_int_fast64_t value;
+	/// Current value of doubles (as bits, low and high 32 bits), read under the sequence lock.
+	atomic_uint_fast32_t doubleValue[2];
+	/// Current value of strings, read under the sequence lock.
+	_Atomic(struct sshs_node_attr_handle_string *) stringValue;
+	/// Old string buffers. Readers may still be copying from them, so they're
+	/// only freed together with the handle. Buffers grow by doubling, so this
+	/// uses at most as much memory again as the current buffer.
+	struct sshs_node_attr_handle_string **retiredStrings;
+	size_t retiredStringsSize;
+	enum sshs_node_attr_value_type value_type;
+	char key[];
+};
+
 struct sshs_node_listener {
 	void (*node_changed)(sshsNode node, void *userData, enum sshs_node_node_events event, const char *changeNode);
 	void *userData;
@@ -37,10 +84,24 @@ struct sshs_node_attr_listener {
 	void (*attribute_changed)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 	void *userData;
+	/// Call from the listener executor thread instead of the changing thread.
+	bool async;
 	sshsNodeAttrListener next;
 };
 
+// Growable output buffer for binary snapshots, written out in one go.
+struct sshs_node_binary_buffer {
+	uint8_t *data;
+	size_t size;
+	size_t capacity;
+};
+
 static void sshsNodeDestroy(sshsNode node);
+static void sshsNodeAddAttributeListenerInternal(sshsNode node, void *userData,
+	sshsAttributeChangedListener attribute_changed, bool async);
+static inline void sshsNodeAttrListenerCall(sshsNode node, sshsNodeAttrListener l,
+	enum sshs_node_attribute_events event, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value);
 static int sshsNodeCmp(const void *a, const void *b);
 static bool sshsNodeCheckRange(enum sshs_node_attr_value_type type, union sshs_node_attr_value value,
 	union sshs_node_attr_range min, union sshs_node_attr_range max);
@@ -57,6 +118,20 @@ static mxml_node_t *sshsNodeGenerateXML(sshsNode node, bool recursive);
 static mxml_node_t **sshsNodeXMLFilterChildNodes(mxml_node_t *node, const char *nodeName, size_t *numChildren);
 static bool sshsNodeFromXML(sshsNode node, int inFd, bool recursive, bool strict);
 static void sshsNodeConsumeXML(sshsNode node, mxml_node_t *content, bool recursive);
+static bool sshsNodeLoadAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value, const char *description);
+static void sshsNodeGenerateBinary(sshsNode node, size_t rootPathLength, struct sshs_node_binary_buffer *buffer,
+	bool onlyChanged);
+static bool sshsNodeConsumeBinary(sshsNode node, const uint8_t *data, size_t dataLength);
+static void sshsNodeAttrHandleUpdate(sshsNodeAttrHandle handle, bool exists, union sshs_node_attr_value value);
+static void sshsNodeAttrHandleFree(sshsNodeAttrHandle handle);
+
+// Call with node_lock held, whenever an attribute is added, changed or removed.
+static inline void sshsNodeMarkDirty(sshsNode node, int flags) {
+	if ((flags & SSHS_FLAGS_NO_EXPORT) == 0) {
+		atomic_store_explicit(&node->dirty, true, memory_order_relaxed);
+	}
+}
 
 sshsNode sshsNodeNew(const char *nodeName, sshsNode parent) {
 	sshsNode newNode = malloc(sizeof(*newNode));
@@ -76,6 +151,7 @@ sshsNode sshsNodeNew(const char *nodeName, sshsNode parent) {
 	newNode->attributes = NULL;
 	newNode->nodeListeners = NULL;
 	newNode->attrListeners = NULL;
+	atomic_init(&newNode->dirty, false);
 
 	if (mtx_shared_init(&newNode->traversal_lock) != thrd_success) {
 		// Locks are critical for thread-safety.
@@ -114,8 +190,26 @@ sshsNode sshsNodeNew(const char *nodeName, sshsNode parent) {
 	return (newNode);
 }
 
+// Incremented whenever a node is destroyed, so that any cached
+// references to nodes can be invalidated.
+static atomic_uint_fast64_t sshsNodeRemovalGeneration = ATOMIC_VAR_INIT(0);
+
+uint64_t sshsNodeGetRemovalGeneration(void) {
+	return (atomic_load(&sshsNodeRemovalGeneration));
+}
+
 // children, attributes, and listeners must be cleaned up prior to this call.
 static void sshsNodeDestroy(sshsNode node) {
+	atomic_fetch_add(&sshsNodeRemovalGeneration, 1);
+
+	// Attribute handles live as long as the node.
+	sshsNodeAttrHandle currHandle, tmpHandle;
+	HASH_ITER(hh, node->attrHandles, currHandle, tmpHandle)
+	{
+		HASH_DELETE(hh, node->attrHandles, currHandle);
+		sshsNodeAttrHandleFree(currHandle);
+	}
+
 	mtx_destroy(&node->node_lock);
 	mtx_shared_destroy(&node->traversal_lock);
 
@@ -186,6 +280,18 @@ sshsNode sshsNodeGetChild(sshsNode node, const char* childName) {
 	return (child);
 }
 
+sshsNode sshsNodeGetChildN(sshsNode node, const char *childName, size_t childNameLength) {
+	mtx_shared_lock_shared(&node->traversal_lock);
+
+	sshsNode child;
+	HASH_FIND(hh, node->children, childName, childNameLength, child);
+
+	mtx_shared_unlock_shared(&node->traversal_lock);
+
+	// Either null or an always valid value.
+	return (child);
+}
+
 static int sshsNodeCmp(const void *a, const void *b) {
 	const sshsNode *aa = a;
 	const sshsNode *bb = b;
@@ -223,6 +329,37 @@ sshsNode *sshsNodeGetChildren(sshsNode node, size_t *numChildren) {
 	return (children);
 }
 
+void sshsNodeVisitSubTree(sshsNode node, void (*visitor)(sshsNode node, void *userData), void *userData) {
+	(*visitor)(node, userData);
+
+	// Removing a child needs its parent's traversal lock exclusively, so
+	// holding it keeps all children alive, also while visiting below them.
+	mtx_shared_lock_shared(&node->traversal_lock);
+
+	size_t childrenCount = HASH_COUNT(node->children);
+
+	if (childrenCount > 0) {
+		sshsNode *children = malloc(childrenCount * sizeof(*children));
+		SSHS_MALLOC_CHECK_EXIT(children);
+
+		size_t i = 0;
+		for (sshsNode n = node->children; n != NULL; n = n->hh.next) {
+			children[i++] = n;
+		}
+
+		// Sort by name.
+		qsort(children, childrenCount, sizeof(sshsNode), &sshsNodeCmp);
+
+		for (i = 0; i < childrenCount; i++) {
+			sshsNodeVisitSubTree(children[i], visitor, userData);
+		}
+
+		free(children);
+	}
+
+	mtx_shared_unlock_shared(&node->traversal_lock);
+}
+
 void sshsNodeAddNodeListener(sshsNode node, void *userData,
 	void (*node_changed)(sshsNode node, void *userData, enum sshs_node_node_events event, const char *changeNode)) {
 	sshsNodeListener listener = malloc(sizeof(*listener));
@@ -286,11 +423,23 @@ void sshsNodeRemoveAllNodeListeners(sshsNode node) {
 void sshsNodeAddAttributeListener(sshsNode node, void *userData,
 	void (*attribute_changed)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue)) {
+	sshsNodeAddAttributeListenerInternal(node, userData, attribute_changed, false);
+}
+
+void sshsNodeAddAttributeListenerAsync(sshsNode node, void *userData,
+	void (*attribute_changed)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue)) {
+	sshsNodeAddAttributeListenerInternal(node, userData, attribute_changed, true);
+}
+
+static void sshsNodeAddAttributeListenerInternal(sshsNode node, void *userData,
+	sshsAttributeChangedListener attribute_changed, bool async) {
 	sshsNodeAttrListener listener = malloc(sizeof(*listener));
 	SSHS_MALLOC_CHECK_EXIT(listener);
 
 	listener->attribute_changed = attribute_changed;
 	listener->userData = userData;
+	listener->async = async;
 
 	mtx_lock(&node->node_lock);
 
@@ -318,31 +467,61 @@ void sshsNodeAddAttributeListener(sshsNode node, void *userData,
 void sshsNodeRemoveAttributeListener(sshsNode node, void *userData,
 	void (*attribute_changed)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue)) {
+	bool removedAsync = false;
+
 	mtx_lock(&node->node_lock);
 
 	sshsNodeAttrListener curr, curr_tmp;
 	LL_FOREACH_SAFE(node->attrListeners, curr, curr_tmp)
 	{
 		if (curr->attribute_changed == attribute_changed && curr->userData == userData) {
+			removedAsync |= curr->async;
+
 			LL_DELETE(node->attrListeners, curr);
 			free(curr);
 		}
 	}
 
 	mtx_unlock(&node->node_lock);
+
+	// Asynchronous listeners may still have calls queued, wait for them
+	// so the caller can safely free userData after returning.
+	if (removedAsync) {
+		sshsExecutorDrain();
+	}
 }
 
 void sshsNodeRemoveAllAttributeListeners(sshsNode node) {
+	bool removedAsync = false;
+
 	mtx_lock(&node->node_lock);
 
 	sshsNodeAttrListener curr, curr_tmp;
 	LL_FOREACH_SAFE(node->attrListeners, curr, curr_tmp)
 	{
+		removedAsync |= curr->async;
+
 		LL_DELETE(node->attrListeners, curr);
 		free(curr);
 	}
 
 	mtx_unlock(&node->node_lock);
+
+	if (removedAsync) {
+		sshsExecutorDrain();
+	}
+}
+
+static inline void sshsNodeAttrListenerCall(sshsNode node, sshsNodeAttrListener l,
+	enum sshs_node_attribute_events event, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) {
+	if (l->async) {
+		// Queued while holding the node lock, so ordering per node is kept.
+		sshsExecutorEnqueue(node, l->userData, l->attribute_changed, event, key, type, value);
+	}
+	else {
+		l->attribute_changed(node, l->userData, event, key, type, value);
+	}
 }
 
 void sshsNodeTransactionLock(sshsNode node) {
@@ -503,14 +682,27 @@ void sshsNodeCreateAttribute(sshsNode node, const char *key, enum sshs_node_attr
 	if (oldAttr == NULL) {
 		HASH_ADD(hh, node->attributes, value_type, fullKeyLength, newAttr);
 
+		// Re-attach handle, if this attribute existed before and had one.
+		HASH_FIND(hh, node->attrHandles, &newAttr->value_type, fullKeyLength, newAttr->handle);
+		if (newAttr->handle != NULL) {
+			sshsNodeAttrHandleUpdate(newAttr->handle, true, newAttr->value);
+		}
+
+		sshsNodeMarkDirty(node, flags);
+
 		// Listener support. Call only on change, which is always the case here.
 		sshsNodeAttrListener l;
 		LL_FOREACH(node->attrListeners, l)
 		{
-			l->attribute_changed(node, l->userData, SSHS_ATTRIBUTE_ADDED, key, type, defaultValue);
+			sshsNodeAttrListenerCall(node, l, SSHS_ATTRIBUTE_ADDED, key, type, defaultValue);
 		}
 	}
 	else {
+		// Flags decide what gets exported, so that's a change for snapshots.
+		if (oldAttr->flags != flags) {
+			atomic_store_explicit(&node->dirty, true, memory_order_relaxed);
+		}
+
 		// If value was present, update its range and flags always.
 		oldAttr->min = minValue;
 		oldAttr->max = maxValue;
@@ -533,11 +725,17 @@ void sshsNodeCreateAttribute(sshsNode node, const char *key, enum sshs_node_attr
 
 			free(newAttr);
 
+			if (oldAttr->handle != NULL) {
+				sshsNodeAttrHandleUpdate(oldAttr->handle, true, oldAttr->value);
+			}
+
+			sshsNodeMarkDirty(node, flags);
+
 			// Listener support. Call only on change, which is always the case here.
 			sshsNodeAttrListener l;
 			LL_FOREACH(node->attrListeners, l)
 			{
-				l->attribute_changed(node, l->userData, SSHS_ATTRIBUTE_MODIFIED, key, type, defaultValue);
+				sshsNodeAttrListenerCall(node, l, SSHS_ATTRIBUTE_MODIFIED, key, type, defaultValue);
 			}
 		}
 		else {
@@ -596,11 +794,17 @@ void sshsNodeRemoveAttribute(sshsNode node, const char *key, enum sshs_node_attr
 	// Remove attribute from node.
 	HASH_DELETE(hh, node->attributes, attr);
 
+	if (attr->handle != NULL) {
+		sshsNodeAttrHandleUpdate(attr->handle, false, attr->value);
+	}
+
+	sshsNodeMarkDirty(node, attr->flags);
+
 	// Listener support.
 	sshsNodeAttrListener l;
 	LL_FOREACH(node->attrListeners, l)
 	{
-		l->attribute_changed(node, l->userData, SSHS_ATTRIBUTE_REMOVED, key, type, attr->value);
+		sshsNodeAttrListenerCall(node, l, SSHS_ATTRIBUTE_REMOVED, key, type, attr->value);
 	}
 
 	mtx_unlock(&node->node_lock);
@@ -617,11 +821,17 @@ void sshsNodeRemoveAllAttributes(sshsNode node) {
 		// Remove attribute from node.
 		HASH_DELETE(hh, node->attributes, currAttr);
 
+		if (currAttr->handle != NULL) {
+			sshsNodeAttrHandleUpdate(currAttr->handle, false, currAttr->value);
+		}
+
+		sshsNodeMarkDirty(node, currAttr->flags);
+
 		// Listener support.
 		sshsNodeAttrListener l;
 		LL_FOREACH(node->attrListeners, l)
 		{
-			l->attribute_changed(node, l->userData, SSHS_ATTRIBUTE_REMOVED, currAttr->key, currAttr->value_type,
+			sshsNodeAttrListenerCall(node, l, SSHS_ATTRIBUTE_REMOVED, currAttr->key, currAttr->value_type,
 				currAttr->value);
 		}
 
@@ -761,6 +971,35 @@ bool sshsNodeAttributeExists(sshsNode node, const char *key, enum sshs_node_attr
 	return (true);
 }
 
+// Check if a value could be put into an attribute, without changing it.
+// For the precise failure reason, look at errno (same as for put).
+bool sshsNodeCheckAttributeValue(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) {
+	sshsNodeAttr attr = sshsNodeFindAttribute(node, key, type);
+
+	if (attr == NULL) {
+		mtx_unlock(&node->node_lock);
+		errno = ENOENT;
+		return (false);
+	}
+
+	if (attr->flags & SSHS_FLAGS_READ_ONLY) {
+		mtx_unlock(&node->node_lock);
+		errno = EPERM;
+		return (false);
+	}
+
+	if (!sshsNodeCheckRange(type, value, attr->min, attr->max)) {
+		mtx_unlock(&node->node_lock);
+		errno = ERANGE;
+		return (false);
+	}
+
+	mtx_unlock(&node->node_lock);
+
+	return (true);
+}
+
 bool sshsNodePutAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
 	union sshs_node_attr_value value) {
 	sshsNodeAttr attr = sshsNodeFindAttribute(node, key, type);
@@ -798,16 +1037,22 @@ bool sshsNodePutAttribute(sshsNode node, const char *key, enum sshs_node_attr_va
 		else {
 			attr->value = value;
 		}
+
+		if (attr->handle != NULL) {
+			sshsNodeAttrHandleUpdate(attr->handle, true, attr->value);
+		}
 	}
 
 	// Let's check if anything changed with this update and call
 	// the appropriate listeners if needed.
 	if (sshsNodeCheckAttributeValueChanged(type, attrValueOld, value)) {
+		sshsNodeMarkDirty(node, attr->flags);
+
 		// Listener support. Call only on change, which is always the case here.
 		sshsNodeAttrListener l;
 		LL_FOREACH(node->attrListeners, l)
 		{
-			l->attribute_changed(node, l->userData, SSHS_ATTRIBUTE_MODIFIED, key, type, value);
+			sshsNodeAttrListenerCall(node, l, SSHS_ATTRIBUTE_MODIFIED, key, type, value);
 		}
 	}
 
@@ -982,14 +1227,20 @@ bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, enum sshs_n
 		attr->value = value;
 	}
 
+	if (attr->handle != NULL) {
+		sshsNodeAttrHandleUpdate(attr->handle, true, attr->value);
+	}
+
 	// Let's check if anything changed with this update and call
 	// the appropriate listeners if needed.
 	if (sshsNodeCheckAttributeValueChanged(type, attrValueOld, value)) {
+		sshsNodeMarkDirty(node, attr->flags);
+
 		// Listener support. Call only on change, which is always the case here.
 		sshsNodeAttrListener l;
 		LL_FOREACH(node->attrListeners, l)
 		{
-			l->attribute_changed(node, l->userData, SSHS_ATTRIBUTE_MODIFIED, key, type, value);
+			sshsNodeAttrListenerCall(node, l, SSHS_ATTRIBUTE_MODIFIED, key, type, value);
 		}
 	}
 
@@ -1003,6 +1254,247 @@ bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, enum sshs_n
 	return (true);
 }
 
+sshsNodeAttrHandle sshsNodeGetAttributeHandle(sshsNode node, const char *key, enum sshs_node_attr_value_type type) {
+	sshsNodeAttr attr = sshsNodeFindAttribute(node, key, type);
+
+	// Verify that a valid attribute exists.
+	sshsNodeVerifyValidAttribute(attr, key, type, "sshsNodeGetAttributeHandle");
+
+	// Only ever one handle per attribute, shared by everybody.
+	if (attr->handle == NULL) {
+		size_t keyLength = strlen(key);
+		sshsNodeAttrHandle handle = calloc(1, sizeof(*handle) + keyLength + 1);
+		SSHS_MALLOC_CHECK_EXIT(handle);
+
+		handle->value_type = type;
+		strcpy(handle->key, key);
+
+		size_t fullKeyLength = offsetof(struct sshs_node_attr_handle, key) + keyLength
+			+ 1 - offsetof(struct sshs_node_attr_handle, value_type);
+
+		HASH_ADD(hh, node->attrHandles, value_type, fullKeyLength, handle);
+
+		sshsNodeAttrHandleUpdate(handle, true, attr->value);
+
+		// Version starts at zero for a new handle.
+		atomic_store(&handle->sequence, 0);
+
+		attr->handle = handle;
+	}
+
+	sshsNodeAttrHandle handle = attr->handle;
+
+	mtx_unlock(&node->node_lock);
+
+	return (handle);
+}
+
+// Must hold node_lock. Only one writer at a time thus.
+static void sshsNodeAttrHandleUpdate(sshsNodeAttrHandle handle, bool exists, union sshs_node_attr_value value) {
+	uint_fast64_t sequence = atomic_load_explicit(&handle->sequence, memory_order_relaxed);
+
+	// Start update: odd sequence number, readers of strings and doubles retry.
+	atomic_store_explicit(&handle->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	atomic_store_explicit(&handle->exists, exists, memory_order_relaxed);
+
+	switch (handle->value_type) {
+		case SSHS_BOOL:
+			atomic_store_explicit(&handle->value, value.boolean, memory_order_relaxed);
+			break;
+
+		case SSHS_BYTE:
+			atomic_store_explicit(&handle->value, value.ibyte, memory_order_relaxed);
+			break;
+
+		case SSHS_SHORT:
+			atomic_store_explicit(&handle->value, value.ishort, memory_order_relaxed);
+			break;
+
+		case SSHS_INT:
+			atomic_store_explicit(&handle->value, value.iint, memory_order_relaxed);
+			break;
+
+		case SSHS_LONG:
+			atomic_store_explicit(&handle->value, value.ilong, memory_order_relaxed);
+			break;
+
+		case SSHS_FLOAT: {
+			uint32_t floatBits;
+			memcpy(&floatBits, &value.ffloat, sizeof(float));
+			atomic_store_explicit(&handle->value, floatBits, memory_order_relaxed);
+			break;
+		}
+
+		case SSHS_DOUBLE: {
+			uint64_t doubleBits;
+			memcpy(&doubleBits, &value.ddouble, sizeof(double));
+			atomic_store_explicit(&handle->doubleValue[0], (uint32_t) doubleBits, memory_order_relaxed);
+			atomic_store_explicit(&handle->doubleValue[1], (uint32_t) (doubleBits >> 32), memory_order_relaxed);
+			break;
+		}
+
+		case SSHS_STRING: {
+			size_t stringLength = strlen(value.string);
+
+			struct sshs_node_attr_handle_string *string = atomic_load_explicit(&handle->stringValue,
+				memory_order_relaxed);
+
+			if ((string == NULL) || ((stringLength + 1) > string->capacity)) {
+				size_t newCapacity = (string == NULL) ? (0) : (string->capacity * 2);
+				if (newCapacity < (stringLength + 1)) {
+					newCapacity = (stringLength + 1);
+				}
+
+				struct sshs_node_attr_handle_string *newString = malloc(sizeof(*newString) + newCapacity);
+				SSHS_MALLOC_CHECK_EXIT(newString);
+
+				newString->capacity = newCapacity;
+				atomic_store_explicit(&newString->length, 0, memory_order_relaxed);
+
+				if (string != NULL) {
+					struct sshs_node_attr_handle_string **newRetiredStrings = realloc(handle->retiredStrings,
+						(handle->retiredStringsSize + 1) * sizeof(*newRetiredStrings));
+					SSHS_MALLOC_CHECK_EXIT(newRetiredStrings);
+
+					handle->retiredStrings = newRetiredStrings;
+					handle->retiredStrings[handle->retiredStringsSize++] = string;
+				}
+
+				string = newString;
+			}
+
+			memcpy(string->data, value.string, stringLength + 1);
+			atomic_store_explicit(&string->length, stringLength, memory_order_relaxed);
+
+			// Readers follow the pointer to the capacity, so publish it only once that is set.
+			atomic_store_explicit(&handle->stringValue, string, memory_order_release);
+			break;
+		}
+
+		case SSHS_UNKNOWN:
+		default:
+			break;
+	}
+
+	// Update done: even sequence number again, one version later.
+	atomic_store_explicit(&handle->sequence, sequence + 2, memory_order_release);
+}
+
+static void sshsNodeAttrHandleFree(sshsNodeAttrHandle handle) {
+	for (size_t i = 0; i < handle->retiredStringsSize; i++) {
+		free(handle->retiredStrings[i]);
+	}
+
+	free(handle->retiredStrings);
+	free(atomic_load(&handle->stringValue));
+	free(handle);
+}
+
+// Wait for a consistent sequence number (no update in progress).
+static inline uint_fast64_t sshsNodeAttrHandleReadBegin(sshsNodeAttrHandle handle) {
+	uint_fast64_t sequence;
+
+	while ((sequence = atomic_load_explicit(&handle->sequence, memory_order_acquire)) & 0x01) {
+		thrd_yield();
+	}
+
+	return (sequence);
+}
+
+static inline bool sshsNodeAttrHandleReadRetry(sshsNodeAttrHandle handle, uint_fast64_t sequence) {
+	atomic_thread_fence(memory_order_acquire);
+
+	return (atomic_load_explicit(&handle->sequence, memory_order_relaxed) != sequence);
+}
+
+uint64_t sshsNodeAttrHandleGetVersion(sshsNodeAttrHandle handle) {
+	return (atomic_load_explicit(&handle->sequence, memory_order_acquire) >> 1);
+}
+
+bool sshsNodeAttrHandleExists(sshsNodeAttrHandle handle) {
+	return (atomic_load_explicit(&handle->exists, memory_order_relaxed));
+}
+
+bool sshsNodeAttrHandleGetBool(sshsNodeAttrHandle handle) {
+	return (atomic_load_explicit(&handle->value, memory_order_relaxed) != 0);
+}
+
+int8_t sshsNodeAttrHandleGetByte(sshsNodeAttrHandle handle) {
+	return ((int8_t) atomic_load_explicit(&handle->value, memory_order_relaxed));
+}
+
+int16_t sshsNodeAttrHandleGetShort(sshsNodeAttrHandle handle) {
+	return ((int16_t) atomic_load_explicit(&handle->value, memory_order_relaxed));
+}
+
+int32_t sshsNodeAttrHandleGetInt(sshsNodeAttrHandle handle) {
+	return ((int32_t) atomic_load_explicit(&handle->value, memory_order_relaxed));
+}
+
+int64_t sshsNodeAttrHandleGetLong(sshsNodeAttrHandle handle) {
+	return ((int64_t) atomic_load_explicit(&handle->value, memory_order_relaxed));
+}
+
+float sshsNodeAttrHandleGetFloat(sshsNodeAttrHandle handle) {
+	uint32_t floatBits = (uint32_t) atomic_load_explicit(&handle->value, memory_order_relaxed);
+
+	float value;
+	memcpy(&value, &floatBits, sizeof(float));
+
+	return (value);
+}
+
+double sshsNodeAttrHandleGetDouble(sshsNodeAttrHandle handle) {
+	uint64_t doubleBits;
+	uint_fast64_t sequence;
+
+	do {
+		sequence = sshsNodeAttrHandleReadBegin(handle);
+
+		doubleBits = atomic_load_explicit(&handle->doubleValue[0], memory_order_relaxed);
+		doubleBits |= (uint64_t) atomic_load_explicit(&handle->doubleValue[1], memory_order_relaxed) << 32;
+	}
+	while (sshsNodeAttrHandleReadRetry(handle, sequence));
+
+	double value;
+	memcpy(&value, &doubleBits, sizeof(double));
+
+	return (value);
+}
+
+// Copies the string into the given buffer, always NUL terminated, truncated
+// if needed. Returns the full string length, like snprintf().
+size_t sshsNodeAttrHandleGetString(sshsNodeAttrHandle handle, char *buffer, size_t bufferSize) {
+	size_t stringLength;
+	uint_fast64_t sequence;
+
+	do {
+		sequence = sshsNodeAttrHandleReadBegin(handle);
+
+		// Length and data always come from the same buffer. Buffers are never
+		// freed while the handle exists, so this is safe even if a writer
+		// replaces or rewrites it: we'll just retry then.
+		const struct sshs_node_attr_handle_string *string = atomic_load_explicit(&handle->stringValue,
+			memory_order_acquire);
+		stringLength = (string != NULL) ? (atomic_load_explicit(&string->length, memory_order_relaxed)) : (0);
+
+		if (bufferSize > 0) {
+			size_t copyLength = (stringLength < bufferSize) ? (stringLength) : (bufferSize - 1);
+
+			if (string != NULL) {
+				memcpy(buffer, string->data, copyLength);
+			}
+
+			buffer[copyLength] = '\0';
+		}
+	}
+	while (sshsNodeAttrHandleReadRetry(handle, sequence));
+
+	return (stringLength);
+}
+
 void sshsNodeCreateBool(sshsNode node, const char *key, bool defaultValue, int flags, const char *description) {
 	sshsNodeCreateAttribute(node, key, SSHS_BOOL, SSHS_VALUE_BOOL(defaultValue), SSHS_RANGES_LONG(-1, -1), flags,
 		description);
@@ -1417,6 +1909,425 @@ static void sshsNodeConsumeXML(sshsNode node, mxml_node_t *content, bool recursi
 	}
 }
 
+// Binary snapshots: a header, followed by one record per node holding all its
+// exported attributes. Values are stored in host byte order, as snapshots are
+// meant as fast local checkpoints; use XML to move configurations around.
+// Incremental exports only append records for nodes that changed since they
+// were last exported. On import, records are applied in order, so the last
+// one for any attribute wins.
+//
+// Header: magic[8] version(u32) rootNameLength(u32) rootName
+// Node:   'N' pathLength(u32) path (relative to root) numAttributes(u32)
+// Attr:   type(u8) keyLength(u16) key value (fixed size, strings as length(u32) + bytes)
+#define SSHS_BINARY_MAGIC "SSHSSNAP"
+#define SSHS_BINARY_MAGIC_LENGTH 8
+#define SSHS_BINARY_VERSION 1
+#define SSHS_BINARY_NODE_RECORD 'N'
+
+static void sshsNodeBinaryAppend(struct sshs_node_binary_buffer *buffer, const void *data, size_t dataLength) {
+	if ((buffer->size + dataLength) > buffer->capacity) {
+		size_t newCapacity = (buffer->capacity == 0) ? (64 * 1024) : (buffer->capacity * 2);
+		while (newCapacity < (buffer->size + dataLength)) {
+			newCapacity *= 2;
+		}
+
+		uint8_t *newData = realloc(buffer->data, newCapacity);
+		SSHS_MALLOC_CHECK_EXIT(newData);
+
+		buffer->data = newData;
+		buffer->capacity = newCapacity;
+	}
+
+	memcpy(buffer->data + buffer->size, data, dataLength);
+	buffer->size += dataLength;
+}
+
+static size_t sshsNodeBinaryValueSize(enum sshs_node_attr_value_type type) {
+	switch (type) {
+		case SSHS_BOOL:
+		case SSHS_BYTE:
+			return (1);
+
+		case SSHS_SHORT:
+			return (2);
+
+		case SSHS_INT:
+		case SSHS_FLOAT:
+			return (4);
+
+		case SSHS_LONG:
+		case SSHS_DOUBLE:
+			return (8);
+
+		case SSHS_STRING:
+			return (4); // Length only.
+
+		case SSHS_UNKNOWN:
+		default:
+			return (0);
+	}
+}
+
+static void sshsNodeBinaryAppendValue(struct sshs_node_binary_buffer *buffer, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) {
+	switch (type) {
+		case SSHS_BOOL: {
+			uint8_t b = value.boolean;
+			sshsNodeBinaryAppend(buffer, &b, 1);
+			break;
+		}
+
+		case SSHS_BYTE:
+			sshsNodeBinaryAppend(buffer, &value.ibyte, 1);
+			break;
+
+		case SSHS_SHORT:
+			sshsNodeBinaryAppend(buffer, &value.ishort, 2);
+			break;
+
+		case SSHS_INT:
+			sshsNodeBinaryAppend(buffer, &value.iint, 4);
+			break;
+
+		case SSHS_LONG:
+			sshsNodeBinaryAppend(buffer, &value.ilong, 8);
+			break;
+
+		case SSHS_FLOAT:
+			sshsNodeBinaryAppend(buffer, &value.ffloat, 4);
+			break;
+
+		case SSHS_DOUBLE:
+			sshsNodeBinaryAppend(buffer, &value.ddouble, 8);
+			break;
+
+		case SSHS_STRING: {
+			uint32_t length = (uint32_t) strlen(value.string);
+			sshsNodeBinaryAppend(buffer, &length, 4);
+			sshsNodeBinaryAppend(buffer, value.string, length);
+			break;
+		}
+
+		case SSHS_UNKNOWN:
+			break;
+	}
+}
+
+static bool sshsNodeBinaryWrite(int outFd, const uint8_t *data, size_t dataLength) {
+	while (dataLength > 0) {
+		ssize_t written = write(outFd, data, dataLength);
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return (false);
+		}
+
+		data += written;
+		dataLength -= (size_t) written;
+	}
+
+	return (true);
+}
+
+bool sshsNodeExportSubTreeToBinary(sshsNode node, int outFd, bool onlyChanged) {
+	struct sshs_node_binary_buffer buffer = { .data = NULL, .size = 0, .capacity = 0 };
+
+	// Incremental exports append to an existing snapshot, without header.
+	if (!onlyChanged) {
+		uint32_t version = SSHS_BINARY_VERSION;
+		uint32_t rootNameLength = (uint32_t) strlen(sshsNodeGetName(node));
+
+		sshsNodeBinaryAppend(&buffer, SSHS_BINARY_MAGIC, SSHS_BINARY_MAGIC_LENGTH);
+		sshsNodeBinaryAppend(&buffer, &version, 4);
+		sshsNodeBinaryAppend(&buffer, &rootNameLength, 4);
+		sshsNodeBinaryAppend(&buffer, sshsNodeGetName(node), rootNameLength);
+	}
+
+	sshsNodeGenerateBinary(node, strlen(sshsNodeGetPath(node)), &buffer, onlyChanged);
+
+	// Write everything at once, so that appends are as atomic as possible.
+	bool result = sshsNodeBinaryWrite(outFd, buffer.data, buffer.size);
+
+	free(buffer.data);
+
+	if (!result) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to write binary snapshot to file descriptor.");
+	}
+
+	return (result);
+}
+
+static void sshsNodeGenerateBinary(sshsNode node, size_t rootPathLength, struct sshs_node_binary_buffer *buffer,
+	bool onlyChanged) {
+	size_t numAttributes;
+	sshsNodeAttr *attributes = sshsNodeGetAttributes(node, &numAttributes);
+
+	// Clear under node_lock, so no change between here and unlock can be lost.
+	bool changed = atomic_exchange(&node->dirty, false);
+
+	if (!onlyChanged || changed) {
+		uint32_t numExported = 0;
+
+		for (size_t i = 0; i < numAttributes; i++) {
+			if ((attributes[i]->flags & SSHS_FLAGS_NO_EXPORT) == 0) {
+				numExported++;
+			}
+		}
+
+		// Nodes without exported attributes are not stored, same as XML.
+		if (numExported > 0) {
+			uint8_t record = SSHS_BINARY_NODE_RECORD;
+			const char *relativePath = sshsNodeGetPath(node) + rootPathLength;
+			uint32_t relativePathLength = (uint32_t) strlen(relativePath);
+
+			sshsNodeBinaryAppend(buffer, &record, 1);
+			sshsNodeBinaryAppend(buffer, &relativePathLength, 4);
+			sshsNodeBinaryAppend(buffer, relativePath, relativePathLength);
+			sshsNodeBinaryAppend(buffer, &numExported, 4);
+
+			for (size_t i = 0; i < numAttributes; i++) {
+				if ((attributes[i]->flags & SSHS_FLAGS_NO_EXPORT)) {
+					continue;
+				}
+
+				uint8_t type = (uint8_t) attributes[i]->value_type;
+				uint16_t keyLength = (uint16_t) strlen(attributes[i]->key);
+
+				sshsNodeBinaryAppend(buffer, &type, 1);
+				sshsNodeBinaryAppend(buffer, &keyLength, 2);
+				sshsNodeBinaryAppend(buffer, attributes[i]->key, keyLength);
+				sshsNodeBinaryAppendValue(buffer, attributes[i]->value_type, attributes[i]->value);
+			}
+		}
+	}
+
+	mtx_unlock(&node->node_lock);
+
+	free(attributes);
+
+	size_t numChildren;
+	sshsNode *children = sshsNodeGetChildren(node, &numChildren);
+
+	for (size_t i = 0; i < numChildren; i++) {
+		sshsNodeGenerateBinary(children[i], rootPathLength, buffer, onlyChanged);
+	}
+
+	free(children);
+}
+
+bool sshsNodeImportSubTreeFromBinary(sshsNode node, int inFd, bool strict) {
+	struct stat inStat;
+	if (fstat(inFd, &inStat) != 0 || inStat.st_size <= 0) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to get size of binary snapshot.");
+		return (false);
+	}
+
+	size_t dataLength = (size_t) inStat.st_size;
+
+#if defined(OS_WINDOWS)
+	// No mmap() available, read the whole file instead.
+	uint8_t *data = malloc(dataLength);
+	SSHS_MALLOC_CHECK_EXIT(data);
+
+	size_t readLength = 0;
+	while (readLength < dataLength) {
+		ssize_t result = read(inFd, data + readLength, dataLength - readLength);
+
+		if (result <= 0) {
+			free(data);
+			(*sshsGetGlobalErrorLogCallback())("Failed to read binary snapshot from file descriptor.");
+			return (false);
+		}
+
+		readLength += (size_t) result;
+	}
+#else
+	// Map the snapshot directly, records are parsed in place.
+	uint8_t *data = mmap(NULL, dataLength, PROT_READ, MAP_PRIVATE, inFd, 0);
+
+	if (data == MAP_FAILED) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to map binary snapshot from file descriptor.");
+		return (false);
+	}
+#endif
+
+	bool result = false;
+
+	// Check header for compliance.
+	uint32_t version = 0, rootNameLength = 0;
+	size_t headerLength = SSHS_BINARY_MAGIC_LENGTH + 4 + 4;
+
+	if (dataLength >= headerLength) {
+		memcpy(&version, data + SSHS_BINARY_MAGIC_LENGTH, 4);
+		memcpy(&rootNameLength, data + SSHS_BINARY_MAGIC_LENGTH + 4, 4);
+	}
+
+	if (dataLength < headerLength || memcmp(data, SSHS_BINARY_MAGIC, SSHS_BINARY_MAGIC_LENGTH) != 0
+		|| version != SSHS_BINARY_VERSION || rootNameLength > (dataLength - headerLength)) {
+		(*sshsGetGlobalErrorLogCallback())("Invalid SSHS v1 binary snapshot content.");
+		goto out;
+	}
+
+	// Strict mode: check if names match.
+	if (strict) {
+		const char *nodeName = sshsNodeGetName(node);
+
+		if (strlen(nodeName) != rootNameLength || memcmp(data + headerLength, nodeName, rootNameLength) != 0) {
+			(*sshsGetGlobalErrorLogCallback())("Names don't match (required in 'strict' mode).");
+			goto out;
+		}
+	}
+
+	headerLength += rootNameLength;
+
+	result = sshsNodeConsumeBinary(node, data + headerLength, dataLength - headerLength);
+
+out:
+#if defined(OS_WINDOWS)
+	free(data);
+#else
+	munmap(data, dataLength);
+#endif
+
+	return (result);
+}
+
+static bool sshsNodeConsumeBinary(sshsNode node, const uint8_t *data, size_t dataLength) {
+	size_t offset = 0;
+
+// Stop on truncated records, for example from an interrupted incremental export.
+#define SSHS_BINARY_NEED(LEN) if ((LEN) > (dataLength - offset)) { goto truncated; }
+
+	while (offset < dataLength) {
+		SSHS_BINARY_NEED(1 + 4);
+
+		if (data[offset] != SSHS_BINARY_NODE_RECORD) {
+			(*sshsGetGlobalErrorLogCallback())("Invalid record in binary snapshot.");
+			return (false);
+		}
+
+		uint32_t pathLength;
+		memcpy(&pathLength, data + offset + 1, 4);
+		offset += 1 + 4;
+
+		SSHS_BINARY_NEED((size_t) pathLength + 4);
+
+		const char *path = (const char *) (data + offset);
+		offset += pathLength;
+
+		uint32_t numAttributes;
+		memcpy(&numAttributes, data + offset, 4);
+		offset += 4;
+
+		// Validate the full record first, so that a truncated one is not
+		// applied partially.
+		size_t recordOffset = offset;
+
+		for (uint32_t i = 0; i < numAttributes; i++) {
+			SSHS_BINARY_NEED(1 + 2);
+
+			enum sshs_node_attr_value_type type = (enum sshs_node_attr_value_type) data[offset];
+			uint16_t keyLength;
+			memcpy(&keyLength, data + offset + 1, 2);
+
+			SSHS_BINARY_NEED(1 + 2 + (size_t) keyLength);
+			offset += 1 + 2 + keyLength;
+
+			size_t valueSize = sshsNodeBinaryValueSize(type);
+			if (valueSize == 0) {
+				(*sshsGetGlobalErrorLogCallback())("Invalid attribute type in binary snapshot.");
+				return (false);
+			}
+
+			SSHS_BINARY_NEED(valueSize);
+
+			if (type == SSHS_STRING) {
+				uint32_t stringLength;
+				memcpy(&stringLength, data + offset, 4);
+				offset += 4;
+
+				SSHS_BINARY_NEED(stringLength);
+				offset += stringLength;
+			}
+			else {
+				offset += valueSize;
+			}
+		}
+
+		// Empty path is the import node itself, everything else is relative to it.
+		sshsNode recordNode = (pathLength == 0) ? (node) : (sshsGetRelativeNodeN(node, path, pathLength));
+
+		if (recordNode == NULL) {
+			// Invalid path, error already logged by SSHS.
+			continue;
+		}
+
+		// Now apply the record's attributes.
+		size_t applyOffset = recordOffset;
+
+		for (uint32_t i = 0; i < numAttributes; i++) {
+			enum sshs_node_attr_value_type type = (enum sshs_node_attr_value_type) data[applyOffset];
+			uint16_t keyLength;
+			memcpy(&keyLength, data + applyOffset + 1, 2);
+			applyOffset += 1 + 2;
+
+			char *key = strndup((const char *) (data + applyOffset), keyLength);
+			SSHS_MALLOC_CHECK_EXIT(key);
+			applyOffset += keyLength;
+
+			union sshs_node_attr_value value;
+			memset(&value, 0, sizeof(value));
+
+			if (type == SSHS_STRING) {
+				uint32_t stringLength;
+				memcpy(&stringLength, data + applyOffset, 4);
+				applyOffset += 4;
+
+				value.string = strndup((const char *) (data + applyOffset), stringLength);
+				SSHS_MALLOC_CHECK_EXIT(value.string);
+				applyOffset += stringLength;
+			}
+			else if (type == SSHS_BOOL) {
+				value.boolean = (data[applyOffset] != 0);
+				applyOffset += 1;
+			}
+			else {
+				size_t valueSize = sshsNodeBinaryValueSize(type);
+				memcpy(&value, data + applyOffset, valueSize);
+				applyOffset += valueSize;
+			}
+
+			if (!sshsNodeLoadAttribute(recordNode, key, type, value, "Snapshot loaded value.")) {
+				// Ignore read-only/range errors.
+				if (errno != EPERM && errno != ERANGE) {
+					char errorMsg[1024];
+					snprintf(errorMsg, 1024, "Failed to load attribute '%s' of type '%s' from binary snapshot.", key,
+						sshsHelperTypeToStringConverter(type));
+
+					(*sshsGetGlobalErrorLogCallback())(errorMsg);
+				}
+			}
+
+			free(key);
+
+			if (type == SSHS_STRING) {
+				free(value.string);
+			}
+		}
+	}
+
+#undef SSHS_BINARY_NEED
+
+	return (true);
+
+truncated:
+	(*sshsGetGlobalErrorLogCallback())("Truncated record at end of binary snapshot, ignored.");
+	return (true);
+}
+
 // For more precise failure reason, look at errno.
 bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const char *typeStr, const char *valueStr) {
 	// Parse the values according to type and put them in the node.
@@ -1436,11 +2347,23 @@ bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const ch
 		return (false);
 	}
 
+	bool result = sshsNodeLoadAttribute(node, key, type, value, "XML loaded value.");
+
+	// Free string copy from helper.
+	if (type == SSHS_STRING) {
+		free(value.string);
+	}
+
+	return (result);
+}
+
+static bool sshsNodeLoadAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value, const char *description) {
 	// IFF attribute already exists, we update it using sshsNodePut(), else
 	// we create the attribute with maximum range and a default description.
-	// These XMl-loaded attributes are also marked NO_EXPORT.
-	// This happens on XML load only. More restrictive ranges and flags can be
-	// enabled later by calling sshsNodeCreate*() again as needed.
+	// These loaded attributes are also marked NO_EXPORT.
+	// This happens on XML or binary snapshot load only. More restrictive ranges
+	// and flags can be enabled later by calling sshsNodeCreate*() again as needed.
 	bool result = false;
 
 	if (sshsNodeAttributeExists(node, key, type)) {
@@ -1453,42 +2376,42 @@ bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const ch
 		switch (type) {
 			case SSHS_BOOL:
 				sshsNodeCreateBool(node, key, value.boolean, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
-					"XML loaded value.");
+					description);
 				break;
 
 			case SSHS_BYTE:
 				sshsNodeCreateByte(node, key, value.ibyte, INT8_MIN, INT8_MAX, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
-					"XML loaded value.");
+					description);
 				break;
 
 			case SSHS_SHORT:
 				sshsNodeCreateShort(node, key, value.ishort, INT16_MIN, INT16_MAX,
-					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, description);
 				break;
 
 			case SSHS_INT:
 				sshsNodeCreateInt(node, key, value.iint, INT32_MIN, INT32_MAX, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
-					"XML loaded value.");
+					description);
 				break;
 
 			case SSHS_LONG:
 				sshsNodeCreateLong(node, key, value.ilong, INT64_MIN, INT64_MAX,
-					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, description);
 				break;
 
 			case SSHS_FLOAT:
 				sshsNodeCreateFloat(node, key, value.ffloat, -FLT_MAX, FLT_MAX,
-					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, description);
 				break;
 
 			case SSHS_DOUBLE:
 				sshsNodeCreateDouble(node, key, value.ddouble, -DBL_MAX, DBL_MAX,
-					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+					SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, description);
 				break;
 
 			case SSHS_STRING:
 				sshsNodeCreateString(node, key, value.string, 0, INT32_MAX, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
-					"XML loaded value.");
+					description);
 				break;
 
 			case SSHS_UNKNOWN:
@@ -1498,11 +2421,6 @@ bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const ch
 		}
 	}
 
-	// Free string copy from helper.
-	if (type == SSHS_STRING) {
-		free(value.string);
-	}
-
 	return (result);
 }
 
@@ -1597,6 +2515,56 @@ enum sshs_node_attr_value_type *sshsNodeGetAttributeTypes(sshsNode node, const c
 	return (attributeTypes);
 }
 
+struct sshs_node_attr_snapshot *sshsNodeGetAttributeSnapshot(sshsNode node, size_t *numAttributes) {
+	size_t attributeCount;
+	sshsNodeAttr *attributes = sshsNodeGetAttributes(node, &attributeCount);
+
+	if (attributes == NULL) {
+		mtx_unlock(&node->node_lock);
+
+		*numAttributes = 0;
+		errno = ENOENT;
+		return (NULL);
+	}
+
+	struct sshs_node_attr_snapshot *snapshot = malloc(attributeCount * sizeof(*snapshot));
+	SSHS_MALLOC_CHECK_EXIT(snapshot);
+
+	// Copy everything while still holding the lock, attributes may be removed right after.
+	for (size_t i = 0; i < attributeCount; i++) {
+		snapshot[i].key = strdup(attributes[i]->key);
+		SSHS_MALLOC_CHECK_EXIT(snapshot[i].key);
+
+		snapshot[i].type = attributes[i]->value_type;
+		snapshot[i].flags = attributes[i]->flags;
+		snapshot[i].value = attributes[i]->value;
+
+		if (snapshot[i].type == SSHS_STRING) {
+			snapshot[i].value.string = strdup(attributes[i]->value.string);
+			SSHS_MALLOC_CHECK_EXIT(snapshot[i].value.string);
+		}
+	}
+
+	mtx_unlock(&node->node_lock);
+
+	free(attributes);
+
+	*numAttributes = attributeCount;
+	return (snapshot);
+}
+
+void sshsNodeFreeAttributeSnapshot(struct sshs_node_attr_snapshot *attributes, size_t numAttributes) {
+	for (size_t i = 0; i < numAttributes; i++) {
+		free(attributes[i].key);
+
+		if (attributes[i].type == SSHS_STRING) {
+			free(attributes[i].value.string);
+		}
+	}
+
+	free(attributes);
+}
+
 struct sshs_node_attr_ranges sshsNodeGetAttributeRanges(sshsNode node, const char *key,
 	enum sshs_node_attr_value_type type) {
 	sshsNodeAttr attr = sshsNodeFindAttribute(node, key, type);
@@ -4,6 +4,7 @@
 #include "base/log.h"
 #include "base/mainloop.h"
 #include "base/misc.h"
+#include "base/trace.h"
 
 int main(int argc, char **argv) {
 	// Initialize config storage from file, support command-line overrides.
@@ -13,6 +14,9 @@ int main(int argc, char **argv) {
 	// Initialize logging sub-system.
 	caerLogInit();
 
+	// Initialize pipeline tracing (disabled by default).
+	caerTraceInit();
+
 	// Daemonize the application (run in background, NOT AVAILABLE ON WINDOWS).
 	// caerDaemonize();
 
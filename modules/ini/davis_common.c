@@ -268,29 +268,31 @@ static bool caerInputDAVISInit(caerModuleData moduleData) {
 	sshsNode deviceConfigNode = sshsGetRelativeNode(moduleData->moduleNode, chipIDToName(devInfo.chipID, true));
 
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	// Device configuration goes over USB and can be slow, so those listeners run
+	// asynchronously and don't hold up whoever changed the attribute (config server, GUI).
 	sshsNode chipNode = sshsGetRelativeNode(deviceConfigNode, "chip/");
-	sshsNodeAddAttributeListener(chipNode, moduleData, &chipConfigListener);
+	sshsNodeAddAttributeListenerAsync(chipNode, moduleData, &chipConfigListener);
 
 	sshsNode muxNode = sshsGetRelativeNode(deviceConfigNode, "multiplexer/");
-	sshsNodeAddAttributeListener(muxNode, moduleData, &muxConfigListener);
+	sshsNodeAddAttributeListenerAsync(muxNode, moduleData, &muxConfigListener);
 
 	sshsNode dvsNode = sshsGetRelativeNode(deviceConfigNode, "dvs/");
-	sshsNodeAddAttributeListener(dvsNode, moduleData, &dvsConfigListener);
+	sshsNodeAddAttributeListenerAsync(dvsNode, moduleData, &dvsConfigListener);
 
 	sshsNode apsNode = sshsGetRelativeNode(deviceConfigNode, "aps/");
-	sshsNodeAddAttributeListener(apsNode, moduleData, &apsConfigListener);
+	sshsNodeAddAttributeListenerAsync(apsNode, moduleData, &apsConfigListener);
 
 	sshsNode imuNode = sshsGetRelativeNode(deviceConfigNode, "imu/");
-	sshsNodeAddAttributeListener(imuNode, moduleData, &imuConfigListener);
+	sshsNodeAddAttributeListenerAsync(imuNode, moduleData, &imuConfigListener);
 
 	sshsNode extNode = sshsGetRelativeNode(deviceConfigNode, "externalInput/");
-	sshsNodeAddAttributeListener(extNode, moduleData, &extInputConfigListener);
+	sshsNodeAddAttributeListenerAsync(extNode, moduleData, &extInputConfigListener);
 
 	sshsNode usbNode = sshsGetRelativeNode(deviceConfigNode, "usb/");
-	sshsNodeAddAttributeListener(usbNode, moduleData, &usbConfigListener);
+	sshsNodeAddAttributeListenerAsync(usbNode, moduleData, &usbConfigListener);
 
 	sshsNode sysNode = sshsGetRelativeNode(moduleData->moduleNode, "system/");
-	sshsNodeAddAttributeListener(sysNode, moduleData, &systemConfigListener);
+	sshsNodeAddAttributeListenerAsync(sysNode, moduleData, &systemConfigListener);
 
 	sshsNode biasNode = sshsGetRelativeNode(deviceConfigNode, "bias/");
 
@@ -300,7 +302,7 @@ static bool caerInputDAVISInit(caerModuleData moduleData) {
 	if (biasNodes != NULL) {
 		for (size_t i = 0; i < biasNodesLength; i++) {
 			// Add listener for this particular bias.
-			sshsNodeAddAttributeListener(biasNodes[i], moduleData, &biasConfigListener);
+			sshsNodeAddAttributeListenerAsync(biasNodes[i], moduleData, &biasConfigListener);
 		}
 
 		free(biasNodes);
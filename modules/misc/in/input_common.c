@@ -1,8 +1,12 @@
 #include "input_common.h"
 #include "base/mainloop.h"
+#include "base/trace.h"
 #include "ext/portable_time.h"
 #include "ext/uthash/utlist.h"
 #include "ext/nets.h"
+#if !defined(OS_WINDOWS)
+#include "modules/misc/inout_shm.h"
+#endif
 
 #ifdef ENABLE_INOUT_PNG_COMPRESSION
 #include <png.h>
@@ -37,6 +41,7 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30);
 static void aedat30ChangeOrigin(inputCommonState state, caerEventPacketHeader packet);
 static bool decompressTimestampSerialize(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
 static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+static ssize_t readSharedMemory(inputCommonState state);
 static int inputReaderThread(void *stateArg);
 
 static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader newPacket, packetData newPacketData);
@@ -1193,6 +1198,35 @@ static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader
 	return (retVal);
 }
 
+// Like readUntilDone() for the shared memory ring: wait until some data is
+// available, or the writer is done (EOF). Also returns zero on shutdown.
+static ssize_t readSharedMemory(inputCommonState state) {
+#if defined(OS_WINDOWS)
+	// No shared memory input on Windows, sharedMemory is never set.
+	UNUSED_ARGUMENT(state);
+#else
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		bool writerDone;
+		size_t result = shmRingReaderGet(state->sharedMemory, state->dataBuffer->buffer,
+			state->dataBuffer->bufferSize, &writerDone);
+
+		if (result > 0) {
+			return ((ssize_t) result);
+		}
+
+		if (writerDone) {
+			break;
+		}
+
+		// Delay by 1 ms if no data, to avoid a wasteful busy loop.
+		struct timespec delaySleep = { .tv_sec = 0, .tv_nsec = 1000000 };
+		thrd_sleep(&delaySleep, NULL);
+	}
+#endif
+
+	return (0);
+}
+
 static int inputReaderThread(void *stateArg) {
 	inputCommonState state = stateArg;
 
@@ -1220,9 +1254,17 @@ static int inputReaderThread(void *stateArg) {
 			}
 		}
 
-		// Read data from disk or socket.
-		ssize_t result = readUntilDone(state->fileDescriptor, state->dataBuffer->buffer, state->dataBuffer->bufferSize);
+		// Read data from disk, socket or shared memory.
+		ssize_t result =
+			(state->sharedMemory != NULL) ?
+				(readSharedMemory(state)) :
+				(readUntilDone(state->fileDescriptor, state->dataBuffer->buffer, state->dataBuffer->bufferSize));
 		if (result <= 0) {
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				// Shutdown while waiting for shared memory data, not an EOF.
+				break;
+			}
+
 			// Error or EOF with no data. Let's just stop at this point.
 			close(state->fileDescriptor);
 			state->fileDescriptor = -1;
@@ -1580,12 +1622,24 @@ static void doPacketContainerCommit(inputCommonState state, caerEventPacketConta
 		return;
 	}
 
+	// Must be recorded before the container becomes visible to the mainloop,
+	// which could free it (and the address be reused) right after.
+	caerTraceFlowStart("InputContainer", packetContainer);
+
+	int32_t eventsNumber = caerEventPacketContainerGetEventsNumber(packetContainer);
+
+	// Count before the mainloop can get it, so depth never goes negative.
+	caerMetricsGaugeAdd(state->queueDepthMetric, 1);
+
 	retry: if (!caerRingBufferPut(state->transferRingPacketContainers, packetContainer)) {
 		if (force && atomic_load_explicit(&state->running, memory_order_relaxed)) {
 			// Retry forever if requested, at least while the module is running.
 			goto retry;
 		}
 
+		caerMetricsGaugeAdd(state->queueDepthMetric, -1);
+		caerMetricsCounterAdd(state->droppedMetric, 1);
+
 		caerEventPacketContainerFree(packetContainer);
 
 		caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
@@ -1596,6 +1650,8 @@ static void doPacketContainerCommit(inputCommonState state, caerEventPacketConta
 		atomic_fetch_add_explicit(&state->dataAvailableModule, 1, memory_order_release);
 		caerMainloopDataNotifyIncrease(NULL);
 
+		caerMetricsCounterAdd(state->eventsMetric, U64T(eventsNumber));
+
 		caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Submitted packet container successfully.");
 	}
 }
@@ -1827,6 +1883,15 @@ static int inputAssemblerThread(void *stateArg) {
 
 static const UT_icd ut_caerEventPacketHeader_icd = { sizeof(caerEventPacketHeader), NULL, NULL, NULL };
 
+static void inputCommonMetricsRelease(inputCommonState state) {
+	caerMetricsRelease(state->eventsMetric);
+	state->eventsMetric = NULL;
+	caerMetricsRelease(state->droppedMetric);
+	state->droppedMetric = NULL;
+	caerMetricsRelease(state->queueDepthMetric);
+	state->queueDepthMetric = NULL;
+}
+
 bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkStream,
 bool isNetworkMessageBased) {
 	inputCommonState state = moduleData->moduleState;
@@ -1912,6 +1977,14 @@ bool isNetworkMessageBased) {
 		atomic_load_explicit(&state->packetContainer.sizeSlice, memory_order_relaxed));
 	state->packetContainer.sizeLimitTimestamp = INT32_MAX;
 
+	// Metrics for monitoring, updated by the input handling threads.
+	state->eventsMetric = caerMetricsGetCounter("caer_input_events_total", "Events read and sent to the mainloop.",
+		moduleData->moduleSubSystemString);
+	state->droppedMetric = caerMetricsGetCounter("caer_input_dropped_containers_total",
+		"Packet containers dropped because the mainloop was too slow.", moduleData->moduleSubSystemString);
+	state->queueDepthMetric = caerMetricsGetGauge("caer_input_queue_depth",
+		"Packet containers waiting for the mainloop.", moduleData->moduleSubSystemString);
+
 	// Start input handling threads.
 	atomic_store(&state->running, true);
 
@@ -1919,6 +1992,7 @@ bool isNetworkMessageBased) {
 		caerRingBufferFree(state->transferRingPackets);
 		caerRingBufferFree(state->transferRingPacketContainers);
 		free(state->dataBuffer);
+		inputCommonMetricsRelease(state);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input assembler thread.");
 		return (false);
@@ -1928,6 +2002,7 @@ bool isNetworkMessageBased) {
 		caerRingBufferFree(state->transferRingPackets);
 		caerRingBufferFree(state->transferRingPacketContainers);
 		free(state->dataBuffer);
+		inputCommonMetricsRelease(state);
 
 		// Stop assembler thread (started just above) and wait on it.
 		atomic_store(&state->running, false);
@@ -2009,6 +2084,19 @@ void caerInputCommonExit(caerModuleData moduleData) {
 		close(state->fileDescriptor);
 	}
 
+#if !defined(OS_WINDOWS)
+	// Unmap shared memory ring.
+	if (state->sharedMemory != NULL) {
+		if (state->sharedMemory->overruns > 0) {
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Fell behind the shared memory writer %" PRIu64 " times, losing data.", state->sharedMemory->overruns);
+		}
+
+		shmRingReaderClose(state->sharedMemory);
+		free(state->sharedMemory);
+	}
+#endif
+
 	// Free allocated memory.
 	free(state->dataBuffer);
 
@@ -2023,6 +2111,8 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	free(state->packets.currPacketData);
 	free(state->packets.currPacket);
 
+	inputCommonMetricsRelease(state);
+
 	// Clear sourceInfo node.
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
 	sshsNodeRemoveAllAttributes(sourceInfoNode);
@@ -2041,11 +2131,15 @@ void caerInputCommonRun(caerModuleData moduleData, caerEventPacketContainer in,
 	*out = caerRingBufferGet(state->transferRingPacketContainers);
 
 	if (*out != NULL) {
+		caerTraceFlowEnd("InputContainer", *out);
+
 		// No special memory order for decrease, because the acquire load to even start running
 		// through a mainloop already synchronizes with the release store above.
 		caerMainloopDataNotifyDecrease(NULL);
 		atomic_fetch_sub_explicit(&state->dataAvailableModule, 1, memory_order_relaxed);
 
+		caerMetricsGaugeAdd(state->queueDepthMetric, -1);
+
 		sshsNodeUpdateReadOnlyAttribute(state->sourceInfoNode, "highestTimestamp", SSHS_LONG,
 			(union sshs_node_attr_value ) { .ilong = caerEventPacketContainerGetHighestEventTimestamp(*out) });
 
@@ -2,6 +2,7 @@
 #define INPUT_COMMON_H_
 
 #include "base/module.h"
+#include "base/metrics.h"
 #include "modules/misc/inout_common.h"
 #include "ext/buffers.h"
 #include "ext/uthash/utarray.h"
@@ -158,6 +159,10 @@ struct input_common_state {
 	struct input_common_packet_container_data packetContainer;
 	/// The file descriptor for reading.
 	int fileDescriptor;
+	/// Shared memory ring to read from instead of the file descriptor, if
+	/// not NULL. Set by the shared memory input module before init. Opaque
+	/// here, as it is POSIX only, see inout_shm.h; always NULL on Windows.
+	struct shm_ring_reader *sharedMemory;
 	/// Data buffer for reading from file descriptor (buffered I/O).
 	simpleBuffer dataBuffer;
 	/// Offset for current data buffer.
@@ -168,6 +173,12 @@ struct input_common_state {
 	caerModuleData parentModule;
 	/// Reference to sourceInfo node (to avoid getting it each time again).
 	sshsNode sourceInfoNode;
+	/// Events committed to the mainloop.
+	caerMetric eventsMetric;
+	/// Packet containers lost because the transfer ring-buffer was full.
+	caerMetric droppedMetric;
+	/// Packet containers waiting in the transfer ring-buffer.
+	caerMetric queueDepthMetric;
 };
 
 typedef struct input_common_state *inputCommonState;
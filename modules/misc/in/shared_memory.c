@@ -0,0 +1,65 @@
+#include "main.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "input_common.h"
+#include "modules/misc/inout_shm.h"
+
+static bool caerInputSharedMemoryInit(caerModuleData moduleData);
+
+static const struct caer_module_functions InputSharedMemoryFunctions = { .moduleInit = &caerInputSharedMemoryInit,
+	.moduleRun = &caerInputCommonRun, .moduleConfig = NULL, .moduleExit = &caerInputCommonExit };
+
+static const struct caer_event_stream_out InputSharedMemoryOutputs[] = { { .type = -1 } };
+
+static const struct caer_module_info InputSharedMemoryInfo = { .version = 1, .name = "SharedMemoryInput",
+	.description = "Read AEDAT data from a shared memory ring on the same host.", .type = CAER_MODULE_INPUT,
+	.memSize = sizeof(struct input_common_state), .functions = &InputSharedMemoryFunctions, .inputStreams = NULL,
+	.inputStreamsSize = 0, .outputStreams = InputSharedMemoryOutputs, .outputStreamsSize =
+		CAER_EVENT_STREAM_OUT_SIZE(InputSharedMemoryOutputs), };
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&InputSharedMemoryInfo);
+}
+
+static bool caerInputSharedMemoryInit(caerModuleData moduleData) {
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "shmName", "/caer", 2, SHM_RING_NAME_MAX - 1, SSHS_FLAGS_NORMAL,
+		"Shared memory object name for reading input data (must start with '/').");
+
+	inputCommonState state = moduleData->moduleState;
+
+	// Map an existing shared memory ring, created by the output module.
+	char *shmName = sshsNodeGetString(moduleData->moduleNode, "shmName");
+
+	shmRingReader reader = malloc(sizeof(*reader));
+	if (reader == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Failed to allocate shared memory ring reader.");
+		free(shmName);
+		return (false);
+	}
+
+	if (!shmRingReaderOpen(reader, shmName)) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not open shared memory ring '%s'. Error: %d.", shmName,
+		errno);
+		free(reader);
+		free(shmName);
+		return (false);
+	}
+
+	state->sharedMemory = reader;
+
+	if (!caerInputCommonInit(moduleData, -1, true, false)) {
+		shmRingReaderClose(reader);
+		free(reader);
+		state->sharedMemory = NULL;
+		free(shmName);
+		return (false);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Shared memory ring ready at '%s'.", shmName);
+
+	free(shmName);
+
+	return (true);
+}
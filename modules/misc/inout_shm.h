@@ -0,0 +1,443 @@
+#ifndef INPUT_OUTPUT_SHM_H_
+#define INPUT_OUTPUT_SHM_H_
+
+/*
+ * Shared memory ring for same-host AEDAT 3.X streams, one writer and any
+ * number of readers. The POSIX shared memory segment starts with a fixed
+ * SHM_RING_HEADER_SIZE bytes header (struct shm_ring_header), followed by
+ * the data area, which holds a sequence of records: a 64-bit native-endian
+ * size, followed by that many bytes of one serialized event packet, padded
+ * to a multiple of SHM_RING_ALIGN bytes. A size of SHM_RING_WRAP means the
+ * rest of the data area is unused and the next record starts at its start.
+ *
+ * Positions are byte counters that only ever increase; the offset into the
+ * data area is (position % dataSize). The writer never waits on readers:
+ * each reader keeps its own read position, and simply detects when the data
+ * it wanted has been overwritten, in which case it skips ahead to the most
+ * recent record. Before overwriting anything, the writer publishes the new
+ * reservePosition, so readers can validate a record after copying it out
+ * (like a sequence lock), and then publishes writePosition once the record
+ * is complete. No system calls are involved in passing packets around.
+ */
+
+#include "main.h"
+#include <libcaer/network.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHM_RING_MAGIC_NUMBER 0x314D485352454163ULL // "cAERSHM1" in little-endian.
+#define SHM_RING_VERSION 1
+#define SHM_RING_HEADER_SIZE 512
+#define SHM_RING_NAME_MAX 256
+#define SHM_RING_ALIGN 8
+#define SHM_RING_WRAP UINT64_MAX
+
+enum shm_ring_writer_state {
+	SHM_RING_WRITER_NOT_READY = 0, SHM_RING_WRITER_ACTIVE = 1, SHM_RING_WRITER_DONE = 2,
+};
+
+struct shm_ring_header {
+	/// Identifies a valid cAER shared memory ring, must be SHM_RING_MAGIC_NUMBER.
+	uint64_t magicNumber;
+	/// Layout version of the segment, must be SHM_RING_VERSION.
+	uint64_t version;
+	/// Size of the data area following the header, in bytes. Multiple of SHM_RING_ALIGN.
+	uint64_t dataSize;
+	/// Writer state (enum shm_ring_writer_state). The network header is valid once active.
+	atomic_uint_least64_t writerState;
+	/// All records before this position are complete. Always the start of a record.
+	atomic_uint_least64_t writePosition;
+	/// Data up to this position may currently be getting written, overwriting older records.
+	atomic_uint_least64_t reservePosition;
+	/// AEDAT 3.1 network header describing the stream. Sequence number is always zero.
+	struct aedat3_network_header networkHeader;
+	/// Name of the shared memory segment, so the writer can remove it again.
+	char name[SHM_RING_NAME_MAX];
+};
+
+typedef struct shm_ring_header *shmRing;
+
+struct shm_ring_reader {
+	/// Mapped shared memory ring (read-only).
+	shmRing ring;
+	/// Position of the next record to read.
+	uint64_t readPosition;
+	/// The network header was already returned, follow with event packets.
+	bool headerRead;
+	/// Number of times the writer overran this reader, losing data.
+	uint64_t overruns;
+	/// Holds a record bigger than the reader's buffer, while it gets handed out in parts.
+	uint8_t *stagingBuffer;
+	/// Allocated size of stagingBuffer.
+	size_t stagingBufferSize;
+	/// Size of the record in stagingBuffer.
+	size_t stagingUsedSize;
+	/// Part of the record in stagingBuffer already handed out.
+	size_t stagingPosition;
+};
+
+typedef struct shm_ring_reader *shmRingReader;
+
+static inline uint8_t *shmRingData(shmRing ring) {
+	return ((uint8_t *) ring + SHM_RING_HEADER_SIZE);
+}
+
+static inline uint64_t shmRingRecordSize(uint64_t dataSize) {
+	return (sizeof(uint64_t) + ((dataSize + (SHM_RING_ALIGN - 1)) & ~((uint64_t) SHM_RING_ALIGN - 1)));
+}
+
+/**
+ * Create a new shared memory ring, replacing any existing one with the same name.
+ * On failure, errno is set accordingly.
+ *
+ * @param name POSIX shared memory object name, like "/caer".
+ * @param dataSize size of the data area in bytes, rounded up to SHM_RING_ALIGN.
+ *
+ * @return mapped shared memory ring, NULL on failure.
+ */
+static inline shmRing shmRingCreate(const char *name, size_t dataSize) {
+	if (strlen(name) >= SHM_RING_NAME_MAX || dataSize < SHM_RING_ALIGN) {
+		errno = EINVAL;
+		return (NULL);
+	}
+
+	dataSize = (dataSize + (SHM_RING_ALIGN - 1)) & ~((size_t) SHM_RING_ALIGN - 1);
+
+	// Remove stale segments (writer crashed, or a previous run of this module).
+	// Readers still mapping it continue to see it, and will notice it is done.
+	shm_unlink(name);
+
+	int shmFd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP);
+	if (shmFd < 0) {
+		return (NULL);
+	}
+
+	if (ftruncate(shmFd, (off_t) (SHM_RING_HEADER_SIZE + dataSize)) != 0) {
+		int errnoSave = errno;
+		close(shmFd);
+		shm_unlink(name);
+		errno = errnoSave;
+		return (NULL);
+	}
+
+	void *mapping = mmap(NULL, SHM_RING_HEADER_SIZE + dataSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+
+	// The mapping stays valid after closing the file descriptor.
+	int errnoSave = errno;
+	close(shmFd);
+
+	if (mapping == MAP_FAILED) {
+		shm_unlink(name);
+		errno = errnoSave;
+		return (NULL);
+	}
+
+	// ftruncate() zeroes the new segment, so only set what differs.
+	shmRing ring = mapping;
+
+	ring->version = SHM_RING_VERSION;
+	ring->dataSize = dataSize;
+	strcpy(ring->name, name);
+
+	atomic_store(&ring->writerState, SHM_RING_WRITER_NOT_READY);
+	atomic_store(&ring->writePosition, 0);
+	atomic_store(&ring->reservePosition, 0);
+
+	// Magic number last, readers check it to see if the segment is ready.
+	atomic_thread_fence(memory_order_release);
+	ring->magicNumber = SHM_RING_MAGIC_NUMBER;
+
+	return (ring);
+}
+
+/**
+ * Mark the stream as done for all readers, unmap the shared memory
+ * ring and remove its name, so that no new readers can find it.
+ *
+ * @param ring shared memory ring created by shmRingCreate().
+ */
+static inline void shmRingDestroy(shmRing ring) {
+	if (ring == NULL) {
+		return;
+	}
+
+	atomic_store_explicit(&ring->writerState, SHM_RING_WRITER_DONE, memory_order_release);
+
+	char name[SHM_RING_NAME_MAX];
+	strcpy(name, ring->name);
+
+	munmap(ring, SHM_RING_HEADER_SIZE + ring->dataSize);
+
+	shm_unlink(name);
+}
+
+/**
+ * Publish the network header and allow readers to start reading the stream.
+ *
+ * @param ring shared memory ring created by shmRingCreate().
+ * @param networkHeader AEDAT 3.1 network header for this stream.
+ */
+static inline void shmRingStart(shmRing ring, const struct aedat3_network_header *networkHeader) {
+	memcpy(&ring->networkHeader, networkHeader, AEDAT3_NETWORK_HEADER_LENGTH);
+
+	atomic_store_explicit(&ring->writerState, SHM_RING_WRITER_ACTIVE, memory_order_release);
+}
+
+/**
+ * Copy one serialized event packet into the shared memory ring, possibly
+ * overwriting the oldest records. Never blocks, single writer only.
+ *
+ * @param ring shared memory ring created by shmRingCreate().
+ * @param data serialized event packet.
+ * @param dataSize size of the event packet in bytes.
+ *
+ * @return true on success, false if the packet can never fit into the ring.
+ */
+static inline bool shmRingPut(shmRing ring, const uint8_t *data, size_t dataSize) {
+	uint64_t recordSize = shmRingRecordSize(dataSize);
+	if (recordSize > ring->dataSize) {
+		return (false);
+	}
+
+	uint8_t *ringData = shmRingData(ring);
+	uint64_t position = atomic_load_explicit(&ring->writePosition, memory_order_relaxed);
+	uint64_t offset = position % ring->dataSize;
+
+	// Records are never split: if it doesn't fit until the end, mark the
+	// rest as unused, and start over at the beginning of the data area.
+	bool wrap = ((offset + recordSize) > ring->dataSize);
+	uint64_t recordPosition = (wrap) ? (position + (ring->dataSize - offset)) : (position);
+
+	// Announce what is going to be overwritten before touching any data.
+	atomic_store_explicit(&ring->reservePosition, recordPosition + recordSize, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	if (wrap) {
+		uint64_t wrapMarker = SHM_RING_WRAP;
+		memcpy(ringData + offset, &wrapMarker, sizeof(uint64_t));
+		offset = 0;
+	}
+
+	uint64_t recordDataSize = dataSize;
+	memcpy(ringData + offset, &recordDataSize, sizeof(uint64_t));
+	memcpy(ringData + offset + sizeof(uint64_t), data, dataSize);
+
+	// Record complete, make it visible to readers.
+	atomic_store_explicit(&ring->writePosition, recordPosition + recordSize, memory_order_release);
+
+	return (true);
+}
+
+/**
+ * Map an existing shared memory ring read-only and prepare to follow it,
+ * starting with the most recent data. On failure, errno is set accordingly.
+ *
+ * @param reader reader structure to initialize.
+ * @param name POSIX shared memory object name, like "/caer".
+ *
+ * @return true on success, false on failure.
+ */
+static inline bool shmRingReaderOpen(shmRingReader reader, const char *name) {
+	memset(reader, 0, sizeof(*reader));
+
+	int shmFd = shm_open(name, O_RDONLY, 0);
+	if (shmFd < 0) {
+		return (false);
+	}
+
+	struct stat shmStat;
+	if (fstat(shmFd, &shmStat) != 0) {
+		int errnoSave = errno;
+		close(shmFd);
+		errno = errnoSave;
+		return (false);
+	}
+
+	if (shmStat.st_size <= SHM_RING_HEADER_SIZE) {
+		close(shmFd);
+		errno = EINVAL;
+		return (false);
+	}
+
+	void *mapping = mmap(NULL, (size_t) shmStat.st_size, PROT_READ, MAP_SHARED, shmFd, 0);
+
+	int errnoSave = errno;
+	close(shmFd);
+
+	if (mapping == MAP_FAILED) {
+		errno = errnoSave;
+		return (false);
+	}
+
+	shmRing ring = mapping;
+
+	if (ring->magicNumber != SHM_RING_MAGIC_NUMBER || ring->version != SHM_RING_VERSION
+		|| (SHM_RING_HEADER_SIZE + ring->dataSize) != (uint64_t) shmStat.st_size) {
+		munmap(mapping, (size_t) shmStat.st_size);
+		errno = EINVAL;
+		return (false);
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+
+	reader->ring = ring;
+
+	return (true);
+}
+
+static inline void shmRingReaderClose(shmRingReader reader) {
+	if (reader->ring != NULL) {
+		munmap(reader->ring, SHM_RING_HEADER_SIZE + reader->ring->dataSize);
+		reader->ring = NULL;
+	}
+
+	free(reader->stagingBuffer);
+	reader->stagingBuffer = NULL;
+}
+
+/**
+ * Read the stream from the shared memory ring as an AEDAT 3.X network
+ * stream: first the network header, then whole event packets. Records
+ * that don't fit into the buffer at all are handed out over multiple
+ * calls. Never blocks, returns zero if no new data is available.
+ *
+ * @param reader reader opened with shmRingReaderOpen().
+ * @param buffer destination buffer.
+ * @param bufferSize size of the destination buffer, at least AEDAT3_NETWORK_HEADER_LENGTH.
+ * @param writerDone set to true if the writer is done and all data has been read.
+ *
+ * @return number of bytes copied into the buffer, zero if none.
+ */
+static inline size_t shmRingReaderGet(shmRingReader reader, uint8_t *buffer, size_t bufferSize, bool *writerDone) {
+	shmRing ring = reader->ring;
+	uint8_t *ringData = shmRingData(ring);
+	size_t copied = 0;
+
+	*writerDone = false;
+
+	// Continue handing out a record that didn't fit.
+	if (reader->stagingPosition < reader->stagingUsedSize) {
+		size_t stagingSize = reader->stagingUsedSize - reader->stagingPosition;
+		copied = (stagingSize > bufferSize) ? (bufferSize) : (stagingSize);
+
+		memcpy(buffer, reader->stagingBuffer + reader->stagingPosition, copied);
+		reader->stagingPosition += copied;
+
+		return (copied);
+	}
+
+	uint64_t writerState = atomic_load_explicit(&ring->writerState, memory_order_acquire);
+
+	if (!reader->headerRead) {
+		if (writerState == SHM_RING_WRITER_NOT_READY) {
+			return (0);
+		}
+
+		if (writerState == SHM_RING_WRITER_DONE) {
+			*writerDone = true;
+			return (0);
+		}
+
+		// Start following the stream from the most recent data.
+		memcpy(buffer, &ring->networkHeader, AEDAT3_NETWORK_HEADER_LENGTH);
+		copied = AEDAT3_NETWORK_HEADER_LENGTH;
+
+		reader->readPosition = atomic_load_explicit(&ring->writePosition, memory_order_acquire);
+		reader->headerRead = true;
+	}
+
+	while (copied < bufferSize) {
+		uint64_t writePosition = atomic_load_explicit(&ring->writePosition, memory_order_acquire);
+
+		if (reader->readPosition == writePosition) {
+			// All caught up. Writer state was loaded before writePosition,
+			// so if it was done then, there really is nothing more to come.
+			if (copied == 0 && writerState == SHM_RING_WRITER_DONE) {
+				*writerDone = true;
+			}
+
+			break;
+		}
+
+		if ((writePosition - reader->readPosition) > ring->dataSize) {
+			// Overrun by the writer, skip ahead to the most recent record.
+			reader->readPosition = writePosition;
+			reader->overruns++;
+			continue;
+		}
+
+		uint64_t offset = reader->readPosition % ring->dataSize;
+
+		uint64_t recordDataSize;
+		memcpy(&recordDataSize, ringData + offset, sizeof(uint64_t));
+
+		uint64_t recordSize = 0;
+		bool staged = false;
+
+		if (recordDataSize == SHM_RING_WRAP) {
+			recordSize = ring->dataSize - offset;
+		}
+		else if (recordDataSize <= (ring->dataSize - offset - sizeof(uint64_t))) {
+			recordSize = shmRingRecordSize(recordDataSize);
+
+			uint8_t *destination = buffer + copied;
+
+			if (recordDataSize > (bufferSize - copied)) {
+				if (copied != 0) {
+					// Hand out what we have first, the record is read next time.
+					break;
+				}
+
+				// Too big for the buffer altogether, stage it.
+				if (recordDataSize > reader->stagingBufferSize) {
+					uint8_t *newStagingBuffer = realloc(reader->stagingBuffer, recordDataSize);
+					if (newStagingBuffer == NULL) {
+						// Skip the record, same as losing it.
+						reader->readPosition += recordSize;
+						reader->overruns++;
+						continue;
+					}
+
+					reader->stagingBuffer = newStagingBuffer;
+					reader->stagingBufferSize = recordDataSize;
+				}
+
+				destination = reader->stagingBuffer;
+				staged = true;
+			}
+
+			memcpy(destination, ringData + offset + sizeof(uint64_t), recordDataSize);
+		}
+
+		// Validate what was just read: the writer must not have started
+		// overwriting it in the meantime. Invalid sizes mean that too.
+		atomic_thread_fence(memory_order_acquire);
+		uint64_t reservePosition = atomic_load_explicit(&ring->reservePosition, memory_order_relaxed);
+
+		if (recordSize == 0 || reservePosition > (reader->readPosition + ring->dataSize)) {
+			reader->readPosition = atomic_load_explicit(&ring->writePosition, memory_order_acquire);
+			reader->overruns++;
+			continue;
+		}
+
+		reader->readPosition += recordSize;
+
+		if (staged) {
+			reader->stagingUsedSize = recordDataSize;
+			reader->stagingPosition = 0;
+
+			return (shmRingReaderGet(reader, buffer, bufferSize, writerDone));
+		}
+
+		if (recordDataSize != SHM_RING_WRAP) {
+			copied += recordDataSize;
+		}
+	}
+
+	return (copied);
+}
+
+#endif /* INPUT_OUTPUT_SHM_H_ */
@@ -29,6 +29,7 @@ caerModuleInfo caerModuleGetInfo(void) {
 
 static char *getUserHomeDirectory(caerModuleData moduleData);
 static char *getFullFilePath(caerModuleData moduleData, const char *directory, const char *prefix);
+static char *getNextFilePath(caerModuleData moduleData);
 
 // Remember to free strings returned by this.
 static char *getUserHomeDirectory(caerModuleData moduleData) {
@@ -98,6 +99,18 @@ static char *getFullFilePath(caerModuleData moduleData, const char *directory, c
 	return (filePath);
 }
 
+// Called from the output thread on file rotation. Remember to free strings returned by this.
+static char *getNextFilePath(caerModuleData moduleData) {
+	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+	char *prefix = sshsNodeGetString(moduleData->moduleNode, "prefix");
+
+	char *filePath = getFullFilePath(moduleData, directory, prefix);
+	free(directory);
+	free(prefix);
+
+	return (filePath);
+}
+
 static bool caerOutputFileInit(caerModuleData moduleData) {
 	// First, always create all needed setting nodes, set their default values
 	// and add their listeners.
@@ -115,13 +128,7 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 		"Output data files name prefix.");
 
 	// Generate current file name and open it.
-	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
-	char *prefix = sshsNodeGetString(moduleData->moduleNode, "prefix");
-
-	char *filePath = getFullFilePath(moduleData, directory, prefix);
-	free(directory);
-	free(prefix);
-
+	char *filePath = getNextFilePath(moduleData);
 	if (filePath == NULL) {
 		// caerModuleLog() called inside getFullFilePath().
 		return (false);
@@ -137,10 +144,16 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 	}
 
 	caerModuleLog(moduleData, CAER_LOG_INFO, "Opened output file '%s' successfully for writing.", filePath);
-	free(filePath);
+
+	// Support rotating to new files, the current file path is kept for that.
+	outputCommonState state = moduleData->moduleState;
+
+	state->fileRotation.filePath = filePath;
+	state->fileRotation.nextFilePath = &getNextFilePath;
 
 	if (!caerOutputCommonInit(moduleData, fileFd, NULL)) {
 		close(fileFd);
+		free(filePath);
 
 		return (false);
 	}
@@ -68,9 +68,15 @@
 
 #include "output_common.h"
 #include "base/mainloop.h"
+#include "base/trace.h"
 #include "ext/portable_misc.h"
 #include "ext/buffers.h"
 #include "ext/nets.h"
+#include "ext/portable_time.h"
+#if !defined(OS_WINDOWS)
+#include "modules/misc/inout_shm.h"
+#endif
+#include <fcntl.h>
 
 #ifdef ENABLE_INOUT_PNG_COMPRESSION
 #include <png.h>
@@ -84,6 +90,112 @@
 
 static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+static bool fileRotationInit(outputCommonState state);
+static void fileRotationExit(outputCommonState state);
+
+/**
+ * Initialize the mutex and condition used for ringBufferWaitGet()
+ * and ringBufferNotify(). On failure, nothing needs to be destroyed.
+ *
+ * @param mutex mutex protecting the wait on the condition.
+ * @param cond condition signaled on new data.
+ *
+ * @return true on success, false on failure.
+ */
+static bool ringBufferNotifyInit(mtx_t *mutex, cnd_t *cond) {
+	if (mtx_init(mutex, mtx_plain) != thrd_success) {
+		return (false);
+	}
+
+	if (cnd_init(cond) != thrd_success) {
+		mtx_destroy(mutex);
+		return (false);
+	}
+
+	return (true);
+}
+
+/**
+ * Wake up all threads waiting in ringBufferWaitGet() on this condition.
+ * Call after putting new data on the ring-buffer, or after changing
+ * the flag the waiting threads check.
+ *
+ * @param mutex mutex protecting the wait on the condition.
+ * @param cond condition to signal.
+ */
+static inline void ringBufferNotify(mtx_t *mutex, cnd_t *cond) {
+	mtx_lock(mutex);
+	cnd_broadcast(cond);
+	mtx_unlock(mutex);
+}
+
+/**
+ * Get the next element from a ring-buffer. If it is empty, wait for
+ * a notification from ringBufferNotify(), for as long as waitWhile is true.
+ * The ring-buffer is re-checked with the mutex held, and notifications
+ * also take the mutex, so no wakeup can get lost in between.
+ *
+ * @param ring ring-buffer to get data from.
+ * @param mutex mutex protecting the wait on the condition.
+ * @param cond condition signaled on new data.
+ * @param waitWhile only wait for new data while this flag is true.
+ *
+ * @return the next element, or NULL if waitWhile is false and the ring-buffer is empty.
+ */
+static void *ringBufferWaitGet(caerRingBuffer ring, mtx_t *mutex, cnd_t *cond, atomic_bool *waitWhile) {
+	void *element = caerRingBufferGet(ring);
+	if (element != NULL) {
+		return (element);
+	}
+
+	mtx_lock(mutex);
+
+	while ((element = caerRingBufferGet(ring)) == NULL && atomic_load(waitWhile)) {
+		cnd_wait(cond, mutex);
+	}
+
+	mtx_unlock(mutex);
+
+	return (element);
+}
+
+/**
+ * Like ringBufferWaitGet(), but wait at most once, and only up to wakeUpTime
+ * if that is not NULL. NULL is then also returned after a timeout or any
+ * notification, so the caller can re-check its own conditions.
+ *
+ * @param ring ring-buffer to get data from.
+ * @param mutex mutex protecting the wait on the condition.
+ * @param cond condition signaled on new data.
+ * @param waitWhile only wait for new data while this flag is true.
+ * @param wakeUpTime stop waiting at this time (realtime clock), NULL to wait for a notification.
+ *
+ * @return the next element, or NULL if the ring-buffer is still empty.
+ */
+static void *ringBufferWaitGetOnce(caerRingBuffer ring, mtx_t *mutex, cnd_t *cond, atomic_bool *waitWhile,
+	const struct timespec *wakeUpTime) {
+	void *element = caerRingBufferGet(ring);
+	if (element != NULL) {
+		return (element);
+	}
+
+	mtx_lock(mutex);
+
+	if ((element = caerRingBufferGet(ring)) == NULL && atomic_load(waitWhile)) {
+		if (wakeUpTime != NULL) {
+			cnd_timedwait(cond, mutex, wakeUpTime);
+		}
+		else {
+			cnd_wait(cond, mutex);
+		}
+
+		element = caerRingBufferGet(ring);
+	}
+
+	mtx_unlock(mutex);
+
+	return (element);
+}
 
 /**
  * ============================================================================
@@ -136,10 +248,14 @@ void caerOutputCommonReset(caerModuleData moduleData, int16_t resetCallSourceID)
 		// Assign special packet to packet container.
 		caerEventPacketContainerSetEventPacket(tsResetContainer, SPECIAL_EVENT, (caerEventPacketHeader) tsResetPacket);
 
+		caerMetricsGaugeAdd(state->statistics.queueDepthMetric, 1);
+
 		while (!caerRingBufferPut(state->compressorRing, tsResetContainer)) {
 			; // Ensure this goes into the first ring-buffer.
 		}
 
+		ringBufferNotify(&state->compressorRingMutex, &state->compressorRingCond);
+
 		// Reset timestamp checking.
 		state->lastTimestamp = 0;
 	}
@@ -292,6 +408,11 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 	// to successfully copy.
 	caerEventPacketContainerSetEventPacketsNumber(eventPackets, (int32_t) idx);
 
+	caerTraceFlowStart("OutputContainer", eventPackets);
+
+	// Count before the compressor thread can get it, so depth never goes negative.
+	caerMetricsGaugeAdd(state->statistics.queueDepthMetric, 1);
+
 	retry: if (!caerRingBufferPut(state->compressorRing, eventPackets)) {
 		if (atomic_load_explicit(&state->keepPackets, memory_order_relaxed)) {
 			// Delay by 500 µs if no change, to avoid a wasteful busy loop.
@@ -302,11 +423,19 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 			goto retry;
 		}
 
+		caerMetricsGaugeAdd(state->statistics.queueDepthMetric, -1);
+		caerMetricsCounterAdd(state->statistics.droppedMetric, 1);
+
 		caerEventPacketContainerFree(eventPackets);
 
 		caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
 			"Failed to put packet's array copy on transfer ring-buffer: full.");
+
+		return;
 	}
+
+	// Wake up compressor thread, new data is available.
+	ringBufferNotify(&state->compressorRingMutex, &state->compressorRingCond);
 }
 
 /**
@@ -322,6 +451,9 @@ static int compressorThread(void *stateArg);
 static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer);
 static int packetsFirstTimestampThenTypeCmp(const void *a, const void *b);
 static void sendEventPacket(outputCommonState state, caerEventPacketHeader packet);
+static bool sendToOutputRing(outputCommonState state, libuvWriteBuf packetBuffer);
+static void checkFileRotation(outputCommonState state);
+static const struct timespec *fileRotationWakeUpTime(outputCommonState state, struct timespec *wakeUpTime);
 static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize);
 static size_t compressTimestampSerialize(outputCommonState state, caerEventPacketHeader packet);
 
@@ -340,17 +472,33 @@ static int compressorThread(void *stateArg) {
 	strcat(threadName, "[Compressor]");
 	thrd_set_name(threadName);
 
-	// If no data is available on the transfer ring-buffer, sleep for 1 ms.
-	// to avoid wasting resources in a busy loop.
-	struct timespec noDataSleep = { .tv_sec = 0, .tv_nsec = 1000000 };
+	// Get the newest event packet container from the transfer ring-buffer.
+	// If there is none, wait for the mainloop to signal new data, or until
+	// the current file segment is due to be rotated. On shutdown
+	// (running=false), this writes out all content remaining in the transfer
+	// ring-buffer, and only then stops.
+	while (true) {
+		struct timespec wakeUpTime;
+		caerEventPacketContainer currPacketContainer = ringBufferWaitGetOnce(state->compressorRing,
+			&state->compressorRingMutex, &state->compressorRingCond, &state->running,
+			fileRotationWakeUpTime(state, &wakeUpTime));
+
+		if (currPacketContainer == NULL && !atomic_load(&state->running)) {
+			// All data was put on the ring-buffer before running went false,
+			// so one more look finds anything still left.
+			currPacketContainer = caerRingBufferGet(state->compressorRing);
+			if (currPacketContainer == NULL) {
+				break;
+			}
+		}
 
-	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
-		// Get the newest event packet container from the transfer ring-buffer.
-		caerEventPacketContainer currPacketContainer = caerRingBufferGet(state->compressorRing);
 		if (currPacketContainer == NULL) {
-			// There is none, so we can't work on and commit this.
-			// We just sleep here a little and then try again, as we need the data!
-			thrd_sleep(&noDataSleep, NULL);
+			// Woken up without data, by the rotation timeout or a configuration
+			// change. Idle streams still get their file segments rotated on time.
+			if (state->fileRotation.nextFilePath != NULL) {
+				checkFileRotation(state);
+			}
+
 			continue;
 		}
 
@@ -358,15 +506,20 @@ static int compressorThread(void *stateArg) {
 		// timestamp decides its ordering with regards to other packets. Smaller
 		// comes first. If equal, order by increasing type ID as a convenience,
 		// not strictly required by specification!
+		caerTraceFlowEnd("OutputContainer", currPacketContainer);
+		caerMetricsGaugeAdd(state->statistics.queueDepthMetric, -1);
+
+		caerTraceBegin("Compress", caerEventPacketContainerGetEventPacketsNumber(currPacketContainer));
+
 		orderAndSendEventPackets(state, currPacketContainer);
-	}
 
-	// Handle shutdown, write out all content remaining in the transfer ring-buffer.
-	caerEventPacketContainer packetContainer;
-	while ((packetContainer = caerRingBufferGet(state->compressorRing)) != NULL) {
-		orderAndSendEventPackets(state, packetContainer);
+		caerTraceEnd("Compress", 0);
 	}
 
+	// No more data will be put on the output ring-buffer, let file output finish.
+	atomic_store(&state->compressorRunning, false);
+	ringBufferNotify(&state->outputRingMutex, &state->outputRingCond);
+
 	return (thrd_success);
 }
 
@@ -382,6 +535,11 @@ static void orderAndSendEventPackets(outputCommonState state, caerEventPacketCon
 		sendEventPacket(state, caerEventPacketContainerGetEventPacket(currPacketContainer, (int32_t) cpIdx));
 	}
 
+	// Packet container boundary, only place where a file can be rotated.
+	if (state->fileRotation.nextFilePath != NULL) {
+		checkFileRotation(state);
+	}
+
 	// Free packet container. The individual packets have already been either
 	// freed on error, or have been transferred out.
 	free(currPacketContainer);
@@ -436,6 +594,9 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
 
 	// Statistics support (after compression).
 	state->statistics.dataWritten += packetSize;
+	caerMetricsCounterAdd(state->statistics.packetsMetric, 1);
+	caerMetricsCounterAdd(state->statistics.dataWrittenMetric, packetSize);
+	state->fileRotation.segmentSize += packetSize;
 
 	// Send compressed packet out to output handling thread.
 	// Already format it as a libuv buffer.
@@ -449,18 +610,146 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
 
 	libuvWriteBufInitWithAnyBuffer(packetBuffer, packet, packetSize);
 
+	sendToOutputRing(state, packetBuffer);
+}
+
+static bool sendToOutputRing(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// Put packet buffer onto output ring-buffer. Retry until successful.
 	while (!caerRingBufferPut(state->outputRing, packetBuffer)) {
 		// If the output thread failed, we'd forever block here, if it can't accept
 		// any more data. So we detect that condition and discard remaining packets.
 		if (atomic_load_explicit(&state->outputThreadFailure, memory_order_relaxed)) {
-			break;
+			free(packetBuffer->freeBuf);
+			free(packetBuffer);
+
+			return (false);
 		}
 
 		// Delay by 500 µs if no change, to avoid a wasteful busy loop.
 		struct timespec retrySleep = { .tv_sec = 0, .tv_nsec = 500000 };
 		thrd_sleep(&retrySleep, NULL);
 	}
+
+	// Wake up output thread, new data is available.
+	if (state->isNetworkStream) {
+		uv_async_send(&state->networkIO->ringBufferGet);
+	}
+	else {
+		ringBufferNotify(&state->outputRingMutex, &state->outputRingCond);
+	}
+
+	return (true);
+}
+
+static void checkFileRotation(outputCommonState state) {
+	uint64_t maxSize = U64T(atomic_load_explicit(&state->fileRotation.maxSize, memory_order_relaxed));
+	uint32_t maxInterval = U32T(atomic_load_explicit(&state->fileRotation.maxInterval, memory_order_relaxed));
+
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	// The counters only start over once the output thread actually switched
+	// files: opening the new one can fail, then the current one continues.
+	uint32_t rotationState = U32T(atomic_load_explicit(&state->fileRotation.rotationState, memory_order_acquire));
+
+	if (rotationState == OUTPUT_ROTATION_PENDING) {
+		return;
+	}
+
+	if (rotationState == OUTPUT_ROTATION_DONE) {
+		// Data queued after the marker already went to the new file.
+		state->fileRotation.segmentSize -= state->fileRotation.segmentSizeAtRotation;
+		state->fileRotation.segmentStart = state->fileRotation.segmentStartAtRotation;
+	}
+	else if (rotationState == OUTPUT_ROTATION_FAILED) {
+		// Keep the size, so size-based rotation is retried with the next packet
+		// container, but only retry time-based rotation after another interval,
+		// instead of trying over and over on an idle stream.
+		state->fileRotation.segmentStart = state->fileRotation.segmentStartAtRotation;
+	}
+
+	atomic_store_explicit(&state->fileRotation.rotationState, OUTPUT_ROTATION_IDLE, memory_order_relaxed);
+
+	bool rotate = ((maxSize != 0) && (state->fileRotation.segmentSize >= maxSize));
+
+	if (!rotate && (maxInterval != 0)) {
+		rotate = ((currentTime.tv_sec - state->fileRotation.segmentStart.tv_sec) >= (time_t) maxInterval);
+	}
+
+	if (!rotate) {
+		return;
+	}
+
+	// Signal the output thread to switch to a new file, using an empty buffer
+	// as marker. It comes right after the last packet of the current packet
+	// container, so containers are never split across files.
+	libuvWriteBuf rotateMarker = calloc(1, sizeof(*rotateMarker));
+	if (rotateMarker == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for file rotation marker.");
+		return;
+	}
+
+	// Pending before sending, the output thread may handle the marker right away.
+	state->fileRotation.segmentSizeAtRotation = state->fileRotation.segmentSize;
+	state->fileRotation.segmentStartAtRotation = currentTime;
+	atomic_store_explicit(&state->fileRotation.rotationState, OUTPUT_ROTATION_PENDING, memory_order_relaxed);
+
+	if (!sendToOutputRing(state, rotateMarker)) {
+		atomic_store_explicit(&state->fileRotation.rotationState, OUTPUT_ROTATION_IDLE, memory_order_relaxed);
+	}
+}
+
+/**
+ * When the compressor thread has to wake up to rotate the current file
+ * segment by time, even if no new data arrives.
+ *
+ * @param state output module state.
+ * @param wakeUpTime filled with the wake up time, on the realtime clock.
+ *
+ * @return wakeUpTime, or NULL if there is no time-based rotation to wait for.
+ */
+static const struct timespec *fileRotationWakeUpTime(outputCommonState state, struct timespec *wakeUpTime) {
+	if (state->fileRotation.nextFilePath == NULL) {
+		return (NULL);
+	}
+
+	uint32_t maxInterval = U32T(atomic_load_explicit(&state->fileRotation.maxInterval, memory_order_relaxed));
+	if (maxInterval == 0) {
+		return (NULL);
+	}
+
+	// After a rotation request, the next segment starts when it was requested.
+	uint32_t rotationState = U32T(atomic_load_explicit(&state->fileRotation.rotationState, memory_order_relaxed));
+	const struct timespec *segmentStart =
+		(rotationState == OUTPUT_ROTATION_IDLE) ?
+			(&state->fileRotation.segmentStart) : (&state->fileRotation.segmentStartAtRotation);
+
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	int64_t waitNanos = ((I64T(segmentStart->tv_sec) + maxInterval - I64T(currentTime.tv_sec)) * 1000000000LL)
+		+ (segmentStart->tv_nsec - currentTime.tv_nsec);
+
+	// Don't spin while the output thread is still busy switching files.
+	if (rotationState == OUTPUT_ROTATION_PENDING && waitNanos < 1000000000LL) {
+		waitNanos = 1000000000LL;
+	}
+
+	if (waitNanos < 0) {
+		waitNanos = 0;
+	}
+
+	// Condition variables wait on the realtime clock.
+	portable_clock_gettime_realtime(wakeUpTime);
+
+	wakeUpTime->tv_sec += (time_t) (waitNanos / 1000000000LL);
+	wakeUpTime->tv_nsec += (long) (waitNanos % 1000000000LL);
+	if (wakeUpTime->tv_nsec >= 1000000000L) {
+		wakeUpTime->tv_sec++;
+		wakeUpTime->tv_nsec -= 1000000000L;
+	}
+
+	return (wakeUpTime);
 }
 
 /**
@@ -800,14 +1089,21 @@ static size_t compressFramePNG(outputCommonState state, caerEventPacketHeader pa
  * ============================================================================
  */
 static int outputThread(void *stateArg);
-static void libuvRingBufferGet(uv_idle_t *handle);
+static void libuvRingBufferGet(uv_async_t *handle);
 static void libuvAsyncShutdown(uv_async_t *handle);
 static void libuvClientShutdown(uv_shutdown_t *clientShutdown, int status);
 static void libuvWriteStatusCheck(uv_handle_t *handle, int status);
-static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer);
+static void logClientStatistics(enum caer_log_level logLevel, const char *subSystem, outputCommonNetIO streams,
+	size_t clientIndex);
+static void writePackets(outputCommonState state, libuvWriteBuf *packetBuffers, size_t packetBuffersSize);
+static void writePacketUDP(outputCommonState state, libuvWriteBuf packetBuffer);
 static void initializeNetworkHeader(outputCommonState state);
 static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, bool startOfUDPPacket);
+#if !defined(OS_WINDOWS)
+static void initializeSharedMemoryHeader(outputCommonState state);
+#endif
 static void writeFileHeader(outputCommonState state);
+static bool rotateFile(outputCommonState state);
 
 static inline _Noreturn void errorExit(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// Free currently held memory.
@@ -838,7 +1134,7 @@ static int outputThread(void *stateArg) {
 
 	bool headerSent = false;
 
-	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+	while (atomic_load_explicit(&state->compressorRunning, memory_order_relaxed)) {
 		// Wait for source to be defined.
 		int16_t sourceID = I16T(atomic_load_explicit(&state->sourceID, memory_order_relaxed));
 		if (sourceID == -1) {
@@ -853,6 +1149,11 @@ static int outputThread(void *stateArg) {
 		if (state->isNetworkStream) {
 			initializeNetworkHeader(state);
 		}
+#if !defined(OS_WINDOWS)
+		else if (state->sharedMemory != NULL) {
+			initializeSharedMemoryHeader(state);
+		}
+#endif
 		else {
 			writeFileHeader(state);
 		}
@@ -861,7 +1162,7 @@ static int outputThread(void *stateArg) {
 		break;
 	}
 
-	// If no header sent, it means we exited (running=false) without ever getting any
+	// If no header sent, it means we exited (compressorRunning=false) without ever getting any
 	// event packet with a source ID, so we don't have to process anything.
 	// But we make sure to empty the transfer ring-buffer, as something may have been
 	// put there in the meantime, so we ensure it's checked and freed. This because
@@ -889,36 +1190,48 @@ static int outputThread(void *stateArg) {
 			errorExit(state, NULL);
 		}
 	}
-	else {
-		// If no data is available on the transfer ring-buffer, sleep for 1 ms.
-		// to avoid wasting resources in a busy loop.
-		struct timespec noDataSleep = { .tv_sec = 0, .tv_nsec = 1000000 };
-
-		while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
-			libuvWriteBuf packetBuffer = caerRingBufferGet(state->outputRing);
-			if (packetBuffer == NULL) {
-				// There is none, so we can't work on and commit this.
-				// We just sleep here a little and then try again, as we need the data!
-				thrd_sleep(&noDataSleep, NULL);
-				continue;
-			}
-
-			// Write buffer to file descriptor.
-			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
-				errorExit(state, packetBuffer);
+#if !defined(OS_WINDOWS)
+	else if (state->sharedMemory != NULL) {
+		// Copy each buffer into the shared memory ring. Readers follow it on
+		// their own, so this never waits on any of them, no matter how many.
+		libuvWriteBuf packetBuffer;
+		while ((packetBuffer = ringBufferWaitGet(state->outputRing, &state->outputRingMutex, &state->outputRingCond,
+			&state->compressorRunning)) != NULL) {
+			if (!shmRingPut(state->sharedMemory, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
+				caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+					"Packet of %zu bytes is bigger than the shared memory ring, dropped it.", packetBuffer->buf.len);
 			}
 
 			free(packetBuffer->freeBuf);
 			free(packetBuffer);
 		}
-
-		// Write all remaining buffers to file.
+	}
+#endif
+	else {
+		// If no data is available on the transfer ring-buffer, wait for the
+		// compressor thread to signal new data. Once the compressor thread is
+		// done, this writes all remaining buffers to file, and then stops.
 		libuvWriteBuf packetBuffer;
-		while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
+		while ((packetBuffer = ringBufferWaitGet(state->outputRing, &state->outputRingMutex, &state->outputRingCond,
+			&state->compressorRunning)) != NULL) {
+			// Empty buffer: marker from compressor thread to switch to a new file.
+			if (packetBuffer->buf.base == NULL) {
+				free(packetBuffer);
+
+				atomic_store_explicit(&state->fileRotation.rotationState,
+					(rotateFile(state)) ? (OUTPUT_ROTATION_DONE) : (OUTPUT_ROTATION_FAILED), memory_order_release);
+				continue;
+			}
+
+			// Write buffer to file descriptor.
+			caerTraceBegin("FileWrite", (int64_t) packetBuffer->buf.len);
+
 			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
 				errorExit(state, packetBuffer);
 			}
 
+			caerTraceEnd("FileWrite", 0);
+
 			free(packetBuffer->freeBuf);
 			free(packetBuffer);
 		}
@@ -927,24 +1240,32 @@ static int outputThread(void *stateArg) {
 	return (thrd_success);
 }
 
-static void libuvRingBufferGet(uv_idle_t *handle) {
+static void libuvRingBufferGet(uv_async_t *handle) {
 	outputCommonState state = handle->data;
 
-	// Write all packets that are currently available out in order,
-	// but never more than 10 at a time.
-	size_t count = 0;
-	libuvWriteBuf packetBuffer;
-	while (count < MAX_OUTPUT_RINGBUFFER_GET && (packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-		writePacket(state, packetBuffer);
-		count++;
-	}
+	// Get all packets that are currently available, MAX_OUTPUT_RINGBUFFER_GET
+	// at a time, and write them out in order, each batch as one vectored write.
+	for (size_t batches = 0; batches < MAX_OUTPUT_RINGBUFFER_BATCHES; batches++) {
+		size_t count = 0;
+		libuvWriteBuf packetBuffers[MAX_OUTPUT_RINGBUFFER_GET];
+		while (count < MAX_OUTPUT_RINGBUFFER_GET
+			&& (packetBuffers[count] = caerRingBufferGet(state->outputRing)) != NULL) {
+			count++;
+		}
 
-	// If nothing, avoid busy loop within libuv event loop by sleeping a little.
-	if (count == 0) {
-		// Sleep for 1 ms.
-		struct timespec noDataSleep = { .tv_sec = 0, .tv_nsec = 1000000 };
-		thrd_sleep(&noDataSleep, NULL);
+		if (count > 0) {
+			writePackets(state, packetBuffers, count);
+		}
+
+		// Ring-buffer is empty, wait for next signal from compressor thread.
+		if (count < MAX_OUTPUT_RINGBUFFER_GET) {
+			return;
+		}
 	}
+
+	// More data may be available, but let the libuv event loop service
+	// other handles first, and then come back here.
+	uv_async_send(handle);
 }
 
 static void libuvAsyncShutdown(uv_async_t *handle) {
@@ -952,17 +1273,25 @@ static void libuvAsyncShutdown(uv_async_t *handle) {
 	outputCommonState state = handle->data;
 
 	// Shutdown, write remaining buffers to network.
-	// First we stop and close the idle handles checking for new data,
-	// then we manually schedule writes for the remaining data.
-	int retVal = uv_idle_stop(&state->networkIO->ringBufferGet);
-	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_stop",);
-
+	// First we close the async handle signaling new data (the compressor
+	// thread has already stopped), then we manually schedule writes for
+	// the remaining data.
 	uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 
 	// Then we empty the ring-buffer and write out all data.
-	libuvWriteBuf packetBuffer;
-	while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-		writePacket(state, packetBuffer);
+	size_t count = 0;
+	libuvWriteBuf packetBuffers[MAX_OUTPUT_RINGBUFFER_GET];
+	while ((packetBuffers[count] = caerRingBufferGet(state->outputRing)) != NULL) {
+		count++;
+
+		if (count == MAX_OUTPUT_RINGBUFFER_GET) {
+			writePackets(state, packetBuffers, count);
+			count = 0;
+		}
+	}
+
+	if (count > 0) {
+		writePackets(state, packetBuffers, count);
 	}
 
 	// Shutdown server (if it exists).
@@ -978,6 +1307,8 @@ static void libuvAsyncShutdown(uv_async_t *handle) {
 			continue;
 		}
 
+		logClientStatistics(CAER_LOG_INFO, state->parentModule->moduleSubSystemString, state->networkIO, i);
+
 		if (state->networkIO->isUDP) {
 			// UDP has no shutdown, just close.
 			uv_close((uv_handle_t *) client, &libuvCloseFree);
@@ -993,7 +1324,7 @@ static void libuvAsyncShutdown(uv_async_t *handle) {
 			continue;
 		}
 
-		retVal = uv_shutdown(clientShutdown, client, &libuvClientShutdown);
+		int retVal = uv_shutdown(clientShutdown, client, &libuvClientShutdown);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_shutdown",
 			free(clientShutdown); uv_close((uv_handle_t *) client, &libuvCloseFree));
 	}
@@ -1021,6 +1352,8 @@ static void libuvWriteStatusCheck(uv_handle_t *handle, int status) {
 
 		for (size_t i = 0; i < streams->clientsSize; i++) {
 			if ((uv_handle_t *) streams->clients[i] == handle) {
+				logClientStatistics(CAER_LOG_INFO, __func__, streams, i);
+
 				streams->clients[i] = NULL;
 				streams->activeClients--;
 
@@ -1033,11 +1366,25 @@ static void libuvWriteStatusCheck(uv_handle_t *handle, int status) {
 	}
 }
 
-static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
+static void logClientStatistics(enum caer_log_level logLevel, const char *subSystem, outputCommonNetIO streams,
+	size_t clientIndex) {
+	struct output_common_client *clientInfo = &streams->clientsInfo[clientIndex];
+
+	caerLog(logLevel, subSystem,
+		"Client %zu statistics: wrote %" PRIu64 " packets, dropped %" PRIu64 " packets (%" PRIu64 " bytes) due to full write queue.",
+		clientIndex, clientInfo->packetsWritten, clientInfo->packetsDropped, clientInfo->bytesDropped);
+}
+
+static void writePackets(outputCommonState state, libuvWriteBuf *packetBuffers, size_t packetBuffersSize) {
+	// Network writes complete asynchronously, only record when they're queued.
+	caerTraceInstant("NetworkWrite", (int64_t) packetBuffersSize);
+
 	// If no active clients exist, don't write anything.
 	if (state->networkIO->activeClients == 0) {
-		free(packetBuffer->freeBuf);
-		free(packetBuffer);
+		for (size_t i = 0; i < packetBuffersSize; i++) {
+			free(packetBuffers[i]->freeBuf);
+			free(packetBuffers[i]);
+		}
 
 		return;
 	}
@@ -1050,86 +1397,44 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// the packets up into manageable sizes (<=64K), together with keeping track
 	// of the sequence number.
 	if (state->networkIO->isUDP) {
-		// UDP output.
-		// If too much data waiting to be sent, just skip current packet.
-		if (((uv_udp_t *) state->networkIO->clients[0])->send_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
-			goto freePacketBufferUDP;
-		}
-
-		size_t packetSize = packetBuffer->buf.len;
-		size_t packetIndex = 0;
-		bool firstChunk = true;
-
-		// Split packets up into chunks for UDP. Send each chunk with its own
-		// header and increasing sequence number. The very first packet of a chunk is
-		// identifiable by having a negative sequence number (highest bit set to one).
-		while (packetSize > 0) {
-			libuvWriteMultiBuf buffers = libuvWriteBufAlloc(2); // One for network header, one for data.
-			if (buffers == NULL) {
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
-
-				goto freePacketBufferUDP;
-			}
-
-			buffers->statusCheck = &libuvWriteStatusCheck;
-
-			// Write header into first buffer.
-			if (!writeNetworkHeader(state->networkIO, &buffers->buffers[0], firstChunk)) {
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to write network header.");
-
-				libuvWriteBufFree(buffers);
-				goto freePacketBufferUDP;
-			}
-
-			firstChunk = false;
-
-			// Write data into second buffer.
-			size_t sendSize = (packetSize > AEDAT3_MAX_UDP_SIZE) ? (AEDAT3_MAX_UDP_SIZE) : (packetSize);
-
-			libuvWriteBufInit(&buffers->buffers[1], sendSize);
-			if (buffers->buffers[1].buf.base == NULL) {
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for data buffer.");
-
-				libuvWriteBufFree(buffers);
-				goto freePacketBufferUDP;
-			}
-
-			memcpy(buffers->buffers[1].buf.base, packetBuffer->buf.base + packetIndex, sendSize);
-
-			// For UDP we only support client mode to ONE outside address.
-			int retVal = libuvWriteUDP((uv_udp_t *) state->networkIO->clients[0], state->networkIO->address, buffers);
-			UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWriteUDP",
-				libuvWriteBufFree(buffers); goto freePacketBufferUDP);
-
-			// Update loop indexes.
-			packetSize -= sendSize;
-			packetIndex += sendSize;
-		}
-
-		// Free all packet memory.
-		freePacketBufferUDP: {
-			free(packetBuffer->freeBuf);
-			free(packetBuffer);
+		// UDP output. Datagrams can't be merged across packets, since each
+		// one has its own header, so go through the packets one by one.
+		for (size_t i = 0; i < packetBuffersSize; i++) {
+			writePacketUDP(state, packetBuffers[i]);
 		}
 	}
 	else {
 		// TCP/Pipe outputs.
-		// Prepare buffers, increase reference count.
-		libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
+		// Coalesce all packets into one vectored write, so that each client
+		// only needs one write request (and one writev() call) per batch.
+		libuvWriteMultiBuf buffers = libuvWriteBufAlloc(packetBuffersSize);
 		if (buffers == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
 
-			free(packetBuffer->freeBuf);
-			free(packetBuffer);
+			for (size_t i = 0; i < packetBuffersSize; i++) {
+				free(packetBuffers[i]->freeBuf);
+				free(packetBuffers[i]);
+			}
+
 			return;
 		}
 
 		buffers->statusCheck = &libuvWriteStatusCheck;
 
+		// Increase reference count.
 		buffers->refCount = state->networkIO->activeClients;
 
-		buffers->buffers[0] = *packetBuffer;
-		free(packetBuffer);
+		// Take over packet memory, freed together with the write buffers.
+		size_t buffersBytes = 0;
+
+		for (size_t i = 0; i < packetBuffersSize; i++) {
+			buffers->buffers[i] = *packetBuffers[i];
+			buffersBytes += packetBuffers[i]->buf.len;
+			free(packetBuffers[i]);
+		}
+
+		int32_t slowClientDecimation = I32T(
+			atomic_load_explicit(&state->slowClientDecimation, memory_order_relaxed));
 
 		// Write to each client, but use common reference-counted buffer.
 		for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
@@ -1139,18 +1444,110 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 				continue;
 			}
 
-			// If too much data waiting to be sent, just skip current packet.
-			if (client->write_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
+			struct output_common_client *clientInfo = &state->networkIO->clientsInfo[i];
+
+			// If too much data waiting to be sent, skip current packets, but only
+			// for this client. Each client has its own write queue, so that one
+			// slow client can't hold back the others.
+			bool skipClient = (client->write_queue_size > MAX_OUTPUT_QUEUED_SIZE);
+
+			// Slow clients can be further limited to only every Nth batch of packets,
+			// to give them a chance to catch up, instead of hitting the limit above.
+			if (!skipClient && slowClientDecimation > 1 && client->write_queue_size > (MAX_OUTPUT_QUEUED_SIZE / 2)) {
+				skipClient = ((clientInfo->decimationCounter++ % (size_t) slowClientDecimation) != 0);
+			}
+
+			if (skipClient) {
+				clientInfo->packetsDropped += packetBuffersSize;
+				clientInfo->bytesDropped += buffersBytes;
+
 				libuvWriteBufFree(buffers);
-				return;
+				continue;
 			}
 
 			int retVal = libuvWrite(client, buffers);
-			UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWrite", libuvWriteBufFree(buffers));
+			UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWrite", libuvWriteBufFree(buffers);
+				clientInfo->packetsDropped += packetBuffersSize; clientInfo->bytesDropped += buffersBytes; continue);
+
+			clientInfo->packetsWritten += packetBuffersSize;
 		}
 	}
 }
 
+static void writePacketUDP(outputCommonState state, libuvWriteBuf packetBuffer) {
+	// If too much data waiting to be sent, just skip current packet.
+	if (((uv_udp_t *) state->networkIO->clients[0])->send_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
+		state->networkIO->clientsInfo[0].packetsDropped++;
+		state->networkIO->clientsInfo[0].bytesDropped += packetBuffer->buf.len;
+
+		goto freePacketBufferUDP;
+	}
+
+	// Split packets up into chunks for UDP. Send each chunk with its own
+	// header and increasing sequence number. The very first packet of a chunk is
+	// identifiable by having a negative sequence number (highest bit set to one).
+	// All chunks share one buffer set: two buffers per datagram, one for the
+	// network header and one pointing directly into the packet memory, so no
+	// copy of the data is needed.
+	size_t chunksNumber = (packetBuffer->buf.len + AEDAT3_MAX_UDP_SIZE - 1) / AEDAT3_MAX_UDP_SIZE;
+
+	libuvWriteMultiBuf buffers = libuvWriteBufAlloc(2 * chunksNumber);
+	if (buffers == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
+
+		goto freePacketBufferUDP;
+	}
+
+	buffers->statusCheck = &libuvWriteStatusCheck;
+
+	size_t packetSize = packetBuffer->buf.len;
+	size_t packetIndex = 0;
+
+	for (size_t i = 0; i < chunksNumber; i++) {
+		// Write header into first buffer.
+		if (!writeNetworkHeader(state->networkIO, &buffers->buffers[2 * i], (i == 0))) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to write network header.");
+
+			libuvWriteBufFree(buffers);
+			goto freePacketBufferUDP;
+		}
+
+		// Point second buffer to data. Only the first data buffer owns the
+		// packet memory, so that it is freed exactly once.
+		size_t sendSize = (packetSize > AEDAT3_MAX_UDP_SIZE) ? (AEDAT3_MAX_UDP_SIZE) : (packetSize);
+
+		buffers->buffers[(2 * i) + 1].buf.base = packetBuffer->buf.base + packetIndex;
+		buffers->buffers[(2 * i) + 1].buf.len = sendSize;
+		buffers->buffers[(2 * i) + 1].freeBuf = NULL;
+
+		// Update loop indexes.
+		packetSize -= sendSize;
+		packetIndex += sendSize;
+	}
+
+	// Buffers now own the packet memory.
+	buffers->buffers[1].freeBuf = packetBuffer->freeBuf;
+	free(packetBuffer);
+
+	// For UDP we only support client mode to ONE outside address.
+	// All datagrams are queued in one go, libuv then flushes them
+	// together once the socket becomes writable.
+	int retVal = libuvWriteUDPMessages((uv_udp_t *) state->networkIO->clients[0], state->networkIO->address,
+		buffers, 2);
+	UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWriteUDPMessages",
+		state->networkIO->clientsInfo[0].packetsDropped++; return);
+
+	state->networkIO->clientsInfo[0].packetsWritten++;
+
+	return;
+
+	// Free all packet memory.
+	freePacketBufferUDP: {
+		free(packetBuffer->freeBuf);
+		free(packetBuffer);
+	}
+}
+
 static void initializeNetworkHeader(outputCommonState state) {
 	// Generate AEDAT 3.1 header for network streams (20 bytes total).
 	state->networkIO->networkHeader.magicNumber = htole64(AEDAT3_NETWORK_MAGIC_NUMBER);
@@ -1193,6 +1590,22 @@ static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, boo
 	return (true);
 }
 
+#if !defined(OS_WINDOWS)
+static void initializeSharedMemoryHeader(outputCommonState state) {
+	// Shared memory readers get the same stream as network clients, starting
+	// with the AEDAT 3.1 network header (20 bytes total, never changes).
+	struct aedat3_network_header networkHeader;
+
+	networkHeader.magicNumber = htole64(AEDAT3_NETWORK_MAGIC_NUMBER);
+	networkHeader.sequenceNumber = htole64(0);
+	networkHeader.versionNumber = AEDAT3_NETWORK_VERSION;
+	networkHeader.formatNumber = state->formatID; // Send numeric format ID.
+	networkHeader.sourceID = htole16(I16T(atomic_load(&state->sourceID))); // Always one source per output module.
+
+	shmRingStart(state->sharedMemory, &networkHeader);
+}
+#endif
+
 static void writeFileHeader(outputCommonState state) {
 	// Write AEDAT 3.1 header.
 	writeUntilDone(state->fileIO, (const uint8_t *) "#!AER-DAT" AEDAT3_FILE_VERSION "\r\n",
@@ -1259,6 +1672,64 @@ static void writeFileHeader(outputCommonState state) {
 	writeUntilDone(state->fileIO, (const uint8_t *) "#!END-HEADER\r\n", 14);
 }
 
+static bool rotateFile(outputCommonState state) {
+	char *filePath = (*state->fileRotation.nextFilePath)(state->parentModule);
+	if (filePath == NULL) {
+		// caerModuleLog() called inside nextFilePath().
+		return (false);
+	}
+
+	// Never overwrite an existing file, this can happen when rotating more
+	// often than the file name resolution allows. Just retry next time.
+	int fileFd = open(filePath, O_WRONLY | O_CREAT | O_EXCL, S_IWUSR | S_IRUSR | S_IRGRP);
+	if (fileFd < 0) {
+		caerModuleLog(state->parentModule, (errno == EEXIST) ? (CAER_LOG_DEBUG) : (CAER_LOG_ERROR),
+			"Could not create new output file '%s' for writing, continuing with current file. Error: %d.", filePath,
+			errno);
+		free(filePath);
+
+		return (false);
+	}
+
+	// Hand off old file to the closer thread, so that it can be synced and
+	// closed without stalling this thread.
+	struct output_common_file_segment *oldSegment = malloc(sizeof(*oldSegment));
+	if (oldSegment == NULL) {
+		close(fileFd);
+		unlink(filePath);
+		free(filePath);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for file segment.");
+		return (false);
+	}
+
+	oldSegment->fileDescriptor = state->fileIO;
+	oldSegment->filePath = state->fileRotation.filePath;
+
+	if (!caerRingBufferPut(state->fileRotation.closeRing, oldSegment)) {
+		// Closer thread is too far behind, don't wait on it, continue with current file.
+		close(fileFd);
+		unlink(filePath);
+		free(filePath);
+		free(oldSegment);
+
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Too many output files waiting to be closed, continuing with current file.");
+		return (false);
+	}
+
+	ringBufferNotify(&state->fileRotation.closeRingMutex, &state->fileRotation.closeRingCond);
+
+	state->fileIO = fileFd;
+	state->fileRotation.filePath = filePath;
+
+	writeFileHeader(state);
+
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Rotated to new output file '%s'.", filePath);
+
+	return (true);
+}
+
 void caerOutputCommonOnServerConnection(uv_stream_t *server, int status) {
 	outputCommonNetIO streams = server->data;
 
@@ -1319,10 +1790,12 @@ void caerOutputCommonOnServerConnection(uv_stream_t *server, int status) {
 			retVal = libuvWrite(client, buffers);
 			UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto killConnection);
 
-			// Ready now for more data, so set client field for writePacket().
+			// Ready now for more data, so set client field for writePackets().
 			streams->clients[i] = client;
 			streams->activeClients++;
 
+			memset(&streams->clientsInfo[i], 0, sizeof(struct output_common_client));
+
 			// TODO: add client IP to connected clients list.
 
 			return;
@@ -1360,22 +1833,37 @@ void caerOutputCommonOnClientConnection(uv_connect_t *connectionRequest, int sta
 	int retVal = libuvWrite(connectionRequest->handle, buffers);
 	UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto cleanupRequest);
 
-	// Ready now for more data, so set client field for writePacket().
+	// Ready now for more data, so set client field for writePackets().
 	streams->clients[0] = connectionRequest->handle;
 	streams->activeClients++;
 
+	memset(&streams->clientsInfo[0], 0, sizeof(struct output_common_client));
+
 	cleanupRequest: {
 		free(connectionRequest);
 	}
 }
 
+static void outputCommonMetricsRelease(outputCommonState state) {
+	caerMetricsRelease(state->statistics.packetsMetric);
+	state->statistics.packetsMetric = NULL;
+	caerMetricsRelease(state->statistics.dataWrittenMetric);
+	state->statistics.dataWrittenMetric = NULL;
+	caerMetricsRelease(state->statistics.droppedMetric);
+	state->statistics.droppedMetric = NULL;
+	caerMetricsRelease(state->statistics.queueDepthMetric);
+	state->statistics.queueDepthMetric = NULL;
+}
+
 bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputCommonNetIO streams) {
 	outputCommonState state = moduleData->moduleState;
 
 	state->parentModule = moduleData;
 
 	// Check for invalid input combinations.
-	if ((fileDescriptor < 0 && streams == NULL) || (fileDescriptor != -1 && streams != NULL)) {
+	if ((fileDescriptor < 0 && streams == NULL && state->sharedMemory == NULL)
+		|| (fileDescriptor != -1 && (streams != NULL || state->sharedMemory != NULL))
+		|| (streams != NULL && state->sharedMemory != NULL)) {
 		return (false);
 	}
 
@@ -1402,6 +1890,32 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 
 	atomic_store(&state->validOnly, sshsNodeGetBool(moduleData->moduleNode, "validOnly"));
 	atomic_store(&state->keepPackets, sshsNodeGetBool(moduleData->moduleNode, "keepPackets"));
+
+	// Stream-based network outputs keep a separate write queue per client.
+	if (state->isNetworkStream && !state->networkIO->isUDP) {
+		sshsNodeCreateInt(moduleData->moduleNode, "slowClientDecimation", 1, 1, 1000, SSHS_FLAGS_NORMAL,
+			"Only send every Nth batch of packets to clients whose write queue is more than half full (1 = disabled).");
+
+		atomic_store(&state->slowClientDecimation, sshsNodeGetInt(moduleData->moduleNode, "slowClientDecimation"));
+	}
+	else {
+		atomic_store(&state->slowClientDecimation, 1);
+	}
+
+	// File outputs that support it can be split into multiple files (segments).
+	if (!state->isNetworkStream && state->fileRotation.nextFilePath != NULL) {
+		sshsNodeCreateInt(moduleData->moduleNode, "rotateSize", 0, 0, 1024 * 1024, SSHS_FLAGS_NORMAL,
+			"Start a new file once the current one reaches this size in MB (0 = disabled).");
+		sshsNodeCreateInt(moduleData->moduleNode, "rotateInterval", 0, 0, 7 * 24 * 3600, SSHS_FLAGS_NORMAL,
+			"Start a new file once the current one is this many seconds old (0 = disabled).");
+		sshsNodeCreateInt(moduleData->moduleNode, "keepFiles", 0, 0, 100000, SSHS_FLAGS_NORMAL,
+			"Maximum number of files to keep on disk when rotating, including the current one. Older files are deleted (0 = keep all).");
+
+		atomic_store(&state->fileRotation.maxSize,
+			U64T(sshsNodeGetInt(moduleData->moduleNode, "rotateSize")) * 1024 * 1024);
+		atomic_store(&state->fileRotation.maxInterval, U32T(sshsNodeGetInt(moduleData->moduleNode, "rotateInterval")));
+		atomic_store(&state->fileRotation.keepFiles, U32T(sshsNodeGetInt(moduleData->moduleNode, "keepFiles")));
+	}
 	int ringSize = sshsNodeGetInt(moduleData->moduleNode, "ringBufferSize");
 
 	// Format configuration (compression modes).
@@ -1425,31 +1939,93 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 
 	// If network output, initialize common libuv components.
 	if (state->isNetworkStream) {
+		// Per-client queue statistics.
+		state->networkIO->clientsInfo = calloc(state->networkIO->clientsSize, sizeof(struct output_common_client));
+		if (state->networkIO->clientsInfo == NULL) {
+			caerRingBufferFree(state->compressorRing);
+			caerRingBufferFree(state->outputRing);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate per-client statistics.");
+			return (false);
+		}
+
 		// Add support for asynchronous shutdown (from caerOutputCommonExit()).
 		state->networkIO->shutdown.data = state;
 		int retVal = uv_async_init(&state->networkIO->loop, &state->networkIO->shutdown, &libuvAsyncShutdown);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_async_init",
-			caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+			free(state->networkIO->clientsInfo); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
 
-		// Use idle handles to check for new data on every loop run.
+		// Use async handle to get signaled of new data by the compressor thread.
 		state->networkIO->ringBufferGet.data = state;
-		retVal = uv_idle_init(&state->networkIO->loop, &state->networkIO->ringBufferGet);
-		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_init",
-			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+		retVal = uv_async_init(&state->networkIO->loop, &state->networkIO->ringBufferGet, &libuvRingBufferGet);
+		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_async_init",
+			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL); free(state->networkIO->clientsInfo); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+	}
+
+	// Initialize thread wakeup on new data.
+	bool notifyInitialized = ringBufferNotifyInit(&state->compressorRingMutex, &state->compressorRingCond);
+
+	if (notifyInitialized && !ringBufferNotifyInit(&state->outputRingMutex, &state->outputRingCond)) {
+		mtx_destroy(&state->compressorRingMutex);
+		cnd_destroy(&state->compressorRingCond);
+
+		notifyInitialized = false;
+	}
+
+	if (!notifyInitialized) {
+		if (state->isNetworkStream) {
+			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
+			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
+			free(state->networkIO->clientsInfo);
+		}
+		caerRingBufferFree(state->compressorRing);
+		caerRingBufferFree(state->outputRing);
 
-		retVal = uv_idle_start(&state->networkIO->ringBufferGet, &libuvRingBufferGet);
-		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_start",
-			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL); uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize thread synchronization.");
+		return (false);
+	}
+
+	// Start file closer thread for rotation support.
+	if (!state->isNetworkStream && state->fileRotation.nextFilePath != NULL && !fileRotationInit(state)) {
+		mtx_destroy(&state->compressorRingMutex);
+		cnd_destroy(&state->compressorRingCond);
+		mtx_destroy(&state->outputRingMutex);
+		cnd_destroy(&state->outputRingCond);
+
+		caerRingBufferFree(state->compressorRing);
+		caerRingBufferFree(state->outputRing);
+
+		// caerModuleLog() called inside fileRotationInit().
+		return (false);
 	}
 
+	// Metrics for monitoring, updated by the compressor thread.
+	state->statistics.packetsMetric = caerMetricsGetCounter("caer_output_packets_total",
+		"Event packets sent to output.", moduleData->moduleSubSystemString);
+	state->statistics.dataWrittenMetric = caerMetricsGetCounter("caer_output_bytes_total",
+		"Bytes sent to output, after compression.", moduleData->moduleSubSystemString);
+	state->statistics.droppedMetric = caerMetricsGetCounter("caer_output_dropped_containers_total",
+		"Packet containers dropped because the output was too slow.", moduleData->moduleSubSystemString);
+	state->statistics.queueDepthMetric = caerMetricsGetGauge("caer_output_queue_depth",
+		"Packet containers waiting for compression.", moduleData->moduleSubSystemString);
+
 	// Start output handling thread.
 	atomic_store(&state->running, true);
+	atomic_store(&state->compressorRunning, true);
 
 	if (thrd_create(&state->compressorThread, &compressorThread, state) != thrd_success) {
+		outputCommonMetricsRelease(state);
+		fileRotationExit(state);
+
+		mtx_destroy(&state->compressorRingMutex);
+		cnd_destroy(&state->compressorRingCond);
+		mtx_destroy(&state->outputRingMutex);
+		cnd_destroy(&state->outputRingCond);
+
 		if (state->isNetworkStream) {
-			uv_idle_stop(&state->networkIO->ringBufferGet);
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
+			free(state->networkIO->clientsInfo);
 		}
 		caerRingBufferFree(state->compressorRing);
 		caerRingBufferFree(state->outputRing);
@@ -1461,6 +2037,7 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 	if (thrd_create(&state->outputThread, &outputThread, state) != thrd_success) {
 		// Stop compressor thread (started just above) and wait on it.
 		atomic_store(&state->running, false);
+		ringBufferNotify(&state->compressorRingMutex, &state->compressorRingCond);
 
 		if ((errno = thrd_join(state->compressorThread, NULL)) != thrd_success) {
 			// This should never happen!
@@ -1468,10 +2045,18 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 			errno);
 		}
 
+		outputCommonMetricsRelease(state);
+		fileRotationExit(state);
+
+		mtx_destroy(&state->compressorRingMutex);
+		cnd_destroy(&state->compressorRingCond);
+		mtx_destroy(&state->outputRingMutex);
+		cnd_destroy(&state->outputRingCond);
+
 		if (state->isNetworkStream) {
-			uv_idle_stop(&state->networkIO->ringBufferGet);
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
+			free(state->networkIO->clientsInfo);
 		}
 		caerRingBufferFree(state->compressorRing);
 		caerRingBufferFree(state->outputRing);
@@ -1492,22 +2077,32 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 
 	outputCommonState state = moduleData->moduleState;
 
-	// Stop output thread and wait on it.
+	// Stop compressor thread and wait on it. It will first pass all remaining
+	// data on to the output thread, which is still running.
 	atomic_store(&state->running, false);
-	if (state->isNetworkStream) {
-		uv_async_send(&state->networkIO->shutdown);
-	}
+	ringBufferNotify(&state->compressorRingMutex, &state->compressorRingCond);
 
 	if ((errno = thrd_join(state->compressorThread, NULL)) != thrd_success) {
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join compressor thread. Error: %d.", errno);
 	}
 
+	// Stop output thread and wait on it. File output stops by itself once the
+	// compressor thread is done, network output needs to shut down libuv.
+	if (state->isNetworkStream) {
+		uv_async_send(&state->networkIO->shutdown);
+	}
+
 	if ((errno = thrd_join(state->outputThread, NULL)) != thrd_success) {
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join output thread. Error: %d.", errno);
 	}
 
+	mtx_destroy(&state->compressorRingMutex);
+	cnd_destroy(&state->compressorRingCond);
+	mtx_destroy(&state->outputRingMutex);
+	cnd_destroy(&state->outputRingCond);
+
 	// Now clean up the ring-buffers: they should be empty, so sanity check!
 	caerEventPacketContainer packetContainer;
 
@@ -1546,15 +2141,27 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_loop_close",);
 
 		// Free allocated memory. libuv already frees all client/server related memory.
+		free(state->networkIO->clientsInfo);
 		free(state->networkIO->address);
 		free(state->networkIO);
 	}
+#if !defined(OS_WINDOWS)
+	else if (state->sharedMemory != NULL) {
+		// Readers see the stream is done, and the segment goes away once they unmap it.
+		shmRingDestroy(state->sharedMemory);
+	}
+#endif
 	else {
 		// Ensure all data written to disk.
 		portable_fsync(state->fileIO);
 
 		// Close file descriptor.
 		close(state->fileIO);
+
+		// Wait for old files from rotation to be closed too.
+		fileRotationExit(state);
+
+		free(state->fileRotation.filePath);
 	}
 
 	free(state->sourceInfoString);
@@ -1566,6 +2173,8 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		state->statistics.packetsNumber, state->statistics.packetsTotalSize, state->statistics.packetsHeaderSize,
 		state->statistics.packetsDataSize, state->statistics.dataWritten,
 		(state->statistics.packetsTotalSize - state->statistics.dataWritten));
+
+	outputCommonMetricsRelease(state);
 }
 
 static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -1584,5 +2193,151 @@ static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum s
 			// Set keep packets flag to given value.
 			atomic_store(&state->keepPackets, changeValue.boolean);
 		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "slowClientDecimation")) {
+			// Set slow client decimation to given value.
+			atomic_store(&state->slowClientDecimation, changeValue.iint);
+		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "rotateSize")) {
+			// Set file rotation size (MB) to given value.
+			atomic_store(&state->fileRotation.maxSize, U64T(changeValue.iint) * 1024 * 1024);
+		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "rotateInterval")) {
+			// Set file rotation interval (seconds) to given value.
+			atomic_store(&state->fileRotation.maxInterval, U32T(changeValue.iint));
+
+			// The compressor thread may be waiting with the old interval, or none.
+			ringBufferNotify(&state->compressorRingMutex, &state->compressorRingCond);
+		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "keepFiles")) {
+			// Set maximum number of files to keep to given value.
+			atomic_store(&state->fileRotation.keepFiles, U32T(changeValue.iint));
+		}
+	}
+}
+
+/**
+ * ============================================================================
+ * FILE CLOSER THREAD
+ * ============================================================================
+ * Sync and close old file segments after rotation, and delete the oldest ones
+ * if only a limited number of files should be kept on disk.
+ * ============================================================================
+ */
+static int fileCloserThread(void *stateArg) {
+	outputCommonState state = stateArg;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 12]; // +1 for NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[FileCloser]");
+	thrd_set_name(threadName);
+
+	// Paths of closed files still on disk, oldest first.
+	char **keptPaths = NULL;
+	size_t keptPathsSize = 0;
+
+	struct output_common_file_segment *segment;
+	while ((segment = ringBufferWaitGet(state->fileRotation.closeRing, &state->fileRotation.closeRingMutex,
+		&state->fileRotation.closeRingCond, &state->fileRotation.closerRunning)) != NULL) {
+		// Ensure all data written to disk.
+		portable_fsync(segment->fileDescriptor);
+
+		// Close file descriptor.
+		close(segment->fileDescriptor);
+
+		char **newKeptPaths = realloc(keptPaths, (keptPathsSize + 1) * sizeof(char *));
+		if (newKeptPaths == NULL) {
+			// Just not tracked for deletion then.
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory to track closed file '%s'.",
+				segment->filePath);
+			free(segment->filePath);
+		}
+		else {
+			keptPaths = newKeptPaths;
+			keptPaths[keptPathsSize++] = segment->filePath;
+		}
+
+		free(segment);
+
+		// Delete oldest files, so that together with the one currently being
+		// written there are at most keepFiles on disk.
+		uint32_t keepFiles = U32T(atomic_load_explicit(&state->fileRotation.keepFiles, memory_order_relaxed));
+
+		while (keepFiles != 0 && keptPathsSize >= keepFiles) {
+			if (unlink(keptPaths[0]) == 0) {
+				caerModuleLog(state->parentModule, CAER_LOG_INFO, "Deleted old output file '%s'.", keptPaths[0]);
+			}
+			else {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to delete old output file '%s'. Error: %d.",
+					keptPaths[0], errno);
+			}
+
+			free(keptPaths[0]);
+
+			keptPathsSize--;
+			memmove(keptPaths, keptPaths + 1, keptPathsSize * sizeof(char *));
+		}
 	}
+
+	for (size_t i = 0; i < keptPathsSize; i++) {
+		free(keptPaths[i]);
+	}
+
+	free(keptPaths);
+
+	return (thrd_success);
+}
+
+static bool fileRotationInit(outputCommonState state) {
+	portable_clock_gettime_monotonic(&state->fileRotation.segmentStart);
+
+	state->fileRotation.closeRing = caerRingBufferInit(MAX_OUTPUT_FILE_CLOSE_QUEUE);
+	if (state->fileRotation.closeRing == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate file closer ring-buffer.");
+		return (false);
+	}
+
+	if (!ringBufferNotifyInit(&state->fileRotation.closeRingMutex, &state->fileRotation.closeRingCond)) {
+		caerRingBufferFree(state->fileRotation.closeRing);
+		state->fileRotation.closeRing = NULL;
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize file closer synchronization.");
+		return (false);
+	}
+
+	atomic_store(&state->fileRotation.closerRunning, true);
+
+	if (thrd_create(&state->fileRotation.closerThread, &fileCloserThread, state) != thrd_success) {
+		mtx_destroy(&state->fileRotation.closeRingMutex);
+		cnd_destroy(&state->fileRotation.closeRingCond);
+		caerRingBufferFree(state->fileRotation.closeRing);
+		state->fileRotation.closeRing = NULL;
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start file closer thread.");
+		return (false);
+	}
+
+	return (true);
+}
+
+static void fileRotationExit(outputCommonState state) {
+	// Rotation support was never initialized.
+	if (state->fileRotation.closeRing == NULL) {
+		return;
+	}
+
+	// Stop closer thread and wait on it. It closes all remaining old files first.
+	atomic_store(&state->fileRotation.closerRunning, false);
+	ringBufferNotify(&state->fileRotation.closeRingMutex, &state->fileRotation.closeRingCond);
+
+	if ((errno = thrd_join(state->fileRotation.closerThread, NULL)) != thrd_success) {
+		// This should never happen!
+		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join file closer thread. Error: %d.", errno);
+	}
+
+	mtx_destroy(&state->fileRotation.closeRingMutex);
+	cnd_destroy(&state->fileRotation.closeRingCond);
+	caerRingBufferFree(state->fileRotation.closeRing);
+	state->fileRotation.closeRing = NULL;
 }
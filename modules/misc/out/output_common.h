@@ -2,6 +2,7 @@
 #define OUTPUT_COMMON_H_
 
 #include "base/module.h"
+#include "base/metrics.h"
 #include "modules/misc/inout_common.h"
 #include "ext/libuv.h"
 #include <libcaer/ringbuffer.h>
@@ -10,9 +11,21 @@
 #include "ext/c11threads_posix.h"
 #endif
 
-#define MAX_OUTPUT_RINGBUFFER_GET 10
+#define MAX_OUTPUT_RINGBUFFER_GET 32 // Maximum number of packets coalesced into one write.
+#define MAX_OUTPUT_RINGBUFFER_BATCHES 16 // Maximum number of writes per output loop wakeup.
 #define MAX_OUTPUT_QUEUED_SIZE (1 * 1024 * 1024) // 1MB outstanding writes
 
+struct output_common_client {
+	/// Number of packets queued for writing to this client.
+	uint64_t packetsWritten;
+	/// Number of packets skipped for this client only, because its write queue was full.
+	uint64_t packetsDropped;
+	/// Size in bytes of the packets skipped for this client.
+	uint64_t bytesDropped;
+	/// Counts batches of packets while this client is slow, used for decimation.
+	size_t decimationCounter;
+};
+
 struct output_common_netio {
 	/// Keep the full network header around, so we can easily update and write it.
 	struct aedat3_network_header networkHeader;
@@ -22,9 +35,12 @@ struct output_common_netio {
 	void *address;
 	uv_loop_t loop;
 	uv_async_t shutdown;
-	uv_idle_t ringBufferGet;
+	/// Signaled by the compressor thread when new data is on the output ring-buffer.
+	uv_async_t ringBufferGet;
 	uv_stream_t *server;
 	size_t activeClients;
+	/// Per-client queue statistics, same size and index as clients.
+	struct output_common_client *clientsInfo;
 	size_t clientsSize;
 	uv_stream_t *clients[];
 };
@@ -37,6 +53,58 @@ struct output_common_statistics {
 	uint64_t packetsHeaderSize;
 	uint64_t packetsDataSize;
 	uint64_t dataWritten;
+	/// Exported for monitoring, updated as the above.
+	caerMetric packetsMetric;
+	caerMetric dataWrittenMetric;
+	/// Packet containers lost because the compressor ring-buffer was full.
+	caerMetric droppedMetric;
+	/// Packet containers waiting for the compressor thread.
+	caerMetric queueDepthMetric;
+};
+
+#define MAX_OUTPUT_FILE_CLOSE_QUEUE 32 // Old file segments waiting to be synced and closed.
+
+struct output_common_file_segment {
+	int fileDescriptor;
+	char *filePath;
+};
+
+enum output_common_rotation_state {
+	OUTPUT_ROTATION_IDLE = 0, OUTPUT_ROTATION_PENDING = 1, OUTPUT_ROTATION_DONE = 2, OUTPUT_ROTATION_FAILED = 3,
+};
+
+struct output_common_file_rotation {
+	/// Path of the file currently being written to. Owned by the output thread once running.
+	char *filePath;
+	/// Generate the path for the next file segment. Returned string must be freed.
+	/// NULL disables rotation support (set by the file output module before init).
+	char *(*nextFilePath)(caerModuleData moduleData);
+	/// Start a new file segment once the current one reaches this size in bytes (0 = disabled).
+	atomic_uint_fast64_t maxSize;
+	/// Start a new file segment once the current one is this many seconds old (0 = disabled).
+	atomic_uint_fast32_t maxInterval;
+	/// Maximum number of file segments to keep on disk, including the current one (0 = keep all).
+	atomic_uint_fast32_t keepFiles;
+	/// Size of the current file segment, tracked by the compressor thread.
+	uint64_t segmentSize;
+	/// Part of segmentSize queued before the pending rotation marker.
+	uint64_t segmentSizeAtRotation;
+	/// Start time of the current file segment, tracked by the compressor thread.
+	struct timespec segmentStart;
+	/// When the pending rotation marker was sent, start time of the next segment.
+	struct timespec segmentStartAtRotation;
+	/// Last rotation request (enum output_common_rotation_state): set to pending
+	/// by the compressor thread, the output thread then reports how it went.
+	atomic_uint_fast32_t rotationState;
+	/// Syncs and closes old file segments in the background, so that rotating
+	/// never stalls the output thread. Also deletes segments exceeding keepFiles.
+	thrd_t closerThread;
+	/// Control flag for closer thread.
+	atomic_bool closerRunning;
+	/// Transfer old file segments (struct output_common_file_segment) to the closer thread.
+	caerRingBuffer closeRing;
+	mtx_t closeRingMutex;
+	cnd_t closeRingCond;
 };
 
 struct output_common_state {
@@ -44,6 +112,9 @@ struct output_common_state {
 	atomic_bool running;
 	/// The compression handling thread (separate as to not hold up processing).
 	thrd_t compressorThread;
+	/// True while the compressor thread may still put data on the output ring-buffer.
+	/// The file output thread only stops after this goes false, so no data is lost.
+	atomic_bool compressorRunning;
 	/// The output handling thread (separate as to not hold up processing).
 	thrd_t outputThread;
 	/// Detect unrecoverable failure of output thread. Used so that the compressor
@@ -57,22 +128,38 @@ struct output_common_state {
 	char *sourceInfoString;
 	/// The file descriptor for file writing.
 	int fileIO;
+	/// Rotation of file output into multiple segments.
+	struct output_common_file_rotation fileRotation;
 	/// Network-like stream or file-like stream. Matters for header format.
 	bool isNetworkStream;
 	/// The libuv stream descriptors for network writing and server mode.
 	outputCommonNetIO networkIO;
+	/// Shared memory ring for same-host readers, instead of a file descriptor.
+	/// Set by the shared memory output module before init. Opaque here, as
+	/// it is POSIX only, see inout_shm.h; always NULL on Windows.
+	struct shm_ring_header *sharedMemory;
 	/// Filter out invalidated events or not.
 	atomic_bool validOnly;
 	/// Force all incoming packets to be committed to the transfer ring-buffer.
 	/// This results in no loss of data, but may slow down processing considerably.
 	/// It may also block it altogether, if the output goes away for any reason.
 	atomic_bool keepPackets;
+	/// Slow network clients, which have more than half of their maximum write queue
+	/// in use, only get every Nth batch of packets. One disables decimation.
+	atomic_int_fast32_t slowClientDecimation;
 	/// Transfer packets coming from a mainloop run to the compression handling thread.
 	/// We use EventPacketContainers as data structure for convenience, they do exactly
 	/// keep track of the data we do want to transfer and are part of libcaer.
 	caerRingBuffer compressorRing;
+	/// Wake up the compressor thread when new data is on its ring-buffer.
+	mtx_t compressorRingMutex;
+	cnd_t compressorRingCond;
 	/// Transfer buffers to output handling thread.
 	caerRingBuffer outputRing;
+	/// Wake up the file output thread when new data is on its ring-buffer.
+	/// Network outputs use the libuv ringBufferGet async handle instead.
+	mtx_t outputRingMutex;
+	cnd_t outputRingCond;
 	/// Track last packet container's highest event timestamp that was sent out.
 	int64_t lastTimestamp;
 	/// Support different formats, providing data compression.
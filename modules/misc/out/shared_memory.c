@@ -0,0 +1,62 @@
+#include "main.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "output_common.h"
+#include "modules/misc/inout_shm.h"
+
+static bool caerOutputSharedMemoryInit(caerModuleData moduleData);
+
+static const struct caer_module_functions OutputSharedMemoryFunctions = { .moduleInit =
+	&caerOutputSharedMemoryInit, .moduleRun = &caerOutputCommonRun, .moduleConfig = NULL, .moduleExit =
+	&caerOutputCommonExit, .moduleReset = &caerOutputCommonReset };
+
+static const struct caer_event_stream_in OutputSharedMemoryInputs[] =
+	{ { .type = -1, .number = -1, .readOnly = true } };
+
+static const struct caer_module_info OutputSharedMemoryInfo = { .version = 1, .name = "SharedMemoryOutput",
+	.description = "Send AEDAT 3 data out to readers on the same host, via a shared memory ring.", .type =
+		CAER_MODULE_OUTPUT, .memSize = sizeof(struct output_common_state), .functions = &OutputSharedMemoryFunctions,
+	.inputStreams = OutputSharedMemoryInputs, .inputStreamsSize = CAER_EVENT_STREAM_IN_SIZE(OutputSharedMemoryInputs),
+	.outputStreams = NULL, .outputStreamsSize = 0, };
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&OutputSharedMemoryInfo);
+}
+
+static bool caerOutputSharedMemoryInit(caerModuleData moduleData) {
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "shmName", "/caer", 2, SHM_RING_NAME_MAX - 1, SSHS_FLAGS_NORMAL,
+		"Shared memory object name to write output data to (must start with '/').");
+	sshsNodeCreateInt(moduleData->moduleNode, "shmSize", 16, 1, 1024, SSHS_FLAGS_NORMAL,
+		"Size of the shared memory ring in MB. Readers lose data if they fall this far behind.");
+
+	char *shmName = sshsNodeGetString(moduleData->moduleNode, "shmName");
+	size_t shmSize = (size_t) sshsNodeGetInt(moduleData->moduleNode, "shmSize") * 1024 * 1024;
+
+	// Create a new shared memory ring, replacing any old one.
+	shmRing ring = shmRingCreate(shmName, shmSize);
+	if (ring == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not create shared memory ring '%s'. Error: %d.", shmName,
+		errno);
+		free(shmName);
+		return (false);
+	}
+
+	outputCommonState state = moduleData->moduleState;
+
+	state->sharedMemory = ring;
+
+	if (!caerOutputCommonInit(moduleData, -1, NULL)) {
+		shmRingDestroy(ring);
+		free(shmName);
+
+		return (false);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Shared memory ring ready at '%s' (%zu bytes).", shmName, shmSize);
+
+	free(shmName);
+
+	return (true);
+}
@@ -28,6 +28,23 @@ struct MNFilter_state {
 	int dynapse_u3_c1;
 	int dynapse_u3_c2;
 	int dynapse_u3_c3;
+	// bound once in init, cheap to read on every run
+	sshsNodeAttrHandle dynapse_u0_c0_handle;
+	sshsNodeAttrHandle dynapse_u0_c1_handle;
+	sshsNodeAttrHandle dynapse_u0_c2_handle;
+	sshsNodeAttrHandle dynapse_u0_c3_handle;
+	sshsNodeAttrHandle dynapse_u1_c0_handle;
+	sshsNodeAttrHandle dynapse_u1_c1_handle;
+	sshsNodeAttrHandle dynapse_u1_c2_handle;
+	sshsNodeAttrHandle dynapse_u1_c3_handle;
+	sshsNodeAttrHandle dynapse_u2_c0_handle;
+	sshsNodeAttrHandle dynapse_u2_c1_handle;
+	sshsNodeAttrHandle dynapse_u2_c2_handle;
+	sshsNodeAttrHandle dynapse_u2_c3_handle;
+	sshsNodeAttrHandle dynapse_u3_c0_handle;
+	sshsNodeAttrHandle dynapse_u3_c1_handle;
+	sshsNodeAttrHandle dynapse_u3_c2_handle;
+	sshsNodeAttrHandle dynapse_u3_c3_handle;
 	int16_t sourceID;
 };
 
@@ -121,10 +138,50 @@ static bool caerMonitorNeuFilterInit(caerModuleData moduleData) {
 	state->dynapse_u3_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2");
 	state->dynapse_u3_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3");
 
+	// handles
+	state->dynapse_u0_c0_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u0_c0", SSHS_INT);
+	state->dynapse_u0_c1_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u0_c1", SSHS_INT);
+	state->dynapse_u0_c2_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u0_c2", SSHS_INT);
+	state->dynapse_u0_c3_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u0_c3", SSHS_INT);
+
+	state->dynapse_u1_c0_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u1_c0", SSHS_INT);
+	state->dynapse_u1_c1_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u1_c1", SSHS_INT);
+	state->dynapse_u1_c2_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u1_c2", SSHS_INT);
+	state->dynapse_u1_c3_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u1_c3", SSHS_INT);
+
+	state->dynapse_u2_c0_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u2_c0", SSHS_INT);
+	state->dynapse_u2_c1_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u2_c1", SSHS_INT);
+	state->dynapse_u2_c2_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u2_c2", SSHS_INT);
+	state->dynapse_u2_c3_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u2_c3", SSHS_INT);
+
+	state->dynapse_u3_c0_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u3_c0", SSHS_INT);
+	state->dynapse_u3_c1_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u3_c1", SSHS_INT);
+	state->dynapse_u3_c2_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u3_c2", SSHS_INT);
+	state->dynapse_u3_c3_handle = sshsNodeGetAttributeHandle(moduleData->moduleNode, "dynapse_u3_c3", SSHS_INT);
+
 	// Nothing that can fail here.
 	return (true);
 }
 
+static void caerMonitorNeuFilterUpdateNeuron(caerModuleData moduleData, caerInputDynapseState stateSource,
+	int *currentNeuron, sshsNodeAttrHandle neuronHandle, uint32_t chipId, uint8_t coreId, const char *neuronName) {
+	int32_t newNeuron = sshsNodeAttrHandleGetInt(neuronHandle);
+
+	if (*currentNeuron == newNeuron) {
+		return;
+	}
+
+	if (newNeuron < 0 || newNeuron > 255) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", newNeuron);
+	}
+	else {
+		caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, chipId);
+		caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_MONITOR_NEU, coreId, (uint32_t) newNeuron);
+		caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron %s num: %d", neuronName, newNeuron);
+		*currentNeuron = newNeuron;
+	}
+}
+
 static void caerMonitorNeuFilterRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out) {
 
 	caerSpikeEventPacketConst spike =
@@ -136,186 +193,41 @@ static void caerMonitorNeuFilterRun(caerModuleData moduleData, caerEventPacketCo
 	caerInputDynapseState stateSource = state->eventSourceModuleState;
 
 	// if changed we set it
-	if(state->dynapse_u0_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0"));
-			state->dynapse_u0_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0");
-		}
-	}
-	if(state->dynapse_u0_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1"));
-			state->dynapse_u0_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1");
-		}
-	}
-	if(state->dynapse_u0_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2"));
-			state->dynapse_u0_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2");
-		}
-	}
-	if(state->dynapse_u0_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3"));
-			state->dynapse_u0_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3");
-		}
-	}
-
-	if(state->dynapse_u1_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0"));
-			state->dynapse_u1_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0");
-		}
-
-	}
-	if(state->dynapse_u1_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t)  sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1"));
-			state->dynapse_u1_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1");
-		}
-	}
-	if(state->dynapse_u1_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2"));
-			state->dynapse_u1_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2");
-		}
-	}
-	if(state->dynapse_u1_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3"));
-			state->dynapse_u1_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3");
-		}
-	}
-
-	if(state->dynapse_u2_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0"));
-			state->dynapse_u2_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0");
-		}
-	}
-	if(state->dynapse_u2_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1"));
-			state->dynapse_u2_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1");
-		}
-	}
-	if(state->dynapse_u2_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2"));
-			state->dynapse_u2_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2");
-		}
-	}
-	if(state->dynapse_u2_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3"));
-			state->dynapse_u2_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3");
-		}
-	}
-
-	if(state->dynapse_u3_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0"));
-			state->dynapse_u3_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0");
-		}
-	}
-	if(state->dynapse_u3_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1"));
-			state->dynapse_u3_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1");
-		}
-	}
-	if(state->dynapse_u3_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2"));
-			state->dynapse_u3_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2");
-		}
-	}
-	if(state->dynapse_u3_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3"));
-			state->dynapse_u3_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3");
-		}
-	}
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u0_c0, state->dynapse_u0_c0_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U0, 0, "dynapse_u0_c0");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u0_c1, state->dynapse_u0_c1_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U0, 1, "dynapse_u0_c1");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u0_c2, state->dynapse_u0_c2_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U0, 2, "dynapse_u0_c2");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u0_c3, state->dynapse_u0_c3_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U0, 3, "dynapse_u0_c3");
+
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u1_c0, state->dynapse_u1_c0_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U1, 0, "dynapse_u1_c0");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u1_c1, state->dynapse_u1_c1_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U1, 1, "dynapse_u1_c1");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u1_c2, state->dynapse_u1_c2_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U1, 2, "dynapse_u1_c2");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u1_c3, state->dynapse_u1_c3_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U1, 3, "dynapse_u1_c3");
+
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u2_c0, state->dynapse_u2_c0_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U2, 0, "dynapse_u2_c0");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u2_c1, state->dynapse_u2_c1_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U2, 1, "dynapse_u2_c1");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u2_c2, state->dynapse_u2_c2_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U2, 2, "dynapse_u2_c2");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u2_c3, state->dynapse_u2_c3_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U2, 3, "dynapse_u2_c3");
+
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u3_c0, state->dynapse_u3_c0_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U3, 0, "dynapse_u3_c0");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u3_c1, state->dynapse_u3_c1_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U3, 1, "dynapse_u3_c1");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u3_c2, state->dynapse_u3_c2_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U3, 2, "dynapse_u3_c2");
+	caerMonitorNeuFilterUpdateNeuron(moduleData, stateSource, &state->dynapse_u3_c3, state->dynapse_u3_c3_handle,
+		DYNAPSE_CONFIG_DYNAPSE_U3, 3, "dynapse_u3_c3");
 
 }
 
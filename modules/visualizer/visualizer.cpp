@@ -2,23 +2,34 @@
 #include "base/mainloop.h"
 #include "base/module.h"
 #include "ext/threads_ext.h"
+#include "ext/pathmax.h"
 #include "ext/resources/LiberationSans-Bold.h"
-#include "ext/sfml/helpers.hpp"
 #include "modules/statistics/statistics.h"
 #include <libcaer/ringbuffer.h>
 
+#include "visualizer_accumulator.hpp"
+#include "visualizer_decimation.hpp"
+#include "visualizer_encoder.hpp"
 #include "visualizer_handlers.hpp"
 #include "visualizer_renderers.hpp"
+#include "visualizer_server.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
+#include <sstream>
 #include <thread>
 #include <mutex>
+#include <vector>
+#include <boost/algorithm/string.hpp>
 
 #if defined(OS_LINUX) && OS_LINUX == 1
 #include <X11/Xlib.h>
 #endif
 
 #define VISUALIZER_REFRESH_RATE 60
+#define VISUALIZER_REFRESH_RATE_MAX 1000
 #define VISUALIZER_ZOOM_DEF  2.0f
 #define VISUALIZER_ZOOM_INC 0.25f
 #define VISUALIZER_ZOOM_MIN 0.50f
@@ -43,29 +54,115 @@ static uint32_t STATISTICS_HEIGHT = 0;
 // Track system init.
 static std::once_flag visualizerSystemIsInitialized;
 
+// Container on its way to the render thread, with its arrival time
+// at the visualizer to measure display latency.
+struct visualizer_transfer {
+	caerEventPacketContainer container;
+	std::chrono::steady_clock::time_point arrivalTime;
+};
+
+typedef struct visualizer_transfer *visualizerTransfer;
+
+// Render thread statistics, published once per second.
+struct visualizer_render_statistics {
+	std::chrono::steady_clock::time_point intervalStart;
+	uint32_t frames;
+	uint32_t latencyCount;
+	std::chrono::microseconds latencySum;
+};
+
+typedef struct visualizer_render_statistics *visualizerRenderStatistics;
+
+// Accumulated polarity image, built on the mainloop thread and handed
+// to the render thread. Two pixel buffers are swapped by the mainloop
+// while transferReady is false, the render thread only reads transferPixels
+// while it is true, so no lock is needed.
+struct visualizer_accumulation {
+	struct caer_visualizer_accumulator accumulator;
+	std::vector<uint8_t> mainloopPixels;
+	std::vector<uint8_t> transferPixels;
+	std::chrono::steady_clock::time_point transferArrivalTime;
+	std::atomic_bool transferReady;
+	// Render thread only.
+	struct caer_visualizer_image image;
+	bool haveImage;
+};
+
+typedef struct visualizer_accumulation *visualizerAccumulation;
+
+// Remote view server, render thread only.
+struct visualizer_remote {
+	caerVisualizerServer server;
+	std::chrono::microseconds framePeriod;
+	std::chrono::steady_clock::time_point nextFrame;
+};
+
+typedef struct visualizer_remote *visualizerRemote;
+
+typedef struct caer_visualizer_state *caerVisualizerState;
+
+// One renderer and its place in the window. Renderers get a pointer to
+// the public state, so it must stay the first member.
+struct visualizer_view {
+	struct caer_visualizer_public_state publicState;
+	caerVisualizerState parent;
+	caerVisualizerRendererInfo renderer;
+	/// Only render packets from this source, -1 for all.
+	int16_t sourceID;
+	/// Upper left corner in the window, in render coordinates.
+	uint32_t positionX;
+	uint32_t positionY;
+	/// With multiple views, each one renders into its own canvas, so views
+	/// without new content keep their last image. Renderers draw into the
+	/// back canvas, the front one is shown.
+	caerVisualizerCanvas tileFront;
+	caerVisualizerCanvas tileBack;
+};
+
+typedef struct visualizer_view *visualizerView;
+
 struct caer_visualizer_state {
 	sshsNode eventSourceConfigNode;
 	sshsNode visualizerConfigNode;
 	uint32_t renderSizeX;
 	uint32_t renderSizeY;
-	void *renderState; // Reserved for renderers to put their internal state into.
-	sf::RenderWindow *renderWindow;
+	void *renderState; // Unused, renderers keep their state in their view.
+	caerVisualizerCanvas canvas;
+	/// Part of the render area that is shown, clipped to it, render thread only.
+	uint32_t roiPositionX;
+	uint32_t roiPositionY;
 	sf::Font *font;
+	sf::RenderWindow *renderWindow;
+	sf::RenderTexture *renderTexture;
+	bool headless;
+	/// Headless rendering into a memory framebuffer, without OpenGL.
+	bool software;
+	caerVisualizerEncoder encoder;
+	visualizerRemote remote;
 	std::atomic_bool running;
 	std::atomic_bool windowResize;
 	std::atomic_bool windowMove;
 	caerRingBuffer dataTransfer;
 	std::thread *renderingThread;
-	caerVisualizerRendererInfo renderer;
+	/// Renderers, tiled into the window in order.
+	visualizerView views;
+	size_t viewsLength;
 	caerVisualizerEventHandlerInfo eventHandler;
 	bool showStatistics;
+	uint32_t roiSizeX;
+	uint32_t roiSizeY;
 	struct caer_statistics_state packetStatistics;
 	std::atomic_uint_fast32_t packetSubsampleRendering;
 	uint32_t packetSubsampleCount;
+	std::atomic_uint_fast32_t maxFPS;
+	std::atomic_uint_fast64_t droppedContainers;
+	visualizerAccumulation accumulation;
+	std::atomic_int_fast32_t accumulationTime;
+	/// Cuts events down to the shown region before they are copied, mainloop only.
+	caerVisualizerDecimation decimation;
+	std::atomic_bool decimationUpdate;
 };
 
-typedef struct caer_visualizer_state *caerVisualizerState;
-
 static void caerVisualizerConfigInit(sshsNode moduleNode);
 static bool caerVisualizerInit(caerModuleData moduleData);
 static void caerVisualizerExit(caerModuleData moduleData);
@@ -74,15 +171,36 @@ static void caerVisualizerReset(caerModuleData moduleData, int16_t resetCallSour
 static void caerVisualizerConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 static void initSystemOnce(caerModuleData moduleData);
-static bool initRenderSize(caerModuleData moduleData, int16_t *inputs, size_t inputsSize);
-static void initRenderersHandlers(caerModuleData moduleData);
+static bool initRenderSize(int16_t *inputs, size_t inputsSize, uint32_t *renderSizeX, uint32_t *renderSizeY);
+static bool initRenderersHandlers(caerModuleData moduleData, int16_t *inputs, size_t inputsSize);
+static bool initRenderStates(caerModuleData moduleData);
+static void exitRenderStates(caerVisualizerState state);
+static bool initAccumulation(caerModuleData moduleData);
+static void accumulateContainer(caerVisualizerState state, caerEventPacketContainer in);
+static void publishAccumulation(caerVisualizerState state, std::chrono::steady_clock::time_point arrivalTime);
+static bool initDecimation(caerModuleData moduleData);
+static void updateDecimation(caerVisualizerState state);
+static caerEventPacketContainer copyContainerWithoutPolarity(caerEventPacketContainer in);
+static caerEventPacketContainer copyContainerDecimated(caerEventPacketContainer in, caerVisualizerDecimation decimation);
+static caerEventPacketContainer selectSourcePackets(caerEventPacketContainer in, int16_t sourceID);
+static void releaseSourcePackets(caerEventPacketContainer selection);
+static bool renderAccumulation(caerVisualizerState state, std::chrono::steady_clock::time_point *arrivalTime);
+static bool initRemote(caerModuleData moduleData);
+static void exitRemote(caerVisualizerState state);
+static void sendRemote(caerVisualizerState state, const uint8_t *pixels);
 static bool initGraphics(caerModuleData moduleData);
 static void exitGraphics(caerModuleData moduleData);
-static void updateDisplaySize(caerVisualizerState state);
+static void updateLayout(caerVisualizerState state);
+static void updateRegionOfInterest(caerVisualizerState state);
+static bool updateDisplaySize(caerVisualizerState state);
 static void updateDisplayLocation(caerVisualizerState state);
 static void saveDisplayLocation(caerVisualizerState state);
+static inline bool graphicsOnMainThread(caerVisualizerState state);
 static void handleEvents(caerModuleData moduleData);
-static void renderScreen(caerModuleData moduleData);
+static bool renderView(caerVisualizerState state, visualizerView view, caerEventPacketContainer container,
+	bool accumulationReady);
+static void renderScreen(caerModuleData moduleData, visualizerRenderStatistics statistics);
+static void updateRenderStatistics(caerModuleData moduleData, visualizerRenderStatistics statistics);
 static int renderThread(void *inModuleData);
 
 static const struct caer_module_functions VisualizerFunctions = { .moduleConfigInit = &caerVisualizerConfigInit,
@@ -101,7 +219,10 @@ caerModuleInfo caerModuleGetInfo(void) {
 }
 
 static void caerVisualizerConfigInit(sshsNode moduleNode) {
-	sshsNodeCreate(moduleNode, "renderer", "None", 0, 100, SSHS_FLAGS_NORMAL, "Renderer to use to generate content.");
+	sshsNodeCreate(moduleNode, "renderer", "None", 0, 1024, SSHS_FLAGS_NORMAL,
+		"Renderer to use to generate content. Multiple comma-separated renderers are tiled into the same "
+			"window; append ':ID' to a renderer to only give it the packets of the input with that source ID "
+			"(for example 'Polarity:1,Frame:1,IMU_6-axes:1').");
 	sshsNodeRemoveAttribute(moduleNode, "rendererListOptions", SSHS_STRING);
 	sshsNodeCreate(moduleNode, "rendererListOptions", caerVisualizerRendererListOptionsString, 0, 200,
 		SSHS_FLAGS_READ_ONLY, "List of available renderers.");
@@ -111,16 +232,74 @@ static void caerVisualizerConfigInit(sshsNode moduleNode) {
 	sshsNodeCreate(moduleNode, "eventHandlerListOptions", caerVisualizerEventHandlerListOptionsString, 0, 200,
 		SSHS_FLAGS_READ_ONLY, "List of available event handlers.");
 
+	sshsNodeCreateInt(moduleNode, "viewColumns", 0, 0, 16, SSHS_FLAGS_NORMAL,
+		"Number of columns to tile multiple renderers into, 0 to arrange them in a square.");
 	sshsNodeCreateInt(moduleNode, "subsampleRendering", 1, 1, 100000, SSHS_FLAGS_NORMAL,
 		"Speed-up rendering by only taking every Nth EventPacketContainer to render.");
+	sshsNodeCreateInt(moduleNode, "maxFPS", VISUALIZER_REFRESH_RATE, 1, VISUALIZER_REFRESH_RATE_MAX,
+		SSHS_FLAGS_NORMAL, "Maximum frames per second to render, the render thread sleeps in between.");
+	sshsNodeCreateFloat(moduleNode, "renderedFPS", 0, 0, VISUALIZER_REFRESH_RATE_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frames per second actually displayed, over the last second.");
+	sshsNodeCreateLong(moduleNode, "droppedContainers", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Containers not rendered, because the render thread was too slow to take them (subsampled ones excluded).");
+	sshsNodeCreateInt(moduleNode, "renderLatency", 0, 0, INT32_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Average time from data arriving at the visualizer to being displayed, over the last second, in µs.");
+	sshsNodeCreate(moduleNode, "accumulationMode", "None", 0, 100, SSHS_FLAGS_NORMAL,
+		"Accumulate polarity events into a persistent image on the mainloop thread, instead of only "
+			"rendering the latest container. Decay fades pixels exponentially, Window shows the last "
+			"event of each pixel for a fixed time.");
+	sshsNodeRemoveAttribute(moduleNode, "accumulationModeListOptions", SSHS_STRING);
+	sshsNodeCreate(moduleNode, "accumulationModeListOptions", caerVisualizerAccumulationModeListOptionsString, 0, 200,
+		SSHS_FLAGS_READ_ONLY, "List of available accumulation modes.");
+	sshsNodeCreateInt(moduleNode, "accumulationTime", 10000, 1, 10000000, SSHS_FLAGS_NORMAL,
+		"Decay time constant (Decay) or window length (Window) for event accumulation, in µs.");
 	sshsNodeCreateBool(moduleNode, "showStatistics", true, SSHS_FLAGS_NORMAL,
 		"Show useful statistics below content (bottom of window).");
 	sshsNodeCreateFloat(moduleNode, "zoomFactor", VISUALIZER_ZOOM_DEF, VISUALIZER_ZOOM_MIN,
 	VISUALIZER_ZOOM_MAX, SSHS_FLAGS_NORMAL, "Content zoom factor.");
+	sshsNodeCreateInt(moduleNode, "roiPositionX", 0, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Region of interest to show (left edge). Only applies to a single renderer, polarity events outside of "
+			"it are dropped before being copied for rendering.");
+	sshsNodeCreateInt(moduleNode, "roiPositionY", 0, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Region of interest to show (top edge).");
+	sshsNodeCreateInt(moduleNode, "roiSizeX", 0, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Region of interest to show (width), 0 to extend it to the right edge.");
+	sshsNodeCreateInt(moduleNode, "roiSizeY", 0, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Region of interest to show (height), 0 to extend it to the bottom edge.");
 	sshsNodeCreateInt(moduleNode, "windowPositionX", VISUALIZER_POSITION_X_DEF, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
 		"Position of window on screen (X coordinate).");
 	sshsNodeCreateInt(moduleNode, "windowPositionY", VISUALIZER_POSITION_Y_DEF, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
 		"Position of window on screen (Y coordinate).");
+
+	sshsNodeCreateBool(moduleNode, "headless", false, SSHS_FLAGS_NORMAL,
+		"Render offscreen instead of into a window, and write frames to headlessOutput at headlessFPS. "
+			"Output size (zoom, statistics) is fixed when the module starts.");
+	sshsNodeCreate(moduleNode, "headlessFormat", "PNG", 0, 10, SSHS_FLAGS_NORMAL,
+		"Headless output format: PNG image sequence, Y4M video or RAW RGBA frames.");
+	sshsNodeRemoveAttribute(moduleNode, "headlessFormatListOptions", SSHS_STRING);
+	sshsNodeCreate(moduleNode, "headlessFormatListOptions", caerVisualizerEncoderFormatListOptionsString, 0, 200,
+		SSHS_FLAGS_READ_ONLY, "List of available headless output formats.");
+	sshsNodeCreate(moduleNode, "headlessOutput", "", 0, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Headless output file (Y4M, RAW; can be a named pipe), or path prefix for PNG images.");
+	sshsNodeCreateInt(moduleNode, "headlessFPS", 30, 1, 1000, SSHS_FLAGS_NORMAL,
+		"Frames per second to render and write in headless mode.");
+	sshsNodeCreateBool(moduleNode, "headlessSoftware", false, SSHS_FLAGS_NORMAL,
+		"Render headless output in software, into memory, instead of with OpenGL. Needs no GPU or display "
+			"(nor Xvfb), but ignores zoom, and text such as statistics is not drawn.");
+
+	sshsNodeCreateBool(moduleNode, "remoteServer", false, SSHS_FLAGS_NORMAL,
+		"Serve the rendered content to remote clients over TCP, as decimated PNG images. Clients that can't "
+			"keep up skip frames and get lower resolutions.");
+	sshsNodeCreate(moduleNode, "remoteIpAddress", "127.0.0.1", 7, 15, SSHS_FLAGS_NORMAL,
+		"IPv4 address to listen on for remote clients.");
+	sshsNodeCreateInt(moduleNode, "remotePortNumber", 7788, 1, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Port number to listen on for remote clients.");
+	sshsNodeCreateShort(moduleNode, "remoteConcurrentConnections", 4, 1, 32, SSHS_FLAGS_NORMAL,
+		"Maximum number of concurrent remote clients.");
+	sshsNodeCreateInt(moduleNode, "remoteFPS", 10, 1, 60, SSHS_FLAGS_NORMAL,
+		"Maximum frames per second to send to remote clients.");
+	sshsNodeCreateInt(moduleNode, "remoteDecimation", 2, 1, 16, SSHS_FLAGS_NORMAL,
+		"Resolution reduction factor for remote clients, before any adaptation to slow clients.");
 }
 
 static bool caerVisualizerInit(caerModuleData moduleData) {
@@ -138,24 +317,80 @@ static bool caerVisualizerInit(caerModuleData moduleData) {
 	}
 
 	// Initialize visualizer. Needs size information from the source.
-	if (!initRenderSize(moduleData, inputs, inputsSize)) {
+	if (!initRenderSize(inputs, inputsSize, &state->renderSizeX, &state->renderSizeY)) {
 		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize render sizes from source.");
 
 		free(inputs);
 		return (false);
 	}
 
-	initRenderersHandlers(moduleData);
-
 	state->visualizerConfigNode = moduleData->moduleNode;
 	state->eventSourceConfigNode = caerMainloopGetSourceNode(inputs[0]);
 
+	if (!initRenderersHandlers(moduleData, inputs, inputsSize)) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize renderers.");
+
+		free(inputs);
+		return (false);
+	}
+
 	free(inputs);
 
+	state->headless = sshsNodeGetBool(moduleData->moduleNode, "headless");
+
+	if (state->headless && sshsNodeGetStdString(moduleData->moduleNode, "headlessOutput").empty()) {
+		delete[] state->views;
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Headless mode needs an output, set headlessOutput.");
+		return (false);
+	}
+
+	state->software = (state->headless && sshsNodeGetBool(moduleData->moduleNode, "headlessSoftware"));
+
+	// Multiple views never need it, see initRenderersHandlers().
+	if (state->software && state->views[0].renderer->needsOpenGL3) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Renderer '%s' needs OpenGL 3.3, it can't render in software.",
+			state->views[0].renderer->name.c_str());
+
+		delete[] state->views;
+		return (false);
+	}
+
 	state->packetSubsampleRendering.store(U32T(sshsNodeGetInt(moduleData->moduleNode, "subsampleRendering")));
+	state->maxFPS.store(U32T(sshsNodeGetInt(moduleData->moduleNode, "maxFPS")));
+	state->droppedContainers.store(0);
+
+	// Statistics start over on each run.
+	union sshs_node_attr_value statisticsReset;
+	statisticsReset.ffloat = 0;
+	sshsNodeUpdateReadOnlyAttribute(moduleData->moduleNode, "renderedFPS", SSHS_FLOAT, statisticsReset);
+	statisticsReset.ilong = 0;
+	sshsNodeUpdateReadOnlyAttribute(moduleData->moduleNode, "droppedContainers", SSHS_LONG, statisticsReset);
+	statisticsReset.iint = 0;
+	sshsNodeUpdateReadOnlyAttribute(moduleData->moduleNode, "renderLatency", SSHS_INT, statisticsReset);
+	state->accumulationTime.store(sshsNodeGetInt(moduleData->moduleNode, "accumulationTime"));
+
+	if (!initAccumulation(moduleData)) {
+		delete[] state->views;
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize event accumulation.");
+		return (false);
+	}
+
+	if (!initDecimation(moduleData)) {
+		delete state->accumulation;
+		delete[] state->views;
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize event decimation.");
+		return (false);
+	}
 
 	// Enable packet statistics.
 	if (!caerStatisticsStringInit(&state->packetStatistics)) {
+		delete state->decimation;
+		delete state->accumulation;
+		delete[] state->views;
+
 		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize statistics string.");
 		return (false);
 	}
@@ -164,27 +399,33 @@ static bool caerVisualizerInit(caerModuleData moduleData) {
 	state->dataTransfer = caerRingBufferInit(64);
 	if (state->dataTransfer == nullptr) {
 		caerStatisticsStringExit(&state->packetStatistics);
+		delete state->decimation;
+		delete state->accumulation;
+		delete[] state->views;
 
 		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize transfer ring-buffer.");
 		return (false);
 	}
 
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 1
-	// Initialize graphics on main thread.
-	// On OS X, creation (and destruction) of the window, as well as its event
-	// handling must happen on the main thread. Only drawing can be separate.
-	if (!initGraphics(moduleData)) {
-		caerRingBufferFree(state->dataTransfer);
-		caerStatisticsStringExit(&state->packetStatistics);
+	if (graphicsOnMainThread(state)) {
+		// Initialize graphics on main thread.
+		// On OS X, creation (and destruction) of the window, as well as its event
+		// handling must happen on the main thread. Only drawing can be separate.
+		if (!initGraphics(moduleData)) {
+			caerRingBufferFree(state->dataTransfer);
+			caerStatisticsStringExit(&state->packetStatistics);
+			delete state->decimation;
+			delete state->accumulation;
+			delete[] state->views;
+
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize rendering window.");
+			return (false);
+		}
 
-		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize rendering window.");
-		return (false);
+		// Disable OpenGL context to pass it to thread.
+		state->renderWindow->setActive(false);
 	}
 
-	// Disable OpenGL context to pass it to thread.
-	state->renderWindow->setActive(false);
-#endif
-
 	// Start separate rendering thread. Decouples presentation from
 	// data processing and preparation. Communication over ring-buffer.
 	state->running.store(true);
@@ -193,11 +434,15 @@ static bool caerVisualizerInit(caerModuleData moduleData) {
 		state->renderingThread = new std::thread(&renderThread, moduleData);
 	}
 	catch (const std::system_error &ex) {
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 1
-		exitGraphics(moduleData);
-#endif
+		if (graphicsOnMainThread(state)) {
+			exitGraphics(moduleData);
+		}
+
 		caerRingBufferFree(state->dataTransfer);
 		caerStatisticsStringExit(&state->packetStatistics);
+		delete state->decimation;
+		delete state->accumulation;
+		delete[] state->views;
 
 		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to start rendering thread. Error: '%s' (%d).", ex.what(),
 			ex.code().value());
@@ -232,17 +477,18 @@ static void caerVisualizerExit(caerModuleData moduleData) {
 
 	delete state->renderingThread;
 
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 1
-	// Shutdown graphics on main thread.
-	// On OS X, creation (and destruction) of the window, as well as its event
-	// handling must happen on the main thread. Only drawing can be separate.
-	exitGraphics(moduleData);
-#endif
+	if (graphicsOnMainThread(state)) {
+		// Shutdown graphics on main thread.
+		// On OS X, creation (and destruction) of the window, as well as its event
+		// handling must happen on the main thread. Only drawing can be separate.
+		exitGraphics(moduleData);
+	}
 
 	// Now clean up the ring-buffer and its contents.
-	caerEventPacketContainer container;
-	while ((container = (caerEventPacketContainer) caerRingBufferGet(state->dataTransfer)) != nullptr) {
-		caerEventPacketContainerFree(container);
+	visualizerTransfer transfer;
+	while ((transfer = (visualizerTransfer) caerRingBufferGet(state->dataTransfer)) != nullptr) {
+		caerEventPacketContainerFree(transfer->container);
+		delete transfer;
 	}
 
 	caerRingBufferFree(state->dataTransfer);
@@ -250,6 +496,13 @@ static void caerVisualizerExit(caerModuleData moduleData) {
 	// Then the statistics string.
 	caerStatisticsStringExit(&state->packetStatistics);
 
+	// And the accumulated image and decimation, if any.
+	delete state->accumulation;
+	delete state->decimation;
+
+	// Renderer states and tiles are gone with the render thread.
+	delete[] state->views;
+
 	caerModuleLog(moduleData, CAER_LOG_DEBUG, "Exited successfully.");
 }
 
@@ -258,12 +511,14 @@ static void caerVisualizerRun(caerModuleData moduleData, caerEventPacketContaine
 
 	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
 
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 1
-	// Handle events on main thread.
-	// On OS X, creation (and destruction) of the window, as well as its event
-	// handling must happen on the main thread. Only drawing can be separate.
-	handleEvents(moduleData);
-#endif
+	const auto arrivalTime = std::chrono::steady_clock::now();
+
+	if (graphicsOnMainThread(state)) {
+		// Handle events on main thread.
+		// On OS X, creation (and destruction) of the window, as well as its event
+		// handling must happen on the main thread. Only drawing can be separate.
+		handleEvents(moduleData);
+	}
 
 	// Without a packet container with events, we cannot render anything.
 	if (in == nullptr || caerEventPacketContainerGetEventsNumber(in) == 0) {
@@ -275,6 +530,11 @@ static void caerVisualizerRun(caerModuleData moduleData, caerEventPacketContaine
 			caerStatisticsStringUpdate(caerEventPacketContainerIteratorElement, &state->packetStatistics);
 		CAER_EVENT_PACKET_CONTAINER_ITERATOR_END
 
+	// Accumulate all events too, subsampling only limits publishing.
+	if (state->accumulation != nullptr) {
+		accumulateContainer(state, in);
+	}
+
 		// Only render every Nth container (or packet, if using standard visualizer).
 	state->packetSubsampleCount++;
 
@@ -285,19 +545,69 @@ static void caerVisualizerRun(caerModuleData moduleData, caerEventPacketContaine
 		return;
 	}
 
-	if (caerRingBufferFull(state->dataTransfer)) {
-		caerModuleLog(moduleData, CAER_LOG_INFO, "Transfer ring-buffer full.");
-		return;
+	// Headless output keeps the region it started with, like its size.
+	if (state->decimation != nullptr && !state->headless && state->decimationUpdate.exchange(false)) {
+		updateDecimation(state);
+	}
+
+	caerEventPacketContainer containerCopy;
+
+	if (state->accumulation != nullptr) {
+		publishAccumulation(state, arrivalTime);
+
+		// Polarity events are in the accumulated image already, only
+		// the remaining packets go to the renderer, if there are any.
+		containerCopy = copyContainerWithoutPolarity(in);
+		if (containerCopy == nullptr) {
+			return;
+		}
+
+		if (caerRingBufferFull(state->dataTransfer)) {
+			caerEventPacketContainerFree(containerCopy);
+			state->droppedContainers.fetch_add(1, std::memory_order_relaxed);
+
+			caerModuleLog(moduleData, CAER_LOG_INFO, "Transfer ring-buffer full.");
+			return;
+		}
+	}
+	else {
+		if (caerRingBufferFull(state->dataTransfer)) {
+			state->droppedContainers.fetch_add(1, std::memory_order_relaxed);
+
+			caerModuleLog(moduleData, CAER_LOG_INFO, "Transfer ring-buffer full.");
+			return;
+		}
+
+		if (state->decimation != nullptr && caerVisualizerDecimationIsActive(state->decimation)) {
+			// Only copy what can be seen, there may be nothing left.
+			containerCopy = copyContainerDecimated(in, state->decimation);
+			if (containerCopy == nullptr) {
+				return;
+			}
+		}
+		else {
+			containerCopy = caerEventPacketContainerCopyAllEvents(in);
+		}
 	}
 
-	caerEventPacketContainer containerCopy = caerEventPacketContainerCopyAllEvents(in);
 	if (containerCopy == nullptr) {
 		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to copy event packet container for rendering.");
 		return;
 	}
 
+	visualizerTransfer transfer = new (std::nothrow) visualizer_transfer();
+	if (transfer == nullptr) {
+		caerEventPacketContainerFree(containerCopy);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate transfer for rendering.");
+		return;
+	}
+
+	transfer->container = containerCopy;
+	transfer->arrivalTime = arrivalTime;
+
 	// Will always succeed because of full check above.
-	caerRingBufferPut(state->dataTransfer, containerCopy);
+	caerRingBufferPut(state->dataTransfer, transfer);
 }
 
 static void caerVisualizerReset(caerModuleData moduleData, int16_t resetCallSourceID) {
@@ -308,6 +618,11 @@ static void caerVisualizerReset(caerModuleData moduleData, int16_t resetCallSour
 	// Reset statistics and counters.
 	caerStatisticsStringReset(&state->packetStatistics);
 	state->packetSubsampleCount = 0;
+
+	// Timestamps restart, old accumulated values would never decay.
+	if (state->accumulation != nullptr) {
+		caerVisualizerAccumulatorReset(&state->accumulation->accumulator);
+	}
 }
 
 static void caerVisualizerConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -318,7 +633,19 @@ static void caerVisualizerConfigListener(sshsNode node, void *userData, enum ssh
 
 	if (event == SSHS_ATTRIBUTE_MODIFIED) {
 		if (changeType == SSHS_FLOAT && caerStrEquals(changeKey, "zoomFactor")) {
-			// Set resize flag.
+			// Set resize flag. Zooming out also changes how many pixels share one.
+			state->windowResize.store(true);
+			state->decimationUpdate.store(true);
+		}
+		else if (changeType == SSHS_INT
+			&& (caerStrEquals(changeKey, "roiPositionX") || caerStrEquals(changeKey, "roiPositionY")
+				|| caerStrEquals(changeKey, "roiSizeX") || caerStrEquals(changeKey, "roiSizeY"))) {
+			// Set resize flag, and update which events are rendered.
+			state->windowResize.store(true);
+			state->decimationUpdate.store(true);
+		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "viewColumns")) {
+			// Set resize flag, the layout is updated with the display size.
 			state->windowResize.store(true);
 		}
 		else if (changeType == SSHS_BOOL && caerStrEquals(changeKey, "showStatistics")) {
@@ -329,6 +656,12 @@ static void caerVisualizerConfigListener(sshsNode node, void *userData, enum ssh
 		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "subsampleRendering")) {
 			state->packetSubsampleRendering.store(U32T(changeValue.iint));
 		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "maxFPS")) {
+			state->maxFPS.store(U32T(changeValue.iint));
+		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "accumulationTime")) {
+			state->accumulationTime.store(changeValue.iint);
+		}
 		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "windowPositionX")) {
 			// Set move flag.
 			state->windowMove.store(true);
@@ -367,9 +700,7 @@ static void initSystemOnce(caerModuleData moduleData) {
 	STATISTICS_HEIGHT = (3 * GLOBAL_FONT_SPACING) + (2 * U32T(maxStatText.getLocalBounds().height));
 }
 
-static bool initRenderSize(caerModuleData moduleData, int16_t *inputs, size_t inputsSize) {
-	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
-
+static bool initRenderSize(int16_t *inputs, size_t inputsSize, uint32_t *renderSizeX, uint32_t *renderSizeY) {
 	// Default sizes if nothing else is specified in sourceInfo node.
 	uint32_t sizeX = 32;
 	uint32_t sizeY = 32;
@@ -410,25 +741,113 @@ static bool initRenderSize(caerModuleData moduleData, int16_t *inputs, size_t in
 	}
 
 	// Set X/Y sizes.
-	state->renderSizeX = sizeX;
-	state->renderSizeY = sizeY;
+	*renderSizeX = sizeX;
+	*renderSizeY = sizeY;
 
 	return (true);
 }
 
-static void initRenderersHandlers(caerModuleData moduleData) {
+static bool initRenderersHandlers(caerModuleData moduleData, int16_t *inputs, size_t inputsSize) {
 	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
 
+	// Each comma-separated renderer gets its own view, optionally only
+	// for the packets of one source: 'Renderer' or 'Renderer:sourceID'.
+	std::vector<std::pair<std::string, int16_t>> viewChoices;
+
+	std::stringstream rendererStream(sshsNodeGetStdString(moduleData->moduleNode, "renderer"));
+	std::string rendererString;
+
+	while (std::getline(rendererStream, rendererString, ',')) {
+		boost::algorithm::trim(rendererString);
+
+		if (rendererString.empty()) {
+			continue;
+		}
+
+		int16_t sourceID = -1;
+		const size_t sourcePosition = rendererString.find(':');
+
+		if (sourcePosition != std::string::npos) {
+			int source = -1;
+
+			try {
+				source = std::stoi(rendererString.substr(sourcePosition + 1));
+			}
+			catch (const std::logic_error &) {
+				// Checked below.
+			}
+
+			if (std::find(inputs, inputs + inputsSize, source) == (inputs + inputsSize)) {
+				caerModuleLog(moduleData, CAER_LOG_ERROR, "Renderer '%s': source ID is not an input of this module.",
+					rendererString.c_str());
+				return (false);
+			}
+
+			sourceID = I16T(source);
+			rendererString.erase(sourcePosition);
+			boost::algorithm::trim(rendererString);
+		}
+
+		viewChoices.emplace_back(rendererString, sourceID);
+	}
+
 	// Standard renderer is the NULL renderer.
-	state->renderer = &caerVisualizerRendererList[0];
+	if (viewChoices.empty()) {
+		viewChoices.emplace_back(caerVisualizerRendererList[0].name, -1);
+	}
 
-	// Search for renderer in list.
-	const std::string rendererChoice = sshsNodeGetStdString(moduleData->moduleNode, "renderer");
+	state->views = new (std::nothrow) visualizer_view[viewChoices.size()]();
+	if (state->views == nullptr) {
+		return (false);
+	}
 
-	for (size_t i = 0; i < caerVisualizerRendererListLength; i++) {
-		if (rendererChoice == caerVisualizerRendererList[i].name) {
-			state->renderer = &caerVisualizerRendererList[i];
-			break;
+	state->viewsLength = viewChoices.size();
+
+	for (size_t i = 0; i < state->viewsLength; i++) {
+		visualizerView view = &state->views[i];
+
+		view->parent = state;
+		view->sourceID = viewChoices[i].second;
+
+		// Search for renderer in list, unknown ones render nothing.
+		view->renderer = &caerVisualizerRendererList[0];
+
+		for (size_t j = 0; j < caerVisualizerRendererListLength; j++) {
+			if (viewChoices[i].first == caerVisualizerRendererList[j].name) {
+				view->renderer = &caerVisualizerRendererList[j];
+				break;
+			}
+		}
+
+		if (view->renderer == &caerVisualizerRendererList[0] && viewChoices[i].first != view->renderer->name) {
+			caerModuleLog(moduleData, CAER_LOG_WARNING, "Unknown renderer '%s', showing nothing in its place.",
+				viewChoices[i].first.c_str());
+		}
+
+		// Tiles are drawn with SFML, which doesn't work in a core profile context.
+		if (view->renderer->needsOpenGL3 && state->viewsLength > 1) {
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "Renderer '%s' needs OpenGL 3.3 and its own visualizer.",
+				view->renderer->name.c_str());
+
+			delete[] state->views;
+			return (false);
+		}
+
+		view->publicState.visualizerConfigNode = state->visualizerConfigNode;
+
+		if (view->sourceID == -1) {
+			view->publicState.eventSourceConfigNode = state->eventSourceConfigNode;
+			view->publicState.renderSizeX = state->renderSizeX;
+			view->publicState.renderSizeY = state->renderSizeY;
+		}
+		else {
+			view->publicState.eventSourceConfigNode = caerMainloopGetSourceNode(view->sourceID);
+
+			if (!initRenderSize(&view->sourceID, 1, &view->publicState.renderSizeX,
+				&view->publicState.renderSizeY)) {
+				delete[] state->views;
+				return (false);
+			}
 		}
 	}
 
@@ -444,11 +863,376 @@ static void initRenderersHandlers(caerModuleData moduleData) {
 			break;
 		}
 	}
+
+	return (true);
+}
+
+static bool initRenderStates(caerModuleData moduleData) {
+	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
+
+	for (size_t i = 0; i < state->viewsLength; i++) {
+		visualizerView view = &state->views[i];
+
+		view->publicState.canvas = state->canvas;
+
+		if (view->renderer->stateInit != nullptr) {
+			view->publicState.renderState = (*view->renderer->stateInit)((caerVisualizerPublicState) view);
+			if (view->publicState.renderState == nullptr) {
+				exitRenderStates(state);
+				return (false);
+			}
+		}
+	}
+
+	if (state->viewsLength == 1) {
+		return (true); // Renders directly into the window.
+	}
+
+	// View sizes are final now, they only change during renderer state init.
+	for (size_t i = 0; i < state->viewsLength; i++) {
+		visualizerView view = &state->views[i];
+
+		view->tileFront = state->canvas->createCanvas(view->publicState.renderSizeX, view->publicState.renderSizeY);
+		view->tileBack = state->canvas->createCanvas(view->publicState.renderSizeX, view->publicState.renderSizeY);
+
+		if (view->tileFront == nullptr || view->tileBack == nullptr) {
+			caerModuleLog(moduleData, CAER_LOG_ERROR,
+				"Failed to create tile canvas with sizeX=%" PRIu32 ", sizeY=%" PRIu32 ".",
+				view->publicState.renderSizeX, view->publicState.renderSizeY);
+
+			exitRenderStates(state);
+			return (false);
+		}
+
+		view->tileFront->clear(sf::Color::Black);
+		view->tileFront->display();
+		view->tileBack->clear(sf::Color::Black);
+
+		view->publicState.canvas = view->tileBack;
+	}
+
+	return (true);
+}
+
+static void exitRenderStates(caerVisualizerState state) {
+	for (size_t i = 0; i < state->viewsLength; i++) {
+		visualizerView view = &state->views[i];
+
+		if ((view->renderer->stateExit != nullptr) && (view->publicState.renderState != nullptr)
+			&& (view->publicState.renderState != CAER_VISUALIZER_RENDER_INIT_NO_MEM)) {
+			(*view->renderer->stateExit)((caerVisualizerPublicState) view);
+		}
+
+		view->publicState.renderState = nullptr;
+
+		delete view->tileFront;
+		delete view->tileBack;
+
+		view->tileFront = nullptr;
+		view->tileBack = nullptr;
+	}
+}
+
+static bool initAccumulation(caerModuleData moduleData) {
+	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
+
+	state->accumulation = nullptr;
+
+	caerVisualizerAccumulationMode mode = caerVisualizerAccumulationModeFromString(
+		sshsNodeGetStdString(moduleData->moduleNode, "accumulationMode"));
+	if (mode == caerVisualizerAccumulationMode::NONE) {
+		return (true); // Disabled, render containers as they come.
+	}
+
+	try {
+		state->accumulation = new visualizer_accumulation();
+
+		caerVisualizerAccumulatorInit(&state->accumulation->accumulator, mode, state->renderSizeX, state->renderSizeY,
+			state->accumulationTime.load());
+
+		// 32-bit RGBA pixels (8-bit per channel), standard CG layout.
+		state->accumulation->mainloopPixels.resize(state->renderSizeX * state->renderSizeY * 4);
+		state->accumulation->transferPixels.resize(state->renderSizeX * state->renderSizeY * 4);
+
+		// Same size, its pixels are swapped with the transfer ones.
+		caerVisualizerImageInit(&state->accumulation->image, state->renderSizeX, state->renderSizeY);
+	}
+	catch (const std::bad_alloc &) {
+		delete state->accumulation;
+		state->accumulation = nullptr;
+
+		return (false);
+	}
+
+	return (true);
+}
+
+static void accumulateContainer(caerVisualizerState state, caerEventPacketContainer in) {
+	caerVisualizerAccumulator accumulator = &state->accumulation->accumulator;
+
+	accumulator->accumulationTime = state->accumulationTime.load(std::memory_order_relaxed);
+
+	// Multiple inputs can each contribute a polarity packet.
+	CAER_EVENT_PACKET_CONTAINER_ITERATOR_START(in)
+			if (caerEventPacketHeaderGetEventType(caerEventPacketContainerIteratorElement) == POLARITY_EVENT) {
+				caerVisualizerAccumulatorAddPolarity(accumulator, caerEventPacketContainerIteratorElement);
+			}
+		CAER_EVENT_PACKET_CONTAINER_ITERATOR_END
+}
+
+static void publishAccumulation(caerVisualizerState state, std::chrono::steady_clock::time_point arrivalTime) {
+	visualizerAccumulation accumulation = state->accumulation;
+
+	// Render thread didn't take the last image yet, a new one would only be
+	// thrown away. This limits publishing to the rate of the render thread.
+	if (accumulation->transferReady.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	caerVisualizerAccumulatorRender(&accumulation->accumulator, accumulation->mainloopPixels.data());
+
+	accumulation->mainloopPixels.swap(accumulation->transferPixels);
+	accumulation->transferArrivalTime = arrivalTime;
+
+	accumulation->transferReady.store(true, std::memory_order_release);
+}
+
+static bool initDecimation(caerModuleData moduleData) {
+	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
+
+	state->decimation = nullptr;
+	state->decimationUpdate.store(false);
+
+	// Polarity events go to the accumulator instead of being copied. Tiles
+	// and software rendering always show all of the render area.
+	if (state->accumulation != nullptr || state->viewsLength != 1 || state->software) {
+		return (true);
+	}
+
+	try {
+		state->decimation = new caer_visualizer_decimation();
+
+		// A single view's render coordinates are its events' coordinates.
+		caerVisualizerDecimationInit(state->decimation, state->views[0].publicState.renderSizeX,
+			state->views[0].publicState.renderSizeY);
+	}
+	catch (const std::bad_alloc &) {
+		delete state->decimation;
+		state->decimation = nullptr;
+
+		return (false);
+	}
+
+	updateDecimation(state);
+
+	return (true);
+}
+
+static void updateDecimation(caerVisualizerState state) {
+	const float zoomFactor = sshsNodeGetFloat(state->visualizerConfigNode, "zoomFactor");
+
+	// Zoomed out, several pixels share one display pixel.
+	const uint32_t cellSize = (zoomFactor < 1.0f) ? (U32T(1.0f / zoomFactor)) : (1);
+
+	caerVisualizerDecimationConfigure(state->decimation,
+		U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiPositionX")),
+		U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiPositionY")),
+		U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiSizeX")),
+		U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiSizeY")), cellSize);
+}
+
+static caerEventPacketContainer copyContainerWithoutPolarity(caerEventPacketContainer in) {
+	caerEventPacketContainer containerCopy = nullptr;
+	int32_t copyIndex = 0;
+
+	CAER_EVENT_PACKET_CONTAINER_ITERATOR_START(in)
+			if (caerEventPacketHeaderGetEventType(caerEventPacketContainerIteratorElement) == POLARITY_EVENT
+				|| caerEventPacketHeaderGetEventValid(caerEventPacketContainerIteratorElement) == 0) {
+				continue;
+			}
+
+			// Only allocate a container when there is something to put into it.
+			if (containerCopy == nullptr) {
+				containerCopy = caerEventPacketContainerAllocate(caerEventPacketContainerGetEventPacketsNumber(in));
+				if (containerCopy == nullptr) {
+					return (nullptr);
+				}
+			}
+
+			caerEventPacketHeader packetCopy = caerEventPacketCopyOnlyEvents(caerEventPacketContainerIteratorElement);
+			if (packetCopy == nullptr) {
+				continue;
+			}
+
+			caerEventPacketContainerSetEventPacket(containerCopy, copyIndex++, packetCopy);
+		CAER_EVENT_PACKET_CONTAINER_ITERATOR_END
+
+	return (containerCopy);
+}
+
+static caerEventPacketContainer copyContainerDecimated(caerEventPacketContainer in, caerVisualizerDecimation decimation) {
+	caerEventPacketContainer containerCopy = nullptr;
+	int32_t copyIndex = 0;
+
+	CAER_EVENT_PACKET_CONTAINER_ITERATOR_START(in)
+			if (caerEventPacketHeaderGetEventValid(caerEventPacketContainerIteratorElement) == 0) {
+				continue;
+			}
+
+			// Only polarity events are decimated, other packets are copied whole.
+			caerEventPacketHeader packetCopy =
+				(caerEventPacketHeaderGetEventType(caerEventPacketContainerIteratorElement) == POLARITY_EVENT) ?
+					(caerVisualizerDecimationCopyPolarity(decimation, caerEventPacketContainerIteratorElement)) :
+					(caerEventPacketCopyOnlyEvents(caerEventPacketContainerIteratorElement));
+			if (packetCopy == nullptr) {
+				continue;
+			}
+
+			// Only allocate a container when there is something to put into it.
+			if (containerCopy == nullptr) {
+				containerCopy = caerEventPacketContainerAllocate(caerEventPacketContainerGetEventPacketsNumber(in));
+				if (containerCopy == nullptr) {
+					free(packetCopy);
+					return (nullptr);
+				}
+			}
+
+			caerEventPacketContainerSetEventPacket(containerCopy, copyIndex++, packetCopy);
+		CAER_EVENT_PACKET_CONTAINER_ITERATOR_END
+
+	return (containerCopy);
+}
+
+// The selection shares its packets with the original container, so it
+// must be freed with releaseSourcePackets(), which leaves them alone.
+static caerEventPacketContainer selectSourcePackets(caerEventPacketContainer in, int16_t sourceID) {
+	caerEventPacketContainer selection = nullptr;
+	int32_t selectionIndex = 0;
+
+	CAER_EVENT_PACKET_CONTAINER_ITERATOR_START(in)
+			if (caerEventPacketHeaderGetEventSource(caerEventPacketContainerIteratorElement) != sourceID) {
+				continue;
+			}
+
+			// Only allocate a container when there is something to put into it.
+			if (selection == nullptr) {
+				selection = caerEventPacketContainerAllocate(caerEventPacketContainerGetEventPacketsNumber(in));
+				if (selection == nullptr) {
+					return (nullptr);
+				}
+			}
+
+			caerEventPacketContainerSetEventPacket(selection, selectionIndex++,
+				caerEventPacketContainerIteratorElement);
+		CAER_EVENT_PACKET_CONTAINER_ITERATOR_END
+
+	return (selection);
+}
+
+static void releaseSourcePackets(caerEventPacketContainer selection) {
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(selection); i++) {
+		caerEventPacketContainerSetEventPacket(selection, i, nullptr);
+	}
+
+	caerEventPacketContainerFree(selection);
+}
+
+static bool initRemote(caerModuleData moduleData) {
+	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
+
+	if (!sshsNodeGetBool(moduleData->moduleNode, "remoteServer")) {
+		state->remote = nullptr;
+		return (true);
+	}
+
+	state->remote = new (std::nothrow) visualizer_remote();
+	if (state->remote == nullptr) {
+		return (false);
+	}
+
+	state->remote->server = caerVisualizerServerInit(moduleData,
+		sshsNodeGetStdString(moduleData->moduleNode, "remoteIpAddress").c_str(),
+		U16T(sshsNodeGetInt(moduleData->moduleNode, "remotePortNumber")),
+		(size_t) sshsNodeGetShort(moduleData->moduleNode, "remoteConcurrentConnections"),
+		U32T(sshsNodeGetInt(moduleData->moduleNode, "remoteDecimation")));
+	if (state->remote->server == nullptr) {
+		delete state->remote;
+		state->remote = nullptr;
+
+		return (false);
+	}
+
+	state->remote->framePeriod = std::chrono::microseconds(
+		1000000 / sshsNodeGetInt(moduleData->moduleNode, "remoteFPS"));
+	state->remote->nextFrame = std::chrono::steady_clock::now();
+
+	return (true);
+}
+
+static void exitRemote(caerVisualizerState state) {
+	if (state->remote == nullptr) {
+		return;
+	}
+
+	caerVisualizerServerExit(state->remote->server);
+
+	delete state->remote;
+	state->remote = nullptr;
+}
+
+static void sendRemote(caerVisualizerState state, const uint8_t *pixels) {
+	visualizerRemote remote = state->remote;
+
+	// Reading back the window is expensive, only do it when somebody is watching.
+	if (!caerVisualizerServerHasClients(remote->server)) {
+		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+
+	if (now < remote->nextFrame) {
+		return;
+	}
+
+	remote->nextFrame += remote->framePeriod;
+
+	// Don't send a burst of frames after pauses in rendering.
+	if (remote->nextFrame < now) {
+		remote->nextFrame = now;
+	}
+
+	// Headless mode already has the frame, the window is read back only now.
+	// This must happen before display().
+	if (pixels == nullptr) {
+		pixels = state->canvas->readPixels();
+		if (pixels == nullptr) {
+			return;
+		}
+	}
+
+	const sf::Vector2u size = state->canvas->getSize();
+
+	caerVisualizerServerPut(remote->server, pixels, size.x, size.y);
 }
 
 static bool initGraphics(caerModuleData moduleData) {
 	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
 
+	state->encoder = nullptr;
+
+	if (state->software) {
+		// Memory framebuffer, sized by updateDisplaySize(). No OpenGL context,
+		// window or font are needed.
+		state->renderWindow = nullptr;
+		state->renderTexture = nullptr;
+		state->font = nullptr;
+		state->canvas = caerVisualizerCanvasInitFramebuffer(state->renderSizeX, state->renderSizeY);
+
+		updateDisplaySize(state);
+
+		return (true);
+	}
+
 	// Create OpenGL context. Depending on flag, either an OpenGL 2.1
 	// default (compatibility) context, so it can be used with SFML graphics,
 	// or an OpenGL 3.3 context with core profile, so it can do 3D everywhere,
@@ -458,7 +1242,8 @@ static bool initGraphics(caerModuleData moduleData) {
 	openGLSettings.depthBits = 24;
 	openGLSettings.stencilBits = 8;
 
-	if (state->renderer->needsOpenGL3) {
+	// Multiple views never need it, see initRenderersHandlers().
+	if (state->views[0].renderer->needsOpenGL3) {
 		openGLSettings.majorVersion = 3;
 		openGLSettings.minorVersion = 3;
 		openGLSettings.attributeFlags = sf::ContextSettings::Core;
@@ -469,21 +1254,45 @@ static bool initGraphics(caerModuleData moduleData) {
 		openGLSettings.attributeFlags = sf::ContextSettings::Default;
 	}
 
-	// Create display window and set its title.
-	state->renderWindow = new sf::RenderWindow(sf::VideoMode(state->renderSizeX, state->renderSizeY),
-		moduleData->moduleSubSystemString, sf::Style::Titlebar | sf::Style::Close, openGLSettings);
-	if (state->renderWindow == nullptr) {
-		caerModuleLog(moduleData, CAER_LOG_ERROR,
-			"Failed to create display window with sizeX=%" PRIu32 ", sizeY=%" PRIu32 ".", state->renderSizeX,
-			state->renderSizeY);
-		return (false);
+	if (state->headless) {
+		// Offscreen texture instead of a window. It still needs an OpenGL
+		// context, without a display one can be had from Xvfb, for example.
+		// Sized by updateDisplaySize(), the texture has no settings parameter
+		// in older SFML, so it always gets a default context.
+		state->renderWindow = nullptr;
+		state->renderTexture = new sf::RenderTexture();
+
+		if (!updateDisplaySize(state)) {
+			caerModuleLog(moduleData, CAER_LOG_ERROR,
+				"Failed to create offscreen texture with sizeX=%" PRIu32 ", sizeY=%" PRIu32 ".", state->renderSizeX,
+				state->renderSizeY);
+
+			delete state->renderTexture;
+			return (false);
+		}
 	}
+	else {
+		// Create display window and set its title.
+		state->renderTexture = nullptr;
+		state->renderWindow = new sf::RenderWindow(sf::VideoMode(state->renderSizeX, state->renderSizeY),
+			moduleData->moduleSubSystemString, sf::Style::Titlebar | sf::Style::Close, openGLSettings);
+		if (state->renderWindow == nullptr) {
+			caerModuleLog(moduleData, CAER_LOG_ERROR,
+				"Failed to create display window with sizeX=%" PRIu32 ", sizeY=%" PRIu32 ".", state->renderSizeX,
+				state->renderSizeY);
+			return (false);
+		}
 
-	// Set scale transform for display window, update sizes.
-	updateDisplaySize(state);
+		// Frame pacing is done by the render thread (maxFPS), VSync would
+		// block on display() and distort it.
+		state->renderWindow->setVerticalSyncEnabled(false);
 
-	// Set window position.
-	updateDisplayLocation(state);
+		// Set scale transform for display window, update sizes.
+		updateDisplaySize(state);
+
+		// Set window position.
+		updateDisplayLocation(state);
+	}
 
 	// Load font here to have it always available on request.
 	state->font = new sf::Font();
@@ -501,27 +1310,146 @@ static bool initGraphics(caerModuleData moduleData) {
 		}
 	}
 
+	// Renderers draw through the canvas, whatever is below it.
+	if (state->headless) {
+		state->canvas = caerVisualizerCanvasInitTexture(state->renderTexture, state->font);
+	}
+	else {
+		state->canvas = caerVisualizerCanvasInitWindow(state->renderWindow, state->font);
+	}
+
 	return (true);
 }
 
 static void exitGraphics(caerModuleData moduleData) {
 	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
 
+	if (state->headless) {
+		// Write out remaining frames.
+		if (state->encoder != nullptr) {
+			caerVisualizerEncoderExit(state->encoder);
+			state->encoder = nullptr;
+		}
+
+		delete state->canvas;
+		delete state->font;
+		delete state->renderTexture;
+
+		return;
+	}
+
 	// Save visualizer window location in config.
 	saveDisplayLocation(state);
 
 	// Close rendering window and free memory.
 	state->renderWindow->close();
 
+	delete state->canvas;
 	delete state->font;
 	delete state->renderWindow;
 }
 
-static void updateDisplaySize(caerVisualizerState state) {
+static void updateLayout(caerVisualizerState state) {
+	size_t columns = (size_t) sshsNodeGetInt(state->visualizerConfigNode, "viewColumns");
+
+	if (columns == 0) {
+		// As square as possible.
+		columns = (size_t) ceil(sqrt((double) state->viewsLength));
+	}
+
+	if (columns > state->viewsLength) {
+		columns = state->viewsLength;
+	}
+
+	const size_t rows = (state->viewsLength + columns - 1) / columns;
+
+	// Views are placed row by row. Each column is as wide as its widest
+	// view, each row as high as its highest one.
+	std::vector<uint32_t> columnPositions(columns + 1, 0);
+	std::vector<uint32_t> rowPositions(rows + 1, 0);
+
+	for (size_t i = 0; i < state->viewsLength; i++) {
+		const struct caer_visualizer_public_state &view = state->views[i].publicState;
+
+		columnPositions[(i % columns) + 1] = std::max(columnPositions[(i % columns) + 1], view.renderSizeX);
+		rowPositions[(i / columns) + 1] = std::max(rowPositions[(i / columns) + 1], view.renderSizeY);
+	}
+
+	for (size_t i = 1; i <= columns; i++) {
+		columnPositions[i] += columnPositions[i - 1];
+	}
+
+	for (size_t i = 1; i <= rows; i++) {
+		rowPositions[i] += rowPositions[i - 1];
+	}
+
+	for (size_t i = 0; i < state->viewsLength; i++) {
+		state->views[i].positionX = columnPositions[i % columns];
+		state->views[i].positionY = rowPositions[i / columns];
+	}
+
+	// The whole window, statistics are placed below it.
+	state->renderSizeX = columnPositions[columns];
+	state->renderSizeY = rowPositions[rows];
+}
+
+// Only a single view can show a region of interest, its render coordinates
+// are the event coordinates the region is given in. Tiles show everything.
+static void updateRegionOfInterest(caerVisualizerState state) {
+	state->roiPositionX = 0;
+	state->roiPositionY = 0;
+	state->roiSizeX = state->renderSizeX;
+	state->roiSizeY = state->renderSizeY;
+
+	if (state->viewsLength != 1) {
+		return;
+	}
+
+	const uint32_t roiPositionX = U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiPositionX"));
+	const uint32_t roiPositionY = U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiPositionY"));
+	const uint32_t roiSizeX = U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiSizeX"));
+	const uint32_t roiSizeY = U32T(sshsNodeGetInt(state->visualizerConfigNode, "roiSizeY"));
+
+	// Clip to the render area, the same way the decimation does.
+	state->roiPositionX = std::min(roiPositionX, state->renderSizeX - 1);
+	state->roiPositionY = std::min(roiPositionY, state->renderSizeY - 1);
+
+	const uint32_t maxSizeX = state->renderSizeX - state->roiPositionX;
+	const uint32_t maxSizeY = state->renderSizeY - state->roiPositionY;
+
+	state->roiSizeX = (roiSizeX == 0 || roiSizeX > maxSizeX) ? (maxSizeX) : (roiSizeX);
+	state->roiSizeY = (roiSizeY == 0 || roiSizeY > maxSizeY) ? (maxSizeY) : (roiSizeY);
+}
+
+static bool updateDisplaySize(caerVisualizerState state) {
+	// Headless output size can't change once frames are being written.
+	if (state->headless && state->encoder != nullptr) {
+		return (true);
+	}
+
+	updateLayout(state);
+
+	if (state->software) {
+		// Memory framebuffer has exactly the render size. There is no view
+		// to zoom it with, and no text for statistics.
+		state->showStatistics = false;
+
+		const sf::Vector2u oldSize = state->canvas->getSize();
+
+		if ((state->renderSizeX != oldSize.x) || (state->renderSizeY != oldSize.y)) {
+			delete state->canvas;
+			state->canvas = caerVisualizerCanvasInitFramebuffer(state->renderSizeX, state->renderSizeY);
+		}
+
+		return (true);
+	}
+
+	updateRegionOfInterest(state);
+
 	state->showStatistics = sshsNodeGetBool(state->visualizerConfigNode, "showStatistics");
 	float zoomFactor = sshsNodeGetFloat(state->visualizerConfigNode, "zoomFactor");
 
-	sf::Vector2u newRenderWindowSize(state->renderSizeX, state->renderSizeY);
+	sf::Vector2u newRenderWindowSize(state->roiSizeX, state->roiSizeY);
 
 	// When statistics are turned on, we need to add some space to the
 	// X axis for displaying the whole line and the Y axis for spacing.
@@ -533,19 +1461,43 @@ static void updateDisplaySize(caerVisualizerState state) {
 		newRenderWindowSize.y += STATISTICS_HEIGHT;
 	}
 
-	// Set view size to render area.
-	state->renderWindow->setView(sf::View(sf::FloatRect(0, 0, newRenderWindowSize.x, newRenderWindowSize.y)));
+	// Content shows the region of interest, in the upper left part of the
+	// window. Statistics are drawn below it, with their own view.
+	sf::View renderView(sf::FloatRect(state->roiPositionX, state->roiPositionY, state->roiSizeX, state->roiSizeY));
+	renderView.setViewport(sf::FloatRect(0, 0, (float) state->roiSizeX / (float) newRenderWindowSize.x,
+		(float) state->roiSizeY / (float) newRenderWindowSize.y));
 
 	// Apply zoom to all content.
 	newRenderWindowSize.x *= zoomFactor;
 	newRenderWindowSize.y *= zoomFactor;
 
+	if (state->headless) {
+		// Offscreen texture has exactly the zoomed size, (re-)create it.
+		sf::Vector2u oldSize = (state->renderTexture->getSize());
+
+		if ((newRenderWindowSize.x != oldSize.x) || (newRenderWindowSize.y != oldSize.y)) {
+			if (!state->renderTexture->create(newRenderWindowSize.x, newRenderWindowSize.y, true)) {
+				return (false);
+			}
+		}
+
+		// Set view size to render area.
+		state->renderTexture->setView(renderView);
+
+		return (true);
+	}
+
+	// Set view size to render area.
+	state->renderWindow->setView(renderView);
+
 	// Set window size to zoomed area (only if value changed!).
 	sf::Vector2u oldSize = state->renderWindow->getSize();
 
 	if ((newRenderWindowSize.x != oldSize.x) || (newRenderWindowSize.y != oldSize.y)) {
 		state->renderWindow->setSize(newRenderWindowSize);
 	}
+
+	return (true);
 }
 
 static void updateDisplayLocation(caerVisualizerState state) {
@@ -564,6 +1516,12 @@ static void saveDisplayLocation(caerVisualizerState state) {
 	sshsNodePutInt(state->visualizerConfigNode, "windowPositionY", currPos.y);
 }
 
+// Window creation, event handling and destruction happen on the main thread
+// where the OS requires it, headless rendering always stays on its own thread.
+static inline bool graphicsOnMainThread(caerVisualizerState state) {
+	return ((VISUALIZER_HANDLE_EVENTS_MAIN == 1) && !state->headless);
+}
+
 static void handleEvents(caerModuleData moduleData) {
 	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
 
@@ -689,33 +1647,130 @@ static void handleEvents(caerModuleData moduleData) {
 	}
 }
 
-static void renderScreen(caerModuleData moduleData) {
+static bool renderAccumulation(caerVisualizerState state, std::chrono::steady_clock::time_point *arrivalTime) {
+	visualizerAccumulation accumulation = state->accumulation;
+
+	if (!accumulation->transferReady.load(std::memory_order_acquire)) {
+		return (false);
+	}
+
+	// Take the pixels, the old ones are overwritten by the next image.
+	accumulation->image.pixels.swap(accumulation->transferPixels);
+	caerVisualizerImageChanged(&accumulation->image, 0, accumulation->image.sizeY);
+
+	accumulation->haveImage = true;
+
+	*arrivalTime = accumulation->transferArrivalTime;
+
+	// Hand buffer back to the mainloop for the next image.
+	accumulation->transferReady.store(false, std::memory_order_release);
+
+	return (true);
+}
+
+static bool renderView(caerVisualizerState state, visualizerView view, caerEventPacketContainer container,
+	bool accumulationReady) {
+	caerVisualizerCanvas target = (view->tileBack != nullptr) ? (view->tileBack) : (state->canvas);
+
+	// The window's canvas changes when the framebuffer is resized.
+	view->publicState.canvas = target;
+
+	bool drewSomething = false;
+
+	// The accumulated image goes below the content of the first view, and is
+	// redrawn with it, as its target is cleared after each display.
+	if (view == &state->views[0] && state->accumulation != nullptr) {
+		drewSomething = accumulationReady;
+
+		if ((accumulationReady || container != nullptr) && state->accumulation->haveImage) {
+			target->drawImage(&state->accumulation->image, sf::Vector2f(0, 0));
+		}
+	}
+
+	// Update view with new content. (0, 0) is upper left corner.
+	// NULL renderer is supported and simply does nothing (black screen).
+	if (container != nullptr && view->renderer->renderer != nullptr) {
+		caerEventPacketContainer viewContainer =
+			(view->sourceID == -1) ? (container) : (selectSourcePackets(container, view->sourceID));
+
+		if (viewContainer != nullptr) {
+			bool drewContainer = (*view->renderer->renderer)((caerVisualizerPublicState) view, viewContainer);
+
+			drewSomething = (drewSomething || drewContainer);
+
+			if (viewContainer != container) {
+				releaseSourcePackets(viewContainer);
+			}
+		}
+	}
+
+	if (view->tileBack != nullptr) {
+		// Show the new content, and start over on the old one.
+		if (drewSomething) {
+			view->tileBack->display();
+
+			std::swap(view->tileFront, view->tileBack);
+		}
+
+		view->tileBack->clear(sf::Color::Black);
+	}
+
+	return (drewSomething);
+}
+
+static void renderScreen(caerModuleData moduleData, visualizerRenderStatistics statistics) {
 	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
 
-	// TODO: rethink this, implement max FPS control, FPS count,
-	// and multiple render passes per displayed frame.
-	caerEventPacketContainer container = (caerEventPacketContainer) caerRingBufferGet(state->dataTransfer);
+	// TODO: multiple render passes per displayed frame.
+	visualizerTransfer transfer = (visualizerTransfer) caerRingBufferGet(state->dataTransfer);
 
-	repeat: if (container != nullptr) {
+	repeat: if (transfer != nullptr) {
 		// Are there others? Only render last one, to avoid getting backed up!
-		caerEventPacketContainer container2 = (caerEventPacketContainer) caerRingBufferGet(state->dataTransfer);
+		visualizerTransfer transfer2 = (visualizerTransfer) caerRingBufferGet(state->dataTransfer);
+
+		if (transfer2 != nullptr) {
+			caerEventPacketContainerFree(transfer->container);
+			delete transfer;
+			state->droppedContainers.fetch_add(1, std::memory_order_relaxed);
 
-		if (container2 != nullptr) {
-			caerEventPacketContainerFree(container);
-			container = container2;
+			transfer = transfer2;
 			goto repeat;
 		}
 	}
 
-	bool drewSomething = false;
+	caerEventPacketContainer container = nullptr;
+	std::chrono::steady_clock::time_point arrivalTime;
 
-	if (container != nullptr) {
-		// Update render window with new content. (0, 0) is upper left corner.
-		// NULL renderer is supported and simply does nothing (black screen).
-		if (state->renderer->renderer != nullptr) {
-			drewSomething = (*state->renderer->renderer)((caerVisualizerPublicState) state, container);
+	if (transfer != nullptr) {
+		container = transfer->container;
+		arrivalTime = transfer->arrivalTime;
+
+		delete transfer;
+	}
+
+	bool accumulationReady = false;
+
+	if (state->accumulation != nullptr) {
+		std::chrono::steady_clock::time_point accumulationArrivalTime;
+
+		accumulationReady = renderAccumulation(state, &accumulationArrivalTime);
+
+		// Latency is measured for the most recent data.
+		if (accumulationReady && (container == nullptr || accumulationArrivalTime > arrivalTime)) {
+			arrivalTime = accumulationArrivalTime;
 		}
+	}
+
+	// All views share the same container copy.
+	bool drewSomething = false;
+
+	for (size_t i = 0; i < state->viewsLength; i++) {
+		bool drewView = renderView(state, &state->views[i], container, accumulationReady);
 
+		drewSomething = (drewSomething || drewView);
+	}
+
+	if (container != nullptr) {
 		// Free packet container copy.
 		caerEventPacketContainerFree(container);
 	}
@@ -729,7 +1784,7 @@ static void renderScreen(caerModuleData moduleData) {
 	}
 
 	// Handle display move.
-	if (state->windowMove.load(std::memory_order_relaxed)) {
+	if (state->windowMove.load(std::memory_order_relaxed) && !state->headless) {
 		state->windowMove.store(false);
 
 		// Move display location appropriately.
@@ -738,33 +1793,115 @@ static void renderScreen(caerModuleData moduleData) {
 
 	// Render content to display.
 	if (drewSomething) {
+		// Multiple views are composed from their tiles, also the ones
+		// without new content. A single view is in the window already.
+		if (state->viewsLength > 1) {
+			for (size_t i = 0; i < state->viewsLength; i++) {
+				const visualizerView view = &state->views[i];
+
+				state->canvas->drawCanvas(view->tileFront,
+					sf::Vector2f((float) view->positionX, (float) view->positionY));
+			}
+		}
+
 		// Render statistics string.
 		// TODO: implement for OpenGL 3.3 too, using some text rendering library.
-		bool doStatistics = (state->showStatistics && state->font != nullptr && !state->renderer->needsOpenGL3);
+		bool doStatistics = (state->showStatistics && !state->views[0].renderer->needsOpenGL3);
 
 		if (doStatistics) {
+			// Statistics have their own view, covering the whole window, as the
+			// content's only covers the region of interest.
+			sf::RenderTarget *target =
+				(state->headless) ?
+					(static_cast<sf::RenderTarget *>(state->renderTexture)) :
+					(static_cast<sf::RenderTarget *>(state->renderWindow));
+
+			const sf::View contentView = target->getView();
+
+			target->setView(
+				sf::View(
+					sf::FloatRect(0, 0, std::max(state->roiSizeX, STATISTICS_WIDTH),
+						state->roiSizeY + STATISTICS_HEIGHT)));
+
 			// Split statistics string in two to use less horizontal space.
 			// Put it below the normal render region, so people can access from
 			// (0,0) to (x-1,y-1) normally without fear of overwriting statistics.
-			sf::Text totalEventsText(state->packetStatistics.currentStatisticsStringTotal, *state->font,
-			GLOBAL_FONT_SIZE);
-			sfml::Helpers::setTextColor(totalEventsText, sf::Color::White);
-			totalEventsText.setPosition(GLOBAL_FONT_SPACING, state->renderSizeY);
-			state->renderWindow->draw(totalEventsText);
+			state->canvas->drawText(state->packetStatistics.currentStatisticsStringTotal,
+				sf::Vector2f(GLOBAL_FONT_SPACING, state->roiSizeY), GLOBAL_FONT_SIZE, sf::Color::White);
+
+			state->canvas->drawText(state->packetStatistics.currentStatisticsStringValid,
+				sf::Vector2f(GLOBAL_FONT_SPACING, state->roiSizeY + GLOBAL_FONT_SIZE), GLOBAL_FONT_SIZE,
+				sf::Color::White);
+
+			target->setView(contentView);
+		}
+
+		if (state->headless) {
+			// Read back finished frame and pass it to the encoder. If that
+			// fails, NULL makes the encoder repeat the last frame.
+			const uint8_t *frame = state->canvas->readPixels();
+
+			if (!caerVisualizerEncoderPut(state->encoder, frame)) {
+				caerModuleLog(moduleData, CAER_LOG_INFO, "Headless output queue full, dropping frame.");
+			}
 
-			sf::Text validEventsText(state->packetStatistics.currentStatisticsStringValid, *state->font,
-			GLOBAL_FONT_SIZE);
-			sfml::Helpers::setTextColor(validEventsText, sf::Color::White);
-			validEventsText.setPosition(GLOBAL_FONT_SPACING, state->renderSizeY + GLOBAL_FONT_SIZE);
-			state->renderWindow->draw(validEventsText);
+			if (state->remote != nullptr && frame != nullptr) {
+				sendRemote(state, frame);
+			}
+		}
+		else {
+			if (state->remote != nullptr) {
+				sendRemote(state, nullptr);
+			}
+
+			// Draw to screen.
+			state->canvas->display();
 		}
 
-		// Draw to screen.
-		state->renderWindow->display();
+		statistics->frames++;
+
+		if (arrivalTime != std::chrono::steady_clock::time_point()) {
+			statistics->latencySum += std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - arrivalTime);
+			statistics->latencyCount++;
+		}
 
 		// Reset window to all black for next rendering pass.
-		state->renderWindow->clear(sf::Color::Black);
+		state->canvas->clear(sf::Color::Black);
+	}
+	else if (state->headless) {
+		// Output runs at a fixed rate, repeat the last frame.
+		caerVisualizerEncoderPut(state->encoder, nullptr);
+	}
+}
+
+static void updateRenderStatistics(caerModuleData moduleData, visualizerRenderStatistics statistics) {
+	caerVisualizerState state = (caerVisualizerState) moduleData->moduleState;
+
+	const auto now = std::chrono::steady_clock::now();
+	const auto interval = std::chrono::duration_cast<std::chrono::microseconds>(now - statistics->intervalStart);
+
+	// Publish once per second.
+	if (interval.count() < 1000000) {
+		return;
 	}
+
+	union sshs_node_attr_value value;
+
+	value.ffloat = (float) (((double) statistics->frames * 1000000.0) / (double) interval.count());
+	sshsNodeUpdateReadOnlyAttribute(moduleData->moduleNode, "renderedFPS", SSHS_FLOAT, value);
+
+	value.ilong = I64T(state->droppedContainers.load(std::memory_order_relaxed));
+	sshsNodeUpdateReadOnlyAttribute(moduleData->moduleNode, "droppedContainers", SSHS_LONG, value);
+
+	value.iint = (statistics->latencyCount == 0) ?
+		(0) : (I32T(statistics->latencySum.count() / statistics->latencyCount));
+	sshsNodeUpdateReadOnlyAttribute(moduleData->moduleNode, "renderLatency", SSHS_INT, value);
+
+	statistics->intervalStart = now;
+	statistics->frames = 0;
+	statistics->latencyCount = 0;
+	statistics->latencySum = std::chrono::microseconds(0);
 }
 
 static int renderThread(void *inModuleData) {
@@ -778,77 +1915,141 @@ static int renderThread(void *inModuleData) {
 	// Set thread name.
 	thrd_set_name(moduleData->moduleSubSystemString);
 
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 0
-	// Initialize graphics on separate thread. Mostly to avoid Windows quirkiness.
-	if (!initGraphics(moduleData)) {
-		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize rendering window.");
-		return (thrd_error);
+	if (!graphicsOnMainThread(state)) {
+		// Initialize graphics on separate thread. Mostly to avoid Windows quirkiness.
+		if (!initGraphics(moduleData)) {
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize rendering window.");
+			return (thrd_error);
+		}
 	}
-#endif
 
-	// Ensure OpenGL context is active, whether it was created in this thread
-	// or on the main thread.
-	state->renderWindow->setActive(true);
+	// Software rendering has no OpenGL context at all.
+	if (!state->software) {
+		// Ensure OpenGL context is active, whether it was created in this thread
+		// or on the main thread.
+		if (state->headless) {
+			state->renderTexture->setActive(true);
+		}
+		else {
+			state->renderWindow->setActive(true);
+		}
+
+		// Initialize GLEW. glewInit() should be called after every context change,
+		// since we have one context per visualizer, always active only in this one
+		// rendering thread, we can just do it here once and always be fine.
+		GLenum res = glewInit();
+		if (res != GLEW_OK) {
+			if (!graphicsOnMainThread(state)) {
+				exitGraphics(moduleData); // Destroy on error.
+			}
 
-	// Initialize GLEW. glewInit() should be called after every context change,
-	// since we have one context per visualizer, always active only in this one
-	// rendering thread, we can just do it here once and always be fine.
-	GLenum res = glewInit();
-	if (res != GLEW_OK) {
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 0
-		exitGraphics(moduleData); // Destroy on error.
-#endif
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize GLEW, error: %s.",
+				glewGetErrorString(res));
+			return (thrd_error);
+		}
+	}
 
-		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize GLEW, error: %s.", glewGetErrorString(res));
+	// Initialize renderer states, and tiles for multiple views.
+	if (!initRenderStates(moduleData)) {
+		if (!graphicsOnMainThread(state)) {
+			exitGraphics(moduleData); // Destroy on error.
+		}
+
+		// Failed at requested state initialization, error out!
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize renderer state.");
 		return (thrd_error);
 	}
 
-	// Initialize renderer state.
-	if (state->renderer->stateInit != nullptr) {
-		state->renderState = (*state->renderer->stateInit)((caerVisualizerPublicState) state);
-		if (state->renderState == nullptr) {
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 0
+	if (state->headless) {
+		// Output size is final now, renderer state init can change it.
+		const sf::Vector2u outputSize = state->canvas->getSize();
+
+		state->encoder = caerVisualizerEncoderInit(moduleData,
+			sshsNodeGetStdString(moduleData->moduleNode, "headlessFormat"),
+			sshsNodeGetStdString(moduleData->moduleNode, "headlessOutput"), outputSize.x, outputSize.y,
+			U32T(sshsNodeGetInt(moduleData->moduleNode, "headlessFPS")));
+		if (state->encoder == nullptr) {
+			exitRenderStates(state);
+
 			exitGraphics(moduleData); // Destroy on error.
-#endif
 
-			// Failed at requested state initialization, error out!
-			caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize renderer state.");
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize headless output.");
 			return (thrd_error);
 		}
 	}
 
+	if (!initRemote(moduleData)) {
+		exitRenderStates(state);
+
+		exitGraphics(moduleData); // Destroy on error.
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize remote server.");
+		return (thrd_error);
+	}
+
 	// Initialize window by clearing it to all black.
-	state->renderWindow->clear(sf::Color::Black);
-	state->renderWindow->display();
+	state->canvas->clear(sf::Color::Black);
+
+	if (!state->headless) {
+		state->canvas->display();
+	}
+
+	// Headless mode renders at exactly the output frame rate, windowed
+	// mode at most at maxFPS, which can change at any time.
+	const uint32_t headlessFPS = U32T(sshsNodeGetInt(moduleData->moduleNode, "headlessFPS"));
+
+	struct visualizer_render_statistics statistics;
+	statistics.intervalStart = std::chrono::steady_clock::now();
+	statistics.frames = 0;
+	statistics.latencyCount = 0;
+	statistics.latencySum = std::chrono::microseconds(0);
+
+	auto nextFrame = std::chrono::steady_clock::now();
 
 	while (state->running.load(std::memory_order_relaxed)) {
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 0
-		handleEvents(moduleData);
-#endif
+		if (!state->headless && !graphicsOnMainThread(state)) {
+			handleEvents(moduleData);
+		}
 
-		renderScreen(moduleData);
-	}
+		renderScreen(moduleData, &statistics);
+
+		updateRenderStatistics(moduleData, &statistics);
+
+		const uint32_t fps = (state->headless) ? (headlessFPS) : (U32T(state->maxFPS.load(std::memory_order_relaxed)));
+		nextFrame += std::chrono::microseconds(1000000 / fps);
+
+		const auto now = std::chrono::steady_clock::now();
 
-	// Destroy render state, if it exists.
-	if ((state->renderer->stateExit != nullptr) && (state->renderState != nullptr)
-		&& (state->renderState != CAER_VISUALIZER_RENDER_INIT_NO_MEM)) {
-		(*state->renderer->stateExit)((caerVisualizerPublicState) state);
+		// Don't try to catch up when displaying: that would only render a
+		// burst of frames nobody can see. Headless output must keep its
+		// frame count matched to real time instead.
+		if (!state->headless && nextFrame < now) {
+			nextFrame = now;
+		}
+
+		std::this_thread::sleep_until(nextFrame);
 	}
 
-#if VISUALIZER_HANDLE_EVENTS_MAIN == 0
-	// Destroy graphics objects on same thread that created them.
-	exitGraphics(moduleData);
-#endif
+	exitRemote(state);
+
+	// Destroy render states, if they exist.
+	exitRenderStates(state);
+
+	if (!graphicsOnMainThread(state)) {
+		// Destroy graphics objects on same thread that created them.
+		exitGraphics(moduleData);
+	}
 
 	return (thrd_success);
 }
 
 void caerVisualizerResetRenderSize(caerVisualizerPublicState pubState, uint32_t newX, uint32_t newY) {
-	caerVisualizerState state = (caerVisualizerState) pubState;
+	// Renderers always get the public state of their view.
+	visualizerView view = (visualizerView) pubState;
 
 	// Set render sizes to new values and force update.
-	state->renderSizeX = newX;
-	state->renderSizeY = newY;
+	view->publicState.renderSizeX = newX;
+	view->publicState.renderSizeY = newY;
 
-	updateDisplaySize(state);
+	updateDisplaySize(view->parent);
 }
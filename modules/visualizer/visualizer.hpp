@@ -7,14 +7,17 @@
 #include <GL/glew.h>
 #include <SFML/Graphics.hpp>
 
+#include "visualizer_canvas.hpp"
+
 struct caer_visualizer_public_state {
 	sshsNode eventSourceConfigNode;
 	sshsNode visualizerConfigNode;
 	uint32_t renderSizeX;
 	uint32_t renderSizeY;
 	void *renderState; // Reserved for renderers to put their internal state into.
-	sf::RenderWindow *renderWindow;
-	sf::Font *font;
+	caerVisualizerCanvas canvas; // Window, offscreen texture or memory framebuffer.
+	uint32_t roiPositionX; // Render position shown in the upper left corner, for event handlers.
+	uint32_t roiPositionY;
 };
 
 typedef const struct caer_visualizer_public_state *caerVisualizerPublicState;
@@ -0,0 +1,123 @@
+#include "visualizer_accumulator.hpp"
+
+#include <libcaercpp/events/polarity.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// Limit accumulated values, so that very active pixels don't stay saturated
+// for many time constants after they stop firing.
+#define ACCUMULATOR_VALUE_LIMIT 4.0f
+
+const std::string caerVisualizerAccumulationModeListOptionsString = "None,Decay,Window";
+
+caerVisualizerAccumulationMode caerVisualizerAccumulationModeFromString(const std::string &mode) {
+	if (mode == "Decay") {
+		return (caerVisualizerAccumulationMode::DECAY);
+	}
+	else if (mode == "Window") {
+		return (caerVisualizerAccumulationMode::WINDOW);
+	}
+
+	return (caerVisualizerAccumulationMode::NONE);
+}
+
+void caerVisualizerAccumulatorInit(caerVisualizerAccumulator acc, caerVisualizerAccumulationMode mode, uint32_t sizeX,
+	uint32_t sizeY, int64_t accumulationTime) {
+	acc->mode = mode;
+	acc->sizeX = sizeX;
+	acc->sizeY = sizeY;
+	acc->accumulationTime = accumulationTime;
+
+	acc->values.resize(sizeX * sizeY);
+	acc->timestamps.resize(sizeX * sizeY);
+
+	caerVisualizerAccumulatorReset(acc);
+}
+
+void caerVisualizerAccumulatorReset(caerVisualizerAccumulator acc) {
+	acc->currentTimestamp = 0;
+
+	std::fill(acc->values.begin(), acc->values.end(), 0.0f);
+	std::fill(acc->timestamps.begin(), acc->timestamps.end(), 0);
+}
+
+void caerVisualizerAccumulatorAddPolarity(caerVisualizerAccumulator acc, caerEventPacketHeader polarityPacketHeader) {
+	const libcaer::events::PolarityEventPacket polarityPacket(polarityPacketHeader, false);
+
+	const float timeConstant = (float) acc->accumulationTime;
+
+	for (const auto &polarityEvent : polarityPacket) {
+		if (!polarityEvent.isValid()) {
+			continue; // Skip invalid events.
+		}
+
+		uint16_t x = polarityEvent.getX();
+		uint16_t y = polarityEvent.getY();
+
+		if (x >= acc->sizeX || y >= acc->sizeY) {
+			continue; // Outside render area.
+		}
+
+		size_t idx = (y * acc->sizeX) + x;
+		int64_t ts = polarityEvent.getTimestamp64(polarityPacket);
+
+		if (acc->mode == caerVisualizerAccumulationMode::DECAY) {
+			// Decay lazily, only when a pixel is touched. Timestamps going
+			// backwards (loops, resets) just don't decay.
+			int64_t timeDiff = ts - acc->timestamps[idx];
+			float value = acc->values[idx];
+
+			if (timeDiff > 0) {
+				value *= expf(-((float) timeDiff) / timeConstant);
+			}
+
+			value += (polarityEvent.getPolarity()) ? (1.0f) : (-1.0f);
+
+			if (value > ACCUMULATOR_VALUE_LIMIT) {
+				value = ACCUMULATOR_VALUE_LIMIT;
+			}
+			else if (value < -ACCUMULATOR_VALUE_LIMIT) {
+				value = -ACCUMULATOR_VALUE_LIMIT;
+			}
+
+			acc->values[idx] = value;
+		}
+		else {
+			// Window: pixel shows the polarity of its last event.
+			acc->values[idx] = (polarityEvent.getPolarity()) ? (1.0f) : (-1.0f);
+		}
+
+		acc->timestamps[idx] = ts;
+
+		if (ts > acc->currentTimestamp) {
+			acc->currentTimestamp = ts;
+		}
+	}
+}
+
+void caerVisualizerAccumulatorRender(caerVisualizerAccumulator acc, uint8_t *pixels) {
+	const float timeConstant = (float) acc->accumulationTime;
+	const size_t pixelsNumber = acc->values.size();
+
+	for (size_t idx = 0, dstIdx = 0; idx < pixelsNumber; idx++) {
+		int64_t timeDiff = acc->currentTimestamp - acc->timestamps[idx];
+		float value = acc->values[idx];
+
+		if (acc->mode == caerVisualizerAccumulationMode::DECAY) {
+			if (timeDiff > 0) {
+				value *= expf(-((float) timeDiff) / timeConstant);
+			}
+		}
+		else if (timeDiff >= acc->accumulationTime) {
+			value = 0; // Last event fell out of the window.
+		}
+
+		uint8_t intensity = U8T(fminf(fabsf(value), 1.0f) * UINT8_MAX);
+
+		pixels[dstIdx++] = (value < 0) ? (intensity) : (0); // R
+		pixels[dstIdx++] = (value > 0) ? (intensity) : (0); // G
+		pixels[dstIdx++] = 0; // B
+		pixels[dstIdx++] = UINT8_MAX; // A
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef MODULES_VISUALIZER_VISUALIZER_ACCUMULATOR_H_
+#define MODULES_VISUALIZER_VISUALIZER_ACCUMULATOR_H_
+
+#include "visualizer.hpp"
+
+#include <vector>
+
+enum class caerVisualizerAccumulationMode {
+	NONE, DECAY, WINDOW,
+};
+
+// Persistent per-pixel image of polarity events, updated on the mainloop
+// thread with every container, so that no event is lost to the render
+// thread falling behind. Time is taken from event timestamps.
+struct caer_visualizer_accumulator {
+	caerVisualizerAccumulationMode mode;
+	uint32_t sizeX;
+	uint32_t sizeY;
+	/// Decay time constant (DECAY) or window length (WINDOW), in µs.
+	int64_t accumulationTime;
+	/// Timestamp of the newest accumulated event.
+	int64_t currentTimestamp;
+	/// Per-pixel value: ON events count positive, OFF events negative.
+	std::vector<float> values;
+	/// Per-pixel timestamp of the last update of values.
+	std::vector<int64_t> timestamps;
+};
+
+typedef struct caer_visualizer_accumulator *caerVisualizerAccumulator;
+
+extern const std::string caerVisualizerAccumulationModeListOptionsString;
+
+caerVisualizerAccumulationMode caerVisualizerAccumulationModeFromString(const std::string &mode);
+
+void caerVisualizerAccumulatorInit(caerVisualizerAccumulator acc, caerVisualizerAccumulationMode mode, uint32_t sizeX,
+	uint32_t sizeY, int64_t accumulationTime);
+void caerVisualizerAccumulatorReset(caerVisualizerAccumulator acc);
+void caerVisualizerAccumulatorAddPolarity(caerVisualizerAccumulator acc, caerEventPacketHeader polarityPacketHeader);
+// Render the current state as 32-bit RGBA pixels (sizeX * sizeY * 4 bytes).
+// ON is green, OFF is red, brightness follows the accumulated value.
+void caerVisualizerAccumulatorRender(caerVisualizerAccumulator acc, uint8_t *pixels);
+
+#endif /* MODULES_VISUALIZER_VISUALIZER_ACCUMULATOR_H_ */
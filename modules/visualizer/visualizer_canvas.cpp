@@ -0,0 +1,389 @@
+#include "visualizer_canvas.hpp"
+
+#include "ext/sfml/line.hpp"
+#include "ext/sfml/helpers.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void caerVisualizerImageInit(caerVisualizerImage image, uint32_t sizeX, uint32_t sizeY) {
+	image->sizeX = sizeX;
+	image->sizeY = sizeY;
+
+	image->pixels.assign((size_t) sizeX * sizeY * 4, 0);
+
+	image->changedRowStart = 0;
+	image->changedRowEnd = sizeY;
+}
+
+// SFML canvas: draws into a window or an offscreen texture.
+struct caer_visualizer_canvas_sfml: public caer_visualizer_canvas {
+	sf::RenderTarget *target;
+	/// One of the two is set, depending on the target.
+	sf::RenderWindow *window;
+	sf::RenderTexture *texture;
+	/// Tiles created by createCanvas() belong to their canvas.
+	bool ownsTexture;
+	const sf::Font *font;
+	/// Window content is copied here to read it back.
+	sf::Texture capture;
+	sf::Image readBack;
+
+	caer_visualizer_canvas_sfml(sf::RenderWindow *w, sf::RenderTexture *t, bool owns, const sf::Font *f) :
+			target((w != nullptr) ? (static_cast<sf::RenderTarget *>(w)) : (static_cast<sf::RenderTarget *>(t))),
+			window(w),
+			texture(t),
+			ownsTexture(owns),
+			font(f) {
+	}
+
+	~caer_visualizer_canvas_sfml() override {
+		if (ownsTexture) {
+			delete texture;
+		}
+	}
+
+	sf::Vector2u getSize() const override {
+		return (target->getSize());
+	}
+
+	void clear(const sf::Color &color) override {
+		target->clear(color);
+	}
+
+	void drawImage(caer_visualizer_image *image, const sf::Vector2f &position) override {
+		upload(image);
+
+		sf::Sprite sprite(image->texture);
+		sprite.setPosition(position);
+
+		target->draw(sprite);
+	}
+
+	void drawImageQuads(caer_visualizer_image *image, const sf::Vertex *vertices, size_t verticesCount) override {
+		upload(image);
+
+		target->draw(vertices, verticesCount, sf::Quads, sf::RenderStates(&image->texture));
+	}
+
+	void drawLine(const sf::Vector2f &point1, const sf::Vector2f &point2, float thickness, const sf::Color &color)
+		override {
+		target->draw(sfml::Line(point1, point2, thickness, color));
+	}
+
+	void drawCircle(const sf::Vector2f &center, float radius, float thickness, const sf::Color &color) override {
+		sf::CircleShape circle(radius);
+		sfml::Helpers::setOriginToCenter(circle);
+		circle.setFillColor(sf::Color::Transparent);
+		circle.setOutlineColor(color);
+		circle.setOutlineThickness(-thickness);
+		circle.setPosition(center);
+
+		target->draw(circle);
+	}
+
+	void drawText(const std::string &text, const sf::Vector2f &position, uint32_t size, const sf::Color &color)
+		override {
+		if (font == nullptr) {
+			return;
+		}
+
+		sf::Text textShape(text, *font, size);
+		sfml::Helpers::setTextColor(textShape, color);
+		textShape.setPosition(position);
+
+		target->draw(textShape);
+	}
+
+	void drawCanvas(caer_visualizer_canvas *canvas, const sf::Vector2f &position) override {
+		caer_visualizer_canvas_sfml *other = static_cast<caer_visualizer_canvas_sfml *>(canvas);
+
+		// Only offscreen textures can be drawn.
+		sf::Sprite sprite(other->texture->getTexture());
+		sprite.setPosition(position);
+
+		target->draw(sprite);
+	}
+
+	const uint8_t *readPixels() override {
+		if (window != nullptr) {
+			// Copy the back buffer, this must happen before display().
+			const sf::Vector2u windowSize = window->getSize();
+
+			if (capture.getSize() != windowSize && !capture.create(windowSize.x, windowSize.y)) {
+				return (nullptr);
+			}
+
+			capture.update(*window);
+
+			readBack = capture.copyToImage();
+		}
+		else {
+			texture->display();
+
+			readBack = texture->getTexture().copyToImage();
+		}
+
+		return (readBack.getPixelsPtr());
+	}
+
+	void display() override {
+		if (window != nullptr) {
+			window->display();
+		}
+		else {
+			texture->display();
+		}
+	}
+
+	caer_visualizer_canvas *createCanvas(uint32_t sizeX, uint32_t sizeY) override {
+		sf::RenderTexture *tile = new sf::RenderTexture();
+
+		if (!tile->create(sizeX, sizeY)) {
+			delete tile;
+			return (nullptr);
+		}
+
+		return (new caer_visualizer_canvas_sfml(nullptr, tile, true, font));
+	}
+
+private:
+	// Bring the image's texture up-to-date, only changed rows are uploaded.
+	static void upload(caer_visualizer_image *image) {
+		const sf::Vector2u textureSize = image->texture.getSize();
+
+		if (textureSize.x != image->sizeX || textureSize.y != image->sizeY) {
+			if (!image->texture.create(image->sizeX, image->sizeY)) {
+				return;
+			}
+
+			image->texture.setSmooth(false);
+
+			image->changedRowStart = 0;
+			image->changedRowEnd = image->sizeY;
+		}
+
+		if (image->changedRowStart < image->changedRowEnd) {
+			image->texture.update(&image->pixels[(size_t) image->changedRowStart * image->sizeX * 4], image->sizeX,
+				image->changedRowEnd - image->changedRowStart, 0, image->changedRowStart);
+
+			image->changedRowStart = 0;
+			image->changedRowEnd = 0;
+		}
+	}
+};
+
+// Framebuffer canvas: software rendering into memory, for headless use
+// without a GPU or display. Draws like SFML with its default alpha blending,
+// but without anti-aliasing: a pixel is covered if its center is.
+struct caer_visualizer_canvas_framebuffer: public caer_visualizer_canvas {
+	struct caer_visualizer_image frame;
+
+	caer_visualizer_canvas_framebuffer(uint32_t sizeX, uint32_t sizeY) {
+		caerVisualizerImageInit(&frame, sizeX, sizeY);
+	}
+
+	sf::Vector2u getSize() const override {
+		return (sf::Vector2u(frame.sizeX, frame.sizeY));
+	}
+
+	void clear(const sf::Color &color) override {
+		for (size_t i = 0; i < frame.pixels.size(); i += 4) {
+			frame.pixels[i] = color.r;
+			frame.pixels[i + 1] = color.g;
+			frame.pixels[i + 2] = color.b;
+			frame.pixels[i + 3] = color.a;
+		}
+	}
+
+	void drawImage(caer_visualizer_image *image, const sf::Vector2f &position) override {
+		const int32_t positionX = I32T(lroundf(position.x));
+		const int32_t positionY = I32T(lroundf(position.y));
+
+		// Clip to the framebuffer.
+		const int32_t startX = std::max(0, -positionX);
+		const int32_t startY = std::max(0, -positionY);
+		const int32_t endX = std::min(I32T(image->sizeX), I32T(frame.sizeX) - positionX);
+		const int32_t endY = std::min(I32T(image->sizeY), I32T(frame.sizeY) - positionY);
+
+		for (int32_t y = startY; y < endY; y++) {
+			const uint8_t *src = &image->pixels[(((size_t) y * image->sizeX) + (size_t) startX) * 4];
+			uint8_t *dst = &frame.pixels[(((size_t) (y + positionY) * frame.sizeX) + (size_t) (startX + positionX))
+				* 4];
+
+			for (int32_t x = startX; x < endX; x++, src += 4, dst += 4) {
+				blend(dst, src);
+			}
+		}
+	}
+
+	void drawImageQuads(caer_visualizer_image *image, const sf::Vertex *vertices, size_t verticesCount) override {
+		if (image->sizeX == 0 || image->sizeY == 0) {
+			return;
+		}
+
+		for (size_t i = 0; (i + 4) <= verticesCount; i += 4) {
+			const sf::Vertex *quad = &vertices[i];
+
+			const float quadX = quad[0].position.x;
+			const float quadY = quad[0].position.y;
+			const float quadSizeX = quad[2].position.x - quadX;
+			const float quadSizeY = quad[2].position.y - quadY;
+
+			if (quadSizeX <= 0 || quadSizeY <= 0) {
+				continue;
+			}
+
+			int32_t startX, startY, endX, endY;
+			coveredPixels(quadX, quadY, quad[2].position.x, quad[2].position.y, &startX, &startY, &endX, &endY);
+
+			for (int32_t y = startY; y < endY; y++) {
+				const float fy = (((float) y + 0.5f) - quadY) / quadSizeY;
+
+				// Texture coordinates along the left and right edges.
+				const sf::Vector2f left = quad[0].texCoords + ((quad[3].texCoords - quad[0].texCoords) * fy);
+				const sf::Vector2f right = quad[1].texCoords + ((quad[2].texCoords - quad[1].texCoords) * fy);
+
+				uint8_t *dst = &frame.pixels[(((size_t) y * frame.sizeX) + (size_t) startX) * 4];
+
+				for (int32_t x = startX; x < endX; x++, dst += 4) {
+					const float fx = (((float) x + 0.5f) - quadX) / quadSizeX;
+					const sf::Vector2f texCoords = left + ((right - left) * fx);
+
+					const uint32_t texX = U32T(std::min(std::max(texCoords.x, 0.0f), (float) (image->sizeX - 1)));
+					const uint32_t texY = U32T(std::min(std::max(texCoords.y, 0.0f), (float) (image->sizeY - 1)));
+
+					blend(dst, &image->pixels[(((size_t) texY * image->sizeX) + texX) * 4]);
+				}
+			}
+		}
+	}
+
+	void drawLine(const sf::Vector2f &point1, const sf::Vector2f &point2, float thickness, const sf::Color &color)
+		override {
+		const sf::Vector2f direction = point2 - point1;
+		const float length = std::sqrt((direction.x * direction.x) + (direction.y * direction.y));
+
+		if (length == 0) {
+			return;
+		}
+
+		const sf::Vector2f unitDirection = direction / length;
+		const float halfThickness = thickness / 2.0f;
+
+		// A rectangle around the segment, without caps, like sfml::Line.
+		int32_t startX, startY, endX, endY;
+		coveredPixels(std::min(point1.x, point2.x) - halfThickness, std::min(point1.y, point2.y) - halfThickness,
+			std::max(point1.x, point2.x) + halfThickness, std::max(point1.y, point2.y) + halfThickness, &startX,
+			&startY, &endX, &endY);
+
+		const uint8_t src[4] = { color.r, color.g, color.b, color.a };
+
+		for (int32_t y = startY; y < endY; y++) {
+			for (int32_t x = startX; x < endX; x++) {
+				const sf::Vector2f relative = sf::Vector2f((float) x + 0.5f, (float) y + 0.5f) - point1;
+
+				const float along = (relative.x * unitDirection.x) + (relative.y * unitDirection.y);
+				const float across = (relative.x * unitDirection.y) - (relative.y * unitDirection.x);
+
+				if (along >= 0 && along <= length && std::fabs(across) <= halfThickness) {
+					blend(&frame.pixels[(((size_t) y * frame.sizeX) + (size_t) x) * 4], src);
+				}
+			}
+		}
+	}
+
+	void drawCircle(const sf::Vector2f &center, float radius, float thickness, const sf::Color &color) override {
+		const float innerRadius = std::max(radius - thickness, 0.0f);
+
+		int32_t startX, startY, endX, endY;
+		coveredPixels(center.x - radius, center.y - radius, center.x + radius, center.y + radius, &startX, &startY,
+			&endX, &endY);
+
+		const uint8_t src[4] = { color.r, color.g, color.b, color.a };
+
+		for (int32_t y = startY; y < endY; y++) {
+			for (int32_t x = startX; x < endX; x++) {
+				const float distanceX = ((float) x + 0.5f) - center.x;
+				const float distanceY = ((float) y + 0.5f) - center.y;
+				const float distance = std::sqrt((distanceX * distanceX) + (distanceY * distanceY));
+
+				if (distance >= innerRadius && distance <= radius) {
+					blend(&frame.pixels[(((size_t) y * frame.sizeX) + (size_t) x) * 4], src);
+				}
+			}
+		}
+	}
+
+	void drawText(const std::string &text, const sf::Vector2f &position, uint32_t size, const sf::Color &color)
+		override {
+		UNUSED_ARGUMENT(text);
+		UNUSED_ARGUMENT(position);
+		UNUSED_ARGUMENT(size);
+		UNUSED_ARGUMENT(color);
+	}
+
+	void drawCanvas(caer_visualizer_canvas *canvas, const sf::Vector2f &position) override {
+		caer_visualizer_canvas_framebuffer *other = static_cast<caer_visualizer_canvas_framebuffer *>(canvas);
+
+		drawImage(&other->frame, position);
+	}
+
+	const uint8_t *readPixels() override {
+		return (frame.pixels.data());
+	}
+
+	void display() override {
+		// Nothing to do, drawing is immediate.
+	}
+
+	caer_visualizer_canvas *createCanvas(uint32_t sizeX, uint32_t sizeY) override {
+		return (new caer_visualizer_canvas_framebuffer(sizeX, sizeY));
+	}
+
+private:
+	// Pixels whose center lies in the rectangle, clipped to the framebuffer.
+	void coveredPixels(float x1, float y1, float x2, float y2, int32_t *startX, int32_t *startY, int32_t *endX,
+		int32_t *endY) const {
+		*startX = std::max(0, I32T(std::ceil(x1 - 0.5f)));
+		*startY = std::max(0, I32T(std::ceil(y1 - 0.5f)));
+		*endX = std::min(I32T(frame.sizeX), I32T(std::ceil(x2 - 0.5f)));
+		*endY = std::min(I32T(frame.sizeY), I32T(std::ceil(y2 - 0.5f)));
+	}
+
+	// Source over destination, like sf::BlendAlpha.
+	static inline void blend(uint8_t *dst, const uint8_t *src) {
+		const uint32_t alpha = src[3];
+
+		if (alpha == UINT8_MAX) {
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+			dst[3] = src[3];
+			return;
+		}
+
+		if (alpha == 0) {
+			return;
+		}
+
+		const uint32_t inverse = UINT8_MAX - alpha;
+
+		dst[0] = U8T(((src[0] * alpha) + (dst[0] * inverse) + 127) / UINT8_MAX);
+		dst[1] = U8T(((src[1] * alpha) + (dst[1] * inverse) + 127) / UINT8_MAX);
+		dst[2] = U8T(((src[2] * alpha) + (dst[2] * inverse) + 127) / UINT8_MAX);
+		dst[3] = U8T(alpha + ((dst[3] * inverse) + 127) / UINT8_MAX);
+	}
+};
+
+caerVisualizerCanvas caerVisualizerCanvasInitWindow(sf::RenderWindow *window, const sf::Font *font) {
+	return (new caer_visualizer_canvas_sfml(window, nullptr, false, font));
+}
+
+caerVisualizerCanvas caerVisualizerCanvasInitTexture(sf::RenderTexture *texture, const sf::Font *font) {
+	return (new caer_visualizer_canvas_sfml(nullptr, texture, false, font));
+}
+
+caerVisualizerCanvas caerVisualizerCanvasInitFramebuffer(uint32_t sizeX, uint32_t sizeY) {
+	return (new caer_visualizer_canvas_framebuffer(sizeX, sizeY));
+}
@@ -0,0 +1,88 @@
+#ifndef MODULES_VISUALIZER_VISUALIZER_CANVAS_H_
+#define MODULES_VISUALIZER_VISUALIZER_CANVAS_H_
+
+#include "main.h"
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+// Image in memory, filled by renderers on the CPU and drawn onto canvases.
+// SFML canvases upload it to its texture, only the rows that changed.
+struct caer_visualizer_image {
+	uint32_t sizeX;
+	uint32_t sizeY;
+	/// 32-bit RGBA pixels (8-bit per channel), standard CG layout.
+	std::vector<uint8_t> pixels;
+	/// Rows changed since the last upload, start to end (exclusive).
+	uint32_t changedRowStart;
+	uint32_t changedRowEnd;
+	/// GPU copy, only created when drawn onto an SFML canvas.
+	sf::Texture texture;
+};
+
+typedef struct caer_visualizer_image *caerVisualizerImage;
+
+// (Re-)size the image and clear it to transparent.
+void caerVisualizerImageInit(caerVisualizerImage image, uint32_t sizeX, uint32_t sizeY);
+
+static inline void caerVisualizerImageChanged(caerVisualizerImage image, uint32_t rowStart, uint32_t rowEnd) {
+	if (image->changedRowStart >= image->changedRowEnd) {
+		image->changedRowStart = rowStart;
+		image->changedRowEnd = rowEnd;
+		return;
+	}
+
+	if (rowStart < image->changedRowStart) {
+		image->changedRowStart = rowStart;
+	}
+
+	if (rowEnd > image->changedRowEnd) {
+		image->changedRowEnd = rowEnd;
+	}
+}
+
+// Where renderers draw to: a window or offscreen texture through SFML and
+// OpenGL, or a plain memory framebuffer rendered in software, which needs
+// no GPU or display. Coordinates are render coordinates, (0, 0) is the
+// upper left corner.
+struct caer_visualizer_canvas {
+	virtual ~caer_visualizer_canvas() {
+	}
+
+	virtual sf::Vector2u getSize() const = 0;
+	virtual void clear(const sf::Color &color) = 0;
+	/// Draw a whole image with its upper left corner at position, blended by alpha.
+	virtual void drawImage(caer_visualizer_image *image, const sf::Vector2f &position) = 0;
+	/// Draw parts of an image as quads: four axis-aligned vertices each, clockwise
+	/// from the upper left corner, with texture coordinates in image pixels.
+	/// Swapping texture coordinates transposes. Vertex colors are ignored.
+	virtual void drawImageQuads(caer_visualizer_image *image, const sf::Vertex *vertices, size_t verticesCount) = 0;
+	virtual void drawLine(const sf::Vector2f &point1, const sf::Vector2f &point2, float thickness,
+		const sf::Color &color) = 0;
+	/// Circle outline, growing inwards from the radius.
+	virtual void drawCircle(const sf::Vector2f &center, float radius, float thickness, const sf::Color &color) = 0;
+	/// Text needs a font, canvases without one skip it.
+	virtual void drawText(const std::string &text, const sf::Vector2f &position, uint32_t size,
+		const sf::Color &color) = 0;
+	/// Draw the last displayed frame of another canvas of the same kind.
+	virtual void drawCanvas(caer_visualizer_canvas *canvas, const sf::Vector2f &position) = 0;
+	/// Pixels of the frame drawn so far, 32-bit RGBA, getSize() large. Valid
+	/// until the next call. Reading back from the GPU is expensive.
+	virtual const uint8_t *readPixels() = 0;
+	/// Finish the frame: show it, or keep it for drawCanvas().
+	virtual void display() = 0;
+	/// New canvas of the same kind, for example for tiles. Returns NULL on failure.
+	virtual caer_visualizer_canvas *createCanvas(uint32_t sizeX, uint32_t sizeY) = 0;
+};
+
+typedef struct caer_visualizer_canvas *caerVisualizerCanvas;
+
+// The font is optional, text is skipped without it. Canvases never take
+// ownership of the passed window, texture or font.
+caerVisualizerCanvas caerVisualizerCanvasInitWindow(sf::RenderWindow *window, const sf::Font *font);
+caerVisualizerCanvas caerVisualizerCanvasInitTexture(sf::RenderTexture *texture, const sf::Font *font);
+// Software rendering into memory. Text is skipped, as there is no font rasterizer.
+caerVisualizerCanvas caerVisualizerCanvasInitFramebuffer(uint32_t sizeX, uint32_t sizeY);
+
+#endif /* MODULES_VISUALIZER_VISUALIZER_CANVAS_H_ */
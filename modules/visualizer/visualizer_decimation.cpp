@@ -0,0 +1,105 @@
+#include "visualizer_decimation.hpp"
+
+#include <libcaer/events/polarity.h>
+
+#include <algorithm>
+
+void caerVisualizerDecimationInit(caerVisualizerDecimation dec, uint32_t sizeX, uint32_t sizeY) {
+	dec->sizeX = sizeX;
+	dec->sizeY = sizeY;
+
+	caerVisualizerDecimationConfigure(dec, 0, 0, 0, 0, 1);
+}
+
+void caerVisualizerDecimationConfigure(caerVisualizerDecimation dec, uint32_t roiPositionX, uint32_t roiPositionY,
+	uint32_t roiSizeX, uint32_t roiSizeY, uint32_t cellSize) {
+	dec->roiPositionX = std::min(roiPositionX, dec->sizeX - 1);
+	dec->roiPositionY = std::min(roiPositionY, dec->sizeY - 1);
+
+	const uint32_t maxSizeX = dec->sizeX - dec->roiPositionX;
+	const uint32_t maxSizeY = dec->sizeY - dec->roiPositionY;
+
+	dec->roiSizeX = (roiSizeX == 0 || roiSizeX > maxSizeX) ? (maxSizeX) : (roiSizeX);
+	dec->roiSizeY = (roiSizeY == 0 || roiSizeY > maxSizeY) ? (maxSizeY) : (roiSizeY);
+
+	dec->cellSize = (cellSize == 0) ? (1) : (cellSize);
+
+	// Partial cells at the right and bottom edges count as whole ones.
+	dec->cellsX = (dec->roiSizeX + dec->cellSize - 1) / dec->cellSize;
+	const uint32_t cellsY = (dec->roiSizeY + dec->cellSize - 1) / dec->cellSize;
+
+	dec->cellEvents.assign((size_t) dec->cellsX * cellsY, -1);
+}
+
+bool caerVisualizerDecimationIsActive(caerVisualizerDecimation dec) {
+	return (dec->cellSize > 1 || dec->roiSizeX < dec->sizeX || dec->roiSizeY < dec->sizeY);
+}
+
+caerEventPacketHeader caerVisualizerDecimationCopyPolarity(caerVisualizerDecimation dec,
+	caerEventPacketHeader polarityPacketHeader) {
+	caerPolarityEventPacket polarityPacket = (caerPolarityEventPacket) polarityPacketHeader;
+
+	// First pass: find the newest event of each cell. Later events simply
+	// overwrite earlier ones, as a renderer drawing all of them would.
+	int32_t keptEvents = 0;
+
+	CAER_POLARITY_ITERATOR_VALID_START(polarityPacket)
+		const uint32_t x = caerPolarityEventGetX(caerPolarityIteratorElement) - dec->roiPositionX;
+		const uint32_t y = caerPolarityEventGetY(caerPolarityIteratorElement) - dec->roiPositionY;
+
+		// Coordinates left of or above the region wrap around to big values.
+		if (x >= dec->roiSizeX || y >= dec->roiSizeY) {
+			continue; // Outside region of interest.
+		}
+
+		int32_t &cellEvent = dec->cellEvents[((y / dec->cellSize) * dec->cellsX) + (x / dec->cellSize)];
+
+		if (cellEvent == -1) {
+			keptEvents++;
+		}
+
+		cellEvent = caerPolarityIteratorCounter;
+	CAER_POLARITY_ITERATOR_VALID_END
+
+	if (keptEvents == 0) {
+		return (nullptr);
+	}
+
+	caerPolarityEventPacket packetCopy = caerPolarityEventPacketAllocate(keptEvents,
+		caerEventPacketHeaderGetEventSource(polarityPacketHeader),
+		caerEventPacketHeaderGetEventTSOverflow(polarityPacketHeader));
+
+	// Second pass: copy the newest events, in order. Their cells are reset on
+	// the way, ready for the next packet, failure included.
+	int32_t copyIndex = 0;
+
+	CAER_POLARITY_ITERATOR_VALID_START(polarityPacket)
+		const uint32_t x = caerPolarityEventGetX(caerPolarityIteratorElement) - dec->roiPositionX;
+		const uint32_t y = caerPolarityEventGetY(caerPolarityIteratorElement) - dec->roiPositionY;
+
+		if (x >= dec->roiSizeX || y >= dec->roiSizeY) {
+			continue; // Outside region of interest.
+		}
+
+		int32_t &cellEvent = dec->cellEvents[((y / dec->cellSize) * dec->cellsX) + (x / dec->cellSize)];
+
+		if (cellEvent != caerPolarityIteratorCounter) {
+			continue; // A newer event in the same cell wins.
+		}
+
+		cellEvent = -1;
+
+		if (packetCopy != nullptr) {
+			*caerPolarityEventPacketGetEvent(packetCopy, copyIndex++) = *caerPolarityIteratorElement;
+		}
+	CAER_POLARITY_ITERATOR_VALID_END
+
+	if (packetCopy == nullptr) {
+		return (nullptr);
+	}
+
+	caerEventPacketHeaderSetEventNumber(&packetCopy->packetHeader, copyIndex);
+	caerEventPacketHeaderSetEventValid(&packetCopy->packetHeader, copyIndex);
+
+	return (&packetCopy->packetHeader);
+}
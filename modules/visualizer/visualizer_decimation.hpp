@@ -0,0 +1,43 @@
+#ifndef MODULES_VISUALIZER_VISUALIZER_DECIMATION_H_
+#define MODULES_VISUALIZER_VISUALIZER_DECIMATION_H_
+
+#include "visualizer.hpp"
+
+#include <vector>
+
+// Reduces polarity events to what can be seen: only events inside a region
+// of interest, and only the newest event of each cell of cellSize * cellSize
+// pixels, for when several pixels share one display pixel. With cells of one
+// pixel, this still keeps only the event a renderer would end up showing.
+// Works while copying, so events that are dropped are never copied.
+struct caer_visualizer_decimation {
+	/// Events are expected in [0, sizeX) and [0, sizeY), usually the sensor size.
+	uint32_t sizeX;
+	uint32_t sizeY;
+	/// Region of interest, always inside the size above.
+	uint32_t roiPositionX;
+	uint32_t roiPositionY;
+	uint32_t roiSizeX;
+	uint32_t roiSizeY;
+	/// Side of a cell in pixels, 1 to keep single pixels apart.
+	uint32_t cellSize;
+	uint32_t cellsX;
+	/// Per cell: index of its newest event in the packet being copied, -1 if none.
+	std::vector<int32_t> cellEvents;
+};
+
+typedef struct caer_visualizer_decimation *caerVisualizerDecimation;
+
+// Starts out with the whole size as region of interest and single pixel cells.
+void caerVisualizerDecimationInit(caerVisualizerDecimation dec, uint32_t sizeX, uint32_t sizeY);
+// The region is clipped to the size, a size of zero extends it up to the edge.
+void caerVisualizerDecimationConfigure(caerVisualizerDecimation dec, uint32_t roiPositionX, uint32_t roiPositionY,
+	uint32_t roiSizeX, uint32_t roiSizeY, uint32_t cellSize);
+// False if all events would be kept apart, a plain copy is cheaper then.
+bool caerVisualizerDecimationIsActive(caerVisualizerDecimation dec);
+// Copy of the valid polarity events that are kept, in their original order.
+// Returns NULL if none are kept, or on allocation failure.
+caerEventPacketHeader caerVisualizerDecimationCopyPolarity(caerVisualizerDecimation dec,
+	caerEventPacketHeader polarityPacketHeader);
+
+#endif /* MODULES_VISUALIZER_VISUALIZER_DECIMATION_H_ */
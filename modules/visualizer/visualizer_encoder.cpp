@@ -0,0 +1,281 @@
+#include "visualizer_encoder.hpp"
+#include "ext/threads_ext.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Maximum number of frames waiting to be written.
+#define ENCODER_QUEUE_SIZE 16
+
+enum class caerVisualizerEncoderFormat {
+	PNG, Y4M, RAW,
+};
+
+struct caer_visualizer_encoder {
+	caerModuleData moduleData;
+	caerVisualizerEncoderFormat format;
+	std::string output;
+	uint32_t sizeX;
+	uint32_t sizeY;
+	/// Y4M and raw output file.
+	FILE *file;
+	/// Stop writing after the first error, a closed pipe won't come back.
+	bool writeFailed;
+	uint64_t frameNumber;
+	std::thread *thread;
+	std::mutex queueLock;
+	std::condition_variable queueCond;
+	bool running;
+	/// Frames to write, an empty frame repeats the previous one.
+	std::deque<std::vector<uint8_t>> queue;
+	/// Written frame buffers, kept for reuse.
+	std::vector<std::vector<uint8_t>> freeFrames;
+	// Encoder thread only.
+	std::vector<uint8_t> lastFrame;
+	std::vector<uint8_t> yuvPlanes;
+};
+
+const std::string caerVisualizerEncoderFormatListOptionsString = "PNG,Y4M,RAW";
+
+static void encoderThread(caerVisualizerEncoder encoder);
+static void writeFrame(caerVisualizerEncoder encoder, const uint8_t *pixels);
+static void writeFramePNG(caerVisualizerEncoder encoder, const uint8_t *pixels);
+static void writeFrameY4M(caerVisualizerEncoder encoder, const uint8_t *pixels);
+static void writeToFile(caerVisualizerEncoder encoder, const void *data, size_t dataSize);
+
+caerVisualizerEncoder caerVisualizerEncoderInit(caerModuleData moduleData, const std::string &format,
+	const std::string &output, uint32_t sizeX, uint32_t sizeY, uint32_t fps) {
+	caerVisualizerEncoder encoder = new caer_visualizer_encoder();
+
+	encoder->moduleData = moduleData;
+	encoder->output = output;
+	encoder->sizeX = sizeX;
+	encoder->sizeY = sizeY;
+	encoder->running = true;
+
+	if (format == "Y4M") {
+		encoder->format = caerVisualizerEncoderFormat::Y4M;
+	}
+	else if (format == "RAW") {
+		encoder->format = caerVisualizerEncoderFormat::RAW;
+	}
+	else {
+		encoder->format = caerVisualizerEncoderFormat::PNG;
+	}
+
+	if (encoder->format != caerVisualizerEncoderFormat::PNG) {
+		encoder->file = fopen(output.c_str(), "wb");
+		if (encoder->file == nullptr) {
+			caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to open headless output '%s'. Error: %d.",
+				output.c_str(), errno);
+
+			delete encoder;
+			return (nullptr);
+		}
+
+		if (encoder->format == caerVisualizerEncoderFormat::Y4M) {
+			// Full 4:4:4 chroma, so odd sizes need no special handling.
+			fprintf(encoder->file, "YUV4MPEG2 W%" PRIu32 " H%" PRIu32 " F%" PRIu32 ":1 Ip A1:1 C444\n", sizeX, sizeY,
+				fps);
+		}
+	}
+
+	try {
+		encoder->thread = new std::thread(&encoderThread, encoder);
+	}
+	catch (const std::system_error &ex) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to start encoder thread. Error: '%s' (%d).", ex.what(),
+			ex.code().value());
+
+		if (encoder->file != nullptr) {
+			fclose(encoder->file);
+		}
+
+		delete encoder;
+		return (nullptr);
+	}
+
+	return (encoder);
+}
+
+bool caerVisualizerEncoderPut(caerVisualizerEncoder encoder, const uint8_t *pixels) {
+	std::vector<uint8_t> frame;
+
+	{
+		std::lock_guard<std::mutex> lock(encoder->queueLock);
+
+		if (encoder->queue.size() >= ENCODER_QUEUE_SIZE) {
+			return (false);
+		}
+
+		if (pixels != nullptr && !encoder->freeFrames.empty()) {
+			frame = std::move(encoder->freeFrames.back());
+			encoder->freeFrames.pop_back();
+		}
+	}
+
+	// Copy outside the lock, the encoder thread can go on meanwhile.
+	if (pixels != nullptr) {
+		frame.assign(pixels, pixels + (encoder->sizeX * encoder->sizeY * 4));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(encoder->queueLock);
+
+		encoder->queue.push_back(std::move(frame));
+	}
+
+	encoder->queueCond.notify_one();
+
+	return (true);
+}
+
+void caerVisualizerEncoderExit(caerVisualizerEncoder encoder) {
+	{
+		std::lock_guard<std::mutex> lock(encoder->queueLock);
+
+		encoder->running = false;
+	}
+
+	encoder->queueCond.notify_one();
+
+	try {
+		encoder->thread->join();
+	}
+	catch (const std::system_error &ex) {
+		// This should never happen!
+		caerModuleLog(encoder->moduleData, CAER_LOG_CRITICAL, "Failed to join encoder thread. Error: '%s' (%d).",
+			ex.what(), ex.code().value());
+	}
+
+	delete encoder->thread;
+
+	if (encoder->file != nullptr) {
+		fclose(encoder->file);
+	}
+
+	caerModuleLog(encoder->moduleData, CAER_LOG_INFO, "Headless output: wrote %" PRIu64 " frames.",
+		encoder->frameNumber);
+
+	delete encoder;
+}
+
+static void encoderThread(caerVisualizerEncoder encoder) {
+	// Set thread name.
+	size_t threadNameLength = strlen(encoder->moduleData->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 9]; // +1 for NUL character.
+	strcpy(threadName, encoder->moduleData->moduleSubSystemString);
+	strcat(threadName, "[Encoder]");
+	thrd_set_name(threadName);
+
+	std::unique_lock<std::mutex> lock(encoder->queueLock);
+
+	while (true) {
+		encoder->queueCond.wait(lock, [encoder]() {
+			return (!encoder->queue.empty() || !encoder->running);
+		});
+
+		// Stopped and everything written.
+		if (encoder->queue.empty()) {
+			break;
+		}
+
+		std::vector<uint8_t> frame = std::move(encoder->queue.front());
+		encoder->queue.pop_front();
+
+		lock.unlock();
+
+		if (!frame.empty()) {
+			encoder->lastFrame.swap(frame);
+		}
+
+		// Nothing to repeat before the first real frame.
+		if (!encoder->lastFrame.empty()) {
+			writeFrame(encoder, encoder->lastFrame.data());
+		}
+
+		lock.lock();
+
+		// After the swap, this is the previous frame's buffer.
+		if (!frame.empty()) {
+			encoder->freeFrames.push_back(std::move(frame));
+		}
+	}
+}
+
+static void writeFrame(caerVisualizerEncoder encoder, const uint8_t *pixels) {
+	if (encoder->writeFailed) {
+		return;
+	}
+
+	switch (encoder->format) {
+		case caerVisualizerEncoderFormat::PNG:
+			writeFramePNG(encoder, pixels);
+			break;
+
+		case caerVisualizerEncoderFormat::Y4M:
+			writeFrameY4M(encoder, pixels);
+			break;
+
+		case caerVisualizerEncoderFormat::RAW:
+			writeToFile(encoder, pixels, encoder->sizeX * encoder->sizeY * 4);
+			break;
+	}
+
+	encoder->frameNumber++;
+}
+
+static void writeFramePNG(caerVisualizerEncoder encoder, const uint8_t *pixels) {
+	sf::Image image;
+	image.create(encoder->sizeX, encoder->sizeY, pixels);
+
+	char frameSuffix[32];
+	snprintf(frameSuffix, 32, "-%06" PRIu64 ".png", encoder->frameNumber + 1);
+
+	if (!image.saveToFile(encoder->output + frameSuffix)) {
+		caerModuleLog(encoder->moduleData, CAER_LOG_ERROR, "Failed to write headless output '%s%s'.",
+			encoder->output.c_str(), frameSuffix);
+		encoder->writeFailed = true;
+	}
+}
+
+static void writeFrameY4M(caerVisualizerEncoder encoder, const uint8_t *pixels) {
+	const size_t planeSize = encoder->sizeX * encoder->sizeY;
+
+	encoder->yuvPlanes.resize(planeSize * 3);
+
+	uint8_t *planeY = encoder->yuvPlanes.data();
+	uint8_t *planeU = planeY + planeSize;
+	uint8_t *planeV = planeU + planeSize;
+
+	// BT.601, limited range (Y 16-235, U/V 16-240), fixed-point.
+	for (size_t i = 0; i < planeSize; i++) {
+		int32_t r = pixels[(i * 4)];
+		int32_t g = pixels[(i * 4) + 1];
+		int32_t b = pixels[(i * 4) + 2];
+
+		planeY[i] = U8T(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		planeU[i] = U8T(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		planeV[i] = U8T(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+
+	static const char frameHeader[] = "FRAME\n";
+
+	writeToFile(encoder, frameHeader, sizeof(frameHeader) - 1);
+	writeToFile(encoder, encoder->yuvPlanes.data(), encoder->yuvPlanes.size());
+}
+
+static void writeToFile(caerVisualizerEncoder encoder, const void *data, size_t dataSize) {
+	if (encoder->writeFailed) {
+		return;
+	}
+
+	if (fwrite(data, 1, dataSize, encoder->file) != dataSize) {
+		caerModuleLog(encoder->moduleData, CAER_LOG_ERROR,
+			"Failed to write headless output '%s', stopping output. Error: %d.", encoder->output.c_str(), errno);
+		encoder->writeFailed = true;
+	}
+}
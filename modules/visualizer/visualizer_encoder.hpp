@@ -0,0 +1,25 @@
+#ifndef MODULES_VISUALIZER_VISUALIZER_ENCODER_H_
+#define MODULES_VISUALIZER_VISUALIZER_ENCODER_H_
+
+#include "visualizer.hpp"
+#include "base/module.h"
+
+// Writes rendered frames, from headless mode, to a PNG image sequence,
+// a YUV4MPEG2 (Y4M) video or raw RGBA frames, on its own thread.
+// Y4M and raw output can go to a named pipe for live encoding.
+typedef struct caer_visualizer_encoder *caerVisualizerEncoder;
+
+extern const std::string caerVisualizerEncoderFormatListOptionsString;
+
+// Output is a file path for Y4M and raw, a path prefix for PNG
+// ('-000001.png' and following are appended). Returns NULL on failure.
+caerVisualizerEncoder caerVisualizerEncoderInit(caerModuleData moduleData, const std::string &format,
+	const std::string &output, uint32_t sizeX, uint32_t sizeY, uint32_t fps);
+// Queue a frame of 32-bit RGBA pixels (sizeX * sizeY * 4 bytes) for writing.
+// NULL repeats the previous frame. Frames are dropped if the encoder can't
+// keep up, returns false in that case.
+bool caerVisualizerEncoderPut(caerVisualizerEncoder encoder, const uint8_t *pixels);
+// Writes out all queued frames, then stops the encoder thread.
+void caerVisualizerEncoderExit(caerVisualizerEncoder encoder);
+
+#endif /* MODULES_VISUALIZER_VISUALIZER_ENCODER_H_ */
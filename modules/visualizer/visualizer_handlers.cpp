@@ -42,6 +42,10 @@ static void caerVisualizerEventHandlerNeuronMonitor(caerVisualizerPublicState st
 			positionY = floorf(positionY * currentZoomFactor);
 		}
 
+		// The window starts at the region of interest (as clipped, zero with tiles).
+		positionX += (float) state->roiPositionX;
+		positionY += (float) state->roiPositionY;
+
 		// Transform into chip ID, core ID and neuron ID.
 		const struct caer_spike_event val = caerDynapseSpikeEventFromXY(U16T(positionX), U16T(positionY));
 
@@ -1,7 +1,6 @@
 #include "visualizer_renderers.hpp"
 
-#include "ext/sfml/line.hpp"
-#include "ext/sfml/helpers.hpp"
+#include "ext/frame_convert.h"
 
 #include <libcaercpp/events/polarity.hpp>
 #include <libcaercpp/events/frame.hpp>
@@ -11,53 +10,134 @@
 #include <libcaercpp/events/spike.hpp>
 #include <libcaercpp/devices/dynapse.hpp> // Only for constants.
 
+#include <algorithm>
+#include <cmath>
+
+// Renderers drawing single pixels write them into a CPU-side image, that
+// is drawn onto the canvas in one go per frame. Zoom is applied by the
+// window view. This way rendering cost depends on the render size, not on
+// the number of events.
+struct renderer_pixels_state {
+	struct caer_visualizer_image image;
+	/// Where the image's upper left corner is drawn.
+	sf::Vector2f position;
+};
+
+typedef struct renderer_pixels_state *rendererPixelsState;
+
+static void *caerVisualizerRendererPixelsStateInit(caerVisualizerPublicState state);
+static void caerVisualizerRendererPixelsStateExit(caerVisualizerPublicState state);
+
 static bool caerVisualizerRendererPolarityEvents(caerVisualizerPublicState state, caerEventPacketContainer container);
 static const struct caer_visualizer_renderer_info rendererPolarityEvents("Polarity",
-	&caerVisualizerRendererPolarityEvents);
+	&caerVisualizerRendererPolarityEvents, false, &caerVisualizerRendererPixelsStateInit,
+	&caerVisualizerRendererPixelsStateExit);
 
-static void *caerVisualizerRendererFrameEventsStateInit(caerVisualizerPublicState state);
-static void caerVisualizerRendererFrameEventsStateExit(caerVisualizerPublicState state);
 static bool caerVisualizerRendererFrameEvents(caerVisualizerPublicState state, caerEventPacketContainer container);
 static const struct caer_visualizer_renderer_info rendererFrameEvents("Frame", &caerVisualizerRendererFrameEvents,
-	false, &caerVisualizerRendererFrameEventsStateInit, &caerVisualizerRendererFrameEventsStateExit);
+	false, &caerVisualizerRendererPixelsStateInit, &caerVisualizerRendererPixelsStateExit);
 
 static bool caerVisualizerRendererIMU6Events(caerVisualizerPublicState state, caerEventPacketContainer container);
 static const struct caer_visualizer_renderer_info rendererIMU6Events("IMU_6-axes", &caerVisualizerRendererIMU6Events);
 
 static bool caerVisualizerRendererPoint2DEvents(caerVisualizerPublicState state, caerEventPacketContainer container);
 static const struct caer_visualizer_renderer_info rendererPoint2DEvents("2D_Points",
-	&caerVisualizerRendererPoint2DEvents);
+	&caerVisualizerRendererPoint2DEvents, false, &caerVisualizerRendererPixelsStateInit,
+	&caerVisualizerRendererPixelsStateExit);
 
 static bool caerVisualizerRendererSpikeEvents(caerVisualizerPublicState state, caerEventPacketContainer container);
-static const struct caer_visualizer_renderer_info rendererSpikeEvents("Spikes", &caerVisualizerRendererSpikeEvents);
+static const struct caer_visualizer_renderer_info rendererSpikeEvents("Spikes", &caerVisualizerRendererSpikeEvents,
+	false, &caerVisualizerRendererPixelsStateInit, &caerVisualizerRendererPixelsStateExit);
 
 static void *caerVisualizerRendererSpikeEventsRasterStateInit(caerVisualizerPublicState state);
 static bool caerVisualizerRendererSpikeEventsRaster(caerVisualizerPublicState state,
 	caerEventPacketContainer container);
 static const struct caer_visualizer_renderer_info rendererSpikeEventsRaster("Spikes_Raster_Plot",
-	&caerVisualizerRendererSpikeEventsRaster, false, &caerVisualizerRendererSpikeEventsRasterStateInit, nullptr);
+	&caerVisualizerRendererSpikeEventsRaster, false, &caerVisualizerRendererSpikeEventsRasterStateInit,
+	&caerVisualizerRendererPixelsStateExit);
+
+static void *caerVisualizerRendererSpikeEventsRasterScrollStateInit(caerVisualizerPublicState state);
+static void caerVisualizerRendererSpikeEventsRasterScrollStateExit(caerVisualizerPublicState state);
+static bool caerVisualizerRendererSpikeEventsRasterScroll(caerVisualizerPublicState state,
+	caerEventPacketContainer container);
+static const struct caer_visualizer_renderer_info rendererSpikeEventsRasterScroll("Spikes_Raster_Scroll",
+	&caerVisualizerRendererSpikeEventsRasterScroll, false, &caerVisualizerRendererSpikeEventsRasterScrollStateInit,
+	&caerVisualizerRendererSpikeEventsRasterScrollStateExit);
 
 static bool caerVisualizerRendererETF4D(caerVisualizerPublicState state, caerEventPacketContainer container);
-static const struct caer_visualizer_renderer_info rendererETF4D("ETF4D", &caerVisualizerRendererETF4D);
+static const struct caer_visualizer_renderer_info rendererETF4D("ETF4D", &caerVisualizerRendererETF4D, false,
+	&caerVisualizerRendererPixelsStateInit, &caerVisualizerRendererPixelsStateExit);
 
+static void *caerVisualizerRendererPolarityAndFrameEventsStateInit(caerVisualizerPublicState state);
+static void caerVisualizerRendererPolarityAndFrameEventsStateExit(caerVisualizerPublicState state);
 static bool caerVisualizerRendererPolarityAndFrameEvents(caerVisualizerPublicState state,
 	caerEventPacketContainer container);
 static const struct caer_visualizer_renderer_info rendererPolarityAndFrameEvents("Polarity_and_Frames",
-	&caerVisualizerRendererPolarityAndFrameEvents);
+	&caerVisualizerRendererPolarityAndFrameEvents, false, &caerVisualizerRendererPolarityAndFrameEventsStateInit,
+	&caerVisualizerRendererPolarityAndFrameEventsStateExit);
 
 const std::string caerVisualizerRendererListOptionsString =
-	"None,Polarity,Frame,IMU_6-axes,2D_Points,Spikes,Spikes_Raster_Plot,ETF4D,Polarity_and_Frames";
+	"None,Polarity,Frame,IMU_6-axes,2D_Points,Spikes,Spikes_Raster_Plot,Spikes_Raster_Scroll,ETF4D,Polarity_and_Frames";
 
 const struct caer_visualizer_renderer_info caerVisualizerRendererList[] = { { "None", nullptr }, rendererPolarityEvents,
 	rendererFrameEvents, rendererIMU6Events, rendererPoint2DEvents, rendererSpikeEvents, rendererSpikeEventsRaster,
-	rendererETF4D, rendererPolarityAndFrameEvents };
+	rendererSpikeEventsRasterScroll, rendererETF4D, rendererPolarityAndFrameEvents };
 
 const size_t caerVisualizerRendererListLength = (sizeof(caerVisualizerRendererList)
 	/ sizeof(struct caer_visualizer_renderer_info));
 
-static bool caerVisualizerRendererPolarityEvents(caerVisualizerPublicState state, caerEventPacketContainer container) {
-	UNUSED_ARGUMENT(state);
+// Image covering the whole render area.
+static void pixelsStateInit(rendererPixelsState renderState, uint32_t sizeX, uint32_t sizeY) {
+	caerVisualizerImageInit(&renderState->image, sizeX, sizeY);
+
+	renderState->position = sf::Vector2f(0, 0);
+}
+
+// Fully transparent, so that content below (accumulated image) stays visible.
+static inline void pixelsClear(rendererPixelsState renderState) {
+	std::fill(renderState->image.pixels.begin(), renderState->image.pixels.end(), 0);
+}
+
+static inline void pixelsSet(rendererPixelsState renderState, uint32_t x, uint32_t y, const sf::Color &color) {
+	if (x >= renderState->image.sizeX || y >= renderState->image.sizeY) {
+		return; // Outside render area.
+	}
+
+	size_t idx = ((y * renderState->image.sizeX) + x) * 4;
+
+	renderState->image.pixels[idx] = color.r;
+	renderState->image.pixels[idx + 1] = color.g;
+	renderState->image.pixels[idx + 2] = color.b;
+	renderState->image.pixels[idx + 3] = color.a;
+}
+
+// The whole image changed, draw it.
+static inline void pixelsDraw(caerVisualizerPublicState state, rendererPixelsState renderState) {
+	caerVisualizerImageChanged(&renderState->image, 0, renderState->image.sizeY);
+
+	state->canvas->drawImage(&renderState->image, renderState->position);
+}
+
+static void *caerVisualizerRendererPixelsStateInit(caerVisualizerPublicState state) {
+	// Allocate memory via C++ for renderer state, since we use C++ objects directly.
+	rendererPixelsState renderState = new (std::nothrow) renderer_pixels_state();
+	if (renderState == nullptr) {
+		return (nullptr);
+	}
+
+	pixelsStateInit(renderState, state->renderSizeX, state->renderSizeY);
+
+	return (renderState);
+}
+
+static void caerVisualizerRendererPixelsStateExit(caerVisualizerPublicState state) {
+	rendererPixelsState renderState = (rendererPixelsState) state->renderState;
 
+	delete renderState;
+}
+
+static bool renderPolarityEvents(caerVisualizerPublicState state, rendererPixelsState renderState,
+	caerEventPacketContainer container) {
 	caerEventPacketHeader polarityPacketHeader = caerEventPacketContainerFindEventPacketByType(container,
 		POLARITY_EVENT);
 
@@ -68,7 +148,7 @@ static bool caerVisualizerRendererPolarityEvents(caerVisualizerPublicState state
 
 	const libcaer::events::PolarityEventPacket polarityPacket(polarityPacketHeader, false);
 
-	std::vector<sf::Vertex> vertices((size_t) polarityPacket.getEventValid() * 4);
+	pixelsClear(renderState);
 
 	// Render all valid events.
 	for (const auto &polarityEvent : polarityPacket) {
@@ -77,49 +157,21 @@ static bool caerVisualizerRendererPolarityEvents(caerVisualizerPublicState state
 		}
 
 		// ON polarity (green), OFF polarity (red).
-		sfml::Helpers::addPixelVertices(vertices, sf::Vector2f(polarityEvent.getX(), polarityEvent.getY()),
+		pixelsSet(renderState, polarityEvent.getX(), polarityEvent.getY(),
 			(polarityEvent.getPolarity()) ? (sf::Color::Green) : (sf::Color::Red));
 	}
 
-	state->renderWindow->draw(vertices.data(), vertices.size(), sf::Quads);
+	pixelsDraw(state, renderState);
 
 	return (true);
 }
 
-struct renderer_frame_events_state {
-	sf::Sprite sprite;
-	sf::Texture texture;
-	std::vector<uint8_t> pixels;
-};
-
-typedef struct renderer_frame_events_state *rendererFrameEventsState;
-
-static void *caerVisualizerRendererFrameEventsStateInit(caerVisualizerPublicState state) {
-	// Allocate memory via C++ for renderer state, since we use C++ objects directly.
-	rendererFrameEventsState renderState = new renderer_frame_events_state();
-
-	// Create texture representing frame, set smoothing.
-	renderState->texture.create(state->renderSizeX, state->renderSizeY);
-	renderState->texture.setSmooth(false);
-
-	// Assign texture to sprite.
-	renderState->sprite.setTexture(renderState->texture);
-
-	// 32-bit RGBA pixels (8-bit per channel), standard CG layout.
-	renderState->pixels.reserve(state->renderSizeX * state->renderSizeY * 4);
-
-	return (renderState);
-}
-
-static void caerVisualizerRendererFrameEventsStateExit(caerVisualizerPublicState state) {
-	rendererFrameEventsState renderState = (rendererFrameEventsState) state->renderState;
-
-	delete renderState;
+static bool caerVisualizerRendererPolarityEvents(caerVisualizerPublicState state, caerEventPacketContainer container) {
+	return (renderPolarityEvents(state, (rendererPixelsState) state->renderState, container));
 }
 
-static bool caerVisualizerRendererFrameEvents(caerVisualizerPublicState state, caerEventPacketContainer container) {
-	UNUSED_ARGUMENT(state);
-
+static bool renderFrameEvents(caerVisualizerPublicState state, rendererPixelsState renderState,
+	caerEventPacketContainer container) {
 	caerEventPacketHeader framePacketHeader = caerEventPacketContainerFindEventPacketByType(container, FRAME_EVENT);
 
 	// No packet of requested type or empty packet (no valid events).
@@ -142,55 +194,44 @@ static bool caerVisualizerRendererFrameEvents(caerVisualizerPublicState state, c
 	// Only operate on the last, valid frame. At least one must exist (see check above).
 	const libcaer::events::FrameEvent &frameEvent = *rIter;
 
-	rendererFrameEventsState renderState = (rendererFrameEventsState) state->renderState;
+	if (U32T(frameEvent.getPositionX() + frameEvent.getLengthX()) > state->renderSizeX
+		|| U32T(frameEvent.getPositionY() + frameEvent.getLengthY()) > state->renderSizeY) {
+		return (false); // Doesn't fit render area.
+	}
 
+	// The image only covers the frame, and is drawn at the frame's position.
+	// Resizing is free if the frame size doesn't change.
 	// 32-bit RGBA pixels (8-bit per channel), standard CG layout.
+	caerVisualizerImageInit(&renderState->image, U32T(frameEvent.getLengthX()), U32T(frameEvent.getLengthY()));
+
 	switch (frameEvent.getChannelNumber()) {
-		case libcaer::events::FrameEvent::colorChannels::GRAYSCALE: {
-			for (size_t srcIdx = 0, dstIdx = 0; srcIdx < frameEvent.getPixelsMaxIndex();) {
-				uint8_t greyValue = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8;
-				renderState->pixels[dstIdx++] = greyValue; // R
-				renderState->pixels[dstIdx++] = greyValue; // G
-				renderState->pixels[dstIdx++] = greyValue; // B
-				renderState->pixels[dstIdx++] = UINT8_MAX; // A
-			}
+		case libcaer::events::FrameEvent::colorChannels::GRAYSCALE:
+			frameConvertGrayscaleToRGBA(renderState->image.pixels.data(), frameEvent.getPixelArrayUnsafe(),
+				frameEvent.getPixelsMaxIndex());
 			break;
-		}
 
-		case libcaer::events::FrameEvent::colorChannels::RGB: {
-			for (size_t srcIdx = 0, dstIdx = 0; srcIdx < frameEvent.getPixelsMaxIndex();) {
-				renderState->pixels[dstIdx++] = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8; // R
-				renderState->pixels[dstIdx++] = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8; // G
-				renderState->pixels[dstIdx++] = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8; // B
-				renderState->pixels[dstIdx++] = UINT8_MAX; // A
-			}
+		case libcaer::events::FrameEvent::colorChannels::RGB:
+			frameConvertRGBToRGBA(renderState->image.pixels.data(), frameEvent.getPixelArrayUnsafe(),
+				frameEvent.getPixelsMaxIndex() / 3);
 			break;
-		}
 
-		case libcaer::events::FrameEvent::colorChannels::RGBA: {
-			for (size_t srcIdx = 0, dstIdx = 0; srcIdx < frameEvent.getPixelsMaxIndex();) {
-				renderState->pixels[dstIdx++] = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8; // R
-				renderState->pixels[dstIdx++] = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8; // G
-				renderState->pixels[dstIdx++] = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8; // B
-				renderState->pixels[dstIdx++] = frameEvent.getPixelArrayUnsafe()[srcIdx++] >> 8; // A
-			}
+		case libcaer::events::FrameEvent::colorChannels::RGBA:
+			frameConvertRGBAToRGBA(renderState->image.pixels.data(), frameEvent.getPixelArrayUnsafe(),
+				frameEvent.getPixelsMaxIndex() / 4);
 			break;
-		}
 	}
 
-	renderState->texture.update(renderState->pixels.data(), U32T(frameEvent.getLengthX()),
-		U32T(frameEvent.getLengthY()), U32T(frameEvent.getPositionX()), U32T(frameEvent.getPositionY()));
-
-	renderState->sprite.setTextureRect(
-		sf::IntRect(frameEvent.getPositionX(), frameEvent.getPositionY(), frameEvent.getLengthX(),
-			frameEvent.getLengthY()));
-	renderState->sprite.setPosition(frameEvent.getPositionX(), frameEvent.getPositionY());
+	renderState->position = sf::Vector2f((float) frameEvent.getPositionX(), (float) frameEvent.getPositionY());
 
-	state->renderWindow->draw(renderState->sprite);
+	state->canvas->drawImage(&renderState->image, renderState->position);
 
 	return (true);
 }
 
+static bool caerVisualizerRendererFrameEvents(caerVisualizerPublicState state, caerEventPacketContainer container) {
+	return (renderFrameEvents(state, (rendererPixelsState) state->renderState, container));
+}
+
 #define RESET_LIMIT_POS(VAL, LIMIT) if ((VAL) > (LIMIT)) { (VAL) = (LIMIT); }
 #define RESET_LIMIT_NEG(VAL, LIMIT) if ((VAL) < (LIMIT)) { (VAL) = (LIMIT); }
 
@@ -252,30 +293,16 @@ static bool caerVisualizerRendererIMU6Events(caerVisualizerPublicState state, ca
 	RESET_LIMIT_POS(accelZScaled, centerPointY - 2 - lineThickness); // Circle max.
 	RESET_LIMIT_NEG(accelZScaled, 1); // Circle min.
 
-	sfml::Line accelLine(sf::Vector2f(centerPointX, centerPointY), sf::Vector2f(accelXScaled, accelYScaled),
+	state->canvas->drawLine(sf::Vector2f(centerPointX, centerPointY), sf::Vector2f(accelXScaled, accelYScaled),
 		lineThickness, accelColor);
-	state->renderWindow->draw(accelLine);
 
-	sf::CircleShape accelCircle(accelZScaled);
-	sfml::Helpers::setOriginToCenter(accelCircle);
-	accelCircle.setFillColor(sf::Color::Transparent);
-	accelCircle.setOutlineColor(accelColor);
-	accelCircle.setOutlineThickness(-lineThickness);
-	accelCircle.setPosition(sf::Vector2f(centerPointX, centerPointY));
-
-	state->renderWindow->draw(accelCircle);
+	state->canvas->drawCircle(sf::Vector2f(centerPointX, centerPointY), accelZScaled, lineThickness, accelColor);
 
 	// TODO: enhance IMU renderer with more text info.
-	if (state->font != nullptr) {
-		char valStr[128];
-		snprintf(valStr, 128, "%.2f,%.2f g", (double) accelX, (double) accelY);
-
-		sf::Text accelText(valStr, *state->font, 20);
-		sfml::Helpers::setTextColor(accelText, accelColor);
-		accelText.setPosition(sf::Vector2f(accelXScaled, accelYScaled));
+	char valStr[128];
+	snprintf(valStr, 128, "%.2f,%.2f g", (double) accelX, (double) accelY);
 
-		state->renderWindow->draw(accelText);
-	}
+	state->canvas->drawText(valStr, sf::Vector2f(accelXScaled, accelYScaled), 20, accelColor);
 
 	// Gyroscope pitch(X), yaw(Y), roll(Z) as lines.
 	float gyroXScaled = centerPointY + gyroX * scaleFactorGyro;
@@ -288,20 +315,16 @@ static bool caerVisualizerRendererIMU6Events(caerVisualizerPublicState state, ca
 	RESET_LIMIT_POS(gyroZScaled, maxSizeX - 2 - lineThickness);
 	RESET_LIMIT_NEG(gyroZScaled, 1 + lineThickness);
 
-	sfml::Line gyroLine1(sf::Vector2f(centerPointX, centerPointY), sf::Vector2f(gyroYScaled, gyroXScaled),
+	state->canvas->drawLine(sf::Vector2f(centerPointX, centerPointY), sf::Vector2f(gyroYScaled, gyroXScaled),
 		lineThickness, gyroColor);
-	state->renderWindow->draw(gyroLine1);
 
-	sfml::Line gyroLine2(sf::Vector2f(centerPointX, centerPointY - 20), sf::Vector2f(gyroZScaled, centerPointY - 20),
+	state->canvas->drawLine(sf::Vector2f(centerPointX, centerPointY - 20), sf::Vector2f(gyroZScaled, centerPointY - 20),
 		lineThickness, gyroColor);
-	state->renderWindow->draw(gyroLine2);
 
 	return (true);
 }
 
 static bool caerVisualizerRendererPoint2DEvents(caerVisualizerPublicState state, caerEventPacketContainer container) {
-	UNUSED_ARGUMENT(state);
-
 	caerEventPacketHeader point2DPacketHeader = caerEventPacketContainerFindEventPacketByType(container, POINT2D_EVENT);
 
 	if (point2DPacketHeader == NULL || caerEventPacketHeaderGetEventValid(point2DPacketHeader) == 0) {
@@ -310,7 +333,9 @@ static bool caerVisualizerRendererPoint2DEvents(caerVisualizerPublicState state,
 
 	const libcaer::events::Point2DEventPacket point2DPacket(point2DPacketHeader, false);
 
-	std::vector<sf::Vertex> vertices((size_t) point2DPacket.getEventValid() * 4);
+	rendererPixelsState renderState = (rendererPixelsState) state->renderState;
+
+	pixelsClear(renderState);
 
 	// Render all valid events.
 	for (const auto &point2DEvent : point2DPacket) {
@@ -318,12 +343,16 @@ static bool caerVisualizerRendererPoint2DEvents(caerVisualizerPublicState state,
 			continue; // Skip invalid events.
 		}
 
+		// Negative coordinates are outside the render area too.
+		if (point2DEvent.getX() < 0 || point2DEvent.getY() < 0) {
+			continue;
+		}
+
 		// Render points in color blue.
-		sfml::Helpers::addPixelVertices(vertices, sf::Vector2f(point2DEvent.getX(), point2DEvent.getY()),
-			sf::Color::Blue);
+		pixelsSet(renderState, U32T(point2DEvent.getX()), U32T(point2DEvent.getY()), sf::Color::Blue);
 	}
 
-	state->renderWindow->draw(vertices.data(), vertices.size(), sf::Quads);
+	pixelsDraw(state, renderState);
 
 	return (true);
 }
@@ -344,8 +373,6 @@ static inline sf::Color dynapseCoreIdToColor(uint8_t coreId) {
 }
 
 static bool caerVisualizerRendererSpikeEvents(caerVisualizerPublicState state, caerEventPacketContainer container) {
-	UNUSED_ARGUMENT(state);
-
 	caerEventPacketHeader spikePacketHeader = caerEventPacketContainerFindEventPacketByType(container, SPIKE_EVENT);
 
 	if (spikePacketHeader == NULL || caerEventPacketHeaderGetEventValid(spikePacketHeader) == 0) {
@@ -354,7 +381,9 @@ static bool caerVisualizerRendererSpikeEvents(caerVisualizerPublicState state, c
 
 	const libcaer::events::SpikeEventPacket spikePacket(spikePacketHeader, false);
 
-	std::vector<sf::Vertex> vertices((size_t) spikePacket.getEventValid() * 4);
+	rendererPixelsState renderState = (rendererPixelsState) state->renderState;
+
+	pixelsClear(renderState);
 
 	// Render all valid events.
 	for (const auto &spikeEvent : spikePacket) {
@@ -364,12 +393,11 @@ static bool caerVisualizerRendererSpikeEvents(caerVisualizerPublicState state, c
 
 		// Render spikes with different colors based on core ID.
 		uint8_t coreId = spikeEvent.getSourceCoreID();
-		sfml::Helpers::addPixelVertices(vertices,
-			sf::Vector2f(libcaer::devices::dynapse::spikeEventGetX(spikeEvent),
-				libcaer::devices::dynapse::spikeEventGetY(spikeEvent)), dynapseCoreIdToColor(coreId));
+		pixelsSet(renderState, libcaer::devices::dynapse::spikeEventGetX(spikeEvent),
+			libcaer::devices::dynapse::spikeEventGetY(spikeEvent), dynapseCoreIdToColor(coreId));
 	}
 
-	state->renderWindow->draw(vertices.data(), vertices.size(), sf::Quads);
+	pixelsDraw(state, renderState);
 
 	return (true);
 }
@@ -384,13 +412,11 @@ static void *caerVisualizerRendererSpikeEventsRasterStateInit(caerVisualizerPubl
 	// Also add 2 pixels on X/Y to compensate for the middle separation bars.
 	caerVisualizerResetRenderSize(state, (SPIKE_RASTER_PLOT_TIMESTEPS * 2) + 2, (SPIKE_RASTER_PLOT_NEURONS * 2) + 2);
 
-	return (CAER_VISUALIZER_RENDER_INIT_NO_MEM); // No allocated memory.
+	return (caerVisualizerRendererPixelsStateInit(state));
 }
 
 static bool caerVisualizerRendererSpikeEventsRaster(caerVisualizerPublicState state,
 	caerEventPacketContainer container) {
-	UNUSED_ARGUMENT(state);
-
 	caerEventPacketHeader spikePacketHeader = caerEventPacketContainerFindEventPacketByType(container, SPIKE_EVENT);
 
 	if (spikePacketHeader == NULL || caerEventPacketHeaderGetEventValid(spikePacketHeader) == 0) {
@@ -416,7 +442,9 @@ static bool caerVisualizerRendererSpikeEventsRaster(caerVisualizerPublicState st
 	float scaleX = ((float) (sizeX / 2)) / ((float) timeSpan);
 	float scaleY = ((float) (sizeY / 2)) / ((float) DYNAPSE_CONFIG_NUMNEURONS);
 
-	std::vector<sf::Vertex> vertices((size_t) spikePacket.getEventNumber() * 4);
+	rendererPixelsState renderState = (rendererPixelsState) state->renderState;
+
+	pixelsClear(renderState);
 
 	// Render all spikes.
 	for (const auto &spikeEvent : spikePacket) {
@@ -450,27 +478,240 @@ static bool caerVisualizerRendererSpikeEventsRaster(caerVisualizerPublicState st
 		// DYNAPSE_CONFIG_DYNAPSE_U0 no changes.
 
 		// Draw pixels of raster plot (some neurons might be merged due to aliasing).
-		sfml::Helpers::addPixelVertices(vertices, sf::Vector2f(plotX, plotY), dynapseCoreIdToColor(coreId));
+		pixelsSet(renderState, plotX, plotY, dynapseCoreIdToColor(coreId));
 	}
 
-	state->renderWindow->draw(vertices.data(), vertices.size(), sf::Quads);
+	pixelsDraw(state, renderState);
 
 	// Draw middle borders, only once!
-	sfml::Line horizontalBorderLine(sf::Vector2f(0, state->renderSizeY / 2),
+	state->canvas->drawLine(sf::Vector2f(0, state->renderSizeY / 2),
 		sf::Vector2f(state->renderSizeX, state->renderSizeY / 2), 2, sf::Color::White);
-	state->renderWindow->draw(horizontalBorderLine);
 
-	sfml::Line verticalBorderLine(sf::Vector2f(state->renderSizeX / 2, 0),
+	state->canvas->drawLine(sf::Vector2f(state->renderSizeX / 2, 0),
 		sf::Vector2f(state->renderSizeX / 2, state->renderSizeY), 2, sf::Color::White);
-	state->renderWindow->draw(verticalBorderLine);
+
+	return (true);
+}
+
+// Time bins (columns) shown by the scrolling raster plot, one pixel each.
+#define SPIKE_RASTER_SCROLL_COLUMNS 1000
+// Neurons beyond this many rows share one row, as the plot would get too high.
+#define SPIKE_RASTER_SCROLL_ROWS_MAX 1024
+// All neurons of the four chips, one after the other.
+#define SPIKE_RASTER_SCROLL_NEURONS (DYNAPSE_CONFIG_NUMNEURONS * 4)
+
+// Scrolling raster plot: the history is kept in a ring buffer of time bins,
+// so each frame only paints and uploads the bins that changed, instead of
+// replaying all spikes of the time window. The image is stored transposed,
+// one image row per time bin, so that a range of bins is contiguous in
+// memory and can be uploaded at once. Drawing untransposes and unrolls it.
+struct renderer_spike_raster_state {
+	/// 'rows' pixels per bin, one bin per image row.
+	struct caer_visualizer_image image;
+	/// Configuration the ring buffer was set up for.
+	int64_t timeWindow;
+	uint32_t neuronStart;
+	uint32_t neuronCount;
+	uint32_t neuronsPerRow;
+	uint32_t rows;
+	/// Time covered by one bin, in µs.
+	int64_t binTime;
+	/// Newest bin with content, -1 before the first spike.
+	int64_t headBin;
+};
+
+typedef struct renderer_spike_raster_state *rendererSpikeRasterState;
+
+static void spikeRasterConfigure(caerVisualizerPublicState state, rendererSpikeRasterState renderState) {
+	const int64_t timeWindow = sshsNodeGetInt(state->visualizerConfigNode, "rasterTimeWindow");
+	const uint32_t neuronStart = U32T(sshsNodeGetInt(state->visualizerConfigNode, "rasterNeuronStart"));
+	uint32_t neuronCount = U32T(sshsNodeGetInt(state->visualizerConfigNode, "rasterNeuronCount"));
+
+	if (neuronCount > (SPIKE_RASTER_SCROLL_NEURONS - neuronStart)) {
+		neuronCount = (SPIKE_RASTER_SCROLL_NEURONS - neuronStart);
+	}
+
+	if ((timeWindow == renderState->timeWindow) && (neuronStart == renderState->neuronStart)
+		&& (neuronCount == renderState->neuronCount)) {
+		return; // Nothing changed.
+	}
+
+	const uint32_t neuronsPerRow = (neuronCount + SPIKE_RASTER_SCROLL_ROWS_MAX - 1) / SPIKE_RASTER_SCROLL_ROWS_MAX;
+	const uint32_t rows = (neuronCount + neuronsPerRow - 1) / neuronsPerRow;
+
+	renderState->timeWindow = timeWindow;
+	renderState->neuronStart = neuronStart;
+	renderState->neuronCount = neuronCount;
+	renderState->neuronsPerRow = neuronsPerRow;
+	renderState->rows = rows;
+
+	renderState->binTime = (timeWindow + SPIKE_RASTER_SCROLL_COLUMNS - 1) / SPIKE_RASTER_SCROLL_COLUMNS;
+	renderState->headBin = -1;
+
+	// Start over with an empty plot.
+	caerVisualizerImageInit(&renderState->image, rows, SPIKE_RASTER_SCROLL_COLUMNS);
+}
+
+static void spikeRasterClearBin(rendererSpikeRasterState renderState, int64_t bin) {
+	const size_t column = (size_t) (bin % SPIKE_RASTER_SCROLL_COLUMNS);
+	const size_t columnSize = (size_t) renderState->rows * 4;
+
+	std::fill_n(renderState->image.pixels.begin() + (ptrdiff_t) (column * columnSize), columnSize, 0);
+	caerVisualizerImageChanged(&renderState->image, U32T(column), U32T(column + 1));
+}
+
+// Move the newest bin forward, clearing the bins that come into view.
+static void spikeRasterAdvance(rendererSpikeRasterState renderState, int64_t bin) {
+	if (renderState->headBin < 0 || bin <= (renderState->headBin - SPIKE_RASTER_SCROLL_COLUMNS)) {
+		// First spike, or older than the whole time window, which only
+		// happens when timestamps are reset: start over.
+		for (int64_t i = 0; i < SPIKE_RASTER_SCROLL_COLUMNS; i++) {
+			spikeRasterClearBin(renderState, i);
+		}
+
+		renderState->headBin = bin;
+		return;
+	}
+
+	if (bin <= renderState->headBin) {
+		return; // Late spike, for example from another chip, its bin is still there.
+	}
+
+	// Only the last window of bins still exists in the ring buffer.
+	const int64_t clearStart = std::max(renderState->headBin + 1, bin - SPIKE_RASTER_SCROLL_COLUMNS + 1);
+
+	for (int64_t i = clearStart; i <= bin; i++) {
+		spikeRasterClearBin(renderState, i);
+	}
+
+	renderState->headBin = bin;
+}
+
+static void *caerVisualizerRendererSpikeEventsRasterScrollStateInit(caerVisualizerPublicState state) {
+	sshsNodeCreateInt(state->visualizerConfigNode, "rasterTimeWindow", 10000000, SPIKE_RASTER_SCROLL_COLUMNS,
+		100000000, SSHS_FLAGS_NORMAL, "Time shown by the scrolling spike raster plot, in µs.");
+	sshsNodeCreateInt(state->visualizerConfigNode, "rasterNeuronStart", 0, 0, SPIKE_RASTER_SCROLL_NEURONS - 1,
+		SSHS_FLAGS_NORMAL,
+		"First neuron shown by the scrolling spike raster plot (chip * 1024 + core * 256 + neuron).");
+	sshsNodeCreateInt(state->visualizerConfigNode, "rasterNeuronCount", SPIKE_RASTER_SCROLL_NEURONS, 1,
+		SPIKE_RASTER_SCROLL_NEURONS, SSHS_FLAGS_NORMAL,
+		"Number of neurons shown by the scrolling spike raster plot, starting at rasterNeuronStart.");
+
+	// Allocate memory via C++ for renderer state, since we use C++ objects directly.
+	rendererSpikeRasterState renderState = new (std::nothrow) renderer_spike_raster_state();
+	if (renderState == nullptr) {
+		return (nullptr);
+	}
+
+	renderState->timeWindow = -1; // Force configuration.
+
+	spikeRasterConfigure(state, renderState);
+
+	// One pixel per time bin. Height follows the neurons at startup, later
+	// changes to the neuron subset are scaled to fit.
+	caerVisualizerResetRenderSize(state, SPIKE_RASTER_SCROLL_COLUMNS, renderState->rows);
+
+	return (renderState);
+}
+
+static void caerVisualizerRendererSpikeEventsRasterScrollStateExit(caerVisualizerPublicState state) {
+	rendererSpikeRasterState renderState = (rendererSpikeRasterState) state->renderState;
+
+	delete renderState;
+}
+
+static bool caerVisualizerRendererSpikeEventsRasterScroll(caerVisualizerPublicState state,
+	caerEventPacketContainer container) {
+	caerEventPacketHeader spikePacketHeader = caerEventPacketContainerFindEventPacketByType(container, SPIKE_EVENT);
+
+	if (spikePacketHeader == NULL || caerEventPacketHeaderGetEventValid(spikePacketHeader) == 0) {
+		return (false);
+	}
+
+	rendererSpikeRasterState renderState = (rendererSpikeRasterState) state->renderState;
+
+	spikeRasterConfigure(state, renderState);
+
+	const libcaer::events::SpikeEventPacket spikePacket(spikePacketHeader, false);
+
+	// Paint new spikes into their bins.
+	for (const auto &spikeEvent : spikePacket) {
+		if (!spikeEvent.isValid()) {
+			continue; // Skip invalid events.
+		}
+
+		// Chips follow each other in the same order as the raster plot's quadrants.
+		uint32_t neuron = spikeEvent.getNeuronID();
+		neuron += U32T(spikeEvent.getSourceCoreID() * DYNAPSE_CONFIG_NUMNEURONS_CORE);
+
+		const uint8_t chipId = spikeEvent.getChipID();
+
+		if (chipId == DYNAPSE_CONFIG_DYNAPSE_U1) {
+			neuron += DYNAPSE_CONFIG_NUMNEURONS;
+		}
+		else if (chipId == DYNAPSE_CONFIG_DYNAPSE_U2) {
+			neuron += DYNAPSE_CONFIG_NUMNEURONS * 2;
+		}
+		else if (chipId == DYNAPSE_CONFIG_DYNAPSE_U3) {
+			neuron += DYNAPSE_CONFIG_NUMNEURONS * 3;
+		}
+
+		if (neuron < renderState->neuronStart || neuron >= (renderState->neuronStart + renderState->neuronCount)) {
+			continue; // Not in shown subset.
+		}
+
+		const int64_t bin = spikeEvent.getTimestamp64(spikePacket) / renderState->binTime;
+
+		spikeRasterAdvance(renderState, bin);
+
+		const size_t column = (size_t) (bin % SPIKE_RASTER_SCROLL_COLUMNS);
+		const uint32_t row = (neuron - renderState->neuronStart) / renderState->neuronsPerRow;
+		const size_t idx = ((column * renderState->rows) + row) * 4;
+
+		const sf::Color color = dynapseCoreIdToColor(spikeEvent.getSourceCoreID());
+
+		renderState->image.pixels[idx] = color.r;
+		renderState->image.pixels[idx + 1] = color.g;
+		renderState->image.pixels[idx + 2] = color.b;
+		renderState->image.pixels[idx + 3] = color.a;
+
+		caerVisualizerImageChanged(&renderState->image, U32T(column), U32T(column + 1));
+	}
+
+	if (renderState->headBin < 0) {
+		return (false); // Nothing to show yet.
+	}
+
+	// Draw the ring buffer from the oldest bin on the left to the newest on the
+	// right, as two quads. Image X is the neuron, image Y the time bin. Only
+	// the changed bins are uploaded.
+	const float sizeX = (float) state->renderSizeX;
+	const float sizeY = (float) state->renderSizeY;
+	const float rows = (float) renderState->rows;
+
+	const uint32_t oldestColumn = U32T((renderState->headBin + 1) % SPIKE_RASTER_SCROLL_COLUMNS);
+	const float splitX = sizeX * ((float) (SPIKE_RASTER_SCROLL_COLUMNS - oldestColumn) / SPIKE_RASTER_SCROLL_COLUMNS);
+
+	const sf::Vertex vertices[8] = {
+		// Oldest bins, up to the end of the ring buffer.
+		sf::Vertex(sf::Vector2f(0, 0), sf::Vector2f(0, oldestColumn)),
+		sf::Vertex(sf::Vector2f(splitX, 0), sf::Vector2f(0, SPIKE_RASTER_SCROLL_COLUMNS)),
+		sf::Vertex(sf::Vector2f(splitX, sizeY), sf::Vector2f(rows, SPIKE_RASTER_SCROLL_COLUMNS)),
+		sf::Vertex(sf::Vector2f(0, sizeY), sf::Vector2f(rows, oldestColumn)),
+		// Newest bins, from the start of the ring buffer.
+		sf::Vertex(sf::Vector2f(splitX, 0), sf::Vector2f(0, 0)),
+		sf::Vertex(sf::Vector2f(sizeX, 0), sf::Vector2f(0, oldestColumn)),
+		sf::Vertex(sf::Vector2f(sizeX, sizeY), sf::Vector2f(rows, oldestColumn)),
+		sf::Vertex(sf::Vector2f(splitX, sizeY), sf::Vector2f(rows, 0)),
+	};
+
+	state->canvas->drawImageQuads(&renderState->image, vertices, 8);
 
 	return (true);
 }
 
 // TODO: what is this? Nowhere is a 4D event generated, nor is it needed as only X/Y/Z are used here.
 static bool caerVisualizerRendererETF4D(caerVisualizerPublicState state, caerEventPacketContainer container) {
-	UNUSED_ARGUMENT(state);
-
 	caerEventPacketHeader point4DPacketHeader = caerEventPacketContainerFindEventPacketByType(container, POINT4D_EVENT);
 
 	if (point4DPacketHeader == NULL || caerEventPacketHeaderGetEventValid(point4DPacketHeader) == 0) {
@@ -499,7 +740,9 @@ static bool caerVisualizerRendererETF4D(caerVisualizerPublicState state, caerEve
 	float scaleX = ((float) sizeX) / 5.0f;
 	float scaleY = ((float) sizeY) / maxMean;
 
-	std::vector<sf::Vertex> vertices((size_t) point4DPacket.getEventValid() * 4);
+	rendererPixelsState renderState = (rendererPixelsState) state->renderState;
+
+	pixelsClear(renderState);
 
 	int counter = 0;
 	for (const auto &point4DEvent : point4DPacket) {
@@ -526,7 +769,7 @@ static bool caerVisualizerRendererETF4D(caerVisualizerPublicState state, caerEve
 			coreId = 3;
 		}
 
-		sfml::Helpers::addPixelVertices(vertices, sf::Vector2f(sizeX - plotX, plotY), dynapseCoreIdToColor(coreId));
+		pixelsSet(renderState, sizeX - plotX, plotY, dynapseCoreIdToColor(coreId));
 
 		// Reset counter, must reset at -1 of value used in scale.
 		if (counter == 4) {
@@ -537,16 +780,53 @@ static bool caerVisualizerRendererETF4D(caerVisualizerPublicState state, caerEve
 		}
 	}
 
-	state->renderWindow->draw(vertices.data(), vertices.size(), sf::Quads);
+	pixelsDraw(state, renderState);
 
 	return (true);
 }
 
+// Frames and events are kept in separate images, so that a frame stays
+// visible below the events until the next one arrives.
+struct renderer_polarity_and_frame_events_state {
+	struct renderer_pixels_state frame;
+	struct renderer_pixels_state polarity;
+	bool haveFrame;
+};
+
+typedef struct renderer_polarity_and_frame_events_state *rendererPolarityAndFrameEventsState;
+
+static void *caerVisualizerRendererPolarityAndFrameEventsStateInit(caerVisualizerPublicState state) {
+	rendererPolarityAndFrameEventsState renderState = new (std::nothrow) renderer_polarity_and_frame_events_state();
+	if (renderState == nullptr) {
+		return (nullptr);
+	}
+
+	pixelsStateInit(&renderState->frame, state->renderSizeX, state->renderSizeY);
+	pixelsStateInit(&renderState->polarity, state->renderSizeX, state->renderSizeY);
+
+	return (renderState);
+}
+
+static void caerVisualizerRendererPolarityAndFrameEventsStateExit(caerVisualizerPublicState state) {
+	rendererPolarityAndFrameEventsState renderState = (rendererPolarityAndFrameEventsState) state->renderState;
+
+	delete renderState;
+}
+
 static bool caerVisualizerRendererPolarityAndFrameEvents(caerVisualizerPublicState state,
 	caerEventPacketContainer container) {
-	bool drewFrameEvents = caerVisualizerRendererFrameEvents(state, container);
+	rendererPolarityAndFrameEventsState renderState = (rendererPolarityAndFrameEventsState) state->renderState;
+
+	bool drewFrameEvents = renderFrameEvents(state, &renderState->frame, container);
+
+	if (drewFrameEvents) {
+		renderState->haveFrame = true;
+	}
+	else if (renderState->haveFrame) {
+		state->canvas->drawImage(&renderState->frame.image, renderState->frame.position);
+	}
 
-	bool drewPolarityEvents = caerVisualizerRendererPolarityEvents(state, container);
+	bool drewPolarityEvents = renderPolarityEvents(state, &renderState->polarity, container);
 
 	return (drewFrameEvents || drewPolarityEvents);
 }
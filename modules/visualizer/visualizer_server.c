@@ -0,0 +1,539 @@
+#include "visualizer_server.h"
+#include "ext/libuv.h"
+#include "ext/threads_ext.h"
+
+#ifdef HAVE_PTHREADS
+#include "ext/c11threads_posix.h"
+#endif
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_STATIC
+#define STBI_WRITE_NO_STDIO
+#include "ext/stblib/stb_image_write.h"
+
+#define SERVER_BACKLOG_SIZE 5
+#define SERVER_HEADER_SIZE 16
+#define SERVER_FORMAT_PNG 0
+
+// Each quality level halves the resolution again.
+#define SERVER_QUALITY_LEVELS 4
+// Frames a client must take without falling behind, before its quality goes back up.
+#define SERVER_QUALITY_RECOVER_FRAMES 20
+
+struct visualizer_server_client {
+	/// NULL if this slot is free.
+	uv_tcp_t *handle;
+	/// Extra decimation steps, raised while the client can't keep up.
+	uint32_t qualityLevel;
+	/// Frames sent in a row since the last quality change.
+	uint32_t goodFrames;
+	uint64_t framesSent;
+	uint64_t framesSkipped;
+};
+
+struct visualizer_server_frame {
+	uint8_t *pixels;
+	size_t pixelsCapacity;
+	uint32_t sizeX;
+	uint32_t sizeY;
+};
+
+struct caer_visualizer_server {
+	caerModuleData moduleData;
+	/// Base decimation, applied to all clients.
+	uint32_t decimation;
+	thrd_t thread;
+	uv_loop_t loop;
+	uv_tcp_t *server;
+	uv_async_t newFrame;
+	uv_async_t shutdown;
+	/// Read by the render thread to skip frame read-back without clients.
+	atomic_size_t activeClients;
+	/// Newest frame from the render thread, not yet picked up.
+	mtx_t frameLock;
+	bool frameReady;
+	struct visualizer_server_frame pendingFrame;
+	// Server thread only.
+	struct visualizer_server_frame sendFrame;
+	uint8_t *decimatedPixels;
+	size_t decimatedPixelsCapacity;
+	size_t clientsSize;
+	struct visualizer_server_client clients[];
+};
+
+struct visualizer_server_png {
+	simpleBuffer buffer;
+	bool failed;
+};
+
+static int serverThread(void *serverPtr);
+static void onConnection(uv_stream_t *serverHandle, int status);
+static void onNewFrame(uv_async_t *handle);
+static void onShutdown(uv_async_t *handle);
+static void writeStatusCheck(uv_handle_t *handle, int status);
+static void closeClient(caerVisualizerServer server, size_t clientIndex);
+static libuvWriteMultiBuf encodeFrame(caerVisualizerServer server, uint32_t decimation);
+static void pngWrite(void *context, void *data, int size);
+static bool ensureCapacity(uint8_t **buffer, size_t *capacity, size_t size);
+static void serverFree(caerVisualizerServer server);
+
+caerVisualizerServer caerVisualizerServerInit(caerModuleData moduleData, const char *ipAddress, uint16_t portNumber,
+	size_t maxClients, uint32_t decimation) {
+	struct sockaddr_in serverAddress;
+
+	int retVal = uv_ip4_addr(ipAddress, portNumber, &serverAddress);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_ip4_addr", return (NULL));
+
+	caerVisualizerServer server = calloc(1, sizeof(*server) + (maxClients * sizeof(struct visualizer_server_client)));
+	if (server == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for remote server.");
+		return (NULL);
+	}
+
+	server->moduleData = moduleData;
+	server->decimation = decimation;
+	server->clientsSize = maxClients;
+	atomic_store(&server->activeClients, 0);
+
+	if (mtx_init(&server->frameLock, mtx_plain) != thrd_success) {
+		free(server);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize frame lock.");
+		return (NULL);
+	}
+
+	server->server = malloc(sizeof(uv_tcp_t));
+	if (server->server == NULL) {
+		serverFree(server);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for network server.");
+		return (NULL);
+	}
+
+	server->server->data = server;
+	server->newFrame.data = server;
+	server->shutdown.data = server;
+
+	retVal = uv_loop_init(&server->loop);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_loop_init", free(server->server); serverFree(server);
+		return (NULL));
+
+	retVal = uv_tcp_init(&server->loop, server->server);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_tcp_init", uv_loop_close(&server->loop);
+		free(server->server); serverFree(server); return (NULL));
+
+	// From here on, libuvCloseLoopHandles() frees the server handle. The async
+	// handles are part of the server structure, they must never be freed by it,
+	// so they are only initialized once nothing else can fail anymore.
+	retVal = uv_tcp_bind(server->server, (const struct sockaddr *) &serverAddress, 0);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_tcp_bind", libuvCloseLoopHandles(&server->loop);
+		uv_loop_close(&server->loop); serverFree(server); return (NULL));
+
+	retVal = uv_listen((uv_stream_t *) server->server, SERVER_BACKLOG_SIZE, &onConnection);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_listen", libuvCloseLoopHandles(&server->loop);
+		uv_loop_close(&server->loop); serverFree(server); return (NULL));
+
+	retVal = uv_async_init(&server->loop, &server->newFrame, &onNewFrame);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_async_init", libuvCloseLoopHandles(&server->loop);
+		uv_loop_close(&server->loop); serverFree(server); return (NULL));
+
+	retVal = uv_async_init(&server->loop, &server->shutdown, &onShutdown);
+	UV_RET_CHECK(retVal, moduleData->moduleSubSystemString, "uv_async_init",
+		uv_close((uv_handle_t *) &server->newFrame, NULL); libuvCloseLoopHandles(&server->loop);
+		uv_loop_close(&server->loop); serverFree(server); return (NULL));
+
+	if (thrd_create(&server->thread, &serverThread, server) != thrd_success) {
+		uv_close((uv_handle_t *) &server->newFrame, NULL);
+		uv_close((uv_handle_t *) &server->shutdown, NULL);
+		libuvCloseLoopHandles(&server->loop);
+		uv_loop_close(&server->loop);
+		serverFree(server);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to start remote server thread.");
+		return (NULL);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Serving remote views on %s:%" PRIu16 ".", ipAddress, portNumber);
+
+	return (server);
+}
+
+bool caerVisualizerServerHasClients(caerVisualizerServer server) {
+	return (atomic_load_explicit(&server->activeClients, memory_order_relaxed) > 0);
+}
+
+void caerVisualizerServerPut(caerVisualizerServer server, const uint8_t *pixels, uint32_t sizeX, uint32_t sizeY) {
+	size_t pixelsSize = (size_t) sizeX * sizeY * 4;
+
+	mtx_lock(&server->frameLock);
+
+	if (!ensureCapacity(&server->pendingFrame.pixels, &server->pendingFrame.pixelsCapacity, pixelsSize)) {
+		mtx_unlock(&server->frameLock);
+
+		caerModuleLog(server->moduleData, CAER_LOG_ERROR, "Failed to allocate memory for remote frame.");
+		return;
+	}
+
+	memcpy(server->pendingFrame.pixels, pixels, pixelsSize);
+	server->pendingFrame.sizeX = sizeX;
+	server->pendingFrame.sizeY = sizeY;
+	server->frameReady = true;
+
+	mtx_unlock(&server->frameLock);
+
+	uv_async_send(&server->newFrame);
+}
+
+void caerVisualizerServerExit(caerVisualizerServer server) {
+	uv_async_send(&server->shutdown);
+
+	if ((errno = thrd_join(server->thread, NULL)) != thrd_success) {
+		// This should never happen!
+		caerModuleLog(server->moduleData, CAER_LOG_CRITICAL, "Failed to join remote server thread. Error: %d.",
+		errno);
+	}
+
+	int retVal = uv_loop_close(&server->loop);
+	UV_RET_CHECK(retVal, server->moduleData->moduleSubSystemString, "uv_loop_close",);
+
+	serverFree(server);
+}
+
+static int serverThread(void *serverPtr) {
+	caerVisualizerServer server = serverPtr;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(server->moduleData->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 8]; // +1 for NUL character.
+	strcpy(threadName, server->moduleData->moduleSubSystemString);
+	strcat(threadName, "[Remote]");
+	thrd_set_name(threadName);
+
+	int retVal = uv_run(&server->loop, UV_RUN_DEFAULT);
+	UV_RET_CHECK(retVal, server->moduleData->moduleSubSystemString, "uv_run", return (thrd_error));
+
+	// Treat anything being still alive as an error. Async shutdown should have closed everything!
+	if (retVal > 0) {
+		caerModuleLog(server->moduleData, CAER_LOG_WARNING, "uv_run() exited with still active handles.");
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static void onConnection(uv_stream_t *serverHandle, int status) {
+	caerVisualizerServer server = serverHandle->data;
+
+	UV_RET_CHECK(status, server->moduleData->moduleSubSystemString, "Connection", return);
+
+	uv_tcp_t *client = malloc(sizeof(uv_tcp_t));
+	if (client == NULL) {
+		caerModuleLog(server->moduleData, CAER_LOG_ERROR, "Failed to allocate memory for new client.");
+		return;
+	}
+
+	int retVal = uv_tcp_init(serverHandle->loop, client);
+	UV_RET_CHECK(retVal, server->moduleData->moduleSubSystemString, "uv_tcp_init", free(client); return);
+
+	client->data = server;
+
+	retVal = uv_accept(serverHandle, (uv_stream_t *) client);
+	UV_RET_CHECK(retVal, server->moduleData->moduleSubSystemString, "uv_accept", goto killConnection);
+
+	// Each frame is one write, and only the newest one matters: send right away.
+	uv_tcp_nodelay(client, true);
+
+	// Find place for new connection. If all exhausted, we've reached maximum
+	// number of clients and just kill the connection.
+	for (size_t i = 0; i < server->clientsSize; i++) {
+		if (server->clients[i].handle == NULL) {
+			memset(&server->clients[i], 0, sizeof(struct visualizer_server_client));
+			server->clients[i].handle = client;
+
+			atomic_fetch_add_explicit(&server->activeClients, 1, memory_order_relaxed);
+
+			return;
+		}
+	}
+
+	caerModuleLog(server->moduleData, CAER_LOG_NOTICE, "Maximum number of remote clients reached, refusing client.");
+
+	killConnection: {
+		uv_close((uv_handle_t *) client, &libuvCloseFree);
+	}
+}
+
+static void onNewFrame(uv_async_t *handle) {
+	caerVisualizerServer server = handle->data;
+
+	mtx_lock(&server->frameLock);
+
+	if (!server->frameReady) {
+		mtx_unlock(&server->frameLock);
+		return;
+	}
+
+	struct visualizer_server_frame swap = server->sendFrame;
+	server->sendFrame = server->pendingFrame;
+	server->pendingFrame = swap;
+	server->frameReady = false;
+
+	mtx_unlock(&server->frameLock);
+
+	// Decide quality for each client first. A client still busy with the
+	// previous frame skips this one, and gets a lower resolution from now on.
+	// So there is at most one frame queued per client, and a slow link only
+	// costs that client frames and resolution, never memory or other clients.
+	size_t levelClients[SERVER_QUALITY_LEVELS] = { 0 };
+	bool sendClient[server->clientsSize];
+
+	for (size_t i = 0; i < server->clientsSize; i++) {
+		struct visualizer_server_client *clientInfo = &server->clients[i];
+
+		sendClient[i] = false;
+
+		if (clientInfo->handle == NULL) {
+			continue;
+		}
+
+		if (clientInfo->handle->write_queue_size > 0) {
+			clientInfo->framesSkipped++;
+			clientInfo->goodFrames = 0;
+
+			if (clientInfo->qualityLevel < (SERVER_QUALITY_LEVELS - 1)) {
+				clientInfo->qualityLevel++;
+			}
+
+			continue;
+		}
+
+		if (++clientInfo->goodFrames >= SERVER_QUALITY_RECOVER_FRAMES && clientInfo->qualityLevel > 0) {
+			clientInfo->qualityLevel--;
+			clientInfo->goodFrames = 0;
+		}
+
+		sendClient[i] = true;
+		levelClients[clientInfo->qualityLevel]++;
+	}
+
+	// Encode each needed quality once, and share the buffer among its clients.
+	libuvWriteMultiBuf levelBuffers[SERVER_QUALITY_LEVELS] = { NULL };
+
+	for (size_t level = 0; level < SERVER_QUALITY_LEVELS; level++) {
+		if (levelClients[level] == 0) {
+			continue;
+		}
+
+		levelBuffers[level] = encodeFrame(server, server->decimation << level);
+		if (levelBuffers[level] != NULL) {
+			levelBuffers[level]->refCount = levelClients[level];
+		}
+	}
+
+	for (size_t i = 0; i < server->clientsSize; i++) {
+		if (!sendClient[i]) {
+			continue;
+		}
+
+		struct visualizer_server_client *clientInfo = &server->clients[i];
+		libuvWriteMultiBuf buffers = levelBuffers[clientInfo->qualityLevel];
+
+		if (buffers == NULL) {
+			clientInfo->framesSkipped++;
+			continue;
+		}
+
+		int retVal = libuvWrite((uv_stream_t *) clientInfo->handle, buffers);
+		UV_RET_CHECK(retVal, server->moduleData->moduleSubSystemString, "libuvWrite", libuvWriteBufFree(buffers);
+			clientInfo->framesSkipped++; continue);
+
+		clientInfo->framesSent++;
+	}
+}
+
+static void onShutdown(uv_async_t *handle) {
+	// This is only ever called in response to caerVisualizerServerExit().
+	caerVisualizerServer server = handle->data;
+
+	uv_close((uv_handle_t *) &server->newFrame, NULL);
+	uv_close((uv_handle_t *) server->server, &libuvCloseFree);
+
+	// Frames still being sent are of no use anymore, no need for a clean shutdown.
+	for (size_t i = 0; i < server->clientsSize; i++) {
+		if (server->clients[i].handle != NULL) {
+			closeClient(server, i);
+		}
+	}
+
+	uv_close((uv_handle_t *) &server->shutdown, NULL);
+}
+
+static void writeStatusCheck(uv_handle_t *handle, int status) {
+	// Writes cancelled by closing the client need no further handling.
+	if (status >= 0 || uv_is_closing(handle)) {
+		return;
+	}
+
+	caerVisualizerServer server = handle->data;
+
+	caerModuleLog(server->moduleData, CAER_LOG_INFO, "Write to remote client failed with error %d (%s), closing it.",
+		status, uv_err_name(status));
+
+	for (size_t i = 0; i < server->clientsSize; i++) {
+		if ((uv_handle_t *) server->clients[i].handle == handle) {
+			closeClient(server, i);
+			break;
+		}
+	}
+}
+
+static void closeClient(caerVisualizerServer server, size_t clientIndex) {
+	struct visualizer_server_client *clientInfo = &server->clients[clientIndex];
+
+	caerModuleLog(server->moduleData, CAER_LOG_INFO,
+		"Remote client %zu statistics: sent %" PRIu64 " frames, skipped %" PRIu64 " frames.", clientIndex,
+		clientInfo->framesSent, clientInfo->framesSkipped);
+
+	uv_close((uv_handle_t *) clientInfo->handle, &libuvCloseFree);
+
+	clientInfo->handle = NULL;
+	atomic_fetch_sub_explicit(&server->activeClients, 1, memory_order_relaxed);
+}
+
+static libuvWriteMultiBuf encodeFrame(caerVisualizerServer server, uint32_t decimation) {
+	const struct visualizer_server_frame *frame = &server->sendFrame;
+
+	const uint32_t outSizeX = (frame->sizeX + decimation - 1) / decimation;
+	const uint32_t outSizeY = (frame->sizeY + decimation - 1) / decimation;
+
+	if (!ensureCapacity(&server->decimatedPixels, &server->decimatedPixelsCapacity,
+		(size_t) outSizeX * outSizeY * 3)) {
+		caerModuleLog(server->moduleData, CAER_LOG_ERROR, "Failed to allocate memory for remote frame.");
+		return (NULL);
+	}
+
+	// Box filter down to RGB, alpha is always opaque.
+	for (uint32_t outY = 0; outY < outSizeY; outY++) {
+		const uint32_t startY = outY * decimation;
+		const uint32_t endY = ((startY + decimation) < frame->sizeY) ? (startY + decimation) : (frame->sizeY);
+
+		for (uint32_t outX = 0; outX < outSizeX; outX++) {
+			const uint32_t startX = outX * decimation;
+			const uint32_t endX = ((startX + decimation) < frame->sizeX) ? (startX + decimation) : (frame->sizeX);
+
+			uint32_t sum[3] = { 0, 0, 0 };
+
+			for (uint32_t y = startY; y < endY; y++) {
+				const uint8_t *pixel = frame->pixels + ((((size_t) y * frame->sizeX) + startX) * 4);
+
+				for (uint32_t x = startX; x < endX; x++, pixel += 4) {
+					sum[0] += pixel[0];
+					sum[1] += pixel[1];
+					sum[2] += pixel[2];
+				}
+			}
+
+			const uint32_t count = (endX - startX) * (endY - startY);
+			uint8_t *outPixel = server->decimatedPixels + ((((size_t) outY * outSizeX) + outX) * 3);
+
+			outPixel[0] = U8T(sum[0] / count);
+			outPixel[1] = U8T(sum[1] / count);
+			outPixel[2] = U8T(sum[2] / count);
+		}
+	}
+
+	// Header and PNG go into one heap buffer, as libuvWrite() needs.
+	struct visualizer_server_png png = { .buffer = NULL, .failed = false };
+
+	if (stbi_write_png_to_func(&pngWrite, &png, I32T(outSizeX), I32T(outSizeY), 3, server->decimatedPixels,
+		I32T(outSizeX * 3)) == 0 || png.failed) {
+		free(png.buffer);
+
+		caerModuleLog(server->moduleData, CAER_LOG_ERROR, "Failed to encode remote frame as PNG.");
+		return (NULL);
+	}
+
+	const uint32_t pngSize = U32T(png.buffer->bufferUsedSize - SERVER_HEADER_SIZE);
+	uint8_t *header = png.buffer->buffer;
+
+	header[0] = 'C';
+	header[1] = 'V';
+	header[2] = 'I';
+	header[3] = 'S';
+	header[4] = U8T(outSizeX);
+	header[5] = U8T(outSizeX >> 8);
+	header[6] = U8T(outSizeY);
+	header[7] = U8T(outSizeY >> 8);
+	header[8] = U8T(decimation);
+	header[9] = SERVER_FORMAT_PNG;
+	header[10] = 0;
+	header[11] = 0;
+	header[12] = U8T(pngSize);
+	header[13] = U8T(pngSize >> 8);
+	header[14] = U8T(pngSize >> 16);
+	header[15] = U8T(pngSize >> 24);
+
+	libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
+	if (buffers == NULL) {
+		free(png.buffer);
+
+		caerModuleLog(server->moduleData, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
+		return (NULL);
+	}
+
+	buffers->statusCheck = &writeStatusCheck;
+
+	libuvWriteBufInitWithSimpleBuffer(&buffers->buffers[0], png.buffer);
+
+	return (buffers);
+}
+
+static void pngWrite(void *context, void *data, int size) {
+	struct visualizer_server_png *png = context;
+
+	if (png->failed) {
+		return;
+	}
+
+	// The encoder writes the whole image at once, but don't rely on it.
+	size_t usedSize = (png->buffer == NULL) ? (SERVER_HEADER_SIZE) : (png->buffer->bufferUsedSize);
+
+	simpleBuffer newBuffer = realloc(png->buffer, sizeof(*newBuffer) + usedSize + (size_t) size);
+	if (newBuffer == NULL) {
+		png->failed = true;
+		return;
+	}
+
+	memcpy(newBuffer->buffer + usedSize, data, (size_t) size);
+	newBuffer->bufferPosition = 0;
+	newBuffer->bufferUsedSize = usedSize + (size_t) size;
+	newBuffer->bufferSize = newBuffer->bufferUsedSize;
+
+	png->buffer = newBuffer;
+}
+
+static bool ensureCapacity(uint8_t **buffer, size_t *capacity, size_t size) {
+	if (*capacity >= size) {
+		return (true);
+	}
+
+	uint8_t *newBuffer = realloc(*buffer, size);
+	if (newBuffer == NULL) {
+		return (false);
+	}
+
+	*buffer = newBuffer;
+	*capacity = size;
+
+	return (true);
+}
+
+static void serverFree(caerVisualizerServer server) {
+	mtx_destroy(&server->frameLock);
+
+	free(server->pendingFrame.pixels);
+	free(server->sendFrame.pixels);
+	free(server->decimatedPixels);
+
+	free(server);
+}
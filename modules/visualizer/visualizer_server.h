@@ -0,0 +1,39 @@
+#ifndef MODULES_VISUALIZER_VISUALIZER_SERVER_H_
+#define MODULES_VISUALIZER_VISUALIZER_SERVER_H_
+
+#include "base/module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Serves the rendered views to remote clients over TCP, as decimated PNG
+// images, from its own libuv event loop thread. Only the newest frame is
+// kept: clients that are still receiving the previous one skip frames and
+// get a lower resolution, until they catch up again.
+//
+// Every frame is sent as a 16 byte header followed by the PNG image (RGB),
+// all little-endian:
+//   bytes 0-3: magic 'CVIS'
+//   bytes 4-5: image width, bytes 6-7: image height (uint16)
+//   byte 8: decimation factor applied to the rendered view
+//   byte 9: payload format (0 = PNG), bytes 10-11: reserved (zero)
+//   bytes 12-15: payload size in bytes (uint32)
+typedef struct caer_visualizer_server *caerVisualizerServer;
+
+// Returns NULL on failure.
+caerVisualizerServer caerVisualizerServerInit(caerModuleData moduleData, const char *ipAddress, uint16_t portNumber,
+	size_t maxClients, uint32_t decimation);
+// If false, there is no need to read back and Put() frames.
+bool caerVisualizerServerHasClients(caerVisualizerServer server);
+// Hand over a frame of 32-bit RGBA pixels (sizeX * sizeY * 4 bytes) for sending.
+// Replaces any frame not yet picked up by the server thread.
+void caerVisualizerServerPut(caerVisualizerServer server, const uint8_t *pixels, uint32_t sizeX, uint32_t sizeY);
+// Closes all connections, then stops the server thread.
+void caerVisualizerServerExit(caerVisualizerServer server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODULES_VISUALIZER_VISUALIZER_SERVER_H_ */
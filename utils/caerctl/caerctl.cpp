@@ -3,11 +3,14 @@
 #include "ext/sshs/sshs.h"
 #include "utils/ext/linenoise-ng/linenoise.h"
 #include <iostream>
+#include <fstream>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <boost/asio.hpp>
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/trim.hpp>
 
 namespace asio = boost::asio;
 namespace asioIP = boost::asio::ip;
@@ -21,6 +24,10 @@ namespace po = boost::program_options;
 
 #define CAERCTL_HISTORY_FILE_NAME ".caerctl_history"
 
+// Batch mode: maximum number of requests sent without having received
+// their response yet.
+#define CAERCTL_PIPELINE_DEPTH 64
+
 static inline boost::filesystem::path getHomeDirectory() {
 	// First query main environment variables: HOME on Unix, USERPROFILE on Windows.
 	const char *homeDir = getenv("HOME");
@@ -57,7 +64,9 @@ static inline boost::filesystem::path getHomeDirectory() {
 		boost::system::errc::make_error_code(boost::system::errc::no_such_file_or_directory));
 }
 
+static size_t generateRequest(const char *buf, size_t bufLength, uint8_t *dataBuffer, std::string &error);
 static void handleInputLine(const char *buf, size_t bufLength);
+static int handleBatch(std::istream &input, bool mergeRequests);
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete);
 
 static void actionCompletion(const char *buf, size_t bufLength, linenoiseCompletions *autoComplete,
@@ -105,7 +114,12 @@ int main(int argc, char *argv[]) {
 		"IP-address or hostname to connect to")("port,p", po::value<std::string>(), "port to connect to")("script,s",
 		po::value<std::vector<std::string>>()->multitoken(),
 		"script mode, sends the given command directly to the server as if typed in and exits.\n"
-			"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7");
+			"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7")("batch,b",
+		po::value<std::string>(),
+		"batch mode, reads commands from the given file (- for standard input), one per line, and exits. Requests are "
+			"pipelined, and consecutive get and put commands are merged into batched requests. Each run of merged puts "
+			"is applied all-or-nothing. Empty lines and lines starting with # are ignored.")("nomerge",
+		"batch mode: send each command as its own request, so that puts are applied independently");
 
 	po::variables_map cliVarMap;
 	try {
@@ -156,6 +170,16 @@ int main(int argc, char *argv[]) {
 		scriptMode = true;
 	}
 
+	std::string batchFile;
+	if (cliVarMap.count("batch")) {
+		if (scriptMode) {
+			std::cout << "Script mode and batch mode cannot be used together!" << std::endl;
+			printHelpAndExit(cliDescription);
+		}
+
+		batchFile = cliVarMap["batch"].as<std::string>();
+	}
+
 	// Generate command history file path (in user home).
 	boost::filesystem::path commandHistoryFilePath;
 
@@ -181,6 +205,23 @@ int main(int argc, char *argv[]) {
 		return (EXIT_FAILURE);
 	}
 
+	// Batch mode doesn't touch the command history.
+	if (!batchFile.empty()) {
+		bool mergeRequests = (cliVarMap.count("nomerge") == 0);
+
+		if (batchFile == "-") {
+			return (handleBatch(std::cin, mergeRequests));
+		}
+
+		std::ifstream batchInput(batchFile);
+		if (!batchInput) {
+			std::cerr << "Failed to open batch file '" << batchFile << "'." << std::endl;
+			return (EXIT_FAILURE);
+		}
+
+		return (handleBatch(batchInput, mergeRequests));
+	}
+
 	// Load command history file.
 	linenoiseHistoryLoad(commandHistoryFilePath.string().c_str());
 
@@ -269,7 +310,15 @@ static inline void setValueLen(uint8_t *buf, uint16_t valueLen) {
 #define CMD_PART_TYPE 3
 #define CMD_PART_VALUE 4
 
-static void handleInputLine(const char *buf, size_t bufLength) {
+// Parse a command and encode it as a request to the configuration server.
+// Returns the request length, or zero on invalid commands (error is set).
+static size_t generateRequest(const char *buf, size_t bufLength, uint8_t *dataBuffer, std::string &error) {
+	// All parts plus their NUL terminators must fit into one request.
+	if (bufLength + 1 > (CAER_CONFIG_SERVER_BUFFER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE)) {
+		error = "command is too long.";
+		return (0);
+	}
+
 	// First let's split up the command into its constituents.
 	char *commandParts[MAX_CMD_PARTS + 1] = { nullptr };
 
@@ -286,8 +335,8 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		}
 		else {
 			// Abort, too many parts.
-			std::cerr << "Error: command is made up of too many parts." << std::endl;
-			return;
+			error = "command is made up of too many parts.";
+			return (0);
 		}
 
 		idx++;
@@ -296,8 +345,8 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 
 	// Check that we got something.
 	if (commandParts[CMD_PART_ACTION] == nullptr) {
-		std::cerr << "Error: empty command." << std::endl;
-		return;
+		error = "empty command.";
+		return (0);
 	}
 
 	// Let's get the action code first thing.
@@ -316,7 +365,6 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 	// EXTRA, NODE, KEY, VALUE have to be NUL terminated, and their length
 	// must include the NUL termination byte.
 	// This results in a maximum message size of 4096 bytes (4KB).
-	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
 	size_t dataBufferLength = 0;
 
 	// Now that we know what we want to do, let's decode the command line.
@@ -324,12 +372,12 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_NODE_EXISTS: {
 			// Check parameters needed for operation.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing node parameter." << std::endl;
-				return;
+				error = "missing node parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_NODE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				error = "too many parameters for command.";
+				return (0);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -353,20 +401,20 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_GET_DESCRIPTION: {
 			// Check parameters needed for operation.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing node parameter." << std::endl;
-				return;
+				error = "missing node parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_KEY] == nullptr) {
-				std::cerr << "Error: missing key parameter." << std::endl;
-				return;
+				error = "missing key parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_TYPE] == nullptr) {
-				std::cerr << "Error: missing type parameter." << std::endl;
-				return;
+				error = "missing type parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_TYPE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				error = "too many parameters for command.";
+				return (0);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -374,8 +422,8 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 
 			enum sshs_node_attr_value_type type = sshsHelperStringToTypeConverter(commandParts[CMD_PART_TYPE]);
 			if (type == SSHS_UNKNOWN) {
-				std::cerr << "Error: invalid type parameter." << std::endl;
-				return;
+				error = "invalid type parameter.";
+				return (0);
 			}
 
 			dataBuffer[0] = actionCode;
@@ -396,24 +444,24 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_PUT: {
 			// Check parameters needed for operation.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing node parameter." << std::endl;
-				return;
+				error = "missing node parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_KEY] == nullptr) {
-				std::cerr << "Error: missing key parameter." << std::endl;
-				return;
+				error = "missing key parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_TYPE] == nullptr) {
-				std::cerr << "Error: missing type parameter." << std::endl;
-				return;
+				error = "missing type parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_VALUE] == nullptr) {
-				std::cerr << "Error: missing value parameter." << std::endl;
-				return;
+				error = "missing value parameter.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_VALUE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				error = "too many parameters for command.";
+				return (0);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -422,8 +470,8 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 
 			enum sshs_node_attr_value_type type = sshsHelperStringToTypeConverter(commandParts[CMD_PART_TYPE]);
 			if (type == SSHS_UNKNOWN) {
-				std::cerr << "Error: invalid type parameter." << std::endl;
-				return;
+				error = "invalid type parameter.";
+				return (0);
 			}
 
 			dataBuffer[0] = actionCode;
@@ -446,16 +494,16 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_ADD_MODULE: {
 			// Check parameters needed for operation. Reuse node parameters.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing module name." << std::endl;
-				return;
+				error = "missing module name.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_KEY] == nullptr) {
-				std::cerr << "Error: missing library name." << std::endl;
-				return;
+				error = "missing library name.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_KEY + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				error = "too many parameters for command.";
+				return (0);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -479,12 +527,12 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_REMOVE_MODULE: {
 			// Check parameters needed for operation. Reuse node parameters.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing module name." << std::endl;
-				return;
+				error = "missing module name.";
+				return (0);
 			}
 			if (commandParts[CMD_PART_NODE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				error = "too many parameters for command.";
+				return (0);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -504,8 +552,21 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		}
 
 		default:
-			std::cerr << "Error: unknown command." << std::endl;
-			return;
+			error = "unknown command.";
+			return (0);
+	}
+
+	return (dataBufferLength);
+}
+
+static void handleInputLine(const char *buf, size_t bufLength) {
+	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
+	std::string error;
+
+	size_t dataBufferLength = generateRequest(buf, bufLength, dataBuffer, error);
+	if (dataBufferLength == 0) {
+		std::cerr << "Error: " << error << std::endl;
+		return;
 	}
 
 	// Send formatted command to configuration server.
@@ -571,6 +632,283 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 	std::cout << resultMsg.str() << std::endl;
 }
 
+struct BatchCommand {
+	size_t lineNumber;
+	/// Encoded single request, empty if the command is invalid.
+	std::vector<uint8_t> request;
+	bool success;
+	uint8_t resultType;
+	std::string result;
+};
+
+struct BatchRequest {
+	/// Action of the request sent: a single command's, or a batch action.
+	uint8_t action;
+	std::vector<uint8_t> data;
+	/// Commands answered by this request, in order.
+	std::vector<size_t> commands;
+	/// Node of the last entry, following entries on the same node leave it empty.
+	std::string lastNode;
+};
+
+static const char *actionToString(uint8_t actionCode) {
+	for (size_t i = 0; i < actionsLength; i++) {
+		if (actions[i].code == actionCode) {
+			return (actions[i].name);
+		}
+	}
+
+	return ("unknown");
+}
+
+// Read a full response, joining the parts of multi-part responses.
+static void readResponse(uint8_t &action, uint8_t &type, std::vector<uint8_t> &msg) {
+	msg.clear();
+
+	while (true) {
+		uint8_t header[4];
+		asio::read(netSocket, asio::buffer(header, 4));
+
+		action = header[0];
+		type = header[1];
+		uint16_t msgLength = le16toh(*(uint16_t * )(header + 2));
+
+		size_t offset = msg.size();
+		msg.resize(offset + msgLength);
+		asio::read(netSocket, asio::buffer(msg.data() + offset, msgLength));
+
+		// Only batch responses are split, TYPE is 1 on all parts but the last.
+		if ((action != CAER_CONFIG_GET_BATCH && action != CAER_CONFIG_GET_SUBTREE) || type == 0) {
+			break;
+		}
+	}
+}
+
+// Turn a single GET or PUT request into an entry of a batch request.
+static void appendBatchEntry(BatchRequest &batch, const std::vector<uint8_t> &request) {
+	uint16_t nodeLength = le16toh(*(const uint16_t * )(request.data() + 4));
+	uint16_t keyLength = le16toh(*(const uint16_t * )(request.data() + 6));
+	uint16_t valueLength = le16toh(*(const uint16_t * )(request.data() + 8));
+
+	const char *node = (const char *) request.data() + CAER_CONFIG_SERVER_HEADER_SIZE;
+
+	batch.data.push_back(request[1]);
+
+	if (batch.lastNode == node) {
+		batch.data.push_back('\0');
+	}
+	else {
+		batch.data.insert(batch.data.end(), node, node + nodeLength);
+		batch.lastNode = node;
+	}
+
+	batch.data.insert(batch.data.end(), request.begin() + CAER_CONFIG_SERVER_HEADER_SIZE + nodeLength,
+		request.begin() + CAER_CONFIG_SERVER_HEADER_SIZE + nodeLength + keyLength + valueLength);
+
+	setValueLen(batch.data.data(), (uint16_t) (batch.data.size() - CAER_CONFIG_SERVER_HEADER_SIZE));
+}
+
+static size_t batchEntryLength(const std::vector<uint8_t> &request) {
+	// TYPE byte plus NODE, KEY, VALUE (at most, NODE may be left out).
+	return (1 + request.size() - CAER_CONFIG_SERVER_HEADER_SIZE);
+}
+
+static void handleBatchResponse(std::vector<BatchCommand> &commands, const BatchRequest &request, uint8_t action,
+	uint8_t type, const std::vector<uint8_t> &msg) {
+	std::string msgString((const char *) msg.data(), strnlen((const char *) msg.data(), msg.size()));
+
+	if (action == CAER_CONFIG_ERROR) {
+		// PUT_BATCH errors say which entry failed, nothing was applied.
+		size_t failedEntry = 0;
+
+		if (request.action == CAER_CONFIG_PUT_BATCH) {
+			if (sscanf(msgString.c_str(), "Batch entry %zu:", &failedEntry) != 1
+				|| failedEntry > request.commands.size()) {
+				failedEntry = 0;
+			}
+		}
+
+		for (size_t i = 0; i < request.commands.size(); i++) {
+			BatchCommand &command = commands[request.commands[i]];
+
+			command.success = false;
+
+			if (failedEntry == 0) {
+				command.result = msgString;
+			}
+			else if (failedEntry == (i + 1)) {
+				// Remove the 'Batch entry N: ' prefix, the line is reported already.
+				size_t prefixEnd = msgString.find(": ");
+				command.result = msgString.substr((prefixEnd != std::string::npos) ? (prefixEnd + 2) : (0));
+			}
+			else {
+				command.result = (boost::format("not applied, put on line %zu failed.")
+					% commands[request.commands[failedEntry - 1]].lineNumber).str();
+			}
+		}
+
+		return;
+	}
+
+	if (action == CAER_CONFIG_GET_BATCH) {
+		size_t pos = 0;
+
+		for (size_t commandIndex : request.commands) {
+			BatchCommand &command = commands[commandIndex];
+
+			// Each entry is: 1 byte TYPE, VALUE (NUL terminated).
+			const uint8_t *value = msg.data() + pos + 1;
+			const uint8_t *nul =
+				(pos + 1 < msg.size()) ? ((const uint8_t *) memchr(value, '\0', msg.size() - pos - 1)) : (nullptr);
+			if (nul == nullptr) {
+				command.success = false;
+				command.result = "malformed batch response.";
+				continue;
+			}
+
+			command.resultType = msg[pos];
+			command.result = std::string((const char *) value, (size_t) (nul - value));
+			command.success = (command.resultType != CAER_CONFIG_BATCH_NOT_FOUND);
+
+			if (!command.success) {
+				command.result = "node or attribute doesn't exist.";
+			}
+
+			pos = (size_t) (nul - msg.data()) + 1;
+		}
+
+		return;
+	}
+
+	// Single command, or PUT_BATCH confirmation: same result for all.
+	for (size_t commandIndex : request.commands) {
+		commands[commandIndex].success = true;
+		commands[commandIndex].resultType = type;
+		commands[commandIndex].result = msgString;
+	}
+}
+
+static int handleBatch(std::istream &input, bool mergeRequests) {
+	std::vector<BatchCommand> commands;
+	std::vector<BatchRequest> requests;
+
+	// Parse all commands first, merging consecutive GETs and PUTs.
+	std::string line;
+	size_t lineNumber = 0;
+
+	while (std::getline(input, line)) {
+		lineNumber++;
+
+		boost::algorithm::trim(line);
+
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		if (line == "quit" || line == "exit") {
+			break;
+		}
+
+		BatchCommand command;
+		command.lineNumber = lineNumber;
+		command.success = false;
+		command.resultType = SSHS_UNKNOWN;
+
+		uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
+		size_t dataBufferLength = generateRequest(line.c_str(), line.length(), dataBuffer, command.result);
+
+		if (dataBufferLength != 0) {
+			command.request.assign(dataBuffer, dataBuffer + dataBufferLength);
+		}
+
+		commands.push_back(command);
+
+		if (dataBufferLength == 0) {
+			continue;
+		}
+
+		const std::vector<uint8_t> &request = commands.back().request;
+		uint8_t action = request[0];
+
+		if (mergeRequests && (action == CAER_CONFIG_GET || action == CAER_CONFIG_PUT)) {
+			uint8_t batchAction = (action == CAER_CONFIG_GET) ? (CAER_CONFIG_GET_BATCH) : (CAER_CONFIG_PUT_BATCH);
+
+			if (requests.empty() || requests.back().action != batchAction
+				|| (requests.back().data.size() + batchEntryLength(request)) > CAER_CONFIG_SERVER_BUFFER_SIZE) {
+				BatchRequest batch;
+				batch.action = batchAction;
+				batch.data.resize(CAER_CONFIG_SERVER_HEADER_SIZE, 0);
+				batch.data[0] = batchAction;
+
+				requests.push_back(batch);
+			}
+
+			appendBatchEntry(requests.back(), request);
+		}
+		else {
+			BatchRequest single;
+			single.action = action;
+			single.data = request;
+
+			requests.push_back(single);
+		}
+
+		requests.back().commands.push_back(commands.size() - 1);
+	}
+
+	// Send requests, without waiting for each response. The server answers
+	// requests on a connection in order.
+	size_t sent = 0;
+	size_t received = 0;
+
+	try {
+		std::vector<uint8_t> msg;
+
+		while (received < requests.size()) {
+			while (sent < requests.size() && (sent - received) < CAERCTL_PIPELINE_DEPTH) {
+				asio::write(netSocket, asio::buffer(requests[sent].data));
+				sent++;
+			}
+
+			uint8_t action, type;
+			readResponse(action, type, msg);
+
+			handleBatchResponse(commands, requests[received], action, type, msg);
+			received++;
+		}
+	}
+	catch (const boost::system::system_error &ex) {
+		boost::format exMsg = boost::format("Unable to communicate with config server, error message is:\n\t%s.")
+			% ex.what();
+		std::cerr << exMsg.str() << std::endl;
+
+		for (size_t i = received; i < requests.size(); i++) {
+			for (size_t commandIndex : requests[i].commands) {
+				commands[commandIndex].result = "no response from config server.";
+			}
+		}
+	}
+
+	// Report per-command results, in order.
+	size_t failures = 0;
+
+	for (const auto &command : commands) {
+		if (command.success) {
+			boost::format resultMsg = boost::format("Line %zu: Result: action=%s, type=%s, msg='%s'.")
+				% command.lineNumber % actionToString(command.request[0])
+				% sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) command.resultType)
+				% command.result;
+			std::cout << resultMsg.str() << std::endl;
+		}
+		else {
+			std::cerr << "Line " << command.lineNumber << ": Error: " << command.result << std::endl;
+			failures++;
+		}
+	}
+
+	return ((failures == 0) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
+
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete) {
 	size_t bufLength = strlen(buf);
 
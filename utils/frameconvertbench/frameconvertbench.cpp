@@ -0,0 +1,222 @@
+#include "frameconvertbench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+// Checks every frame conversion kernel from ext/frame_convert.h against the
+// scalar code, byte for byte, for all short lengths, so that every vector
+// loop and every tail length gets exercised. Then measures how long each
+// one takes to convert a full frame.
+
+// Source data is generated once, with a fixed seed, so that every run and
+// every kernel gets exactly the same data.
+#define BENCH_RANDOM_SEED 42
+
+// Bytes after the end of the destination, that must not be written to.
+#define BENCH_GUARD_SIZE 64
+#define BENCH_GUARD_VALUE 0xA5
+
+enum class benchFormat {
+	GRAYSCALE,
+	RGB,
+	RGBA,
+};
+
+struct bench_format_info {
+	const char *name;
+	size_t channels;
+	enum benchFormat format;
+};
+
+static const struct bench_format_info benchFormats[] = { { "Grayscale", 1, benchFormat::GRAYSCALE }, { "RGB", 3,
+	benchFormat::RGB }, { "RGBA", 4, benchFormat::RGBA } };
+
+typedef void (*frameConvertFunction)(uint8_t *dst, const uint16_t *src, size_t pixels);
+
+[[ noreturn ]] static inline void printHelpAndExit(po::options_description &desc) {
+	std::cout << std::endl << desc << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+static frameConvertFunction getFunction(const struct frame_convert_kernels *kernels, enum benchFormat format) {
+	switch (format) {
+		case benchFormat::GRAYSCALE:
+			return (kernels->grayscaleToRGBA);
+
+		case benchFormat::RGB:
+			return (kernels->rgbToRGBA);
+
+		case benchFormat::RGBA:
+		default:
+			return (kernels->rgbaToRGBA);
+	}
+}
+
+// Only the instruction sets this binary was built with are listed. Whether
+// the CPU running it supports them is checked separately.
+static bool kernelsSupported(const struct frame_convert_kernels *kernels) {
+#if defined(FRAME_CONVERT_BENCH_X86)
+	if (kernels == &frameConvertKernelsSSSE3) {
+		return (__builtin_cpu_supports("ssse3"));
+	}
+
+	if (kernels == &frameConvertKernelsAVX2) {
+		return (__builtin_cpu_supports("avx2"));
+	}
+#else
+	(void) (kernels);
+#endif
+
+	return (true);
+}
+
+// Convert 'pixels' pixels with both functions, starting 'offset' values into
+// the source and 'offset' bytes into the destination, so that unaligned
+// accesses are covered too. Returns true if the destinations, including the
+// guard bytes after them, are identical.
+static bool checkLength(frameConvertFunction reference, frameConvertFunction tested, const std::vector<uint16_t> &src,
+	size_t channels, size_t pixels, size_t offset) {
+	std::vector<uint8_t> referenceDst(offset + (pixels * 4) + BENCH_GUARD_SIZE, BENCH_GUARD_VALUE);
+	std::vector<uint8_t> testedDst(offset + (pixels * 4) + BENCH_GUARD_SIZE, BENCH_GUARD_VALUE);
+
+	// The source is copied to a buffer of exactly the right size, so that
+	// memory checkers can catch reads past its end.
+	std::vector<uint16_t> exactSrc(src.begin(), src.begin() + (ptrdiff_t) (offset + (pixels * channels)));
+
+	(*reference)(referenceDst.data() + offset, exactSrc.data() + offset, pixels);
+	(*tested)(testedDst.data() + offset, exactSrc.data() + offset, pixels);
+
+	return (memcmp(referenceDst.data(), testedDst.data(), referenceDst.size()) == 0);
+}
+
+int main(int argc, char *argv[]) {
+	// Allowed command-line options for caer-frameconvert-bench.
+	po::options_description cliDescription("Command-line options");
+	cliDescription.add_options()("help,h", "print help text")("length,l",
+		po::value<size_t>()->default_value(200), "check all lengths from 0 to this many pixels")("sizex,x",
+		po::value<uint32_t>()->default_value(346), "frame width for measuring throughput")("sizey,y",
+		po::value<uint32_t>()->default_value(260), "frame height for measuring throughput")("iterations,n",
+		po::value<size_t>()->default_value(1000), "frames to convert for measuring throughput, 0 to skip it");
+
+	po::variables_map cliVarMap;
+	try {
+		po::store(boost::program_options::parse_command_line(argc, argv, cliDescription), cliVarMap);
+		po::notify(cliVarMap);
+	}
+	catch (...) {
+		std::cout << "Failed to parse command-line options!" << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
+	// Parse/check command-line options.
+	if (cliVarMap.count("help")) {
+		printHelpAndExit(cliDescription);
+	}
+
+	const size_t checkPixels = cliVarMap["length"].as<size_t>();
+	const uint32_t sizeX = cliVarMap["sizex"].as<uint32_t>();
+	const uint32_t sizeY = cliVarMap["sizey"].as<uint32_t>();
+	const size_t iterations = cliVarMap["iterations"].as<size_t>();
+
+	if (sizeX == 0 || sizeY == 0) {
+		std::cout << "Frame sizes must be positive!" << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
+	const size_t framePixels = (size_t) sizeX * sizeY;
+
+	std::vector<const struct frame_convert_kernels *> kernelsList;
+	kernelsList.push_back(&frameConvertKernelsScalar);
+#if defined(FRAME_CONVERT_BENCH_X86)
+	kernelsList.push_back(&frameConvertKernelsSSE2);
+	kernelsList.push_back(&frameConvertKernelsSSSE3);
+	kernelsList.push_back(&frameConvertKernelsAVX2);
+#endif
+#if defined(FRAME_CONVERT_BENCH_ARM)
+	kernelsList.push_back(&frameConvertKernelsNEON);
+#endif
+
+	// Enough source data for both the checks (plus one value of offset) and
+	// a full frame, in the format with the most channels. Full 16-bit range.
+	std::mt19937 rng(BENCH_RANDOM_SEED);
+	std::uniform_int_distribution<uint32_t> randomPixel(0, UINT16_MAX);
+
+	std::vector<uint16_t> src(std::max(checkPixels + 1, framePixels) * 4);
+	for (auto &value : src) {
+		value = (uint16_t) randomPixel(rng);
+	}
+
+	std::vector<uint8_t> dst(framePixels * 4);
+
+	std::cout << boost::format("%-10s %-8s %-22s %12s %12s %8s") % "Format" % "Kernels" % "Check" % "us/frame"
+		% "Mpixels/s" % "Speedup" << std::endl;
+
+	bool failed = false;
+
+	for (const auto &format : benchFormats) {
+		const frameConvertFunction reference = getFunction(&frameConvertKernelsScalar, format.format);
+		double referenceSeconds = 0;
+
+		for (const auto kernels : kernelsList) {
+			if (!kernelsSupported(kernels)) {
+				std::cout << boost::format("%-10s %-8s not supported by this CPU") % format.name % kernels->name
+					<< std::endl;
+				continue;
+			}
+
+			const frameConvertFunction tested = getFunction(kernels, format.format);
+
+			std::string check("reference");
+
+			if (kernels != &frameConvertKernelsScalar) {
+				check = "match";
+
+				for (size_t pixels = 0; pixels <= checkPixels; pixels++) {
+					if (!checkLength(reference, tested, src, format.channels, pixels, 0)
+						|| !checkLength(reference, tested, src, format.channels, pixels, 1)) {
+						check = (boost::format("MISMATCH (%d pixels)") % pixels).str();
+						failed = true;
+						break;
+					}
+				}
+			}
+
+			std::string microsPerFrame("-");
+			std::string pixelsPerSecond("-");
+			std::string speedup("-");
+
+			if (iterations != 0) {
+				const auto start = std::chrono::steady_clock::now();
+
+				for (size_t i = 0; i < iterations; i++) {
+					(*tested)(dst.data(), src.data(), framePixels);
+				}
+
+				const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+				const double seconds = elapsed.count() / (double) iterations;
+
+				if (kernels == &frameConvertKernelsScalar) {
+					referenceSeconds = seconds;
+				}
+
+				microsPerFrame = (boost::format("%.1f") % (seconds * 1000000.0)).str();
+				pixelsPerSecond = (boost::format("%.1f") % ((double) framePixels / seconds / 1000000.0)).str();
+				speedup = (boost::format("%.2fx") % (referenceSeconds / seconds)).str();
+			}
+
+			std::cout << boost::format("%-10s %-8s %-22s %12s %12s %8s") % format.name % kernels->name % check
+				% microsPerFrame % pixelsPerSecond % speedup << std::endl;
+		}
+	}
+
+	return ((failed) ? (EXIT_FAILURE) : (EXIT_SUCCESS));
+}
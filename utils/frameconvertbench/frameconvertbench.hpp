@@ -0,0 +1,36 @@
+#ifndef FRAMECONVERTBENCH_HPP_
+#define FRAMECONVERTBENCH_HPP_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// ext/frame_convert.h selects its kernels at compile time, so it is compiled
+// once per instruction set, each time with different flags, into its own
+// table of conversion functions.
+struct frame_convert_kernels {
+	const char *name;
+	void (*grayscaleToRGBA)(uint8_t *dst, const uint16_t *src, size_t pixels);
+	void (*rgbToRGBA)(uint8_t *dst, const uint16_t *src, size_t pixels);
+	void (*rgbaToRGBA)(uint8_t *dst, const uint16_t *src, size_t pixels);
+};
+
+// Define a kernel table from the functions of the including file's copy of
+// ext/frame_convert.h.
+#define FRAME_CONVERT_BENCH_KERNELS(VAR, NAME) \
+	extern const struct frame_convert_kernels VAR; \
+	const struct frame_convert_kernels VAR = { NAME, &frameConvertGrayscaleToRGBA, &frameConvertRGBToRGBA, \
+		&frameConvertRGBAToRGBA }
+
+// The scalar code is always there, as reference. The others are only built
+// on matching architectures (see CMakeLists.txt).
+extern const struct frame_convert_kernels frameConvertKernelsScalar;
+#if defined(FRAME_CONVERT_BENCH_X86)
+extern const struct frame_convert_kernels frameConvertKernelsSSE2;
+extern const struct frame_convert_kernels frameConvertKernelsSSSE3;
+extern const struct frame_convert_kernels frameConvertKernelsAVX2;
+#endif
+#if defined(FRAME_CONVERT_BENCH_ARM)
+extern const struct frame_convert_kernels frameConvertKernelsNEON;
+#endif
+
+#endif /* FRAMECONVERTBENCH_HPP_ */
@@ -0,0 +1,9 @@
+#include "ext/frame_convert.h"
+#include "frameconvertbench.hpp"
+
+// Built with -mavx2, see CMakeLists.txt.
+#if !defined(FRAME_CONVERT_AVX2)
+	#error "Wrong compiler flags, AVX2 must be enabled."
+#endif
+
+FRAME_CONVERT_BENCH_KERNELS(frameConvertKernelsAVX2, "AVX2");
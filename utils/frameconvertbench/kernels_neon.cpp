@@ -0,0 +1,9 @@
+#include "ext/frame_convert.h"
+#include "frameconvertbench.hpp"
+
+// NEON is always there on ARM64, see CMakeLists.txt.
+#if !defined(FRAME_CONVERT_NEON)
+	#error "Wrong compiler flags, NEON must be enabled."
+#endif
+
+FRAME_CONVERT_BENCH_KERNELS(frameConvertKernelsNEON, "NEON");
@@ -0,0 +1,5 @@
+#define FRAME_CONVERT_NO_SIMD 1
+#include "ext/frame_convert.h"
+#include "frameconvertbench.hpp"
+
+FRAME_CONVERT_BENCH_KERNELS(frameConvertKernelsScalar, "scalar");
@@ -0,0 +1,9 @@
+#include "ext/frame_convert.h"
+#include "frameconvertbench.hpp"
+
+// Built with -msse2 -mno-ssse3, see CMakeLists.txt.
+#if !defined(FRAME_CONVERT_SSE2) || defined(FRAME_CONVERT_SSSE3)
+	#error "Wrong compiler flags, SSE2 (and only SSE2) must be enabled."
+#endif
+
+FRAME_CONVERT_BENCH_KERNELS(frameConvertKernelsSSE2, "SSE2");
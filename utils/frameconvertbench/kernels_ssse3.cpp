@@ -0,0 +1,9 @@
+#include "ext/frame_convert.h"
+#include "frameconvertbench.hpp"
+
+// Built with -mssse3 -mno-avx2, see CMakeLists.txt.
+#if !defined(FRAME_CONVERT_SSSE3) || defined(FRAME_CONVERT_AVX2)
+	#error "Wrong compiler flags, SSSE3 (and not AVX2) must be enabled."
+#endif
+
+FRAME_CONVERT_BENCH_KERNELS(frameConvertKernelsSSSE3, "SSSE3");
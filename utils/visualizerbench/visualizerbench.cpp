@@ -0,0 +1,490 @@
+#include "main.h"
+#include "modules/visualizer/visualizer_renderers.hpp"
+#include <libcaer/events/polarity.h>
+#include <libcaer/events/frame.h>
+#include <libcaer/events/imu6.h>
+#include <libcaer/events/point2d.h>
+#include <libcaer/events/point4d.h>
+#include <libcaer/events/spike.h>
+#include <libcaercpp/devices/dynapse.hpp> // Only for constants.
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+// Draws the same synthetic event packets with each visualizer renderer into
+// the software framebuffer canvas, compares the first frame against stored
+// images, and measures how many events per second each renderer can draw.
+// All drawing happens on the CPU, so no display or GPU is needed.
+
+#define BENCH_CONFIG_NODE "/caer-visualizer-bench/"
+
+// Packets are generated once, with a fixed seed, so that every run and every
+// renderer gets exactly the same data.
+#define BENCH_RANDOM_SEED 42
+
+#define BENCH_SOURCE_ID 1
+
+static const int16_t dynapseChipIDs[] = { DYNAPSE_CONFIG_DYNAPSE_U0, DYNAPSE_CONFIG_DYNAPSE_U1,
+	DYNAPSE_CONFIG_DYNAPSE_U2, DYNAPSE_CONFIG_DYNAPSE_U3 };
+
+static sshsNode benchConfigNode = nullptr;
+
+[[ noreturn ]] static inline void printHelpAndExit(po::options_description &desc) {
+	std::cout << std::endl << desc << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+// Renderers that change their size do so from their state init function,
+// before the canvas exists. Replace the canvas anyway, should that change.
+void caerVisualizerResetRenderSize(caerVisualizerPublicState pubState, uint32_t newX, uint32_t newY) {
+	struct caer_visualizer_public_state *state = const_cast<struct caer_visualizer_public_state *>(pubState);
+
+	state->renderSizeX = newX;
+	state->renderSizeY = newY;
+
+	if (state->canvas != nullptr) {
+		delete state->canvas;
+		state->canvas = caerVisualizerCanvasInitFramebuffer(newX, newY);
+	}
+}
+
+static caerEventPacketContainer generateContainer(std::mt19937 &rng, uint32_t sizeX, uint32_t sizeY,
+	int32_t eventsNumber, int32_t timeStart, int32_t timeSlice) {
+	// Polarity, Frame, IMU6, Point2D, Point4D and Spike packets.
+	caerEventPacketContainer container = caerEventPacketContainerAllocate(6);
+	if (container == nullptr) {
+		return (nullptr);
+	}
+
+	std::uniform_int_distribution<uint32_t> randomX(0, sizeX - 1);
+	std::uniform_int_distribution<uint32_t> randomY(0, sizeY - 1);
+	std::uniform_int_distribution<uint32_t> randomBit(0, 1);
+	std::uniform_int_distribution<uint32_t> randomChip(0, 3);
+	std::uniform_int_distribution<uint32_t> randomCore(0, DYNAPSE_CONFIG_NUMCORES - 1);
+	std::uniform_int_distribution<uint32_t> randomNeuron(0, DYNAPSE_CONFIG_NUMNEURONS_CORE - 1);
+	std::uniform_int_distribution<uint32_t> randomPixel(0, UINT16_MAX);
+	std::uniform_real_distribution<float> randomUnit(-1.0f, 1.0f);
+
+	// Events are spread evenly over the time slice, in order.
+	auto timestamp = [timeStart, timeSlice, eventsNumber](int32_t i) {
+		return (timeStart + I32T(((int64_t) timeSlice * i) / eventsNumber));
+	};
+
+	caerPolarityEventPacket polarity = caerPolarityEventPacketAllocate(eventsNumber, BENCH_SOURCE_ID, 0);
+	if (polarity != nullptr) {
+		for (int32_t i = 0; i < eventsNumber; i++) {
+			caerPolarityEvent event = caerPolarityEventPacketGetEvent(polarity, i);
+
+			caerPolarityEventSetTimestamp(event, timestamp(i));
+			caerPolarityEventSetX(event, U16T(randomX(rng)));
+			caerPolarityEventSetY(event, U16T(randomY(rng)));
+			caerPolarityEventSetPolarity(event, randomBit(rng));
+			caerPolarityEventValidate(event, polarity);
+		}
+
+		caerEventPacketHeaderSetEventNumber(&polarity->packetHeader, eventsNumber);
+		caerEventPacketContainerSetEventPacket(container, 0, &polarity->packetHeader);
+	}
+
+	// One grayscale frame over the whole area per container, as a camera would send.
+	caerFrameEventPacket frame = caerFrameEventPacketAllocate(1, BENCH_SOURCE_ID, 0, I32T(sizeX), I32T(sizeY), 1);
+	if (frame != nullptr) {
+		caerFrameEvent event = caerFrameEventPacketGetEvent(frame, 0);
+
+		caerFrameEventSetLengthXLengthYChannelNumber(event, I32T(sizeX), I32T(sizeY), GRAYSCALE, frame);
+		caerFrameEventSetTSStartOfFrame(event, timeStart);
+		caerFrameEventSetTSEndOfFrame(event, timeStart + timeSlice - 1);
+
+		uint16_t *pixels = caerFrameEventGetPixelArrayUnsafe(event);
+
+		for (size_t i = 0; i < ((size_t) sizeX * sizeY); i++) {
+			pixels[i] = U16T(randomPixel(rng));
+		}
+
+		caerFrameEventValidate(event, frame);
+
+		caerEventPacketHeaderSetEventNumber(&frame->packetHeader, 1);
+		caerEventPacketContainerSetEventPacket(container, 1, &frame->packetHeader);
+	}
+
+	// IMUs run much slower than the sensor.
+	const int32_t imu6Number = std::max(1, eventsNumber / 100);
+
+	caerIMU6EventPacket imu6 = caerIMU6EventPacketAllocate(imu6Number, BENCH_SOURCE_ID, 0);
+	if (imu6 != nullptr) {
+		for (int32_t i = 0; i < imu6Number; i++) {
+			caerIMU6Event event = caerIMU6EventPacketGetEvent(imu6, i);
+
+			caerIMU6EventSetTimestamp(event, timeStart + I32T(((int64_t) timeSlice * i) / imu6Number));
+			caerIMU6EventSetAccelX(event, randomUnit(rng) * 2.0f);
+			caerIMU6EventSetAccelY(event, randomUnit(rng) * 2.0f);
+			caerIMU6EventSetAccelZ(event, 1.0f + randomUnit(rng));
+			caerIMU6EventSetGyroX(event, randomUnit(rng) * 100.0f);
+			caerIMU6EventSetGyroY(event, randomUnit(rng) * 100.0f);
+			caerIMU6EventSetGyroZ(event, randomUnit(rng) * 100.0f);
+			caerIMU6EventValidate(event, imu6);
+		}
+
+		caerEventPacketHeaderSetEventNumber(&imu6->packetHeader, imu6Number);
+		caerEventPacketContainerSetEventPacket(container, 2, &imu6->packetHeader);
+	}
+
+	caerPoint2DEventPacket point2D = caerPoint2DEventPacketAllocate(eventsNumber, BENCH_SOURCE_ID, 0);
+	if (point2D != nullptr) {
+		for (int32_t i = 0; i < eventsNumber; i++) {
+			caerPoint2DEvent event = caerPoint2DEventPacketGetEvent(point2D, i);
+
+			caerPoint2DEventSetTimestamp(event, timestamp(i));
+			caerPoint2DEventSetX(event, (float) randomX(rng));
+			caerPoint2DEventSetY(event, (float) randomY(rng));
+			caerPoint2DEventValidate(event, point2D);
+		}
+
+		caerEventPacketHeaderSetEventNumber(&point2D->packetHeader, eventsNumber);
+		caerEventPacketContainerSetEventPacket(container, 3, &point2D->packetHeader);
+	}
+
+	// ETF4D plots one column per event, for a handful of them.
+	const int32_t point4DNumber = 4;
+
+	caerPoint4DEventPacket point4D = caerPoint4DEventPacketAllocate(point4DNumber, BENCH_SOURCE_ID, 0);
+	if (point4D != nullptr) {
+		for (int32_t i = 0; i < point4DNumber; i++) {
+			caerPoint4DEvent event = caerPoint4DEventPacketGetEvent(point4D, i);
+
+			caerPoint4DEventSetTimestamp(event, timeStart);
+			caerPoint4DEventSetX(event, (float) randomX(rng));
+			caerPoint4DEventSetY(event, (float) randomY(rng));
+			caerPoint4DEventSetZ(event, 1.0f + randomUnit(rng) * 0.5f);
+			caerPoint4DEventSetW(event, 0);
+			caerPoint4DEventValidate(event, point4D);
+		}
+
+		caerEventPacketHeaderSetEventNumber(&point4D->packetHeader, point4DNumber);
+		caerEventPacketContainerSetEventPacket(container, 4, &point4D->packetHeader);
+	}
+
+	caerSpikeEventPacket spike = caerSpikeEventPacketAllocate(eventsNumber, BENCH_SOURCE_ID, 0);
+	if (spike != nullptr) {
+		for (int32_t i = 0; i < eventsNumber; i++) {
+			caerSpikeEvent event = caerSpikeEventPacketGetEvent(spike, i);
+
+			caerSpikeEventSetTimestamp(event, timestamp(i));
+			caerSpikeEventSetChipID(event, U8T(dynapseChipIDs[randomChip(rng)]));
+			caerSpikeEventSetSourceCoreID(event, U8T(randomCore(rng)));
+			caerSpikeEventSetNeuronID(event, randomNeuron(rng));
+			caerSpikeEventValidate(event, spike);
+		}
+
+		caerEventPacketHeaderSetEventNumber(&spike->packetHeader, eventsNumber);
+		caerEventPacketContainerSetEventPacket(container, 5, &spike->packetHeader);
+	}
+
+	return (container);
+}
+
+static bool rendererInit(struct caer_visualizer_public_state *state, caerVisualizerRendererInfo renderer,
+	uint32_t sizeX, uint32_t sizeY) {
+	state->eventSourceConfigNode = benchConfigNode;
+	state->visualizerConfigNode = benchConfigNode;
+	state->renderSizeX = sizeX;
+	state->renderSizeY = sizeY;
+	state->renderState = nullptr;
+	state->canvas = nullptr;
+	state->roiPositionX = 0;
+	state->roiPositionY = 0;
+
+	if (renderer->stateInit != nullptr) {
+		state->renderState = (*renderer->stateInit)(state);
+		if (state->renderState == nullptr) {
+			return (false);
+		}
+	}
+
+	state->canvas = caerVisualizerCanvasInitFramebuffer(state->renderSizeX, state->renderSizeY);
+
+	return (true);
+}
+
+static void rendererExit(struct caer_visualizer_public_state *state, caerVisualizerRendererInfo renderer) {
+	if ((renderer->stateExit != nullptr) && (state->renderState != nullptr)
+		&& (state->renderState != CAER_VISUALIZER_RENDER_INIT_NO_MEM)) {
+		(*renderer->stateExit)(state);
+	}
+
+	state->renderState = nullptr;
+
+	delete state->canvas;
+	state->canvas = nullptr;
+}
+
+static inline bool rendererFrame(struct caer_visualizer_public_state *state, caerVisualizerRendererInfo renderer,
+	caerEventPacketContainer container) {
+	state->canvas->clear(sf::Color::Black);
+
+	bool drewContainer = (*renderer->renderer)(state, container);
+
+	state->canvas->display();
+
+	return (drewContainer);
+}
+
+// Valid events in the packets a renderer actually draws: each packet is
+// offered alone to a fresh renderer, and counts if it draws something.
+static int64_t rendererDrawnEvents(caerVisualizerRendererInfo renderer, caerEventPacketContainer container,
+	uint32_t sizeX, uint32_t sizeY) {
+	int64_t drawnEvents = 0;
+
+	caerEventPacketContainer probe = caerEventPacketContainerAllocate(1);
+	if (probe == nullptr) {
+		return (0);
+	}
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+		caerEventPacketHeader packet = caerEventPacketContainerGetEventPacket(container, i);
+		if (packet == nullptr) {
+			continue;
+		}
+
+		caerEventPacketContainerSetEventPacket(probe, 0, packet);
+
+		struct caer_visualizer_public_state state;
+		if (!rendererInit(&state, renderer, sizeX, sizeY)) {
+			rendererExit(&state, renderer);
+			break;
+		}
+
+		if (rendererFrame(&state, renderer, probe)) {
+			drawnEvents += caerEventPacketHeaderGetEventValid(packet);
+		}
+
+		rendererExit(&state, renderer);
+	}
+
+	// The packets belong to the original container.
+	caerEventPacketContainerSetEventPacket(probe, 0, nullptr);
+	caerEventPacketContainerFree(probe);
+
+	return (drawnEvents);
+}
+
+// Compare against, or with update set store as, <goldenDir>/<renderer>.png.
+static std::string checkGolden(const struct caer_visualizer_public_state *state, caerVisualizerRendererInfo renderer,
+	const boost::filesystem::path &goldenDir, bool update, bool *failed) {
+	const sf::Vector2u size = state->canvas->getSize();
+	const uint8_t *pixels = state->canvas->readPixels();
+
+	const boost::filesystem::path goldenPath = goldenDir / (renderer->name + ".png");
+
+	if (update) {
+		sf::Image image;
+		image.create(size.x, size.y, pixels);
+
+		if (!image.saveToFile(goldenPath.string())) {
+			*failed = true;
+			return ("write failed");
+		}
+
+		return ("written");
+	}
+
+	if (!boost::filesystem::exists(goldenPath)) {
+		*failed = true;
+		return ("no golden image");
+	}
+
+	sf::Image golden;
+	if (!golden.loadFromFile(goldenPath.string())) {
+		*failed = true;
+		return ("read failed");
+	}
+
+	if (golden.getSize() != size) {
+		*failed = true;
+		return ((boost::format("size %dx%d, expected %dx%d") % size.x % size.y % golden.getSize().x
+			% golden.getSize().y).str());
+	}
+
+	const uint8_t *goldenPixels = golden.getPixelsPtr();
+	size_t differentPixels = 0;
+
+	for (size_t i = 0; i < ((size_t) size.x * size.y); i++) {
+		if (memcmp(pixels + (i * 4), goldenPixels + (i * 4), 4) != 0) {
+			differentPixels++;
+		}
+	}
+
+	if (differentPixels != 0) {
+		*failed = true;
+		return ((boost::format("MISMATCH (%d pixels)") % differentPixels).str());
+	}
+
+	return ("match");
+}
+
+int main(int argc, char *argv[]) {
+	// Allowed command-line options for caer-visualizer-bench.
+	po::options_description cliDescription("Command-line options");
+	cliDescription.add_options()("help,h", "print help text")("renderer,r",
+		po::value<std::vector<std::string>>()->multitoken(),
+		"renderers to check, default all that don't need OpenGL 3.3")("golden,g", po::value<std::string>(),
+		"directory with the expected first frame of each renderer, as <renderer>.png")("update,u",
+		"write the golden images instead of comparing against them")("sizex,x",
+		po::value<uint32_t>()->default_value(240), "render width, the sensor size")("sizey,y",
+		po::value<uint32_t>()->default_value(180), "render height, the sensor size")("events,e",
+		po::value<int32_t>()->default_value(10000), "events per packet")("containers,c",
+		po::value<size_t>()->default_value(16), "different packet containers, drawn in turn")("timeslice,t",
+		po::value<int32_t>()->default_value(10000), "time covered by one packet container, in µs")("iterations,n",
+		po::value<size_t>()->default_value(1000), "frames to draw for measuring throughput, 0 to skip it");
+
+	po::variables_map cliVarMap;
+	try {
+		po::store(boost::program_options::parse_command_line(argc, argv, cliDescription), cliVarMap);
+		po::notify(cliVarMap);
+	}
+	catch (...) {
+		std::cout << "Failed to parse command-line options!" << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
+	// Parse/check command-line options.
+	if (cliVarMap.count("help")) {
+		printHelpAndExit(cliDescription);
+	}
+
+	const uint32_t sizeX = cliVarMap["sizex"].as<uint32_t>();
+	const uint32_t sizeY = cliVarMap["sizey"].as<uint32_t>();
+	const int32_t eventsNumber = cliVarMap["events"].as<int32_t>();
+	const size_t containersNumber = cliVarMap["containers"].as<size_t>();
+	const int32_t timeSlice = cliVarMap["timeslice"].as<int32_t>();
+	const size_t iterations = cliVarMap["iterations"].as<size_t>();
+
+	if (sizeX == 0 || sizeY == 0 || eventsNumber <= 0 || containersNumber == 0 || timeSlice <= 0) {
+		std::cout << "Sizes, events, containers and time slice must be positive!" << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
+	if ((int64_t) timeSlice * (int64_t) containersNumber > INT32_MAX) {
+		std::cout << "Containers times time slice must fit into 32-bit timestamps!" << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
+	const bool update = (cliVarMap.count("update") != 0);
+
+	boost::filesystem::path goldenDir;
+	if (cliVarMap.count("golden")) {
+		goldenDir = cliVarMap["golden"].as<std::string>();
+	}
+	else if (update) {
+		std::cout << "Updating golden images needs their directory!" << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
+	// Renderers to check, in list order.
+	std::vector<caerVisualizerRendererInfo> renderers;
+
+	if (cliVarMap.count("renderer")) {
+		for (const auto &name : cliVarMap["renderer"].as<std::vector<std::string>>()) {
+			caerVisualizerRendererInfo found = nullptr;
+
+			for (size_t i = 0; i < caerVisualizerRendererListLength; i++) {
+				if (caerVisualizerRendererList[i].name == name && caerVisualizerRendererList[i].renderer != nullptr) {
+					found = &caerVisualizerRendererList[i];
+					break;
+				}
+			}
+
+			if (found == nullptr || found->needsOpenGL3) {
+				std::cout << "Unknown renderer '" << name << "', or it needs OpenGL 3.3!" << std::endl;
+				std::cout << "Renderers: " << caerVisualizerRendererListOptionsString << std::endl;
+				return (EXIT_FAILURE);
+			}
+
+			renderers.push_back(found);
+		}
+	}
+	else {
+		for (size_t i = 0; i < caerVisualizerRendererListLength; i++) {
+			if (caerVisualizerRendererList[i].renderer != nullptr && !caerVisualizerRendererList[i].needsOpenGL3) {
+				renderers.push_back(&caerVisualizerRendererList[i]);
+			}
+		}
+	}
+
+	// Renderers may read and create configuration attributes.
+	benchConfigNode = sshsGetNode(sshsGetGlobal(), BENCH_CONFIG_NODE);
+
+	std::mt19937 rng(BENCH_RANDOM_SEED);
+	std::vector<caerEventPacketContainer> containers;
+
+	for (size_t i = 0; i < containersNumber; i++) {
+		caerEventPacketContainer container = generateContainer(rng, sizeX, sizeY, eventsNumber,
+			I32T(i) * timeSlice, timeSlice);
+		if (container == nullptr) {
+			std::cerr << "Failed to allocate event packets." << std::endl;
+			return (EXIT_FAILURE);
+		}
+
+		containers.push_back(container);
+	}
+
+	std::cout << boost::format("%-22s %10s %10s %14s  %s") % "Renderer" % "Events" % "Frames/s" % "Events/s"
+		% "Golden image" << std::endl;
+
+	bool failed = false;
+
+	for (const auto renderer : renderers) {
+		const int64_t drawnEvents = rendererDrawnEvents(renderer, containers[0], sizeX, sizeY);
+
+		struct caer_visualizer_public_state state;
+		if (!rendererInit(&state, renderer, sizeX, sizeY)) {
+			rendererExit(&state, renderer);
+
+			std::cout << boost::format("%-22s failed to initialize") % renderer->name << std::endl;
+			failed = true;
+			continue;
+		}
+
+		// The first frame, drawn from a fresh state, is the one that is compared.
+		rendererFrame(&state, renderer, containers[0]);
+
+		std::string golden("-");
+		if (!goldenDir.empty()) {
+			golden = checkGolden(&state, renderer, goldenDir, update, &failed);
+		}
+
+		std::string framesPerSecond("-");
+		std::string eventsPerSecond("-");
+
+		if (iterations != 0) {
+			const auto start = std::chrono::steady_clock::now();
+
+			for (size_t i = 1; i <= iterations; i++) {
+				rendererFrame(&state, renderer, containers[i % containersNumber]);
+			}
+
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			framesPerSecond = (boost::format("%.1f") % ((double) iterations / elapsed.count())).str();
+			eventsPerSecond = (boost::format("%.0f")
+				% ((double) drawnEvents * (double) iterations / elapsed.count())).str();
+		}
+
+		rendererExit(&state, renderer);
+
+		std::cout << boost::format("%-22s %10d %10s %14s  %s") % renderer->name % drawnEvents % framesPerSecond
+			% eventsPerSecond % golden << std::endl;
+	}
+
+	for (const auto container : containers) {
+		caerEventPacketContainerFree(container);
+	}
+
+	return ((failed) ? (EXIT_FAILURE) : (EXIT_SUCCESS));
+}